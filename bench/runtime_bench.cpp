@@ -0,0 +1,839 @@
+// Benchmark harness for the OpenXR Simulator runtime
+// - Loads openxr_simulator.dll directly through xrNegotiateLoaderRuntimeInterface (no loader,
+//   no registry), so a run measures exactly the DLL next to it
+// - Creates a D3D11, D3D12 and OpenGL session in turn and drives synthetic frames: the eye
+//   swapchains are acquired, waited and released every frame but never drawn to, so the
+//   numbers are the runtime's own CPU cost
+// - The runtime runs headless (no preview window) unless --windowed is given; headless composes
+//   no quad layers, so the quad-layer sweep only measures real compositing with --windowed
+// - Output is JSON Lines, one record per measurement, so runs can be appended to one file and
+//   compared across releases
+//
+// Measurements (times in microseconds, warm-up frames excluded):
+//   wait_frame_pacing  xrWaitFrame return-to-return interval at a fixed refresh rate, and its
+//                      deviation from the predicted display period (jitter)
+//   end_frame          xrEndFrame CPU time per backend and per-eye resolution
+//   quad_layers        xrEndFrame CPU time with 0..8 quad layers over the projection layer
+//   action_polling     xrSyncActions plus one xrGetActionState* call per action
+//   swapchain_create / swapchain_destroy  per backend and resolution
+//
+// Usage:
+//   openxr_simulator_bench [--runtime path.dll] [--backends d3d11,d3d12,gl] [--frames N]
+//                          [--warmup N] [--refresh HZ] [--windowed] [--out results.jsonl]
+
+#define XR_USE_PLATFORM_WIN32
+#define XR_USE_GRAPHICS_API_D3D11
+#define XR_USE_GRAPHICS_API_D3D12
+#define XR_USE_GRAPHICS_API_OPENGL
+
+#include <windows.h>
+#include <wrl/client.h>
+#include <d3d11.h>
+#include <d3d12.h>
+#include <dxgi.h>
+#include <GL/gl.h>
+
+#include <string>
+#include <vector>
+#include <algorithm>
+#include <cmath>
+#include <cstdarg>
+#include <cstdio>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+
+#include <openxr/openxr.h>
+#include <openxr/openxr_platform.h>
+#include <loader_interfaces.h>
+
+#pragma comment(lib, "d3d11.lib")
+#pragma comment(lib, "d3d12.lib")
+#pragma comment(lib, "dxgi.lib")
+#pragma comment(lib, "opengl32.lib")
+
+using Microsoft::WRL::ComPtr;
+
+namespace {
+
+// Runtime entry points the harness calls, resolved through xrGetInstanceProcAddr
+#define BENCH_FUNCTIONS(X) \
+    X(xrCreateInstance) \
+    X(xrDestroyInstance) \
+    X(xrGetInstanceProperties) \
+    X(xrGetSystem) \
+    X(xrGetD3D11GraphicsRequirementsKHR) \
+    X(xrGetD3D12GraphicsRequirementsKHR) \
+    X(xrGetOpenGLGraphicsRequirementsKHR) \
+    X(xrCreateSession) \
+    X(xrDestroySession) \
+    X(xrBeginSession) \
+    X(xrEndSession) \
+    X(xrPollEvent) \
+    X(xrEnumerateSwapchainFormats) \
+    X(xrCreateSwapchain) \
+    X(xrDestroySwapchain) \
+    X(xrEnumerateSwapchainImages) \
+    X(xrAcquireSwapchainImage) \
+    X(xrWaitSwapchainImage) \
+    X(xrReleaseSwapchainImage) \
+    X(xrCreateReferenceSpace) \
+    X(xrDestroySpace) \
+    X(xrWaitFrame) \
+    X(xrBeginFrame) \
+    X(xrEndFrame) \
+    X(xrLocateViews) \
+    X(xrStringToPath) \
+    X(xrCreateActionSet) \
+    X(xrDestroyActionSet) \
+    X(xrCreateAction) \
+    X(xrDestroyAction) \
+    X(xrSuggestInteractionProfileBindings) \
+    X(xrAttachSessionActionSets) \
+    X(xrSyncActions) \
+    X(xrGetActionStateBoolean) \
+    X(xrGetActionStateFloat)
+
+struct Api {
+    PFN_xrGetInstanceProcAddr getInstanceProcAddr = nullptr;
+#define BENCH_FN_MEMBER(name) PFN_##name name = nullptr;
+    BENCH_FUNCTIONS(BENCH_FN_MEMBER)
+#undef BENCH_FN_MEMBER
+};
+
+Api g_xr;
+
+struct Options {
+    std::string runtimePath;
+    std::vector<std::string> backends = { "d3d11", "d3d12", "gl" };
+    uint32_t frames = 240;
+    uint32_t warmup = 30;
+    int refreshHz = 90;
+    bool windowed = false;
+    std::string outPath;  // empty: stdout
+};
+
+FILE* g_out = stdout;
+
+void Note(const char* fmt, ...) {
+    va_list args;
+    va_start(args, fmt);
+    fprintf(stderr, "[bench] ");
+    vfprintf(stderr, fmt, args);
+    fprintf(stderr, "\n");
+    va_end(args);
+}
+
+double NowUs() {
+    static LARGE_INTEGER freq = [] { LARGE_INTEGER f; QueryPerformanceFrequency(&f); return f; }();
+    LARGE_INTEGER now;
+    QueryPerformanceCounter(&now);
+    return (double)now.QuadPart * 1e6 / (double)freq.QuadPart;
+}
+
+#define XR_CHECK(call)                                                         \
+    do {                                                                       \
+        const XrResult xrCheckResult = (call);                                 \
+        if (XR_FAILED(xrCheckResult)) {                                        \
+            Note("%s failed (XrResult %d)", #call, (int)xrCheckResult);        \
+            return false;                                                      \
+        }                                                                      \
+    } while (0)
+
+// ---------------------------------------------------------------------------------------------
+// Results
+
+struct Stats {
+    size_t samples = 0;
+    double mean = 0, p50 = 0, p95 = 0, p99 = 0, max = 0;
+};
+
+Stats Summarize(std::vector<double> values) {
+    Stats s;
+    if (values.empty()) return s;
+    std::sort(values.begin(), values.end());
+    auto pct = [&](double p) { return values[std::min(values.size() - 1, (size_t)(p * (double)(values.size() - 1) + 0.5))]; };
+    double sum = 0;
+    for (double v : values) sum += v;
+    s.samples = values.size();
+    s.mean = sum / (double)values.size();
+    s.p50 = pct(0.50);
+    s.p95 = pct(0.95);
+    s.p99 = pct(0.99);
+    s.max = values.back();
+    return s;
+}
+
+// {"bench": ..., "backend": ..., <extra>, "samples": .., "mean_us": .., ...}
+void Emit(const char* bench, const char* backend, const char* extra, const Stats& s) {
+    fprintf(g_out, "{\"bench\": \"%s\", \"backend\": \"%s\"%s%s, \"samples\": %zu, \"mean_us\": %.2f, "
+            "\"p50_us\": %.2f, \"p95_us\": %.2f, \"p99_us\": %.2f, \"max_us\": %.2f}\n",
+            bench, backend, extra[0] ? ", " : "", extra, s.samples, s.mean, s.p50, s.p95, s.p99, s.max);
+    fflush(g_out);
+}
+
+// ---------------------------------------------------------------------------------------------
+// Graphics devices
+
+struct Device {
+    std::string backend;
+    ComPtr<ID3D11Device> d3d11;
+    ComPtr<ID3D12Device> d3d12;
+    ComPtr<ID3D12CommandQueue> queue12;
+    HWND glWindow = nullptr;
+    HDC glDC = nullptr;
+    HGLRC glRC = nullptr;
+
+    XrGraphicsBindingD3D11KHR binding11{ XR_TYPE_GRAPHICS_BINDING_D3D11_KHR };
+    XrGraphicsBindingD3D12KHR binding12{ XR_TYPE_GRAPHICS_BINDING_D3D12_KHR };
+    XrGraphicsBindingOpenGLWin32KHR bindingGL{ XR_TYPE_GRAPHICS_BINDING_OPENGL_WIN32_KHR };
+
+    XrStructureType ImageType() const {
+        if (backend == "d3d11") return XR_TYPE_SWAPCHAIN_IMAGE_D3D11_KHR;
+        if (backend == "d3d12") return XR_TYPE_SWAPCHAIN_IMAGE_D3D12_KHR;
+        return XR_TYPE_SWAPCHAIN_IMAGE_OPENGL_KHR;
+    }
+    size_t ImageSize() const {
+        if (backend == "d3d11") return sizeof(XrSwapchainImageD3D11KHR);
+        if (backend == "d3d12") return sizeof(XrSwapchainImageD3D12KHR);
+        return sizeof(XrSwapchainImageOpenGLKHR);
+    }
+    const void* Binding() const {
+        if (backend == "d3d11") return &binding11;
+        if (backend == "d3d12") return &binding12;
+        return &bindingGL;
+    }
+};
+
+bool CreateDevice(XrInstance instance, XrSystemId system, Device& dev) {
+    if (dev.backend == "d3d11") {
+        XrGraphicsRequirementsD3D11KHR req{ XR_TYPE_GRAPHICS_REQUIREMENTS_D3D11_KHR };
+        XR_CHECK(g_xr.xrGetD3D11GraphicsRequirementsKHR(instance, system, &req));
+        const D3D_FEATURE_LEVEL level = req.minFeatureLevel;
+        HRESULT hr = D3D11CreateDevice(nullptr, D3D_DRIVER_TYPE_HARDWARE, nullptr, D3D11_CREATE_DEVICE_BGRA_SUPPORT,
+                                       &level, 1, D3D11_SDK_VERSION, dev.d3d11.GetAddressOf(), nullptr, nullptr);
+        if (FAILED(hr)) {
+            Note("D3D11CreateDevice failed (0x%08X)", (unsigned)hr);
+            return false;
+        }
+        dev.binding11.device = dev.d3d11.Get();
+        return true;
+    }
+    if (dev.backend == "d3d12") {
+        XrGraphicsRequirementsD3D12KHR req{ XR_TYPE_GRAPHICS_REQUIREMENTS_D3D12_KHR };
+        XR_CHECK(g_xr.xrGetD3D12GraphicsRequirementsKHR(instance, system, &req));
+        HRESULT hr = D3D12CreateDevice(nullptr, req.minFeatureLevel, IID_PPV_ARGS(dev.d3d12.GetAddressOf()));
+        if (FAILED(hr)) {
+            Note("D3D12CreateDevice failed (0x%08X)", (unsigned)hr);
+            return false;
+        }
+        D3D12_COMMAND_QUEUE_DESC qd = {};
+        qd.Type = D3D12_COMMAND_LIST_TYPE_DIRECT;
+        hr = dev.d3d12->CreateCommandQueue(&qd, IID_PPV_ARGS(dev.queue12.GetAddressOf()));
+        if (FAILED(hr)) {
+            Note("CreateCommandQueue failed (0x%08X)", (unsigned)hr);
+            return false;
+        }
+        dev.binding12.device = dev.d3d12.Get();
+        dev.binding12.queue = dev.queue12.Get();
+        return true;
+    }
+
+    XrGraphicsRequirementsOpenGLKHR req{ XR_TYPE_GRAPHICS_REQUIREMENTS_OPENGL_KHR };
+    XR_CHECK(g_xr.xrGetOpenGLGraphicsRequirementsKHR(instance, system, &req));
+    // Hidden window for the pixel format; the context stays current on this thread
+    WNDCLASSA wc = {};
+    wc.lpfnWndProc = DefWindowProcA;
+    wc.hInstance = GetModuleHandleA(nullptr);
+    wc.lpszClassName = "OpenXRSimulatorBenchGL";
+    RegisterClassA(&wc);
+    dev.glWindow = CreateWindowA(wc.lpszClassName, "bench", WS_OVERLAPPEDWINDOW, 0, 0, 64, 64,
+                                 nullptr, nullptr, wc.hInstance, nullptr);
+    dev.glDC = dev.glWindow ? GetDC(dev.glWindow) : nullptr;
+    if (!dev.glDC) {
+        Note("GL: cannot create the context window (error=%lu)", GetLastError());
+        return false;
+    }
+    PIXELFORMATDESCRIPTOR pfd = { sizeof(pfd), 1 };
+    pfd.dwFlags = PFD_DRAW_TO_WINDOW | PFD_SUPPORT_OPENGL | PFD_DOUBLEBUFFER;
+    pfd.iPixelType = PFD_TYPE_RGBA;
+    pfd.cColorBits = 32;
+    pfd.cDepthBits = 24;
+    const int format = ChoosePixelFormat(dev.glDC, &pfd);
+    if (!format || !SetPixelFormat(dev.glDC, format, &pfd) || !(dev.glRC = wglCreateContext(dev.glDC)) ||
+        !wglMakeCurrent(dev.glDC, dev.glRC)) {
+        Note("GL: cannot create a context (error=%lu)", GetLastError());
+        return false;
+    }
+    dev.bindingGL.hDC = dev.glDC;
+    dev.bindingGL.hGLRC = dev.glRC;
+    return true;
+}
+
+void DestroyDevice(Device& dev) {
+    if (dev.glRC) {
+        wglMakeCurrent(nullptr, nullptr);
+        wglDeleteContext(dev.glRC);
+    }
+    if (dev.glDC) ReleaseDC(dev.glWindow, dev.glDC);
+    if (dev.glWindow) DestroyWindow(dev.glWindow);
+    dev.glRC = nullptr;
+    dev.glDC = nullptr;
+    dev.glWindow = nullptr;
+    dev.queue12.Reset();
+    dev.d3d12.Reset();
+    dev.d3d11.Reset();
+}
+
+// ---------------------------------------------------------------------------------------------
+// Session
+
+struct Chain {
+    XrSwapchain handle = XR_NULL_HANDLE;
+    int32_t width = 0, height = 0;
+};
+
+struct Session {
+    XrInstance instance = XR_NULL_HANDLE;
+    XrSystemId system = XR_NULL_SYSTEM_ID;
+    Device* dev = nullptr;
+    XrSession handle = XR_NULL_HANDLE;
+    XrSpace local = XR_NULL_HANDLE;
+    int64_t colorFormat = 0;
+    Chain eyes[2];
+    std::vector<Chain> quads;
+    XrActionSet actionSet = XR_NULL_HANDLE;
+    std::vector<XrAction> actions;
+    std::vector<bool> actionIsFloat;
+};
+
+void DrainEvents(XrInstance instance, XrSessionState* last = nullptr) {
+    XrEventDataBuffer event{ XR_TYPE_EVENT_DATA_BUFFER };
+    while (g_xr.xrPollEvent(instance, &event) == XR_SUCCESS) {
+        if (event.type == XR_TYPE_EVENT_DATA_SESSION_STATE_CHANGED && last) {
+            *last = reinterpret_cast<const XrEventDataSessionStateChanged*>(&event)->state;
+        }
+        event = { XR_TYPE_EVENT_DATA_BUFFER };
+    }
+}
+
+bool CreateChain(Session& s, int32_t width, int32_t height, Chain& chain) {
+    XrSwapchainCreateInfo ci{ XR_TYPE_SWAPCHAIN_CREATE_INFO };
+    ci.usageFlags = XR_SWAPCHAIN_USAGE_COLOR_ATTACHMENT_BIT | XR_SWAPCHAIN_USAGE_SAMPLED_BIT;
+    ci.format = s.colorFormat;
+    ci.sampleCount = 1;
+    ci.width = (uint32_t)width;
+    ci.height = (uint32_t)height;
+    ci.faceCount = 1;
+    ci.arraySize = 1;
+    ci.mipCount = 1;
+    XR_CHECK(g_xr.xrCreateSwapchain(s.handle, &ci, &chain.handle));
+    chain.width = width;
+    chain.height = height;
+    // Apps enumerate once after creation; the harness does too so backends create their views
+    uint32_t count = 0;
+    XR_CHECK(g_xr.xrEnumerateSwapchainImages(chain.handle, 0, &count, nullptr));
+    std::vector<uint8_t> images(count * s.dev->ImageSize());
+    for (uint32_t i = 0; i < count; ++i) {
+        auto* header = reinterpret_cast<XrSwapchainImageBaseHeader*>(images.data() + i * s.dev->ImageSize());
+        header->type = s.dev->ImageType();
+    }
+    XR_CHECK(g_xr.xrEnumerateSwapchainImages(chain.handle, count, &count,
+                                             reinterpret_cast<XrSwapchainImageBaseHeader*>(images.data())));
+    return true;
+}
+
+void DestroyChain(Chain& chain) {
+    if (chain.handle != XR_NULL_HANDLE) g_xr.xrDestroySwapchain(chain.handle);
+    chain = {};
+}
+
+bool CycleChain(const Chain& chain) {
+    uint32_t index = 0;
+    XR_CHECK(g_xr.xrAcquireSwapchainImage(chain.handle, nullptr, &index));
+    XrSwapchainImageWaitInfo wait{ XR_TYPE_SWAPCHAIN_IMAGE_WAIT_INFO };
+    wait.timeout = XR_INFINITE_DURATION;
+    XR_CHECK(g_xr.xrWaitSwapchainImage(chain.handle, &wait));
+    XR_CHECK(g_xr.xrReleaseSwapchainImage(chain.handle, nullptr));
+    return true;
+}
+
+bool BeginSession(Session& s) {
+    XrSessionCreateInfo ci{ XR_TYPE_SESSION_CREATE_INFO };
+    ci.next = s.dev->Binding();
+    ci.systemId = s.system;
+    XR_CHECK(g_xr.xrCreateSession(s.instance, &ci, &s.handle));
+    XrSessionState state = XR_SESSION_STATE_UNKNOWN;
+    DrainEvents(s.instance, &state);
+    XrSessionBeginInfo bi{ XR_TYPE_SESSION_BEGIN_INFO };
+    bi.primaryViewConfigurationType = XR_VIEW_CONFIGURATION_TYPE_PRIMARY_STEREO;
+    XR_CHECK(g_xr.xrBeginSession(s.handle, &bi));
+    DrainEvents(s.instance);
+
+    XrReferenceSpaceCreateInfo si{ XR_TYPE_REFERENCE_SPACE_CREATE_INFO };
+    si.referenceSpaceType = XR_REFERENCE_SPACE_TYPE_LOCAL;
+    si.poseInReferenceSpace.orientation.w = 1.0f;
+    XR_CHECK(g_xr.xrCreateReferenceSpace(s.handle, &si, &s.local));
+
+    uint32_t count = 0;
+    XR_CHECK(g_xr.xrEnumerateSwapchainFormats(s.handle, 0, &count, nullptr));
+    std::vector<int64_t> formats(count);
+    XR_CHECK(g_xr.xrEnumerateSwapchainFormats(s.handle, count, &count, formats.data()));
+    if (formats.empty()) {
+        Note("%s: no swapchain formats", s.dev->backend.c_str());
+        return false;
+    }
+    s.colorFormat = formats[0];
+    return true;
+}
+
+void EndSession(Session& s) {
+    for (Chain& chain : s.quads) DestroyChain(chain);
+    s.quads.clear();
+    for (Chain& eye : s.eyes) DestroyChain(eye);
+    for (XrAction action : s.actions) g_xr.xrDestroyAction(action);
+    s.actions.clear();
+    s.actionIsFloat.clear();
+    if (s.actionSet != XR_NULL_HANDLE) g_xr.xrDestroyActionSet(s.actionSet);
+    s.actionSet = XR_NULL_HANDLE;
+    if (s.local != XR_NULL_HANDLE) g_xr.xrDestroySpace(s.local);
+    s.local = XR_NULL_HANDLE;
+    if (s.handle != XR_NULL_HANDLE) {
+        g_xr.xrEndSession(s.handle);
+        g_xr.xrDestroySession(s.handle);
+        DrainEvents(s.instance);
+    }
+    s.handle = XR_NULL_HANDLE;
+}
+
+bool CreateEyes(Session& s, int32_t width, int32_t height) {
+    for (Chain& eye : s.eyes) {
+        DestroyChain(eye);
+        if (!CreateChain(s, width, height, eye)) return false;
+    }
+    return true;
+}
+
+// Per-frame timings of one synthetic frame
+struct FrameTimes {
+    double waitReturnUs = 0;  // when xrWaitFrame returned
+    double endFrameUs = 0;    // xrEndFrame CPU time
+    XrTime period = 0;
+};
+
+// Wait, begin, cycle every swapchain, locate, submit the projection layer plus the quads
+bool RunFrame(Session& s, FrameTimes& out) {
+    XrFrameState fs{ XR_TYPE_FRAME_STATE };
+    XR_CHECK(g_xr.xrWaitFrame(s.handle, nullptr, &fs));
+    out.waitReturnUs = NowUs();
+    out.period = fs.predictedDisplayPeriod;
+    XR_CHECK(g_xr.xrBeginFrame(s.handle, nullptr));
+
+    for (const Chain& eye : s.eyes) {
+        if (!CycleChain(eye)) return false;
+    }
+    for (const Chain& quad : s.quads) {
+        if (!CycleChain(quad)) return false;
+    }
+
+    XrViewLocateInfo li{ XR_TYPE_VIEW_LOCATE_INFO };
+    li.viewConfigurationType = XR_VIEW_CONFIGURATION_TYPE_PRIMARY_STEREO;
+    li.displayTime = fs.predictedDisplayTime;
+    li.space = s.local;
+    XrViewState vs{ XR_TYPE_VIEW_STATE };
+    XrView views[2] = { { XR_TYPE_VIEW }, { XR_TYPE_VIEW } };
+    uint32_t viewCount = 0;
+    XR_CHECK(g_xr.xrLocateViews(s.handle, &li, &vs, 2, &viewCount, views));
+
+    XrCompositionLayerProjectionView projViews[2] = { { XR_TYPE_COMPOSITION_LAYER_PROJECTION_VIEW },
+                                                      { XR_TYPE_COMPOSITION_LAYER_PROJECTION_VIEW } };
+    for (int i = 0; i < 2; ++i) {
+        projViews[i].pose = views[i].pose;
+        projViews[i].fov = views[i].fov;
+        projViews[i].subImage.swapchain = s.eyes[i].handle;
+        projViews[i].subImage.imageRect = { { 0, 0 }, { s.eyes[i].width, s.eyes[i].height } };
+    }
+    XrCompositionLayerProjection proj{ XR_TYPE_COMPOSITION_LAYER_PROJECTION };
+    proj.space = s.local;
+    proj.viewCount = 2;
+    proj.views = projViews;
+
+    std::vector<XrCompositionLayerQuad> quads(s.quads.size(), XrCompositionLayerQuad{ XR_TYPE_COMPOSITION_LAYER_QUAD });
+    std::vector<const XrCompositionLayerBaseHeader*> layers;
+    layers.push_back(reinterpret_cast<const XrCompositionLayerBaseHeader*>(&proj));
+    for (size_t i = 0; i < s.quads.size(); ++i) {
+        XrCompositionLayerQuad& q = quads[i];
+        q.space = s.local;
+        q.eyeVisibility = XR_EYE_VISIBILITY_BOTH;
+        q.subImage.swapchain = s.quads[i].handle;
+        q.subImage.imageRect = { { 0, 0 }, { s.quads[i].width, s.quads[i].height } };
+        // Spread over the view so the layers do not all cover the same pixels
+        q.pose.orientation.w = 1.0f;
+        q.pose.position = { -0.6f + 0.4f * (float)(i % 4), 0.3f - 0.4f * (float)(i / 4), -1.5f };
+        q.size = { 0.35f, 0.35f };
+        layers.push_back(reinterpret_cast<const XrCompositionLayerBaseHeader*>(&q));
+    }
+
+    XrFrameEndInfo ei{ XR_TYPE_FRAME_END_INFO };
+    ei.displayTime = fs.predictedDisplayTime;
+    ei.environmentBlendMode = XR_ENVIRONMENT_BLEND_MODE_OPAQUE;
+    ei.layerCount = (uint32_t)layers.size();
+    ei.layers = layers.data();
+    const double start = NowUs();
+    XR_CHECK(g_xr.xrEndFrame(s.handle, &ei));
+    out.endFrameUs = NowUs() - start;
+    DrainEvents(s.instance);
+    return true;
+}
+
+// ---------------------------------------------------------------------------------------------
+// Benchmarks
+
+bool BenchPacing(Session& s, const Options& opt) {
+    if (!CreateEyes(s, 1024, 1024)) return false;
+    std::vector<double> intervals, jitter;
+    double lastReturn = 0;
+    uint32_t missed = 0;
+    double periodUs = 0;
+    for (uint32_t f = 0; f < opt.warmup + opt.frames; ++f) {
+        FrameTimes t;
+        if (!RunFrame(s, t)) return false;
+        if (f > opt.warmup) {
+            const double interval = t.waitReturnUs - lastReturn;
+            periodUs = (double)t.period * 1e-3;
+            intervals.push_back(interval);
+            jitter.push_back(fabs(interval - periodUs));
+            if (interval > periodUs * 1.5) ++missed;
+        }
+        lastReturn = t.waitReturnUs;
+    }
+    char extra[160];
+    snprintf(extra, sizeof(extra), "\"refresh_hz\": %d, \"period_us\": %.2f, \"missed\": %u", opt.refreshHz, periodUs,
+             missed);
+    Emit("wait_frame_pacing", s.dev->backend.c_str(), extra, Summarize(intervals));
+    Emit("wait_frame_jitter", s.dev->backend.c_str(), extra, Summarize(jitter));
+    return true;
+}
+
+const int32_t kResolutions[][2] = { { 1024, 1024 }, { 1832, 1920 }, { 2880, 2880 } };
+
+bool BenchEndFrame(Session& s, const Options& opt) {
+    for (const auto& res : kResolutions) {
+        if (!CreateEyes(s, res[0], res[1])) return false;
+        std::vector<double> end;
+        for (uint32_t f = 0; f < opt.warmup + opt.frames; ++f) {
+            FrameTimes t;
+            if (!RunFrame(s, t)) return false;
+            if (f >= opt.warmup) end.push_back(t.endFrameUs);
+        }
+        char extra[96];
+        snprintf(extra, sizeof(extra), "\"width\": %d, \"height\": %d, \"headless\": %s", res[0], res[1],
+                 opt.windowed ? "false" : "true");
+        Emit("end_frame", s.dev->backend.c_str(), extra, Summarize(end));
+    }
+    return true;
+}
+
+bool BenchQuadLayers(Session& s, const Options& opt) {
+    if (!CreateEyes(s, 1832, 1920)) return false;
+    const uint32_t kLayerCounts[] = { 0, 1, 4, 8 };
+    for (uint32_t layers : kLayerCounts) {
+        while (s.quads.size() < layers) {
+            Chain quad;
+            if (!CreateChain(s, 512, 512, quad)) return false;
+            s.quads.push_back(quad);
+        }
+        std::vector<double> end;
+        for (uint32_t f = 0; f < opt.warmup + opt.frames; ++f) {
+            FrameTimes t;
+            if (!RunFrame(s, t)) return false;
+            if (f >= opt.warmup) end.push_back(t.endFrameUs);
+        }
+        // Headless sessions compose no overlays; the records say so rather than look cheap
+        char extra[96];
+        snprintf(extra, sizeof(extra), "\"layers\": %u, \"composited\": %s", layers, opt.windowed ? "true" : "false");
+        Emit("quad_layers", s.dev->backend.c_str(), extra, Summarize(end));
+    }
+    for (Chain& quad : s.quads) DestroyChain(quad);
+    s.quads.clear();
+    return true;
+}
+
+bool CreateActions(Session& s, uint32_t count) {
+    XrActionSetCreateInfo si{ XR_TYPE_ACTION_SET_CREATE_INFO };
+    strcpy_s(si.actionSetName, "bench");
+    strcpy_s(si.localizedActionSetName, "Bench");
+    XR_CHECK(g_xr.xrCreateActionSet(s.instance, &si, &s.actionSet));
+
+    XrPath profile = XR_NULL_PATH, click = XR_NULL_PATH, value = XR_NULL_PATH;
+    XR_CHECK(g_xr.xrStringToPath(s.instance, "/interaction_profiles/oculus/touch_controller", &profile));
+    XR_CHECK(g_xr.xrStringToPath(s.instance, "/user/hand/right/input/a/click", &click));
+    XR_CHECK(g_xr.xrStringToPath(s.instance, "/user/hand/right/input/trigger/value", &value));
+    std::vector<XrActionSuggestedBinding> bindings;
+    for (uint32_t i = 0; i < count; ++i) {
+        const bool isFloat = (i & 1) != 0;
+        XrActionCreateInfo ai{ XR_TYPE_ACTION_CREATE_INFO };
+        ai.actionType = isFloat ? XR_ACTION_TYPE_FLOAT_INPUT : XR_ACTION_TYPE_BOOLEAN_INPUT;
+        snprintf(ai.actionName, sizeof(ai.actionName), "action_%u", i);
+        snprintf(ai.localizedActionName, sizeof(ai.localizedActionName), "Action %u", i);
+        XrAction action = XR_NULL_HANDLE;
+        XR_CHECK(g_xr.xrCreateAction(s.actionSet, &ai, &action));
+        s.actions.push_back(action);
+        s.actionIsFloat.push_back(isFloat);
+        bindings.push_back({ action, isFloat ? value : click });
+    }
+    XrInteractionProfileSuggestedBinding sb{ XR_TYPE_INTERACTION_PROFILE_SUGGESTED_BINDING };
+    sb.interactionProfile = profile;
+    sb.countSuggestedBindings = (uint32_t)bindings.size();
+    sb.suggestedBindings = bindings.data();
+    XR_CHECK(g_xr.xrSuggestInteractionProfileBindings(s.instance, &sb));
+    XrSessionActionSetsAttachInfo attach{ XR_TYPE_SESSION_ACTION_SETS_ATTACH_INFO };
+    attach.countActionSets = 1;
+    attach.actionSets = &s.actionSet;
+    XR_CHECK(g_xr.xrAttachSessionActionSets(s.handle, &attach));
+    return true;
+}
+
+// One action set with the largest count is attached once; each pass polls its first N actions
+bool BenchActions(Session& s, const Options& opt) {
+    const uint32_t kActionCounts[] = { 1, 8, 32, 128 };
+    if (!CreateActions(s, 128)) return false;
+    XrActiveActionSet active{ s.actionSet, XR_NULL_PATH };
+    XrActionsSyncInfo sync{ XR_TYPE_ACTIONS_SYNC_INFO };
+    sync.countActiveActionSets = 1;
+    sync.activeActionSets = &active;
+    for (uint32_t count : kActionCounts) {
+        std::vector<double> poll;
+        for (uint32_t f = 0; f < opt.warmup + opt.frames; ++f) {
+            const double start = NowUs();
+            XR_CHECK(g_xr.xrSyncActions(s.handle, &sync));
+            for (uint32_t i = 0; i < count; ++i) {
+                XrActionStateGetInfo gi{ XR_TYPE_ACTION_STATE_GET_INFO };
+                gi.action = s.actions[i];
+                if (s.actionIsFloat[i]) {
+                    XrActionStateFloat state{ XR_TYPE_ACTION_STATE_FLOAT };
+                    XR_CHECK(g_xr.xrGetActionStateFloat(s.handle, &gi, &state));
+                } else {
+                    XrActionStateBoolean state{ XR_TYPE_ACTION_STATE_BOOLEAN };
+                    XR_CHECK(g_xr.xrGetActionStateBoolean(s.handle, &gi, &state));
+                }
+            }
+            if (f >= opt.warmup) poll.push_back(NowUs() - start);
+        }
+        char extra[32];
+        snprintf(extra, sizeof(extra), "\"actions\": %u", count);
+        Emit("action_polling", s.dev->backend.c_str(), extra, Summarize(poll));
+    }
+    return true;
+}
+
+bool BenchSwapchains(Session& s, const Options& opt) {
+    const uint32_t iterations = std::max<uint32_t>(opt.frames / 8, 10);
+    for (const auto& res : kResolutions) {
+        std::vector<double> create, destroy;
+        for (uint32_t i = 0; i < iterations; ++i) {
+            Chain chain;
+            double start = NowUs();
+            if (!CreateChain(s, res[0], res[1], chain)) return false;
+            create.push_back(NowUs() - start);
+            start = NowUs();
+            DestroyChain(chain);
+            destroy.push_back(NowUs() - start);
+        }
+        char extra[64];
+        snprintf(extra, sizeof(extra), "\"width\": %d, \"height\": %d", res[0], res[1]);
+        Emit("swapchain_create", s.dev->backend.c_str(), extra, Summarize(create));
+        Emit("swapchain_destroy", s.dev->backend.c_str(), extra, Summarize(destroy));
+    }
+    return true;
+}
+
+// ---------------------------------------------------------------------------------------------
+// Runtime
+
+bool LoadRuntime(const Options& opt) {
+    HMODULE dll = LoadLibraryA(opt.runtimePath.c_str());
+    if (!dll) {
+        Note("cannot load %s (error=%lu)", opt.runtimePath.c_str(), GetLastError());
+        return false;
+    }
+    using PFN_Negotiate = XrResult(XRAPI_PTR*)(const XrNegotiateLoaderInfo*, XrNegotiateRuntimeRequest*);
+    auto negotiate = (PFN_Negotiate)GetProcAddress(dll, "xrNegotiateLoaderRuntimeInterface");
+    if (!negotiate) {
+        Note("%s does not export xrNegotiateLoaderRuntimeInterface", opt.runtimePath.c_str());
+        return false;
+    }
+    XrNegotiateLoaderInfo info = {};
+    info.structType = XR_LOADER_INTERFACE_STRUCT_LOADER_INFO;
+    info.structVersion = XR_LOADER_INFO_STRUCT_VERSION;
+    info.structSize = sizeof(info);
+    info.minInterfaceVersion = 1;
+    info.maxInterfaceVersion = XR_CURRENT_LOADER_RUNTIME_VERSION;
+    info.minApiVersion = XR_MAKE_VERSION(1, 0, 0);
+    info.maxApiVersion = XR_CURRENT_API_VERSION;
+    XrNegotiateRuntimeRequest request = {};
+    request.structType = XR_LOADER_INTERFACE_STRUCT_RUNTIME_REQUEST;
+    request.structVersion = XR_RUNTIME_INFO_STRUCT_VERSION;
+    request.structSize = sizeof(request);
+    XR_CHECK(negotiate(&info, &request));
+    g_xr.getInstanceProcAddr = request.getInstanceProcAddr;
+    // The runtime resolves every entry point without an instance
+#define BENCH_FN_RESOLVE(name)                                                                           \
+    if (XR_FAILED(g_xr.getInstanceProcAddr(XR_NULL_HANDLE, #name, (PFN_xrVoidFunction*)&g_xr.name)) || \
+        !g_xr.name) {                                                                                    \
+        Note("runtime does not provide %s", #name);                                                      \
+        return false;                                                                                    \
+    }
+    BENCH_FUNCTIONS(BENCH_FN_RESOLVE)
+#undef BENCH_FN_RESOLVE
+    return true;
+}
+
+bool CreateInstance(XrInstance& instance, XrSystemId& system) {
+    const char* extensions[] = { XR_KHR_D3D11_ENABLE_EXTENSION_NAME, XR_KHR_D3D12_ENABLE_EXTENSION_NAME,
+                                 XR_KHR_OPENGL_ENABLE_EXTENSION_NAME };
+    XrInstanceCreateInfo ci{ XR_TYPE_INSTANCE_CREATE_INFO };
+    strcpy_s(ci.applicationInfo.applicationName, "openxr_simulator_bench");
+    ci.applicationInfo.applicationVersion = 1;
+    ci.applicationInfo.apiVersion = XR_CURRENT_API_VERSION;
+    ci.enabledExtensionCount = (uint32_t)(sizeof(extensions) / sizeof(extensions[0]));
+    ci.enabledExtensionNames = extensions;
+    XR_CHECK(g_xr.xrCreateInstance(&ci, &instance));
+    XrSystemGetInfo si{ XR_TYPE_SYSTEM_GET_INFO };
+    si.formFactor = XR_FORM_FACTOR_HEAD_MOUNTED_DISPLAY;
+    XR_CHECK(g_xr.xrGetSystem(instance, &si, &system));
+    return true;
+}
+
+// One instance per phase: the runtime reads its pacing settings in xrCreateInstance
+bool RunPhase(const Options& opt, bool paced) {
+    char refresh[16];
+    snprintf(refresh, sizeof(refresh), "%d", opt.refreshHz);
+    SetEnvironmentVariableA("OPENXR_SIM_REFRESH_RATE", paced ? refresh : "unlocked");
+    XrInstance instance = XR_NULL_HANDLE;
+    XrSystemId system = XR_NULL_SYSTEM_ID;
+    if (!CreateInstance(instance, system)) return false;
+
+    bool ok = true;
+    for (const std::string& backend : opt.backends) {
+        Device dev;
+        dev.backend = backend;
+        Session s;
+        s.instance = instance;
+        s.system = system;
+        s.dev = &dev;
+        Note("%s: %s", backend.c_str(), paced ? "pacing" : "costs");
+        bool passed = CreateDevice(instance, system, dev) && BeginSession(s);
+        if (passed && paced) {
+            passed = BenchPacing(s, opt);
+        } else if (passed) {
+            passed = BenchEndFrame(s, opt) && BenchQuadLayers(s, opt) && BenchActions(s, opt) &&
+                     BenchSwapchains(s, opt);
+        }
+        if (!passed) {
+            Note("%s: benchmark failed", backend.c_str());
+            ok = false;
+        }
+        EndSession(s);
+        DestroyDevice(dev);
+    }
+    g_xr.xrDestroyInstance(instance);
+    return ok;
+}
+
+void EmitMeta(const Options& opt) {
+    XrInstance instance = XR_NULL_HANDLE;
+    XrSystemId system = XR_NULL_SYSTEM_ID;
+    XrInstanceProperties props{ XR_TYPE_INSTANCE_PROPERTIES };
+    if (CreateInstance(instance, system)) {
+        g_xr.xrGetInstanceProperties(instance, &props);
+        g_xr.xrDestroyInstance(instance);
+    }
+    SYSTEMTIME now;
+    GetSystemTime(&now);
+    std::string backends;
+    for (const std::string& b : opt.backends) backends += (backends.empty() ? "\"" : ", \"") + b + "\"";
+    fprintf(g_out, "{\"bench\": \"meta\", \"runtime\": \"%s\", \"runtime_version\": \"%u.%u.%u\", "
+            "\"timestamp\": \"%04u-%02u-%02uT%02u:%02u:%02uZ\", \"backends\": [%s], \"frames\": %u, "
+            "\"warmup\": %u, \"refresh_hz\": %d, \"headless\": %s}\n",
+            props.runtimeName, (unsigned)XR_VERSION_MAJOR(props.runtimeVersion),
+            (unsigned)XR_VERSION_MINOR(props.runtimeVersion), (unsigned)XR_VERSION_PATCH(props.runtimeVersion),
+            now.wYear, now.wMonth, now.wDay, now.wHour, now.wMinute, now.wSecond, backends.c_str(), opt.frames,
+            opt.warmup, opt.refreshHz, opt.windowed ? "false" : "true");
+    fflush(g_out);
+}
+
+bool ParseOptions(int argc, char** argv, Options& opt) {
+    char exe[MAX_PATH] = {};
+    GetModuleFileNameA(nullptr, exe, MAX_PATH);
+    std::string dir = exe;
+    dir = dir.substr(0, dir.find_last_of("\\/") + 1);
+    opt.runtimePath = dir + "openxr_simulator.dll";
+    for (int i = 1; i < argc; ++i) {
+        const std::string arg = argv[i];
+        const bool hasValue = i + 1 < argc;
+        if (arg == "--runtime" && hasValue) {
+            opt.runtimePath = argv[++i];
+        } else if (arg == "--backends" && hasValue) {
+            opt.backends.clear();
+            std::string list = argv[++i];
+            size_t pos = 0;
+            while (pos <= list.size()) {
+                const size_t comma = std::min(list.find(',', pos), list.size());
+                const std::string name = list.substr(pos, comma - pos);
+                if (name == "d3d11" || name == "d3d12" || name == "gl") {
+                    opt.backends.push_back(name);
+                } else if (!name.empty()) {
+                    Note("unknown backend %s (d3d11, d3d12, gl)", name.c_str());
+                    return false;
+                }
+                pos = comma + 1;
+            }
+        } else if (arg == "--frames" && hasValue) {
+            opt.frames = (uint32_t)std::max(atoi(argv[++i]), 10);
+        } else if (arg == "--warmup" && hasValue) {
+            opt.warmup = (uint32_t)std::max(atoi(argv[++i]), 0);
+        } else if (arg == "--refresh" && hasValue) {
+            opt.refreshHz = std::clamp(atoi(argv[++i]), 10, 1000);
+        } else if (arg == "--windowed") {
+            opt.windowed = true;
+        } else if (arg == "--out" && hasValue) {
+            opt.outPath = argv[++i];
+        } else {
+            fprintf(stderr, "usage: openxr_simulator_bench [--runtime path.dll] [--backends d3d11,d3d12,gl] "
+                            "[--frames N] [--warmup N] [--refresh HZ] [--windowed] [--out results.jsonl]\n");
+            return false;
+        }
+    }
+    return true;
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+    Options opt;
+    if (!ParseOptions(argc, argv, opt)) return 2;
+    if (!opt.outPath.empty()) {
+        // Append, so one file collects the runs of several releases
+        if (fopen_s(&g_out, opt.outPath.c_str(), "a") != 0 || !g_out) {
+            Note("cannot open %s", opt.outPath.c_str());
+            return 2;
+        }
+    }
+
+    // Settings the runtime reads from the environment at xrCreateInstance. A private run ID
+    // keeps the harness off the MCP channels and log of an app running at the same time.
+    SetEnvironmentVariableA("OPENXR_SIM_HEADLESS", opt.windowed ? "0" : "1");
+    char runId[16] = {};
+    if (GetEnvironmentVariableA("OPENXR_SIM_RUN_ID", runId, (DWORD)sizeof(runId)) == 0) {
+        SetEnvironmentVariableA("OPENXR_SIM_RUN_ID", "bench");
+    }
+    if (!LoadRuntime(opt)) return 1;
+
+    EmitMeta(opt);
+    bool ok = RunPhase(opt, true);
+    ok = RunPhase(opt, false) && ok;
+    if (g_out != stdout) fclose(g_out);
+    Note("%s", ok ? "done" : "finished with failures");
+    return ok ? 0 : 1;
+}
@@ -14,9 +14,11 @@ Features:
 
 import asyncio
 import base64
+import ctypes
 import json
 import os
 import re
+import struct
 import sys
 import time
 from datetime import datetime
@@ -40,7 +42,13 @@ except ImportError:
 
 # Configuration
 LOCALAPPDATA = os.environ.get("LOCALAPPDATA", "")
+# Run ID of the simulated app to drive (mirrors src/run_id.h). A runtime started with
+# OPENXR_SIM_RUN_ID=pid uses the app's process ID, so pass that number here.
+RUN_ID = "".join(c for c in os.environ.get("OPENXR_SIM_RUN_ID", "")
+                 if c.isascii() and (c.isalnum() or c in "_-"))[:32]
 SIMULATOR_DIR = Path(LOCALAPPDATA) / "OpenXR-Simulator"
+if RUN_ID:
+    SIMULATOR_DIR = SIMULATOR_DIR / "runs" / RUN_ID
 LOG_FILE = SIMULATOR_DIR / "openxr_simulator.log"
 SCREENSHOT_REQUEST_FILE = SIMULATOR_DIR / "screenshot_request.json"
 # Runtime may write any of these formats — we'll pick whichever shows up most recently after the request.
@@ -66,6 +74,63 @@ HEADSET_PROFILE_CMD_FILE = SIMULATOR_DIR / "headset_profile_command.json"
 ANAGLYPH_CMD_FILE        = SIMULATOR_DIR / "anaglyph_command.json"
 PROJ_LOG_DUMP_REQUEST    = SIMULATOR_DIR / "projection_log_dump_request"
 PROJ_LOG_FILE            = SIMULATOR_DIR / "projection_log.json"
+RECORD_CMD_FILE          = SIMULATOR_DIR / "record_command.json"
+GL_VALIDATION_CMD_FILE   = SIMULATOR_DIR / "gl_validation_command.json"
+STRESS_CMD_FILE          = SIMULATOR_DIR / "stress_command.json"
+
+# Shared-memory command channel (mirrors mcp::CommandChannel in src/mcp_integration.h).
+# Header: magic, version, slotCount, slotSize (u32 each), then writeIndex, readIndex,
+# ackSeq, consumerTickMs (u64 each), padded to 64 bytes; followed by the slots.
+# Slot: type (u32), length (u32), seq (u64), JSON payload.
+CMD_CHANNEL_NAME     = "Local\\OpenXRSimulator_Commands" + (f"_{RUN_ID}" if RUN_ID else "")
+CMD_CHANNEL_MAGIC    = 0x43525853  # 'SXRC'
+CMD_CHANNEL_VERSION  = 1
+CMD_HEADER_SIZE      = 64
+CMD_SLOT_COUNT       = 64
+CMD_SLOT_SIZE        = 1024
+CMD_PAYLOAD_SIZE     = CMD_SLOT_SIZE - 16
+CMD_CHANNEL_SIZE     = CMD_HEADER_SIZE + CMD_SLOT_COUNT * CMD_SLOT_SIZE
+# The runtime stamps consumerTickMs every frame; older stamps mean nobody is polling
+CMD_CONSUMER_TIMEOUT_MS = 2000
+CMD_TYPES = {
+    "head_pose": 1,
+    "fov": 2,
+    "ipd": 3,
+    "headset_profile": 4,
+    "anaglyph": 5,
+    "pose_sweep": 6,
+    "controller_pose": 7,
+    "screenshot": 8,
+    "projection_log_dump": 9,
+    "record": 10,
+    "gl_validation": 11,
+    "stress": 12,
+}
+
+# Shared-memory frame telemetry (mirrors mcp::TelemetryBlock). Rewritten every frame
+# under a seqlock: seq is odd while the runtime writes, so readers retry on odd/changed seq.
+TELEMETRY_NAME    = "Local\\OpenXRSimulator_Telemetry" + (f"_{RUN_ID}" if RUN_ID else "")
+TELEMETRY_MAGIC   = 0x54525853  # 'SXRT'
+TELEMETRY_SIZE    = 192
+TELEMETRY_FORMAT  = "<IIII Q q q IIII 3f 3f 4f f 8f I Q Q II 3f 2f III"
+TELEMETRY_SIZE_V1 = 144  # runtimes without the stereo analysis fields
+TELEMETRY_FORMAT_V1 = "<IIII Q q q IIII 3f 3f 4f f 8f I Q"
+TELEMETRY_STAGES  = ("wait_frame", "app_frame", "end_frame")
+# stereo::Flags in the telemetry block's stereoFlags
+STEREO_FLAG_STEREO        = 1 << 0
+STEREO_FLAG_LOW_TEXTURE   = 1 << 1
+STEREO_FLAG_EYES_SWAPPED  = 1 << 2
+STEREO_FLAG_LEFT_BLACK    = 1 << 3
+STEREO_FLAG_RIGHT_BLACK   = 1 << 4
+STEREO_FLAG_FROZEN        = 1 << 5
+# A stereo result older than this many frames no longer describes what is on screen
+STEREO_STALE_FRAMES = 120
+# Telemetry older than this is from a runtime that stopped submitting frames
+TELEMETRY_STALE_SEC = 2.0
+SESSION_STATE_NAMES = {
+    0: "UNKNOWN", 1: "IDLE", 2: "READY", 3: "SYNCHRONIZED", 4: "VISIBLE",
+    5: "FOCUSED", 6: "STOPPING", 7: "LOSS_PENDING", 8: "EXITING",
+}
 
 import math as _math
 
@@ -78,6 +143,156 @@ def ensure_simulator_dir():
     SIMULATOR_DIR.mkdir(parents=True, exist_ok=True)
 
 
+class CommandChannel:
+    """Producer side of the runtime's shared-memory command ring.
+
+    Single producer: only one MCP server should write to a given runtime.
+    """
+
+    def __init__(self):
+        self._mm = None
+        if sys.platform != "win32":
+            return
+        try:
+            import mmap
+            # Opens the runtime's mapping, or creates it if the runtime hasn't started yet
+            self._mm = mmap.mmap(-1, CMD_CHANNEL_SIZE, tagname=CMD_CHANNEL_NAME)
+        except Exception:
+            self._mm = None
+            return
+        # Aligned 8-byte ctypes views give single-store updates of the shared indices
+        self._write_index = ctypes.c_uint64.from_buffer(self._mm, 16)
+        self._read_index = ctypes.c_uint64.from_buffer(self._mm, 24)
+        self._ack_seq = ctypes.c_uint64.from_buffer(self._mm, 32)
+        self._consumer_tick = ctypes.c_uint64.from_buffer(self._mm, 40)
+        self._kernel32 = ctypes.windll.kernel32
+        self._kernel32.GetTickCount64.restype = ctypes.c_uint64
+        (magic,) = struct.unpack_from("<I", self._mm, 0)
+        if magic != CMD_CHANNEL_MAGIC:
+            struct.pack_into("<III", self._mm, 4, CMD_CHANNEL_VERSION, CMD_SLOT_COUNT, CMD_SLOT_SIZE)
+            struct.pack_into("<I", self._mm, 0, CMD_CHANNEL_MAGIC)
+
+    def consumer_alive(self) -> bool:
+        if self._mm is None:
+            return False
+        tick = self._consumer_tick.value
+        return tick != 0 and self._kernel32.GetTickCount64() - tick < CMD_CONSUMER_TIMEOUT_MS
+
+    def acked(self, seq: int) -> bool:
+        return self._mm is not None and self._ack_seq.value >= seq
+
+    def send(self, cmd_type: str, payload: bytes) -> Optional[int]:
+        """Publish a command; returns its sequence number, or None if it wasn't queued."""
+        if not self.consumer_alive() or len(payload) > CMD_PAYLOAD_SIZE:
+            return None
+        write = self._write_index.value
+        if write - self._read_index.value >= CMD_SLOT_COUNT:
+            return None  # ring full
+        seq = write + 1
+        off = CMD_HEADER_SIZE + (write % CMD_SLOT_COUNT) * CMD_SLOT_SIZE
+        struct.pack_into("<IIQ", self._mm, off, CMD_TYPES[cmd_type], len(payload), seq)
+        self._mm[off + 16:off + 16 + len(payload)] = payload
+        # Publish last; x86 keeps stores in order, so the slot is visible before the index
+        self._write_index.value = write + 1
+        return seq
+
+
+_command_channel: Optional[CommandChannel] = None
+
+
+def command_channel() -> CommandChannel:
+    global _command_channel
+    if _command_channel is None:
+        _command_channel = CommandChannel()
+    return _command_channel
+
+
+_telemetry_mm = None
+
+
+def read_telemetry() -> Optional[dict[str, Any]]:
+    """Consistent snapshot of the runtime's telemetry block, or None if it isn't live."""
+    global _telemetry_mm
+    if sys.platform != "win32":
+        return None
+    if _telemetry_mm is None:
+        try:
+            import mmap
+            try:
+                _telemetry_mm = mmap.mmap(-1, TELEMETRY_SIZE, tagname=TELEMETRY_NAME)
+            except OSError:
+                # A version 1 runtime created the smaller mapping
+                _telemetry_mm = mmap.mmap(-1, TELEMETRY_SIZE_V1, tagname=TELEMETRY_NAME)
+        except Exception:
+            return None
+    mm = _telemetry_mm
+    if struct.unpack_from("<I", mm, 0)[0] != TELEMETRY_MAGIC:
+        return None
+    full = len(mm) >= TELEMETRY_SIZE and struct.unpack_from("<I", mm, 4)[0] >= 2
+    layout = TELEMETRY_FORMAT if full else TELEMETRY_FORMAT_V1
+    for _ in range(100):
+        (seq_before,) = struct.unpack_from("<I", mm, 12)
+        if seq_before & 1:
+            continue
+        fields = struct.unpack_from(layout, mm, 0)
+        (seq_after,) = struct.unpack_from("<I", mm, 12)
+        if seq_before == seq_after:
+            break
+    else:
+        return None
+
+    (_, version, _, _, frame_index, qpc, qpc_freq, state, width, height, stage_count,
+     px, py, pz, yaw, pitch, roll, qx, qy, qz, qw, interval_ms, *rest) = fields
+    stage_ms = rest[:8]
+    log_dropped = rest[9]
+    stereo = rest[10:]
+    now = ctypes.c_int64()
+    ctypes.windll.kernel32.QueryPerformanceCounter(ctypes.byref(now))
+    if qpc_freq <= 0 or (now.value - qpc) / qpc_freq > TELEMETRY_STALE_SEC:
+        return None
+    result = {
+        "source": "telemetry",
+        "telemetry_version": version,
+        "frame_count": frame_index,
+        "preview_width": width,
+        "preview_height": height,
+        "session_state": SESSION_STATE_NAMES.get(state, str(state)),
+        "frame_time_ms": round(interval_ms, 3),
+        "stage_ms": {name: round(stage_ms[i], 3)
+                     for i, name in enumerate(TELEMETRY_STAGES) if i < stage_count},
+        "log_records_dropped": log_dropped,
+        "head_tracking": {
+            "position": {"x": round(px, 3), "y": round(py, 3), "z": round(pz, 3)},
+            "yaw": round(yaw, 3),
+            "pitch": round(pitch, 3),
+            "roll": round(roll, 3),
+            "orientation": {"x": qx, "y": qy, "z": qz, "w": qw},
+        },
+    }
+    if stereo:
+        (s_frame, flags, eye_w, disparity, match_rms, texture_std, luma_l, luma_r,
+         changed, tiles, unchanged_run) = stereo
+        result["stereo"] = {
+            "frame": s_frame,
+            "frames_ago": frame_index - s_frame if s_frame else None,
+            "analysed_pair": bool(flags & STEREO_FLAG_STEREO),
+            "low_texture": bool(flags & STEREO_FLAG_LOW_TEXTURE),
+            "eyes_swapped": bool(flags & STEREO_FLAG_EYES_SWAPPED),
+            "left_black": bool(flags & STEREO_FLAG_LEFT_BLACK),
+            "right_black": bool(flags & STEREO_FLAG_RIGHT_BLACK),
+            "frozen": bool(flags & STEREO_FLAG_FROZEN),
+            "eye_width": eye_w,
+            "horizontal_disparity_px": round(disparity, 2),
+            "match_rms": round(match_rms, 2),
+            "texture_std": round(texture_std, 2),
+            "mean_luma": [round(luma_l, 1), round(luma_r, 1)],
+            "changed_tiles": changed,
+            "tile_count": tiles,
+            "unchanged_run": unchanged_run,
+        }
+    return result
+
+
 def read_log_file(lines: int = 100, filter_pattern: Optional[str] = None) -> str:
     """Read the last N lines from the simulator log file."""
     if not LOG_FILE.exists():
@@ -167,7 +382,8 @@ def parse_log_for_diagnostics() -> dict[str, Any]:
     return diagnostics
 
 
-def request_screenshot(eye: str = "both", include_ui: bool = True) -> dict[str, Any]:
+def request_screenshot(eye: str = "both", include_ui: bool = True,
+                       image_format: Optional[str] = None) -> dict[str, Any]:
     """
     Request a screenshot from the runtime.
 
@@ -182,12 +398,11 @@ def request_screenshot(eye: str = "both", include_ui: bool = True) -> dict[str,
         "include_ui": include_ui,
         "requested_by": "mcp"
     }
+    if image_format:
+        request["format"] = image_format  # "png" or "bmp"; runtime default otherwise
 
     try:
-        # Write the request
-        with open(SCREENSHOT_REQUEST_FILE, "w") as f:
-            json.dump(request, f)
-
+        _send_command("screenshot", SCREENSHOT_REQUEST_FILE, request)
         return {"status": "requested", "request": request}
     except Exception as e:
         return {"status": "error", "error": str(e)}
@@ -246,7 +461,19 @@ def to_jpeg(image_bytes: bytes, max_width: int = SCREENSHOT_MAX_WIDTH,
 
 
 def get_frame_info() -> dict[str, Any]:
-    """Get current frame information from the runtime status file."""
+    """Get current frame information from the telemetry block, else the runtime status file."""
+    telemetry = read_telemetry()
+    if telemetry is not None:
+        # Stage percentiles are only aggregated into the (once per second) status file
+        try:
+            with open(STATUS_FILE, "r") as f:
+                status = json.load(f)
+            if "stage_timing_ms" in status:
+                telemetry["stage_timing_ms"] = status["stage_timing_ms"]
+        except Exception:
+            pass
+        return telemetry
+
     if STATUS_FILE.exists():
         try:
             with open(STATUS_FILE, "r") as f:
@@ -338,6 +565,13 @@ def _write_json_command(path: Path, payload: dict[str, Any]) -> None:
     tmp.replace(path)
 
 
+def _send_command(cmd_type: str, path: Path, payload: dict[str, Any]) -> None:
+    """Deliver a one-shot command through shared memory when the runtime is polling it,
+    falling back to the JSON command file (older runtimes, or no frame loop running)."""
+    if command_channel().send(cmd_type, json.dumps(payload).encode("utf-8")) is None:
+        _write_json_command(path, payload)
+
+
 def _deg(rad: float) -> float:
     return rad * 180.0 / _math.pi
 
@@ -346,6 +580,35 @@ def _rad(deg: float) -> float:
     return deg * _math.pi / 180.0
 
 
+def _stereo_verdict(dx: float, layout_w: int) -> dict[str, Any]:
+    """PASS / FAIL_NO_PARALLAX / FAIL_EXCESSIVE_PARALLAX for a disparity on layout_w-wide eyes."""
+    # Heuristic verdict:
+    #  - |dx| within [2, 30] px on a 1280-wide eye -> typical IPD parallax (PASS)
+    #  - |dx| < 2  -> eyes nearly identical (FAIL: no IPD or aliased eyes)
+    #  - |dx| > 30 -> excessive parallax (FAIL: IPD too large or wrong)
+    expected_min = max(2,  layout_w // 640)   # ~2 px on 1280-wide
+    expected_max = max(30, layout_w // 40)    # ~30 px on 1280-wide
+    if abs(dx) < expected_min:
+        verdict = "FAIL_NO_PARALLAX"
+        diagnosis = ("Both eye images look identical (disparity below noise floor). "
+                     "Likely cause: aliased per-eye matrix, IPD=0, or projection "
+                     "matrix not differentiating eyes.")
+    elif abs(dx) > expected_max:
+        verdict = "FAIL_EXCESSIVE_PARALLAX"
+        diagnosis = ("Disparity is much larger than expected for typical IPD. "
+                     "Likely cause: IPD applied as raw OpenXR LOCAL-space position, "
+                     "or per-eye view matrix mis-translated.")
+    else:
+        verdict = "PASS"
+        diagnosis = "Stereo disparity is within expected range for human IPD."
+
+    return {
+        "verdict": verdict,
+        "diagnosis": diagnosis,
+        "expected_range_px": [expected_min, expected_max],
+    }
+
+
 def _validate_stereo_from_screenshot(image_bytes: bytes) -> dict[str, Any]:
     """Crude horizontal-disparity check on a side-by-side stereo screenshot.
 
@@ -408,36 +671,54 @@ def _validate_stereo_from_screenshot(image_bytes: bytes) -> dict[str, Any]:
     dx = results[best_layout]["disparity_px"]
     layout_w = (w // 2) if best_layout == "side_by_side" else w
 
-    # Heuristic verdict:
-    #  - |dx| within [2, 30] px on a 1280-wide eye -> typical IPD parallax (PASS)
-    #  - |dx| < 2  -> eyes nearly identical (FAIL: no IPD or aliased eyes)
-    #  - |dx| > 30 -> excessive parallax (FAIL: IPD too large or wrong)
-    expected_min = max(2,  layout_w // 640)   # ~2 px on 1280-wide
-    expected_max = max(30, layout_w // 40)    # ~30 px on 1280-wide
-    if abs(dx) < expected_min:
-        verdict = "FAIL_NO_PARALLAX"
-        diagnosis = ("Both eye images look identical (disparity below noise floor). "
-                     "Likely cause: aliased per-eye matrix, IPD=0, or projection "
-                     "matrix not differentiating eyes.")
-    elif abs(dx) > expected_max:
-        verdict = "FAIL_EXCESSIVE_PARALLAX"
-        diagnosis = ("Disparity is much larger than expected for typical IPD. "
-                     "Likely cause: IPD applied as raw OpenXR LOCAL-space position, "
-                     "or per-eye view matrix mis-translated.")
-    else:
-        verdict = "PASS"
-        diagnosis = "Stereo disparity is within expected range for human IPD."
-
+    verdict = _stereo_verdict(dx, layout_w)
     return {
-        "verdict": verdict,
-        "diagnosis": diagnosis,
+        **verdict,
+        "source": "screenshot",
         "best_layout": best_layout,
         "horizontal_disparity_px": dx,
-        "expected_range_px": [expected_min, expected_max],
         "all_layouts": results,
     }
 
 
+def _validate_stereo_from_telemetry() -> Optional[dict[str, Any]]:
+    """Verdict from the runtime's own analysis of the composed preview (telemetry block
+    version 2), or None when there is no recent stereo-pair result to judge by."""
+    telemetry = read_telemetry()
+    stereo = telemetry.get("stereo") if telemetry else None
+    if (not stereo or not stereo["frame"] or not stereo["analysed_pair"]
+            or stereo["frames_ago"] > STEREO_STALE_FRAMES):
+        return None
+    dx = stereo["horizontal_disparity_px"]
+    if stereo["left_black"] or stereo["right_black"]:
+        eyes = [e for e in ("left", "right") if stereo[f"{e}_black"]]
+        verdict = {"verdict": "FAIL_BLACK_FRAME",
+                   "diagnosis": (f"The {' and '.join(eyes)} eye image is black. Likely cause: the app "
+                                 "submits before rendering, or renders to a different swapchain image "
+                                 "than the one it releases.")}
+    elif stereo["frozen"]:
+        verdict = {"verdict": "FAIL_FROZEN_FRAME",
+                   "diagnosis": ("The preview stopped changing while the head pose moved. Likely cause: "
+                                 "the app re-submits a stale image or ignores the located views.")}
+    elif stereo["low_texture"]:
+        verdict = {"verdict": "INCONCLUSIVE_LOW_TEXTURE",
+                   "diagnosis": ("Too little detail in the centre of the view to measure disparity. "
+                                 "Look at a textured part of the scene and retry.")}
+    elif stereo["eyes_swapped"]:
+        verdict = {"verdict": "FAIL_EYES_SWAPPED",
+                   "diagnosis": ("Near content sits further left in the left eye than in the right. "
+                                 "Likely cause: view 0 and view 1 swapped, or the IPD offset applied "
+                                 "with the wrong sign.")}
+    else:
+        verdict = _stereo_verdict(dx, stereo["eye_width"])
+    return {
+        **verdict,
+        "source": "telemetry",
+        "horizontal_disparity_px": dx,
+        "analysis": stereo,
+    }
+
+
 # Define MCP tools
 @server.list_tools()
 async def list_tools() -> list[Tool]:
@@ -460,6 +741,12 @@ async def list_tools() -> list[Tool]:
                         "type": "number",
                         "default": 5.0,
                         "description": "Timeout in seconds to wait for screenshot"
+                    },
+                    "format": {
+                        "type": "string",
+                        "enum": ["png", "bmp"],
+                        "description": "File format the runtime writes (PNG is much smaller); "
+                                       "defaults to OPENXR_SIM_SCREENSHOT_FORMAT or bmp"
                     }
                 }
             }
@@ -671,16 +958,89 @@ async def list_tools() -> list[Tool]:
                 }
             }
         ),
+        Tool(
+            name="start_recording",
+            description=("Start recording the simulator to hardware-encoded MP4 "
+                         "(Media Foundation, no CPU readback). 'preview' records the "
+                         "composed preview window; 'eyes' records each eye at full "
+                         "resolution into its own file. Files are written to the "
+                         "simulator data directory as recording_<timestamp>_<stream>.mp4, "
+                         "timestamped with the frames' display times. A recording in "
+                         "progress is finished first."),
+            inputSchema={
+                "type": "object",
+                "properties": {
+                    "source":       {"type": "string", "enum": ["preview", "eyes"], "default": "preview"},
+                    "codec":        {"type": "string", "enum": ["h264", "hevc"], "default": "h264"},
+                    "bitrate_mbps": {"type": "number", "default": 20},
+                }
+            }
+        ),
+        Tool(
+            name="stop_recording",
+            description=("Stop the current recording. The files are finalized in the "
+                         "background; returns the most recent recording files."),
+            inputSchema={"type": "object", "properties": {}}
+        ),
+        Tool(
+            name="set_gl_validation",
+            description=("Enable or disable the simulator's OpenGL validation readbacks. "
+                         "'checks' is 'all', 'off' or a comma list of: create (new swapchain "
+                         "textures), enumerate (images returned to the app), release (full GL "
+                         "state dump at xrReleaseSwapchainImage; stalls the app's GL queue), "
+                         "pixels (pixel sums of the preview and quad-layer readbacks). Results "
+                         "go to the simulator log in the 'gl' category."),
+            inputSchema={
+                "type": "object",
+                "properties": {
+                    "checks": {"type": "string", "default": "all"},
+                }
+            }
+        ),
+        Tool(
+            name="set_stress",
+            description=("Frame-budget stress mode for testing an app's dynamic resolution and "
+                         "frame-timing code. xrWaitFrame can miss vsyncs (every 'miss_every' "
+                         "frames and/or with probability 'miss_chance', blocking 'miss_vsyncs' "
+                         "extra periods), jitter predictedDisplayTime by up to ±'jitter_ms', and "
+                         "return shouldRender=false every 'skip_render_every' frames. xrEndFrame "
+                         "can add 'cpu_load_ms' of busy time on the app's thread and about "
+                         "'gpu_load_ms' of copy work on the app's D3D11 context or D3D12 queue "
+                         "(calibrated from GPU timestamps). The schedule restarts on every call "
+                         "and random choices use 'seed', so runs repeat. 'frames' > 0 stops after "
+                         "that many frames. Counters are reported under \"stress\" in the "
+                         "runtime status. Call with enabled=false to stop."),
+            inputSchema={
+                "type": "object",
+                "properties": {
+                    "enabled":           {"type": "boolean", "default": True},
+                    "miss_every":        {"type": "integer", "default": 0},
+                    "miss_vsyncs":       {"type": "integer", "default": 1},
+                    "miss_chance":       {"type": "number",  "default": 0.0},
+                    "jitter_ms":         {"type": "number",  "default": 0.0},
+                    "skip_render_every": {"type": "integer", "default": 0},
+                    "cpu_load_ms":       {"type": "number",  "default": 0.0},
+                    "gpu_load_ms":       {"type": "number",  "default": 0.0},
+                    "seed":              {"type": "integer", "default": 1},
+                    "frames":            {"type": "integer", "default": 0},
+                }
+            }
+        ),
         Tool(
             name="validate_stereo",
-            description=("Capture the current stereo preview and run a disparity "
-                         "analysis. Returns: verdict (PASS / FAIL_NO_PARALLAX / "
-                         "FAIL_EXCESSIVE_PARALLAX), measured horizontal pixel "
-                         "disparity, expected range, and a diagnostic hint."),
+            description=("Check the stereo preview for correct parallax. Reads the runtime's "
+                         "own analysis of the composed preview from the telemetry block "
+                         "(disparity, eye swap, black and frozen frames); falls back to "
+                         "capturing and analysing a screenshot. Returns: verdict (PASS / "
+                         "FAIL_NO_PARALLAX / FAIL_EXCESSIVE_PARALLAX / FAIL_EYES_SWAPPED / "
+                         "FAIL_BLACK_FRAME / FAIL_FROZEN_FRAME / INCONCLUSIVE_LOW_TEXTURE), "
+                         "measured horizontal pixel disparity, and a diagnostic hint."),
             inputSchema={
                 "type": "object",
                 "properties": {
-                    "timeout": {"type": "number", "default": 5.0}
+                    "timeout": {"type": "number", "default": 5.0},
+                    "use_screenshot": {"type": "boolean", "default": False,
+                                       "description": "Skip the telemetry result and analyse a fresh screenshot"},
                 }
             }
         ),
@@ -700,7 +1060,7 @@ async def call_tool(name: str, arguments: dict[str, Any]) -> list[TextContent |
             p.unlink(missing_ok=True)
 
         request_time = time.time()
-        result = request_screenshot(eye=eye)
+        result = request_screenshot(eye=eye, image_format=arguments.get("format"))
         if result["status"] == "error":
             return [TextContent(
                 type="text",
@@ -884,12 +1244,12 @@ async def call_tool(name: str, arguments: dict[str, Any]) -> list[TextContent |
         }
         if "roll_deg" in arguments and arguments["roll_deg"] is not None:
             payload["roll"] = _rad(float(arguments["roll_deg"]))
-        _write_json_command(HEAD_POSE_CMD_FILE, payload)
+        _send_command("head_pose", HEAD_POSE_CMD_FILE, payload)
         return [TextContent(type="text", text=f"Head pose command queued: {payload}")]
 
     elif name == "set_fov":
         if arguments.get("clear"):
-            _write_json_command(FOV_CMD_FILE, {"clear": True})
+            _send_command("fov", FOV_CMD_FILE, {"clear": True})
             return [TextContent(type="text", text="FOV reverted to symmetric default.")]
         def _eye(d):
             if not d: return None
@@ -903,37 +1263,37 @@ async def call_tool(name: str, arguments: dict[str, Any]) -> list[TextContent |
         if L is None or R is None:
             return [TextContent(type="text",
                 text="set_fov requires both left_eye and right_eye sub-objects (or clear=true)")]
-        _write_json_command(FOV_CMD_FILE, {"left": L, "right": R})
+        _send_command("fov", FOV_CMD_FILE, {"left": L, "right": R})
         return [TextContent(type="text",
             text=f"Per-eye asymmetric FOV applied. left={L} right={R}")]
 
     elif name == "set_ipd":
         if arguments.get("clear"):
-            _write_json_command(IPD_CMD_FILE, {"clear": True})
+            _send_command("ipd", IPD_CMD_FILE, {"clear": True})
             return [TextContent(type="text", text="IPD reverted to 64 mm.")]
         ipd_mm = float(arguments.get("ipd_mm", 64.0))
         if ipd_mm < 0 or ipd_mm > 200:
             return [TextContent(type="text", text="ipd_mm must be in [0, 200]")]
-        _write_json_command(IPD_CMD_FILE, {"ipd_mm": ipd_mm})
+        _send_command("ipd", IPD_CMD_FILE, {"ipd_mm": ipd_mm})
         return [TextContent(type="text", text=f"IPD set to {ipd_mm:.1f} mm")]
 
     elif name == "set_headset_profile":
         prof_name = arguments.get("name", "default")
-        _write_json_command(HEADSET_PROFILE_CMD_FILE, {"name": prof_name})
+        _send_command("headset_profile", HEADSET_PROFILE_CMD_FILE, {"name": prof_name})
         return [TextContent(type="text", text=f"Headset profile applied: {prof_name}")]
 
     elif name == "enable_anaglyph_preview":
         enabled = bool(arguments.get("enabled", True))
-        _write_json_command(ANAGLYPH_CMD_FILE, {"enabled": enabled})
+        _send_command("anaglyph", ANAGLYPH_CMD_FILE, {"enabled": enabled})
         return [TextContent(type="text",
             text=f"Anaglyph preview {'enabled' if enabled else 'disabled'}.")]
 
     elif name == "get_projection_log":
-        # Touch the dump-request flag file; the simulator writes the log
+        # Send the dump request (channel or flag file); the simulator writes the log
         # at the end of the next xrEndFrame.
         ensure_simulator_dir()
         PROJ_LOG_FILE.unlink(missing_ok=True)
-        PROJ_LOG_DUMP_REQUEST.touch()
+        _send_command("projection_log_dump", PROJ_LOG_DUMP_REQUEST, {})
         # Wait briefly for the simulator to dump.
         for _ in range(50):
             if PROJ_LOG_FILE.exists():
@@ -960,14 +1320,67 @@ async def call_tool(name: str, arguments: dict[str, Any]) -> list[TextContent |
             "roll_amp_deg":  float(arguments.get("roll_amp_deg",  15.0)),
             "freq_hz":       float(arguments.get("freq_hz",        0.25)),
         }
-        _write_json_command(SIMULATOR_DIR / "pose_sweep_command.json", payload)
+        _send_command("pose_sweep", SIMULATOR_DIR / "pose_sweep_command.json", payload)
         return [TextContent(type="text",
             text=("Pose sweep " + ("enabled" if payload["enabled"] else "disabled") +
                   f" — yaw=±{payload['yaw_amp_deg']}° pitch=±{payload['pitch_amp_deg']}°"
                   f" roll=±{payload['roll_amp_deg']}° freq={payload['freq_hz']}Hz"))]
 
+    elif name == "start_recording":
+        payload = {
+            "action":       "start",
+            "source":       str(arguments.get("source", "preview")),
+            "codec":        str(arguments.get("codec", "h264")),
+            "bitrate_mbps": float(arguments.get("bitrate_mbps", 20)),
+        }
+        _send_command("record", RECORD_CMD_FILE, payload)
+        return [TextContent(type="text",
+            text=(f"Recording requested: source={payload['source']} codec={payload['codec']} "
+                  f"{payload['bitrate_mbps']:g} Mbit/s. Progress is reported under \"recording\" "
+                  f"in {STATUS_FILE}."))]
+
+    elif name == "stop_recording":
+        _send_command("record", RECORD_CMD_FILE, {"action": "stop"})
+        # Finalizing writes the MP4 index; give the recorder thread a moment
+        time.sleep(1.0)
+        files = sorted(SIMULATOR_DIR.glob("recording_*.mp4"), key=lambda p: p.stat().st_mtime, reverse=True)
+        listing = "\n".join(f"  {p} ({p.stat().st_size / 1e6:.1f} MB)" for p in files[:3])
+        return [TextContent(type="text",
+            text="Recording stopped." + (f" Recent files:\n{listing}" if listing else " No recording files found."))]
+
+    elif name == "set_gl_validation":
+        checks = str(arguments.get("checks", "all")).strip()
+        _send_command("gl_validation", GL_VALIDATION_CMD_FILE, {"checks": checks})
+        return [TextContent(type="text",
+            text=f"GL validation checks set to '{checks}'. Results are logged in the 'gl' category.")]
+
+    elif name == "set_stress":
+        payload = {
+            "enabled":           bool(arguments.get("enabled", True)),
+            "miss_every":        int(arguments.get("miss_every", 0)),
+            "miss_vsyncs":       int(arguments.get("miss_vsyncs", 1)),
+            "miss_chance":       float(arguments.get("miss_chance", 0.0)),
+            "jitter_ms":         float(arguments.get("jitter_ms", 0.0)),
+            "skip_render_every": int(arguments.get("skip_render_every", 0)),
+            "cpu_load_ms":       float(arguments.get("cpu_load_ms", 0.0)),
+            "gpu_load_ms":       float(arguments.get("gpu_load_ms", 0.0)),
+            "seed":              int(arguments.get("seed", 1)),
+            "frames":            int(arguments.get("frames", 0)),
+        }
+        _send_command("stress", STRESS_CMD_FILE, payload)
+        if not payload["enabled"]:
+            return [TextContent(type="text", text="Stress mode disabled.")]
+        return [TextContent(type="text",
+            text=("Stress mode enabled: " + json.dumps(payload) +
+                  f". Counters are reported under \"stress\" in {STATUS_FILE}."))]
+
     elif name == "validate_stereo":
         timeout = float(arguments.get("timeout", 5.0))
+        if not arguments.get("use_screenshot", False):
+            result = _validate_stereo_from_telemetry()
+            if result:
+                return [TextContent(type="text", text=json.dumps(result, indent=2))]
+        # No native analysis (older runtime, anaglyph or single-eye view): screenshot it.
         # Pre-clean stale screenshots so we don't validate an old frame.
         for p in SCREENSHOT_OUTPUT_CANDIDATES:
             p.unlink(missing_ok=True)
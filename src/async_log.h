@@ -0,0 +1,233 @@
+// Asynchronous logger for OpenXR Simulator
+// - Producers format into fixed-size records in a lock-free bounded MPSC ring
+// - A background writer thread drains the ring to OutputDebugStringA + the log file
+// - Records carry a level and a category so per-frame chatter can be filtered at runtime
+//
+// Environment:
+//   OPENXR_SIM_LOG_LEVEL       error | warn | info | debug (default) | trace
+//   OPENXR_SIM_LOG_CATEGORIES  comma list of general,frame,swapchain,gl,mcp or "all" (default);
+//                              "-frame" style entries remove a category from the default set
+//   OPENXR_SIM_LOG_SYNC=1      write synchronously from the calling thread (crash debugging)
+#pragma once
+
+#include <windows.h>
+#include <atomic>
+#include <thread>
+#include <mutex>
+#include <cstdio>
+#include <cstring>
+#include <cstdlib>
+#include <cstdint>
+#include "run_id.h"
+
+namespace logging {
+
+enum class Level : uint8_t { Error = 0, Warn, Info, Debug, Trace };
+
+// Category bits; a record is written when its bit is enabled and its level is within g_level
+enum Category : uint32_t {
+    CatGeneral   = 1u << 0,
+    CatFrame     = 1u << 1,  // per-frame compositor / preview output
+    CatSwapchain = 1u << 2,  // acquire / wait / release
+    CatGLDebug   = 1u << 3,  // GL texture readback diagnostics
+    CatMCP       = 1u << 4,
+    CatAll       = 0xFFFFFFFFu,
+};
+
+inline std::atomic<uint32_t> g_categories{CatAll};
+inline std::atomic<uint8_t> g_level{(uint8_t)Level::Debug};
+
+// Bounded MPSC ring (Vyukov): each cell's sequence number tells producers whether it is free
+// and the consumer whether it has been published. Producers never block; a full ring drops.
+class Logger {
+public:
+    static constexpr size_t kCapacity = 4096;  // must be a power of two
+    static constexpr size_t kTextSize = 500;   // longer messages are truncated
+
+    static Logger& Get() {
+        static Logger instance;
+        return instance;
+    }
+
+    void Write(const char* msg) {
+        if (m_sync || !m_running.load(std::memory_order_acquire)) {
+            // Before Start()/after Shutdown() (or in sync mode) there is no writer thread
+            std::lock_guard<std::mutex> lock(m_fileMutex);
+            Emit(msg);
+            if (m_file) fflush(m_file);
+            return;
+        }
+
+        size_t pos = m_enqueuePos.load(std::memory_order_relaxed);
+        Cell* cell;
+        for (;;) {
+            cell = &m_cells[pos & (kCapacity - 1)];
+            size_t seq = cell->seq.load(std::memory_order_acquire);
+            intptr_t diff = (intptr_t)seq - (intptr_t)pos;
+            if (diff == 0) {
+                if (m_enqueuePos.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed)) break;
+            } else if (diff < 0) {
+                m_dropped.fetch_add(1, std::memory_order_relaxed);
+                m_droppedTotal.fetch_add(1, std::memory_order_relaxed);
+                return;
+            } else {
+                pos = m_enqueuePos.load(std::memory_order_relaxed);
+            }
+        }
+        strncpy_s(cell->text, sizeof(cell->text), msg, _TRUNCATE);
+        cell->seq.store(pos + 1, std::memory_order_release);
+
+        // Wake the writer once per half ring of records; otherwise it polls every 20 ms
+        if ((pos & (kCapacity / 2 - 1)) == 0) SetEvent(m_wake);
+    }
+
+    // Start the writer thread. Called from xrCreateInstance.
+    void Start() {
+        if (m_sync) return;
+        std::lock_guard<std::mutex> lock(m_threadMutex);
+        if (m_running.load(std::memory_order_acquire)) return;
+        m_stop.store(false, std::memory_order_relaxed);
+        m_running.store(true, std::memory_order_release);
+        m_thread = std::thread([this] { WriterLoop(); });
+    }
+
+    // Drain and join the writer. Must run before the loader may unload the DLL
+    // (xrDestroyInstance); later records are written synchronously.
+    void Shutdown() {
+        std::lock_guard<std::mutex> lock(m_threadMutex);
+        if (!m_running.load(std::memory_order_acquire)) return;
+        // Producers write synchronously from here on; the drain after the join picks up
+        // records from any producer that saw m_running just before the store
+        m_running.store(false, std::memory_order_release);
+        m_stop.store(true, std::memory_order_release);
+        SetEvent(m_wake);
+        if (m_thread.joinable()) m_thread.join();
+        Drain();
+    }
+
+    uint64_t DroppedTotal() const { return m_droppedTotal.load(std::memory_order_relaxed); }
+
+private:
+    struct Cell {
+        std::atomic<size_t> seq;
+        char text[kTextSize];
+    };
+
+    // A host that exits without xrDestroyInstance leaves the writer running; don't terminate
+    ~Logger() { if (m_thread.joinable()) m_thread.detach(); }
+
+    Logger() {
+        for (size_t i = 0; i < kCapacity; ++i) m_cells[i].seq.store(i, std::memory_order_relaxed);
+        m_wake = CreateEventA(nullptr, FALSE, FALSE, nullptr);
+        ConfigureFromEnv();
+    }
+
+    void ConfigureFromEnv() {
+        char buf[256]{};
+        if (GetEnvironmentVariableA("OPENXR_SIM_LOG_LEVEL", buf, sizeof(buf)) > 0) {
+            static const char* names[] = { "error", "warn", "info", "debug", "trace" };
+            for (uint8_t i = 0; i < 5; ++i) {
+                if (_stricmp(buf, names[i]) == 0) g_level.store(i, std::memory_order_relaxed);
+            }
+        }
+        if (GetEnvironmentVariableA("OPENXR_SIM_LOG_CATEGORIES", buf, sizeof(buf)) > 0) {
+            uint32_t mask = (buf[0] == '-') ? (uint32_t)CatAll : 0u;
+            char* ctx = nullptr;
+            for (char* tok = strtok_s(buf, ", ", &ctx); tok; tok = strtok_s(nullptr, ", ", &ctx)) {
+                bool remove = (tok[0] == '-');
+                if (remove) ++tok;
+                uint32_t bit = 0;
+                if (_stricmp(tok, "all") == 0) bit = CatAll;
+                else if (_stricmp(tok, "general") == 0) bit = CatGeneral;
+                else if (_stricmp(tok, "frame") == 0) bit = CatFrame;
+                else if (_stricmp(tok, "swapchain") == 0) bit = CatSwapchain;
+                else if (_stricmp(tok, "gl") == 0 || _stricmp(tok, "gldebug") == 0) bit = CatGLDebug;
+                else if (_stricmp(tok, "mcp") == 0) bit = CatMCP;
+                mask = remove ? (mask & ~bit) : (mask | bit);
+            }
+            g_categories.store(mask, std::memory_order_relaxed);
+        }
+        if (GetEnvironmentVariableA("OPENXR_SIM_LOG_SYNC", buf, sizeof(buf)) > 0) {
+            m_sync = (buf[0] == '1');
+        }
+    }
+
+    void EnsureFile() {
+        if (m_file) return;
+        // One log per run when OPENXR_SIM_RUN_ID is set (it selects the directory)
+        const std::string path = runid::DataDirectory() + "\\openxr_simulator.log";
+        fopen_s(&m_file, path.c_str(), "a");
+    }
+
+    // Caller holds m_fileMutex (or is the writer thread)
+    void Emit(const char* msg) {
+        OutputDebugStringA(msg);
+        EnsureFile();
+        if (m_file) {
+            fputs(msg, m_file);
+            if (msg[0] && msg[strlen(msg) - 1] != '\n') fputc('\n', m_file);
+        }
+    }
+
+    // Drain everything published so far; returns the number of records written
+    size_t Drain() {
+        size_t written = 0;
+        std::lock_guard<std::mutex> lock(m_fileMutex);
+        for (;;) {
+            Cell* cell = &m_cells[m_dequeuePos & (kCapacity - 1)];
+            if (cell->seq.load(std::memory_order_acquire) != m_dequeuePos + 1) break;
+            Emit(cell->text);
+            cell->seq.store(m_dequeuePos + kCapacity, std::memory_order_release);
+            ++m_dequeuePos;
+            ++written;
+        }
+        uint64_t dropped = m_dropped.exchange(0, std::memory_order_relaxed);
+        if (dropped) {
+            char note[128];
+            snprintf(note, sizeof(note), "[SimXR] Log ring overflow: %llu records dropped (%llu total)",
+                     (unsigned long long)dropped, (unsigned long long)DroppedTotal());
+            Emit(note);
+        }
+        if ((written || dropped) && m_file) fflush(m_file);
+        return written;
+    }
+
+    void WriterLoop() {
+        while (!m_stop.load(std::memory_order_acquire)) {
+            if (Drain() == 0) WaitForSingleObject(m_wake, 20);
+        }
+        Drain();
+    }
+
+    Cell m_cells[kCapacity];
+    alignas(64) std::atomic<size_t> m_enqueuePos{0};
+    alignas(64) size_t m_dequeuePos{0};
+    std::atomic<uint64_t> m_dropped{0};       // since the last overflow note
+    std::atomic<uint64_t> m_droppedTotal{0};
+    std::atomic<bool> m_running{false};
+    std::atomic<bool> m_stop{false};
+    bool m_sync{false};
+    HANDLE m_wake{nullptr};
+    FILE* m_file{nullptr};
+    std::mutex m_fileMutex;
+    std::mutex m_threadMutex;
+    std::thread m_thread;
+};
+
+// Cheap filter for call sites that want to skip formatting. The first call constructs the
+// logger, which applies the environment configuration.
+inline bool Enabled(uint32_t cat, Level level) {
+    static const bool configured = (Logger::Get(), true);
+    (void)configured;
+    return (uint8_t)level <= g_level.load(std::memory_order_relaxed) &&
+           (g_categories.load(std::memory_order_relaxed) & cat) != 0;
+}
+
+inline void Write(uint32_t cat, Level level, const char* msg) {
+    if (!Enabled(cat, level)) return;
+    Logger::Get().Write(msg);
+}
+
+inline uint64_t DroppedCount() { return Logger::Get().DroppedTotal(); }
+
+} // namespace logging
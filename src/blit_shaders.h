@@ -0,0 +1,18 @@
+// Precompiled preview blit shaders (src/shaders/blit.hlsl)
+// The headers are generated by fxc at build time; each defines a const BYTE array of DXBC.
+//   g_blitVS, g_blitVSFlipY, g_blitPS   D3D11 fullscreen blit (vs_5_0 / ps_5_0)
+//   g_blitVSRect                        D3D12 sub-rect blit vertex shader (vs_5_1)
+//   g_blitPS12                          D3D12 pixel shader (ps_5_1)
+//   g_blitPSArray12                     D3D12 pixel shader for one slice of an array image
+//   g_blitRootSig                       D3D12 root signature (rootsig_1_0), pass to CreateRootSignature
+#pragma once
+
+#include <windows.h>
+
+#include "blit_vs.h"
+#include "blit_vs_flipy.h"
+#include "blit_ps.h"
+#include "blit_vs_rect.h"
+#include "blit_ps12.h"
+#include "blit_ps_array.h"
+#include "blit_rootsig.h"
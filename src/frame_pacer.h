@@ -0,0 +1,151 @@
+// Frame pacer for xrWaitFrame
+// - Fixed: sleeps on a high-resolution waitable timer until shortly before the next frame
+//   boundary, then spins the rest so wakeups land within a few microseconds
+// - Unlocked: never waits; the reported period follows the measured frame interval
+// - VBlank: blocks on the preview monitor's vertical blank (IDXGIOutput::WaitForVBlank,
+//   or DwmFlush when there is no DXGI output, e.g. the GDI-painted D3D12 preview)
+#pragma once
+
+#include <windows.h>
+#include <dxgi.h>
+#include <dwmapi.h>
+#include <cstdint>
+
+#pragma comment(lib, "dwmapi.lib")
+
+#ifndef CREATE_WAITABLE_TIMER_HIGH_RESOLUTION
+#define CREATE_WAITABLE_TIMER_HIGH_RESOLUTION 0x00000002
+#endif
+
+namespace pacing {
+
+enum class Mode { Fixed, Unlocked, VBlank };
+
+struct FrameTiming {
+    int64_t qpc;       // frame boundary the wait ended on
+    int64_t periodNs;  // predictedDisplayPeriod
+};
+
+class FramePacer {
+public:
+    static FramePacer& Get() {
+        static FramePacer instance;
+        return instance;
+    }
+
+    // Block until the next frame boundary for the given mode. hz is used in Fixed mode.
+    FrameTiming Wait(Mode mode, double hz, IDXGIOutput* vblankOutput) {
+        FrameTiming result{};
+        if (mode != m_lastMode || (mode == Mode::Fixed && hz != m_lastHz)) {
+            m_nextTick = 0;  // re-anchor on mode or rate change
+            m_lastMode = mode;
+            m_lastHz = hz;
+        }
+
+        if (mode == Mode::Fixed) {
+            if (hz < 1.0) hz = 90.0;
+            const int64_t period = (int64_t)((double)m_freq / hz);
+            int64_t now = Now();
+            if (m_nextTick == 0) m_nextTick = now;
+            WaitUntil(m_nextTick);
+            result.qpc = m_nextTick;
+            m_nextTick += period;
+            // Fell more than a frame behind (app hitch, debugger): restart the cadence
+            // from now instead of returning a burst of already-expired deadlines
+            now = Now();
+            if (now - m_nextTick > period) m_nextTick = now + period;
+            result.periodNs = (int64_t)(1e9 / hz);
+        } else if (mode == Mode::VBlank) {
+            if (!vblankOutput || FAILED(vblankOutput->WaitForVBlank())) {
+                DwmFlush();
+            }
+            result.qpc = Now();
+            result.periodNs = DisplayPeriodNs();
+        } else {
+            result.qpc = Now();
+            result.periodNs = MeasuredPeriodNs(result.qpc);
+        }
+
+        // Keep the measured interval current in every mode (Unlocked reports it)
+        if (mode != Mode::Unlocked) MeasuredPeriodNs(result.qpc);
+        return result;
+    }
+
+    int64_t Frequency() const { return m_freq; }
+    bool HighResolutionTimer() const { return m_highRes; }
+
+private:
+    FramePacer() {
+        LARGE_INTEGER f;
+        QueryPerformanceFrequency(&f);
+        m_freq = f.QuadPart;
+        m_timer = CreateWaitableTimerExW(nullptr, nullptr, CREATE_WAITABLE_TIMER_HIGH_RESOLUTION, TIMER_ALL_ACCESS);
+        m_highRes = (m_timer != nullptr);
+        if (!m_timer) {
+            // Pre-1803 Windows: a normal timer only wakes on the scheduler tick, so spin longer
+            m_timer = CreateWaitableTimerExW(nullptr, nullptr, 0, TIMER_ALL_ACCESS);
+        }
+        m_spinTicks = m_freq * (m_highRes ? 1 : 2) / 1000;
+    }
+
+    static int64_t Now() {
+        LARGE_INTEGER t;
+        QueryPerformanceCounter(&t);
+        return t.QuadPart;
+    }
+
+    void WaitUntil(int64_t deadline) {
+        int64_t remaining = deadline - Now();
+        if (remaining > m_spinTicks && m_timer) {
+            // Relative due time in 100 ns units (negative = relative)
+            LARGE_INTEGER due;
+            due.QuadPart = -(LONGLONG)((double)(remaining - m_spinTicks) * 1e7 / (double)m_freq);
+            if (SetWaitableTimerEx(m_timer, &due, 0, nullptr, nullptr, nullptr, 0)) {
+                WaitForSingleObject(m_timer, 100);
+            }
+        }
+        while (Now() < deadline) YieldProcessor();
+    }
+
+    // Refresh period of the desktop compositor's display, cached for a second
+    int64_t DisplayPeriodNs() {
+        ULONGLONG nowMs = GetTickCount64();
+        if (m_displayPeriodNs == 0 || nowMs - m_displayPeriodCheckedMs > 1000) {
+            DWM_TIMING_INFO info{};
+            info.cbSize = sizeof(info);
+            if (SUCCEEDED(DwmGetCompositionTimingInfo(nullptr, &info)) && info.rateRefresh.uiNumerator) {
+                m_displayPeriodNs = (int64_t)(1e9 * (double)info.rateRefresh.uiDenominator /
+                                              (double)info.rateRefresh.uiNumerator);
+            } else if (m_displayPeriodNs == 0) {
+                m_displayPeriodNs = 16666667;
+            }
+            m_displayPeriodCheckedMs = nowMs;
+        }
+        return m_displayPeriodNs;
+    }
+
+    // Exponential moving average of the wait-to-wait interval (never below 1 ms)
+    int64_t MeasuredPeriodNs(int64_t now) {
+        if (m_lastWaitQpc != 0 && now > m_lastWaitQpc) {
+            double ns = (double)(now - m_lastWaitQpc) * 1e9 / (double)m_freq;
+            m_measuredNs = (m_measuredNs == 0.0) ? ns : m_measuredNs * 0.9 + ns * 0.1;
+        }
+        m_lastWaitQpc = now;
+        if (m_measuredNs < 1e6) return m_measuredNs == 0.0 ? 11111111 : 1000000;
+        return (int64_t)m_measuredNs;
+    }
+
+    HANDLE m_timer{nullptr};
+    bool m_highRes{false};
+    int64_t m_freq{1};
+    int64_t m_spinTicks{0};
+    int64_t m_nextTick{0};
+    Mode m_lastMode{Mode::Fixed};
+    double m_lastHz{0.0};
+    int64_t m_displayPeriodNs{0};
+    ULONGLONG m_displayPeriodCheckedMs{0};
+    int64_t m_lastWaitQpc{0};
+    double m_measuredNs{0.0};
+};
+
+} // namespace pacing
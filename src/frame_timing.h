@@ -0,0 +1,199 @@
+// Per-stage CPU timing for the frame pipeline
+// - ScopedStage brackets a section with QueryPerformanceCounter and adds the elapsed time to
+//   the stage's total for the current frame (a stage may run several times per frame)
+// - EndFrame() (end of xrEndFrame) moves each stage's frame total into a rolling window of the
+//   last kWindow frames it ran in; Snapshot() reports p50/p95/p99 over that window
+// - GPU stages are fed by AddSample() when timestamp queries resolve, a few frames late
+// - The MCP status file and the preview title (Tools > Show Statistics, F3) read the snapshot
+#pragma once
+
+#include <windows.h>
+#include <atomic>
+#include <mutex>
+#include <algorithm>
+#include <cstdio>
+#include <cstdint>
+#include <cwchar>
+
+namespace timing {
+
+enum Stage : uint32_t {
+    StWaitPump = 0,     // xrWaitFrame message pump
+    StWaitMcp,          // xrWaitFrame MCP command polling
+    StWaitSleep,        // xrWaitFrame pacing sleep
+    StProjection,       // presentProjection, total
+    StProjBlit,         // eye blits into the preview backbuffer (D3D11 / GL)
+    StProjGLReadback,   // GL PBO readback + upload
+    StProjScreenshot,   // screenshot request check + capture
+    StQuadLayer,        // renderQuadLayer
+    StD3D12Submit,      // blitD3D12ToPreview: record draws + readback, ExecuteCommandLists
+    StD3D12FenceWait,   // blitD3D12ToPreview: waits on the preview fence
+    StD3D12Map,         // blitD3D12ToPreview: readback Map
+    StD3D12Paint,       // blitD3D12ToPreview: StretchDIBits of the readback
+    StPresent,          // DXGI Present of the preview swapchain
+    StCompositorHandoff,// copy into the compositor thread's shared textures (app thread)
+    StGpuBlit,          // GPU: blitViewToHalf draws (D3D11)
+    StGpuQuadLayer,     // GPU: renderQuadLayer draws (D3D11)
+    StGpuD3D12Copy,     // GPU: blitD3D12ToPreview composition + readback (preview queue)
+    StGpuCompositor,    // GPU: all of the above for the frame
+    StageCount
+};
+
+inline const char* StageName(uint32_t stage) {
+    static const char* names[StageCount] = {
+        "wait_pump", "wait_mcp", "wait_sleep", "projection", "projection_blit", "gl_readback",
+        "screenshot", "quad_layer", "d3d12_submit", "d3d12_fence_wait", "d3d12_map",
+        "d3d12_paint", "present", "compositor_handoff", "gpu_blit", "gpu_quad_layer", "gpu_d3d12_copy", "gpu_compositor"
+    };
+    return stage < StageCount ? names[stage] : "unknown";
+}
+
+inline int64_t Now() {
+    LARGE_INTEGER t;
+    QueryPerformanceCounter(&t);
+    return t.QuadPart;
+}
+
+inline double TicksToMs(int64_t ticks) {
+    static const double msPerTick = [](){ LARGE_INTEGER f; QueryPerformanceFrequency(&f); return 1000.0 / (double)f.QuadPart; }();
+    return (double)ticks * msPerTick;
+}
+
+struct StageStats {
+    float p50 = 0, p95 = 0, p99 = 0;
+    float last = 0;        // most recent frame
+    uint32_t samples = 0;  // frames in the window
+};
+
+class FrameTimers {
+public:
+    static constexpr uint32_t kWindow = 512;  // ~5.7 s at 90 Hz
+
+    static FrameTimers& Get() {
+        static FrameTimers instance;
+        return instance;
+    }
+
+    // Frame-thread hot path: one relaxed add, no lock
+    void Add(Stage stage, int64_t ticks) {
+        m_frameTicks[stage].fetch_add(ticks, std::memory_order_relaxed);
+    }
+
+    // Close the current frame. Stages that did not run this frame add no sample.
+    void EndFrame() {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        for (uint32_t i = 0; i < StageCount; ++i) {
+            int64_t ticks = m_frameTicks[i].exchange(0, std::memory_order_relaxed);
+            if (ticks <= 0) continue;
+            Push(i, (float)TicksToMs(ticks));
+        }
+        m_dirty = true;
+    }
+
+    // One completed frame's value for a stage measured elsewhere (GPU timestamps)
+    void AddSample(Stage stage, float ms) {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        Push(stage, ms);
+        m_dirty = true;
+    }
+
+    // Percentiles over the window; sorting is redone at most every 250 ms
+    void Snapshot(StageStats out[StageCount]) {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        ULONGLONG nowMs = GetTickCount64();
+        if (m_dirty && nowMs - m_lastComputeMs >= 250) {
+            float sorted[kWindow];
+            for (uint32_t i = 0; i < StageCount; ++i) {
+                uint32_t n = (uint32_t)std::min<uint64_t>(m_count[i], kWindow);
+                m_stats[i].samples = n;
+                if (n == 0) continue;
+                std::copy(m_window[i], m_window[i] + n, sorted);
+                std::sort(sorted, sorted + n);
+                auto pct = [&](float p) { return sorted[(uint32_t)(p * (float)(n - 1) + 0.5f)]; };
+                m_stats[i].p50 = pct(0.50f);
+                m_stats[i].p95 = pct(0.95f);
+                m_stats[i].p99 = pct(0.99f);
+            }
+            m_dirty = false;
+            m_lastComputeMs = nowMs;
+        }
+        std::copy(m_stats, m_stats + StageCount, out);
+    }
+
+private:
+    FrameTimers() = default;
+
+    // Caller holds m_mutex
+    void Push(uint32_t stage, float ms) {
+        m_window[stage][m_count[stage] % kWindow] = ms;
+        m_count[stage]++;
+        m_stats[stage].last = ms;
+    }
+
+    std::atomic<int64_t> m_frameTicks[StageCount] = {};
+    std::mutex m_mutex;
+    float m_window[StageCount][kWindow] = {};
+    uint64_t m_count[StageCount] = {};
+    StageStats m_stats[StageCount];
+    bool m_dirty = false;
+    ULONGLONG m_lastComputeMs = 0;
+};
+
+// RAII timer; Stop() ends the measurement early for sections that don't map to a scope
+class ScopedStage {
+public:
+    explicit ScopedStage(Stage stage) : m_stage(stage), m_start(Now()) {}
+    ~ScopedStage() { Stop(); }
+    ScopedStage(const ScopedStage&) = delete;
+    ScopedStage& operator=(const ScopedStage&) = delete;
+
+    void Stop() {
+        if (!m_start) return;
+        FrameTimers::Get().Add(m_stage, Now() - m_start);
+        m_start = 0;
+    }
+
+private:
+    Stage m_stage;
+    int64_t m_start;
+};
+
+// "stage p50/p99" for the heaviest stages by p50, e.g. "wait_sleep 9.8/10.9 ms | present 0.4/1.2 ms"
+inline void FormatSummary(wchar_t* buf, size_t count, uint32_t maxStages) {
+    StageStats stats[StageCount];
+    FrameTimers::Get().Snapshot(stats);
+    uint32_t order[StageCount];
+    for (uint32_t i = 0; i < StageCount; ++i) order[i] = i;
+    std::sort(order, order + StageCount, [&](uint32_t a, uint32_t b) { return stats[a].p50 > stats[b].p50; });
+    size_t len = 0;
+    buf[0] = L'\0';
+    uint32_t shown = 0;
+    for (uint32_t k = 0; k < StageCount && shown < maxStages; ++k) {
+        uint32_t i = order[k];
+        // The projection total overlaps its sub-stages; show only the breakdown
+        if (i == StProjection || stats[i].samples == 0) continue;
+        int n = swprintf_s(buf + len, count - len, L"%s%hs %.1f/%.1f ms", shown ? L" | " : L"",
+                           StageName(i), stats[i].p50, stats[i].p99);
+        if (n < 0) break;
+        len += (size_t)n;
+        ++shown;
+    }
+}
+
+// "stage_timing_ms" object for the MCP status file
+inline void WriteJson(FILE* f, const char* indent) {
+    StageStats stats[StageCount];
+    FrameTimers::Get().Snapshot(stats);
+    fprintf(f, "%s\"stage_timing_ms\": {\n", indent);
+    bool first = true;
+    for (uint32_t i = 0; i < StageCount; ++i) {
+        if (stats[i].samples == 0) continue;
+        fprintf(f, "%s%s  \"%s\": {\"p50\": %.3f, \"p95\": %.3f, \"p99\": %.3f, \"last\": %.3f, \"samples\": %u}",
+                first ? "" : ",\n", indent, StageName(i), stats[i].p50, stats[i].p95, stats[i].p99,
+                stats[i].last, stats[i].samples);
+        first = false;
+    }
+    fprintf(f, "%s%s}", first ? "" : "\n", indent);
+}
+
+} // namespace timing
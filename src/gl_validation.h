@@ -0,0 +1,94 @@
+// Opt-in GL validation layer for OpenXR Simulator
+// - The debug readbacks that used to run inside the GL swapchain calls (a context switch,
+//   glFinish, glMemoryBarrier(ALL), a temporary FBO and a full-texture glGetTexImage at release
+//   time, and pixel sums over the preview and quad-layer readbacks) only run while their check
+//   is enabled here, so the production path issues no extra GPU syncs or readbacks
+// - Checks are independent bits and can be flipped at runtime through the MCP
+//   set_gl_validation tool; the per-frame checks only run on a sample of frames
+//
+// Environment:
+//   OPENXR_SIM_GL_VALIDATION  off (default) | all | comma list of create, enumerate, release, pixels
+#pragma once
+
+#include <windows.h>
+#include <atomic>
+#include <cstdio>
+#include <cstdint>
+#include <cstring>
+
+namespace glvalidation {
+
+enum Check : uint32_t {
+    CheckCreate    = 1u << 0,  // read back each new swapchain texture once
+    CheckEnumerate = 1u << 1,  // read back the first image handed out by xrEnumerateSwapchainImages
+    CheckRelease   = 1u << 2,  // full GL state and content dump of the released image (stalls GL)
+    CheckPixels    = 1u << 3,  // pixel sums of the preview eye and quad-layer readbacks
+    CheckAll       = CheckCreate | CheckEnumerate | CheckRelease | CheckPixels,
+};
+
+inline std::atomic<uint32_t> g_checks{0};
+
+struct CheckName {
+    const char* name;
+    Check check;
+};
+inline constexpr CheckName kCheckNames[] = {
+    { "create", CheckCreate },
+    { "enumerate", CheckEnumerate },
+    { "release", CheckRelease },
+    { "pixels", CheckPixels },
+};
+
+// "all", "1" or "on" enable everything; "", "0", "off" or "none" nothing; otherwise a comma
+// (or space) separated list of check names. Unknown names are ignored.
+inline uint32_t ParseChecks(const char* text) {
+    if (!text) return 0;
+    if (!_stricmp(text, "all") || !_stricmp(text, "1") || !_stricmp(text, "on")) return CheckAll;
+    uint32_t checks = 0;
+    const char* p = text;
+    while (*p) {
+        while (*p == ',' || *p == ' ') ++p;
+        const char* end = p;
+        while (*end && *end != ',' && *end != ' ') ++end;
+        const size_t len = (size_t)(end - p);
+        for (const CheckName& entry : kCheckNames) {
+            if (len == strlen(entry.name) && !_strnicmp(p, entry.name, len)) checks |= entry.check;
+        }
+        p = end;
+    }
+    return checks;
+}
+
+// Comma list of the enabled checks ("off" when none), for logs and command acks
+inline const char* Describe(uint32_t checks, char* buf, size_t size) {
+    if (size == 0) return buf;
+    buf[0] = '\0';
+    size_t used = 0;
+    for (const CheckName& entry : kCheckNames) {
+        if (!(checks & entry.check)) continue;
+        const int n = snprintf(buf + used, size - used, "%s%s", used ? "," : "", entry.name);
+        if (n < 0 || (size_t)n >= size - used) break;
+        used += (size_t)n;
+    }
+    if (used == 0) snprintf(buf, size, "off");
+    return buf;
+}
+
+inline void Set(uint32_t checks) { g_checks.store(checks & CheckAll, std::memory_order_relaxed); }
+
+inline void Configure() {
+    char value[128] = {};
+    if (GetEnvironmentVariableA("OPENXR_SIM_GL_VALIDATION", value, sizeof(value)) > 0) {
+        Set(ParseChecks(value));
+    }
+}
+
+inline bool Enabled(Check check) { return (g_checks.load(std::memory_order_relaxed) & check) != 0; }
+
+// Per-site throttle: the first 10 calls, then every 60th
+inline bool Sample(uint32_t& counter) {
+    ++counter;
+    return counter <= 10 || counter % 60 == 1;
+}
+
+} // namespace glvalidation
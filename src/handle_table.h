@@ -0,0 +1,98 @@
+// Generational handle tables for OpenXR Simulator
+// - A handle's value encodes the table's tag, its slot index and the slot's generation:
+//   (tag << 56) | (generation << 32) | (index + 1), never zero (XR_NULL_HANDLE). Generations
+//   are 24 bits and wrap.
+// - Lookup is an index plus a tag and generation compare, with no hashing. Destroying a handle
+//   bumps its slot's generation, so a stale handle is rejected instead of aliasing whatever
+//   reuses the slot, and the tag rejects a handle of another type (a swapchain passed as a
+//   space); callers turn that into XR_ERROR_HANDLE_INVALID
+// - Slots live in a std::deque: contiguous chunks, and references stay valid as the table
+//   grows (a Swapchain& held across xrCreateSwapchain stays valid, as with the maps before)
+#pragma once
+
+#include <deque>
+#include <optional>
+#include <utility>
+#include <vector>
+#include <cstdint>
+
+namespace handles {
+
+// Tag: nonzero and distinct per table
+template <typename Handle, typename T, uint8_t Tag>
+class HandleTable {
+    static_assert(Tag != 0, "handle table tags must be nonzero");
+
+public:
+    Handle Insert(T&& value) {
+        uint32_t index;
+        if (!m_free.empty()) {
+            index = m_free.back();
+            m_free.pop_back();
+        } else {
+            index = (uint32_t)m_slots.size();
+            m_slots.emplace_back();
+        }
+        Slot& slot = m_slots[index];
+        slot.value.emplace(std::move(value));
+        ++m_count;
+        return Encode(index, slot.generation);
+    }
+
+    T* Find(Handle handle) {
+        Slot* slot = Lookup(handle);
+        return slot ? &*slot->value : nullptr;
+    }
+
+    const T* Find(Handle handle) const {
+        return const_cast<HandleTable*>(this)->Find(handle);
+    }
+
+    bool Erase(Handle handle) {
+        Slot* slot = Lookup(handle);
+        if (!slot) return false;
+        slot->value.reset();
+        slot->generation = (slot->generation + 1) & kGenerationMask;
+        m_free.push_back(DecodeIndex(handle));
+        --m_count;
+        return true;
+    }
+
+    size_t Size() const { return m_count; }
+
+    // Visit every live value; f must not insert or erase
+    template <typename F>
+    void ForEach(F&& f) {
+        for (Slot& slot : m_slots) {
+            if (slot.value) f(*slot.value);
+        }
+    }
+
+private:
+    static constexpr uint32_t kGenerationMask = 0xFFFFFFu;
+
+    struct Slot {
+        uint32_t generation{1};
+        std::optional<T> value;
+    };
+
+    static Handle Encode(uint32_t index, uint32_t generation) {
+        return (Handle)(((uint64_t)Tag << 56) | ((uint64_t)generation << 32) | (uint64_t)(index + 1));
+    }
+    static uint32_t DecodeIndex(Handle handle) { return (uint32_t)((uint64_t)handle & 0xFFFFFFFFu) - 1; }
+
+    Slot* Lookup(Handle handle) {
+        const uint64_t value = (uint64_t)handle;
+        const uint32_t low = (uint32_t)(value & 0xFFFFFFFFu);
+        if ((uint8_t)(value >> 56) != Tag || low == 0 || low > m_slots.size()) return nullptr;
+        Slot& slot = m_slots[low - 1];
+        if (slot.generation != ((uint32_t)(value >> 32) & kGenerationMask) || !slot.value) return nullptr;
+        return &slot;
+    }
+
+    std::deque<Slot> m_slots;
+    std::vector<uint32_t> m_free;
+    size_t m_count{0};
+};
+
+} // namespace handles
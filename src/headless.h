@@ -0,0 +1,407 @@
+// Headless benchmark mode for OpenXR Simulator
+// - No preview window, DXGI swapchain or Present: xrEndFrame touches no window, so CI runs
+//   measure the app's own frame cost without window messages, DWM or vsync
+// - xrWaitFrame runs unlocked, or at a fixed simulated rate when one is configured
+// - Optional sparse validation captures: every Nth frame each eye's submitted sub-image is
+//   read back without stalling (collected a frame or more later), hashed (FNV-1a 64 over the
+//   pixel rows) and logged as one JSON line in headless_captures.jsonl. "save" also writes
+//   8-bit captures as PNGs through the screenshot writer.
+//
+// Settings come from the runtime manifest (beside the DLL, ignored by the loader)
+//   "simulator": { "headless": true, "refresh_rate": 90, "capture_every": 300, "capture": "hash" }
+// and are overridden by the environment:
+//   OPENXR_SIM_HEADLESS               1 | 0
+//   OPENXR_SIM_REFRESH_RATE           as usual; headless defaults to unlocked, vblank is unavailable
+//   OPENXR_SIM_HEADLESS_CAPTURE_EVERY N frames between captures (0 = none, default)
+//   OPENXR_SIM_HEADLESS_CAPTURE       hash (default) | save
+#pragma once
+
+#include <windows.h>
+#include <d3d11.h>
+#include <d3d12.h>
+#include <wrl/client.h>
+#include <string>
+#include <vector>
+#include <algorithm>
+#include <cstdio>
+#include <cstdint>
+#include <cstring>
+#include "mcp_integration.h"
+
+namespace headless {
+
+using Microsoft::WRL::ComPtr;
+
+enum class CaptureMode { Hash, Save };
+
+struct Config {
+    bool enabled = false;
+    int refreshRateHz = 0;       // from the manifest; 0 = unlocked (OPENXR_SIM_REFRESH_RATE wins)
+    uint32_t captureEvery = 0;   // frames; 0 = no captures
+    CaptureMode capture = CaptureMode::Hash;
+};
+
+inline Config g_config;
+
+// "key": value in the manifest's "simulator" object
+inline const char* FindSetting(const char* json, const char* key) {
+    const char* section = strstr(json, "\"simulator\"");
+    if (!section) return nullptr;
+    char searchKey[64];
+    snprintf(searchKey, sizeof(searchKey), "\"%s\"", key);
+    const char* pos = strstr(section, searchKey);
+    if (!pos) return nullptr;
+    pos = strchr(pos + strlen(searchKey), ':');
+    if (!pos) return nullptr;
+    ++pos;
+    while (*pos == ' ' || *pos == '\t' || *pos == '\r' || *pos == '\n') ++pos;
+    return pos;
+}
+
+// Manifest next to this DLL (openxr_simulator.dll -> openxr_simulator.json), then environment.
+// Called from xrCreateInstance.
+inline void LoadConfig() {
+    Config config;
+    HMODULE module = nullptr;
+    char path[MAX_PATH] = {0};
+    if (GetModuleHandleExA(GET_MODULE_HANDLE_EX_FLAG_FROM_ADDRESS | GET_MODULE_HANDLE_EX_FLAG_UNCHANGED_REFCOUNT,
+                           (LPCSTR)&LoadConfig, &module) &&
+        GetModuleFileNameA(module, path, MAX_PATH) > 0) {
+        char* ext = strrchr(path, '.');
+        if (ext && (size_t)(ext - path) + 6 < MAX_PATH) strcpy_s(ext, MAX_PATH - (ext - path), ".json");
+        FILE* f = nullptr;
+        if (fopen_s(&f, path, "r") == 0 && f) {
+            char buf[4096];
+            const size_t n = fread(buf, 1, sizeof(buf) - 1, f);
+            buf[n] = 0;
+            fclose(f);
+            if (const char* v = FindSetting(buf, "headless")) config.enabled = (strncmp(v, "true", 4) == 0);
+            if (const char* v = FindSetting(buf, "refresh_rate")) config.refreshRateHz = atoi(v);
+            if (const char* v = FindSetting(buf, "capture_every")) config.captureEvery = (uint32_t)(std::max)(atoi(v), 0);
+            if (const char* v = FindSetting(buf, "capture")) {
+                if (strncmp(v, "\"save\"", 6) == 0) config.capture = CaptureMode::Save;
+            }
+        }
+    }
+
+    char value[32] = {0};
+    if (GetEnvironmentVariableA("OPENXR_SIM_HEADLESS", value, (DWORD)sizeof(value)) > 0) {
+        config.enabled = (strcmp(value, "1") == 0 || _stricmp(value, "true") == 0);
+    }
+    if (GetEnvironmentVariableA("OPENXR_SIM_HEADLESS_CAPTURE_EVERY", value, (DWORD)sizeof(value)) > 0) {
+        config.captureEvery = (uint32_t)(std::max)(atoi(value), 0);
+    }
+    if (GetEnvironmentVariableA("OPENXR_SIM_HEADLESS_CAPTURE", value, (DWORD)sizeof(value)) > 0) {
+        config.capture = (_stricmp(value, "save") == 0) ? CaptureMode::Save : CaptureMode::Hash;
+    }
+    g_config = config;
+}
+
+inline bool Enabled() { return g_config.enabled; }
+
+// Whether this frame (xrEndFrame count) takes a validation capture
+inline bool CaptureFrame(uint32_t frame) {
+    return g_config.enabled && g_config.captureEvery != 0 && frame % g_config.captureEvery == 0;
+}
+
+inline uint32_t BytesPerPixel(DXGI_FORMAT format) {
+    switch (format) {
+        case DXGI_FORMAT_R16G16B16A16_TYPELESS: case DXGI_FORMAT_R16G16B16A16_FLOAT:
+        case DXGI_FORMAT_R16G16B16A16_UNORM: case DXGI_FORMAT_R32G8X24_TYPELESS:
+        case DXGI_FORMAT_D32_FLOAT_S8X24_UINT:
+            return 8;
+        case DXGI_FORMAT_R8G8B8A8_TYPELESS: case DXGI_FORMAT_R8G8B8A8_UNORM: case DXGI_FORMAT_R8G8B8A8_UNORM_SRGB:
+        case DXGI_FORMAT_B8G8R8A8_TYPELESS: case DXGI_FORMAT_B8G8R8A8_UNORM: case DXGI_FORMAT_B8G8R8A8_UNORM_SRGB:
+        case DXGI_FORMAT_B8G8R8X8_TYPELESS: case DXGI_FORMAT_B8G8R8X8_UNORM: case DXGI_FORMAT_B8G8R8X8_UNORM_SRGB:
+        case DXGI_FORMAT_R10G10B10A2_TYPELESS: case DXGI_FORMAT_R10G10B10A2_UNORM:
+        case DXGI_FORMAT_R11G11B10_FLOAT: case DXGI_FORMAT_R32_TYPELESS: case DXGI_FORMAT_D32_FLOAT:
+        case DXGI_FORMAT_R24G8_TYPELESS: case DXGI_FORMAT_D24_UNORM_S8_UINT:
+            return 4;
+        case DXGI_FORMAT_R16_TYPELESS: case DXGI_FORMAT_D16_UNORM:
+            return 2;
+        default:
+            return 0;
+    }
+}
+
+// Hash one capture, append it to headless_captures.jsonl and, in save mode, hand 8-bit
+// images to the screenshot writer. Rows are bottom-up for GL images.
+inline void Report(uint32_t frame, const char* eye, uint32_t width, uint32_t height, DXGI_FORMAT format,
+                   const uint8_t* data, uint32_t rowPitch, bool bottomUp) {
+    const uint32_t bpp = BytesPerPixel(format);
+    if (!data || bpp == 0 || width == 0 || height == 0) return;
+    const size_t rowBytes = (size_t)width * bpp;
+    uint64_t hash = 1469598103934665603ull;  // FNV-1a 64, top row first
+    for (uint32_t y = 0; y < height; ++y) {
+        const uint8_t* row = data + (size_t)(bottomUp ? height - 1 - y : y) * rowPitch;
+        for (size_t i = 0; i < rowBytes; ++i) {
+            hash ^= row[i];
+            hash *= 1099511628211ull;
+        }
+    }
+
+    static FILE* log = nullptr;
+    if (!log) {
+        const std::string path = mcp::GetSimulatorDataPath() + "\\headless_captures.jsonl";
+        CreateDirectoryA(mcp::GetSimulatorDataPath().c_str(), nullptr);
+        if (fopen_s(&log, path.c_str(), "w") != 0) log = nullptr;
+    }
+    if (log) {
+        fprintf(log, "{\"frame\": %u, \"eye\": \"%s\", \"width\": %u, \"height\": %u, \"format\": %d, \"fnv1a64\": \"%016llx\"}\n",
+                frame, eye, width, height, (int)format, (unsigned long long)hash);
+        fflush(log);
+    }
+
+    const bool rgba8 = format == DXGI_FORMAT_R8G8B8A8_UNORM || format == DXGI_FORMAT_R8G8B8A8_UNORM_SRGB ||
+                       format == DXGI_FORMAT_R8G8B8A8_TYPELESS;
+    const bool bgra8 = format == DXGI_FORMAT_B8G8R8A8_UNORM || format == DXGI_FORMAT_B8G8R8A8_UNORM_SRGB ||
+                       format == DXGI_FORMAT_B8G8R8A8_TYPELESS || format == DXGI_FORMAT_B8G8R8X8_UNORM ||
+                       format == DXGI_FORMAT_B8G8R8X8_UNORM_SRGB || format == DXGI_FORMAT_B8G8R8X8_TYPELESS;
+    if (g_config.capture != CaptureMode::Save || !(rgba8 || bgra8)) return;
+    std::vector<uint8_t> pixels(rowBytes * height);
+    for (uint32_t y = 0; y < height; ++y) {
+        memcpy(pixels.data() + (size_t)y * rowBytes, data + (size_t)(bottomUp ? height - 1 - y : y) * rowPitch, rowBytes);
+    }
+    char stem[64];
+    snprintf(stem, sizeof(stem), "headless_%06u_%s", frame, eye);
+    mcp::SubmitScreenshot(std::move(pixels), width, height, (uint32_t)rowBytes, bgra8, stem, screenshot::Format::Png);
+}
+
+// D3D11 (and GL interop) captures: Queue() copies the sub-image into a staging texture, Poll()
+// maps finished copies without waiting, as mcp::AsyncCapture11 does for screenshots
+class Capture11 {
+public:
+    static constexpr uint32_t kSlots = 4;  // both eyes of two capture frames in flight
+    static constexpr uint32_t kMaxFramesWaited = 8;
+
+    bool Queue(ID3D11Device* device, ID3D11DeviceContext* ctx, ID3D11Texture2D* texture, UINT subresource,
+               const D3D11_BOX& box, uint32_t frame, const char* eye, bool bottomUp) {
+        if (!device || !ctx || !texture || box.right <= box.left || box.bottom <= box.top) return false;
+        D3D11_TEXTURE2D_DESC desc;
+        texture->GetDesc(&desc);
+        if (desc.SampleDesc.Count > 1 || BytesPerPixel(desc.Format) == 0) return false;
+        Slot* slot = nullptr;
+        for (auto& candidate : m_slots) {
+            if (!candidate.pending) { slot = &candidate; break; }
+        }
+        if (!slot) return false;
+        const UINT width = box.right - box.left, height = box.bottom - box.top;
+        if (!slot->staging || slot->width != width || slot->height != height || slot->format != desc.Format ||
+            slot->device.Get() != device) {
+            D3D11_TEXTURE2D_DESC stagingDesc = {};
+            stagingDesc.Width = width;
+            stagingDesc.Height = height;
+            stagingDesc.MipLevels = 1;
+            stagingDesc.ArraySize = 1;
+            stagingDesc.Format = desc.Format;
+            stagingDesc.SampleDesc.Count = 1;
+            stagingDesc.Usage = D3D11_USAGE_STAGING;
+            stagingDesc.CPUAccessFlags = D3D11_CPU_ACCESS_READ;
+            slot->staging.Reset();
+            HRESULT hr = device->CreateTexture2D(&stagingDesc, nullptr, slot->staging.GetAddressOf());
+            if (FAILED(hr)) {
+                McpLogf("Headless capture: staging texture %ux%u fmt=%d failed 0x%08X", width, height,
+                        (int)desc.Format, (unsigned)hr);
+                return false;
+            }
+            slot->device = device;
+            slot->width = width;
+            slot->height = height;
+            slot->format = desc.Format;
+        }
+        ctx->CopySubresourceRegion(slot->staging.Get(), 0, 0, 0, 0, texture, subresource, &box);
+        slot->pending = true;
+        slot->framesWaited = 0;
+        slot->frame = frame;
+        slot->eye = eye;
+        slot->bottomUp = bottomUp;
+        return true;
+    }
+
+    // wait: map even copies still in flight (session teardown)
+    void Poll(ID3D11DeviceContext* ctx, bool wait = false) {
+        if (!ctx) return;
+        for (auto& slot : m_slots) {
+            if (!slot.pending) continue;
+            const UINT flags = (!wait && ++slot.framesWaited < kMaxFramesWaited) ? D3D11_MAP_FLAG_DO_NOT_WAIT : 0;
+            D3D11_MAPPED_SUBRESOURCE mapped;
+            HRESULT hr = ctx->Map(slot.staging.Get(), 0, D3D11_MAP_READ, flags, &mapped);
+            if (hr == DXGI_ERROR_WAS_STILL_DRAWING) continue;
+            slot.pending = false;
+            if (FAILED(hr)) continue;
+            Report(slot.frame, slot.eye, slot.width, slot.height, slot.format, (const uint8_t*)mapped.pData,
+                   mapped.RowPitch, slot.bottomUp);
+            ctx->Unmap(slot.staging.Get(), 0);
+        }
+    }
+
+    void Reset() {
+        for (auto& slot : m_slots) slot = Slot{};
+    }
+
+private:
+    struct Slot {
+        ComPtr<ID3D11Device> device;
+        ComPtr<ID3D11Texture2D> staging;
+        UINT width{0}, height{0};
+        DXGI_FORMAT format{DXGI_FORMAT_UNKNOWN};
+        bool pending{false};
+        uint32_t framesWaited{0};
+        uint32_t frame{0};
+        const char* eye{""};
+        bool bottomUp{false};
+    };
+    Slot m_slots[kSlots];
+};
+
+// D3D12 captures: the copy is recorded into a list of our own and submitted to the app's queue
+// behind the frame's rendering; Poll() maps readbacks whose fence has passed
+class Capture12 {
+public:
+    static constexpr uint32_t kSlots = 4;
+
+    // source must be in COMMON (released images are); it is used through implicit promotion
+    bool Queue(ID3D12Device* device, ID3D12CommandQueue* queue, ID3D12Resource* source, UINT subresource,
+               const D3D12_BOX& box, uint32_t frame, const char* eye) {
+        if (!device || !queue || !source || box.right <= box.left || box.bottom <= box.top) return false;
+        const D3D12_RESOURCE_DESC desc = source->GetDesc();
+        if (desc.SampleDesc.Count > 1 || BytesPerPixel(desc.Format) == 0) return false;
+        if (!EnsureDevice(device)) return false;
+        Poll();
+        Slot* slot = nullptr;
+        for (auto& candidate : m_slots) {
+            if (candidate.fenceValue == 0) { slot = &candidate; break; }
+        }
+        if (!slot) return false;
+
+        const UINT width = box.right - box.left, height = box.bottom - box.top;
+        const UINT bpp = BytesPerPixel(desc.Format);
+        const UINT pitch = (width * bpp + D3D12_TEXTURE_DATA_PITCH_ALIGNMENT - 1) & ~(D3D12_TEXTURE_DATA_PITCH_ALIGNMENT - 1);
+        const UINT64 size = (UINT64)pitch * height;
+        if (!slot->readback || slot->size < size) {
+            D3D12_HEAP_PROPERTIES heap = {};
+            heap.Type = D3D12_HEAP_TYPE_READBACK;
+            D3D12_RESOURCE_DESC bufDesc = {};
+            bufDesc.Dimension = D3D12_RESOURCE_DIMENSION_BUFFER;
+            bufDesc.Width = size;
+            bufDesc.Height = 1;
+            bufDesc.DepthOrArraySize = 1;
+            bufDesc.MipLevels = 1;
+            bufDesc.SampleDesc.Count = 1;
+            bufDesc.Layout = D3D12_TEXTURE_LAYOUT_ROW_MAJOR;
+            slot->readback.Reset();
+            HRESULT hr = device->CreateCommittedResource(&heap, D3D12_HEAP_FLAG_NONE, &bufDesc,
+                                                         D3D12_RESOURCE_STATE_COPY_DEST, nullptr,
+                                                         IID_PPV_ARGS(slot->readback.GetAddressOf()));
+            if (FAILED(hr)) {
+                McpLogf("Headless capture: readback buffer failed 0x%08X", (unsigned)hr);
+                return false;
+            }
+            slot->size = size;
+        }
+        if (!slot->alloc && FAILED(device->CreateCommandAllocator(D3D12_COMMAND_LIST_TYPE_DIRECT,
+                                                                  IID_PPV_ARGS(slot->alloc.GetAddressOf())))) {
+            return false;
+        }
+        if (FAILED(slot->alloc->Reset())) return false;
+        if (!m_list) {
+            if (FAILED(device->CreateCommandList(0, D3D12_COMMAND_LIST_TYPE_DIRECT, slot->alloc.Get(), nullptr,
+                                                 IID_PPV_ARGS(m_list.GetAddressOf())))) {
+                return false;
+            }
+        } else if (FAILED(m_list->Reset(slot->alloc.Get(), nullptr))) {
+            return false;
+        }
+
+        D3D12_TEXTURE_COPY_LOCATION dst = {};
+        dst.pResource = slot->readback.Get();
+        dst.Type = D3D12_TEXTURE_COPY_TYPE_PLACED_FOOTPRINT;
+        dst.PlacedFootprint.Footprint.Format = desc.Format;
+        dst.PlacedFootprint.Footprint.Width = width;
+        dst.PlacedFootprint.Footprint.Height = height;
+        dst.PlacedFootprint.Footprint.Depth = 1;
+        dst.PlacedFootprint.Footprint.RowPitch = pitch;
+        D3D12_TEXTURE_COPY_LOCATION src = {};
+        src.pResource = source;
+        src.Type = D3D12_TEXTURE_COPY_TYPE_SUBRESOURCE_INDEX;
+        src.SubresourceIndex = subresource;
+        m_list->CopyTextureRegion(&dst, 0, 0, 0, &src, &box);
+        m_list->Close();
+        ID3D12CommandList* lists[] = { m_list.Get() };
+        queue->ExecuteCommandLists(1, lists);
+        queue->Signal(m_fence.Get(), ++m_fenceValue);
+
+        slot->fenceValue = m_fenceValue;
+        slot->frame = frame;
+        slot->eye = eye;
+        slot->width = width;
+        slot->height = height;
+        slot->pitch = pitch;
+        slot->format = desc.Format;
+        return true;
+    }
+
+    // wait: block for copies still in flight (session teardown)
+    void Poll(bool wait = false) {
+        if (!m_fence) return;
+        for (auto& slot : m_slots) {
+            if (slot.fenceValue == 0) continue;
+            if (m_fence->GetCompletedValue() < slot.fenceValue) {
+                if (!wait) continue;
+                m_fence->SetEventOnCompletion(slot.fenceValue, m_event);
+                WaitForSingleObject(m_event, 1000);
+            }
+            slot.fenceValue = 0;
+            void* mapped = nullptr;
+            D3D12_RANGE readRange = { 0, (SIZE_T)slot.pitch * slot.height };
+            if (FAILED(slot.readback->Map(0, &readRange, &mapped)) || !mapped) continue;
+            Report(slot.frame, slot.eye, slot.width, slot.height, slot.format, (const uint8_t*)mapped, slot.pitch, false);
+            D3D12_RANGE writeRange = { 0, 0 };
+            slot.readback->Unmap(0, &writeRange);
+        }
+    }
+
+    void Reset() {
+        Poll(true);
+        for (auto& slot : m_slots) slot = Slot{};
+        m_list.Reset();
+        m_fence.Reset();
+        m_fenceValue = 0;
+        m_device = nullptr;
+        if (m_event) CloseHandle(m_event);
+        m_event = nullptr;
+    }
+
+private:
+    struct Slot {
+        ComPtr<ID3D12CommandAllocator> alloc;
+        ComPtr<ID3D12Resource> readback;
+        UINT64 size{0};
+        UINT64 fenceValue{0};  // 0 = free
+        uint32_t frame{0};
+        const char* eye{""};
+        UINT width{0}, height{0}, pitch{0};
+        DXGI_FORMAT format{DXGI_FORMAT_UNKNOWN};
+    };
+
+    bool EnsureDevice(ID3D12Device* device) {
+        if (m_device == device && m_fence) return true;
+        Reset();
+        if (FAILED(device->CreateFence(0, D3D12_FENCE_FLAG_NONE, IID_PPV_ARGS(m_fence.GetAddressOf())))) return false;
+        m_event = CreateEventA(nullptr, FALSE, FALSE, nullptr);
+        m_device = device;
+        return true;
+    }
+
+    Slot m_slots[kSlots];
+    ComPtr<ID3D12GraphicsCommandList> m_list;
+    ComPtr<ID3D12Fence> m_fence;
+    UINT64 m_fenceValue{0};
+    HANDLE m_event{nullptr};
+    const ID3D12Device* m_device{nullptr};
+};
+
+inline Capture11 g_capture11;
+inline Capture12 g_capture12;
+
+} // namespace headless
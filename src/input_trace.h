@@ -0,0 +1,300 @@
+// Input trace recording and replay for repeatable perf runs
+// - One fixed-size record per frame: head pose, both controllers (pose offsets, buttons,
+//   analog values, velocities) and the frame's display-time offset and period
+// - Recording appends records to a buffer that a writer thread streams to disk, so the frame
+//   thread never waits on I/O; the header's frame count is patched when the trace is closed
+// - Playback maps the file and hands out record N on the Nth xrWaitFrame, so every run sees
+//   the same poses, inputs and display times at the same frame regardless of wall-clock time
+//
+// File layout (little-endian): Header, then Header::frameCount Frame records
+//
+// Environment:
+//   OPENXR_SIM_TRACE_RECORD  path of a trace to write (relative paths go to the data directory)
+//   OPENXR_SIM_TRACE_PLAY    path of a trace to replay; overrides keyboard, mouse, auto motion,
+//                            pose sweep and MCP pose commands while frames remain
+//   OPENXR_SIM_TRACE_LOOP=1  restart playback at the first frame instead of holding the last
+#pragma once
+
+#include <windows.h>
+#include <atomic>
+#include <condition_variable>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <utility>
+#include <vector>
+#include <cstdarg>
+#include <cstddef>
+#include <cstdio>
+#include <cstdint>
+#include <cstring>
+#include "async_log.h"
+
+namespace trace {
+
+constexpr uint32_t kMagic = 0x54525853;  // "SXRT"
+constexpr uint32_t kVersion = 1;
+
+// Button bits of ControllerSample::buttons
+enum Button : uint32_t {
+    BtnTrigger    = 1u << 0,
+    BtnGrip       = 1u << 1,
+    BtnMenu       = 1u << 2,
+    BtnPrimary    = 1u << 3,
+    BtnSecondary  = 1u << 4,
+    BtnThumbstick = 1u << 5,
+    BtnTracking   = 1u << 31,  // isTracking
+};
+
+#pragma pack(push, 1)
+struct ControllerSample {
+    float posOffset[3];
+    float yawOffset, pitchOffset;
+    uint32_t buttons;
+    float triggerValue, gripValue;
+    float thumbstick[2];
+    float linearVelocity[3];
+    float angularVelocity[3];
+};
+
+struct Frame {
+    uint64_t frameIndex;        // xrWaitFrame count since recording started
+    int64_t displayTimeNs;      // predictedDisplayTime relative to the first recorded frame
+    int64_t periodNs;           // predictedDisplayPeriod
+    float headPos[3];
+    float headYaw, headPitch, headRoll;  // head state (controllers follow it)
+    float viewYaw, viewPitch, viewRoll;  // as xrLocateViews reports it (pose sweep applied)
+    ControllerSample controllers[2];     // left, right
+};
+
+struct Header {
+    uint32_t magic;
+    uint32_t version;
+    uint32_t frameSize;    // sizeof(Frame), so a reader can reject mismatched builds
+    uint32_t reserved;
+    uint64_t frameCount;   // patched on close; 0 in a trace that was not closed cleanly
+};
+#pragma pack(pop)
+
+inline void Note(const char* fmt, ...) {
+    char msg[MAX_PATH + 128];
+    int n = snprintf(msg, sizeof(msg), "[SimXR] ");
+    va_list args;
+    va_start(args, fmt);
+    vsnprintf(msg + n, sizeof(msg) - n, fmt, args);
+    va_end(args);
+    logging::Write(logging::CatGeneral, logging::Level::Info, msg);
+}
+
+// Frame thread appends; full blocks of kBlockFrames are swapped to the writer thread
+class Recorder {
+public:
+    static constexpr size_t kBlockFrames = 512;  // ~100 KB, ~5.7 s at 90 Hz
+
+    static Recorder& Get() {
+        static Recorder instance;
+        return instance;
+    }
+
+    bool Start(const std::string& path) {
+        Stop();
+        FILE* file = nullptr;
+        if (fopen_s(&file, path.c_str(), "wb") != 0 || !file) {
+            Note("Input trace: cannot open %s for writing", path.c_str());
+            return false;
+        }
+        Header header = { kMagic, kVersion, (uint32_t)sizeof(Frame), 0, 0 };
+        fwrite(&header, sizeof(header), 1, file);
+        m_file = file;
+        m_path = path;
+        m_frames = 0;
+        m_firstDisplayTime = 0;
+        m_block.clear();
+        m_block.reserve(kBlockFrames);
+        m_stop = false;
+        m_thread = std::thread([this] { WriterLoop(); });
+        m_active.store(true, std::memory_order_release);
+        Note("Input trace: recording to %s", path.c_str());
+        return true;
+    }
+
+    bool Active() const { return m_active.load(std::memory_order_acquire); }
+
+    // Frame thread, once per xrWaitFrame. frame.frameIndex and displayTimeNs are filled in here;
+    // displayTimeNs is passed as the absolute predictedDisplayTime.
+    void Append(Frame frame) {
+        if (!Active()) return;
+        if (m_frames == 0) m_firstDisplayTime = frame.displayTimeNs;
+        frame.frameIndex = m_frames++;
+        frame.displayTimeNs -= m_firstDisplayTime;
+        m_block.push_back(frame);
+        if (m_block.size() >= kBlockFrames) Flush();
+    }
+
+    // Hand over the partial block, let the writer drain, patch the frame count and close
+    void Stop() {
+        if (!m_active.exchange(false)) return;
+        Flush();
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            m_stop = true;
+        }
+        m_cv.notify_one();
+        if (m_thread.joinable()) m_thread.join();
+        const uint64_t frames = m_frames;
+        fseek(m_file, offsetof(Header, frameCount), SEEK_SET);
+        fwrite(&frames, sizeof(frames), 1, m_file);
+        fclose(m_file);
+        m_file = nullptr;
+        Note("Input trace: wrote %llu frames to %s", (unsigned long long)frames, m_path.c_str());
+    }
+
+private:
+    Recorder() = default;
+    // Joining from static destruction (loader lock) could deadlock; Stop() is the exit path
+    ~Recorder() { if (m_thread.joinable()) m_thread.detach(); }
+
+    void Flush() {
+        if (m_block.empty()) return;
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            m_queue.push_back(std::move(m_block));
+        }
+        m_cv.notify_one();
+        m_block = std::vector<Frame>();
+        m_block.reserve(kBlockFrames);
+    }
+
+    void WriterLoop() {
+        for (;;) {
+            std::vector<std::vector<Frame>> blocks;
+            {
+                std::unique_lock<std::mutex> lock(m_mutex);
+                m_cv.wait(lock, [this] { return m_stop || !m_queue.empty(); });
+                if (m_queue.empty()) break;  // stop requested and drained
+                blocks.swap(m_queue);
+            }
+            for (const auto& block : blocks) {
+                if (fwrite(block.data(), sizeof(Frame), block.size(), m_file) != block.size()) {
+                    Note("Input trace: write to %s failed", m_path.c_str());
+                }
+            }
+        }
+        fflush(m_file);
+    }
+
+    std::atomic<bool> m_active{false};
+    FILE* m_file{nullptr};
+    std::string m_path;
+    uint64_t m_frames{0};
+    int64_t m_firstDisplayTime{0};
+    std::vector<Frame> m_block;              // frame thread only
+    std::mutex m_mutex;
+    std::condition_variable m_cv;
+    std::vector<std::vector<Frame>> m_queue;  // blocks waiting for the writer
+    bool m_stop{false};
+    std::thread m_thread;
+};
+
+// Read-only mapping of a trace; Next() is called once per xrWaitFrame
+class Player {
+public:
+    static Player& Get() {
+        static Player instance;
+        return instance;
+    }
+
+    bool Open(const std::string& path, bool loop) {
+        Close();
+        HANDLE file = CreateFileA(path.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING,
+                                  FILE_ATTRIBUTE_NORMAL | FILE_FLAG_SEQUENTIAL_SCAN, nullptr);
+        if (file == INVALID_HANDLE_VALUE) {
+            Note("Input trace: cannot open %s (error=%lu)", path.c_str(), GetLastError());
+            return false;
+        }
+        LARGE_INTEGER size = {};
+        GetFileSizeEx(file, &size);
+        HANDLE mapping = size.QuadPart > (LONGLONG)sizeof(Header)
+                             ? CreateFileMappingA(file, nullptr, PAGE_READONLY, 0, 0, nullptr) : nullptr;
+        CloseHandle(file);  // the mapping keeps the file open
+        const void* view = mapping ? MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0) : nullptr;
+        const Header* header = (const Header*)view;
+        if (!header || header->magic != kMagic || header->version != kVersion || header->frameSize != sizeof(Frame)) {
+            Note("Input trace: %s is not a version %u trace", path.c_str(), kVersion);
+            if (view) UnmapViewOfFile(view);
+            if (mapping) CloseHandle(mapping);
+            return false;
+        }
+        // A trace that was not closed cleanly still replays the frames that reached the disk
+        const uint64_t onDisk = (uint64_t)(size.QuadPart - (LONGLONG)sizeof(Header)) / sizeof(Frame);
+        m_count = (header->frameCount != 0 && header->frameCount <= onDisk) ? header->frameCount : onDisk;
+        m_mapping = mapping;
+        m_view = view;
+        m_frames = (const Frame*)(header + 1);
+        m_next = 0;
+        m_loop = loop;
+        m_finishedLogged = false;
+        Note("Input trace: replaying %llu frames from %s%s", (unsigned long long)m_count, path.c_str(),
+             loop ? " (looping)" : "");
+        return m_count != 0;
+    }
+
+    bool Active() const { return m_frames != nullptr && m_count != 0; }
+
+    // The record for this frame, or the last one once a non-looping trace has run out
+    const Frame* Next() {
+        if (!Active()) return nullptr;
+        if (m_next >= m_count) {
+            if (m_loop) {
+                m_next = 0;
+                ++m_loops;
+            } else {
+                if (!m_finishedLogged) {
+                    Note("Input trace: playback finished after %llu frames; holding the last frame",
+                         (unsigned long long)m_count);
+                    m_finishedLogged = true;
+                }
+                return &m_frames[m_count - 1];
+            }
+        }
+        return &m_frames[m_next++];
+    }
+
+    // Display times continue across loops instead of jumping back
+    int64_t LoopOffsetNs() const {
+        if (m_count == 0) return 0;
+        const Frame& last = m_frames[m_count - 1];
+        return (int64_t)m_loops * (last.displayTimeNs + last.periodNs);
+    }
+
+    // A non-looping trace past its last frame: inputs hold, display timing is live again
+    bool Finished() const { return Active() && !m_loop && m_next >= m_count; }
+
+    uint64_t Position() const { return m_next; }
+    uint64_t Count() const { return m_count; }
+
+    void Close() {
+        if (m_view) UnmapViewOfFile(m_view);
+        if (m_mapping) CloseHandle(m_mapping);
+        m_view = nullptr;
+        m_mapping = nullptr;
+        m_frames = nullptr;
+        m_count = 0;
+        m_next = 0;
+        m_loops = 0;
+    }
+
+private:
+    Player() = default;
+
+    HANDLE m_mapping{nullptr};
+    const void* m_view{nullptr};
+    const Frame* m_frames{nullptr};
+    uint64_t m_count{0};
+    uint64_t m_next{0};
+    uint64_t m_loops{0};
+    bool m_loop{false};
+    bool m_finishedLogged{false};
+};
+
+} // namespace trace
@@ -11,18 +11,31 @@
 #include <cstdio>
 #include <cstring>
 #include <cstdarg>
+#include <cstddef>
+#include <atomic>
+#include "async_log.h"
+#include "run_id.h"
+#include "frame_timing.h"
+#include "screenshot_writer.h"
+#include "video_recorder.h"
+#include "gl_validation.h"
+#include "pose_history.h"
+#include "stress.h"
+#include "stereo_analyzer.h"
 
 namespace mcp {
 
 using Microsoft::WRL::ComPtr;
 
-// MCP-specific logging
+// MCP-specific logging (CatMCP in the async logger)
 inline void McpLog(const char* msg) {
-    OutputDebugStringA("[SimXR-MCP] ");
-    OutputDebugStringA(msg);
-    OutputDebugStringA("\n");
+    if (!logging::Enabled(logging::CatMCP, logging::Level::Info)) return;
+    char buf[2048];
+    snprintf(buf, sizeof(buf), "[SimXR-MCP] %s", msg);
+    logging::Write(logging::CatMCP, logging::Level::Info, buf);
 }
 inline void McpLogf(const char* fmt, ...) {
+    if (!logging::Enabled(logging::CatMCP, logging::Level::Info)) return;
     char buf[2048];
     va_list ap; va_start(ap, fmt);
     vsnprintf(buf, sizeof(buf), fmt, ap);
@@ -30,18 +43,166 @@ inline void McpLogf(const char* fmt, ...) {
     McpLog(buf);
 }
 
+// %LOCALAPPDATA%\OpenXR-Simulator, or its runs\<id> subdirectory with OPENXR_SIM_RUN_ID
 inline std::string GetSimulatorDataPath() {
-    char base[MAX_PATH]{};
-    DWORD len = GetEnvironmentVariableA("LOCALAPPDATA", base, (DWORD)sizeof(base));
-    if (len > 0 && len < sizeof(base)) {
-        return std::string(base) + "\\OpenXR-Simulator";
+    return runid::DataDirectory();
+}
+
+// ---------- Command channel ----------
+//
+// The MCP server delivers one-shot commands through a named shared-memory ring
+// (Local\\OpenXRSimulator_Commands, layout below, mirrored in openxr_simulator_mcp.py).
+// The runtime is the single consumer and polls it with one atomic load per frame.
+// Slot payloads are the same JSON bodies as the legacy *_command.json files, which are
+// still honoured. Those are only scanned in frames where a directory change
+// notification has fired, not with an fopen per command per frame.
+
+enum CommandType : uint32_t {
+    CmdNone = 0,
+    CmdHeadPose,
+    CmdFov,
+    CmdIpd,
+    CmdHeadsetProfile,
+    CmdAnaglyph,
+    CmdPoseSweep,
+    CmdControllerPose,
+    CmdScreenshot,
+    CmdProjLogDump,
+    CmdRecord,
+    CmdGLValidation,
+    CmdStress,
+    CmdTypeCount
+};
+
+constexpr uint32_t kCommandChannelMagic   = 0x43525853;  // 'SXRC'
+constexpr uint32_t kCommandChannelVersion = 1;
+constexpr uint32_t kCommandSlotCount      = 64;          // power of two
+constexpr uint32_t kCommandPayloadSize    = 1008;
+
+struct CommandSlot {
+    uint32_t type;       // CommandType
+    uint32_t length;     // payload bytes (no terminator required)
+    uint64_t seq;        // writeIndex + 1 at publish time
+    char payload[kCommandPayloadSize];
+};
+static_assert(sizeof(CommandSlot) == 1024, "CommandSlot layout is shared with the MCP server");
+
+struct CommandChannel {
+    uint32_t magic;
+    uint32_t version;
+    uint32_t slotCount;
+    uint32_t slotSize;
+    std::atomic<uint64_t> writeIndex;      // producer (MCP server) only; published after the slot
+    std::atomic<uint64_t> readIndex;       // consumer (runtime) only
+    std::atomic<uint64_t> ackSeq;          // seq of the last command the runtime consumed
+    std::atomic<uint64_t> consumerTickMs;  // GetTickCount64() at the last poll (liveness)
+    uint8_t reserved[16];
+    CommandSlot slots[kCommandSlotCount];
+};
+static_assert(offsetof(CommandChannel, writeIndex) == 16 && offsetof(CommandChannel, slots) == 64,
+              "CommandChannel layout is shared with the MCP server");
+static_assert(std::atomic<uint64_t>::is_always_lock_free, "shared-memory indices must be lock-free");
+
+inline CommandChannel* g_cmdChannel = nullptr;
+inline HANDLE g_cmdChannelMapping = nullptr;
+inline HANDLE g_cmdDirNotify = INVALID_HANDLE_VALUE;
+inline bool g_cmdFileScan = true;  // legacy command files may have changed this frame
+inline bool g_cmdPending[CmdTypeCount] = {};
+inline char g_cmdPayload[CmdTypeCount][kCommandPayloadSize + 1] = {};
+
+inline void OpenCommandChannel() {
+    static bool attempted = false;
+    if (attempted) return;
+    attempted = true;
+
+    // Either side may create the mapping first; the first one in initialises the header
+    g_cmdChannelMapping = CreateFileMappingA(INVALID_HANDLE_VALUE, nullptr, PAGE_READWRITE, 0,
+                                             (DWORD)sizeof(CommandChannel),
+                                             runid::ObjectName("Local\\OpenXRSimulator_Commands").c_str());
+    if (g_cmdChannelMapping) {
+        g_cmdChannel = (CommandChannel*)MapViewOfFile(g_cmdChannelMapping, FILE_MAP_ALL_ACCESS, 0, 0, sizeof(CommandChannel));
+    }
+    if (!g_cmdChannel) {
+        McpLogf("Command channel unavailable (error=%lu); using command files only", GetLastError());
+    } else if (g_cmdChannel->magic != kCommandChannelMagic) {
+        g_cmdChannel->version = kCommandChannelVersion;
+        g_cmdChannel->slotCount = kCommandSlotCount;
+        g_cmdChannel->slotSize = (uint32_t)sizeof(CommandSlot);
+        g_cmdChannel->readIndex.store(g_cmdChannel->writeIndex.load(std::memory_order_acquire), std::memory_order_relaxed);
+        g_cmdChannel->magic = kCommandChannelMagic;
+        McpLog("Command channel created");
+    } else {
+        McpLogf("Command channel attached (writeIndex=%llu)",
+                (unsigned long long)g_cmdChannel->writeIndex.load(std::memory_order_relaxed));
     }
-    return ".";
+
+    std::string dir = GetSimulatorDataPath();
+    CreateDirectoryA(dir.c_str(), nullptr);
+    g_cmdDirNotify = FindFirstChangeNotificationA(dir.c_str(), FALSE, FILE_NOTIFY_CHANGE_FILE_NAME);
+}
+
+// Once per frame (xrWaitFrame): drain the shared-memory ring into per-type pending slots
+// (latest command of a type wins, as with the files) and decide whether to scan the files.
+// Pending commands stay queued until their Check* function takes them.
+inline void PollCommandChannel() {
+    OpenCommandChannel();
+
+    if (g_cmdChannel) {
+        g_cmdChannel->consumerTickMs.store(GetTickCount64(), std::memory_order_relaxed);
+        const uint64_t write = g_cmdChannel->writeIndex.load(std::memory_order_acquire);
+        uint64_t read = g_cmdChannel->readIndex.load(std::memory_order_relaxed);
+        if (write - read > kCommandSlotCount) {
+            McpLogf("Command channel overrun: skipping %llu commands", (unsigned long long)(write - read - kCommandSlotCount));
+            read = write - kCommandSlotCount;
+        }
+        for (; read != write; ++read) {
+            const CommandSlot& slot = g_cmdChannel->slots[read % kCommandSlotCount];
+            if (slot.type > CmdNone && slot.type < CmdTypeCount) {
+                uint32_t len = slot.length < kCommandPayloadSize ? slot.length : kCommandPayloadSize;
+                memcpy(g_cmdPayload[slot.type], slot.payload, len);
+                g_cmdPayload[slot.type][len] = 0;
+                g_cmdPending[slot.type] = true;
+            }
+            g_cmdChannel->ackSeq.store(slot.seq, std::memory_order_release);
+        }
+        g_cmdChannel->readIndex.store(read, std::memory_order_release);
+    }
+
+    // Files are also rescanned every 30 polls, for commands whose consumer did not run in
+    // the frame the notification fired (e.g. a screenshot request with no projection layer)
+    static uint32_t pollCount = 0;
+    if (g_cmdDirNotify == INVALID_HANDLE_VALUE) {
+        g_cmdFileScan = true;  // no notification support: poll the files as before
+    } else {
+        g_cmdFileScan = (WaitForSingleObject(g_cmdDirNotify, 0) == WAIT_OBJECT_0);
+        if (g_cmdFileScan) FindNextChangeNotification(g_cmdDirNotify);  // re-arm before scanning
+        if (++pollCount % 30 == 0) g_cmdFileScan = true;
+    }
+}
+
+// Fetch the JSON body of a one-shot command into buf: from the channel if one arrived
+// this frame, otherwise from its legacy command file (deleted once read).
+inline bool TakeCommand(CommandType type, const char* fileName, char* buf, size_t bufSize) {
+    if (g_cmdPending[type]) {
+        g_cmdPending[type] = false;
+        strncpy_s(buf, bufSize, g_cmdPayload[type], _TRUNCATE);
+        return true;
+    }
+    if (!g_cmdFileScan) return false;
+    std::string path = GetSimulatorDataPath() + "\\" + fileName;
+    FILE* f = nullptr;
+    if (fopen_s(&f, path.c_str(), "r") != 0 || !f) return false;
+    size_t n = fread(buf, 1, bufSize - 1, f);
+    buf[n] = 0;
+    fclose(f);
+    DeleteFileA(path.c_str());
+    return true;
 }
 
 inline bool g_screenshotRequested = false;
 inline std::string g_screenshotEye = "both";
 inline std::string g_screenshotLayer = "projection";  // "projection", "quad", or "all"
+inline screenshot::Format g_screenshotFormat = screenshot::Format::Bmp;  // of the pending request
 
 // Storage for quad layer pixels (set by renderQuadLayer)
 inline std::vector<uint8_t> g_quadLayerPixels;
@@ -51,17 +212,13 @@ inline bool g_quadLayerCaptured = false;
 
 // Check if MCP has requested a screenshot
 inline void CheckScreenshotRequest() {
-    std::string reqPath = GetSimulatorDataPath() + "\\screenshot_request.json";
-    FILE* f = nullptr;
-    if (fopen_s(&f, reqPath.c_str(), "r") == 0 && f) {
-        char buf[512];
-        size_t n = fread(buf, 1, sizeof(buf)-1, f);
-        buf[n] = 0;
-        fclose(f);
+    char buf[512];
+    if (TakeCommand(CmdScreenshot, "screenshot_request.json", buf, sizeof(buf))) {
 
         g_screenshotRequested = true;
         g_screenshotEye = "both";
         g_screenshotLayer = "projection";  // default
+        g_screenshotFormat = screenshot::g_defaultFormat.load(std::memory_order_relaxed);
 
         const char* eyePos = strstr(buf, "\"eye\"");
         if (eyePos) {
@@ -76,8 +233,41 @@ inline void CheckScreenshotRequest() {
             else if (strstr(layerPos, "\"all\"")) g_screenshotLayer = "all";
         }
 
-        DeleteFileA(reqPath.c_str());
-        McpLogf("Screenshot request detected: layer=%s, eye=%s", g_screenshotLayer.c_str(), g_screenshotEye.c_str());
+        const char* formatPos = strstr(buf, "\"format\"");
+        if (formatPos) {
+            if (strstr(formatPos, "\"png\"")) g_screenshotFormat = screenshot::Format::Png;
+            else if (strstr(formatPos, "\"bmp\"")) g_screenshotFormat = screenshot::Format::Bmp;
+        }
+
+        McpLogf("Screenshot request detected: layer=%s, eye=%s, format=%s", g_screenshotLayer.c_str(),
+                g_screenshotEye.c_str(), screenshot::Extension(g_screenshotFormat));
+    }
+}
+
+// The request has been turned into a capture; hotkey requests after it use the default format
+inline void CompleteScreenshotRequest() {
+    g_screenshotRequested = false;
+    g_screenshotFormat = screenshot::g_defaultFormat.load(std::memory_order_relaxed);
+}
+
+// <data dir>\<stem>.<bmp|png> for the pending request's format
+inline std::string ScreenshotPath(const char* stem, screenshot::Format format) {
+    return GetSimulatorDataPath() + "\\" + stem + "." + screenshot::Extension(format);
+}
+
+// Hand CPU pixels (32 bpp, top-down) to the writer thread
+inline void SubmitScreenshot(std::vector<uint8_t>&& pixels, uint32_t width, uint32_t height, uint32_t rowPitch,
+                             bool bgra, const char* stem, screenshot::Format format) {
+    screenshot::Job job;
+    job.pixels = std::move(pixels);
+    job.width = width;
+    job.height = height;
+    job.rowPitch = rowPitch;
+    job.bgra = bgra;
+    job.format = format;
+    job.path = ScreenshotPath(stem, format);
+    if (screenshot::Submit(std::move(job))) {
+        McpLogf("Screenshot queued for writing: %s.%s (%ux%u)", stem, screenshot::Extension(format), width, height);
     }
 }
 
@@ -91,119 +281,109 @@ inline void StoreQuadLayerPixels(const uint8_t* pixels, uint32_t width, uint32_t
     g_quadLayerCaptured = true;
 }
 
-// Forward declaration - CaptureQuadScreenshot is defined after SavePixelsToBMP
-inline void CaptureQuadScreenshot();
-
-// Save a D3D11 texture to BMP file
-inline bool SaveTextureToBMP(ID3D11Device* device, ID3D11DeviceContext* ctx,
-                              ID3D11Texture2D* texture, const char* filename) {
-    if (!device || !ctx || !texture) return false;
-
-    D3D11_TEXTURE2D_DESC desc;
-    texture->GetDesc(&desc);
-
-    // Create staging texture for CPU read
-    D3D11_TEXTURE2D_DESC stagingDesc = desc;
-    stagingDesc.Usage = D3D11_USAGE_STAGING;
-    stagingDesc.BindFlags = 0;
-    stagingDesc.CPUAccessFlags = D3D11_CPU_ACCESS_READ;
-    stagingDesc.MiscFlags = 0;
-
-    ComPtr<ID3D11Texture2D> staging;
-    HRESULT hr = device->CreateTexture2D(&stagingDesc, nullptr, staging.GetAddressOf());
-    if (FAILED(hr)) {
-        McpLogf("Failed to create staging texture: 0x%08X", hr);
-        return false;
+// D3D11 screenshot readback without a stall: Queue() copies the texture into a persistent
+// staging slot, Poll() (once per frame on the same context) maps finished copies with
+// DO_NOT_WAIT and hands the pixels to the writer, typically a frame or two later. One
+// instance per device context: the app thread's and the compositor thread's.
+class AsyncCapture11 {
+public:
+    static constexpr uint32_t kSlots = 2;
+
+    bool Queue(ID3D11Device* device, ID3D11DeviceContext* ctx, ID3D11Texture2D* texture,
+               const char* stem, screenshot::Format format) {
+        if (!device || !ctx || !texture) return false;
+        D3D11_TEXTURE2D_DESC desc;
+        texture->GetDesc(&desc);
+        if (desc.SampleDesc.Count > 1) {
+            McpLog("Screenshot: multisampled source not supported");
+            return false;
+        }
+        const bool bgra = desc.Format == DXGI_FORMAT_B8G8R8A8_UNORM || desc.Format == DXGI_FORMAT_B8G8R8A8_UNORM_SRGB ||
+                          desc.Format == DXGI_FORMAT_B8G8R8A8_TYPELESS;
+        Slot* slot = nullptr;
+        for (auto& candidate : m_slots) {
+            if (!candidate.pending) { slot = &candidate; break; }
+        }
+        if (!slot) {
+            McpLog("Screenshot readback ring busy; dropping capture");
+            return false;
+        }
+        if (!slot->staging || slot->desc.Width != desc.Width || slot->desc.Height != desc.Height ||
+            slot->desc.Format != desc.Format || slot->device.Get() != device) {
+            D3D11_TEXTURE2D_DESC stagingDesc = desc;
+            stagingDesc.MipLevels = 1;
+            stagingDesc.ArraySize = 1;
+            stagingDesc.SampleDesc.Count = 1;
+            stagingDesc.SampleDesc.Quality = 0;
+            stagingDesc.Usage = D3D11_USAGE_STAGING;
+            stagingDesc.BindFlags = 0;
+            stagingDesc.CPUAccessFlags = D3D11_CPU_ACCESS_READ;
+            stagingDesc.MiscFlags = 0;
+            slot->staging.Reset();
+            HRESULT hr = device->CreateTexture2D(&stagingDesc, nullptr, slot->staging.GetAddressOf());
+            if (FAILED(hr)) {
+                McpLogf("Failed to create staging texture: 0x%08X", hr);
+                return false;
+            }
+            slot->device = device;
+            slot->desc = desc;
+        }
+        ctx->CopySubresourceRegion(slot->staging.Get(), 0, 0, 0, 0, texture, 0, nullptr);
+        slot->pending = true;
+        slot->bgra = bgra;
+        slot->framesWaited = 0;
+        slot->format = format;
+        slot->stem = stem;
+        return true;
     }
 
-    // Copy to staging
-    ctx->CopyResource(staging.Get(), texture);
-
-    // Map and read pixels
-    D3D11_MAPPED_SUBRESOURCE mapped;
-    hr = ctx->Map(staging.Get(), 0, D3D11_MAP_READ, 0, &mapped);
-    if (FAILED(hr)) {
-        McpLogf("Failed to map staging texture: 0x%08X", hr);
-        return false;
+    // wait: map even copies still in flight (session teardown)
+    void Poll(ID3D11DeviceContext* ctx, bool wait = false) {
+        if (!ctx) return;
+        for (auto& slot : m_slots) {
+            if (!slot.pending) continue;
+            // Never wait for a copy that is still in flight, unless it has been stuck long
+            // enough that the context was evidently not flushed (no Present since)
+            const UINT flags = (!wait && ++slot.framesWaited < kMaxFramesWaited) ? D3D11_MAP_FLAG_DO_NOT_WAIT : 0;
+            D3D11_MAPPED_SUBRESOURCE mapped;
+            HRESULT hr = ctx->Map(slot.staging.Get(), 0, D3D11_MAP_READ, flags, &mapped);
+            if (hr == DXGI_ERROR_WAS_STILL_DRAWING) continue;
+            slot.pending = false;
+            if (FAILED(hr)) {
+                McpLogf("Failed to map staging texture: 0x%08X", hr);
+                continue;
+            }
+            const uint32_t w = slot.desc.Width, h = slot.desc.Height;
+            std::vector<uint8_t> pixels((size_t)mapped.RowPitch * h);
+            memcpy(pixels.data(), mapped.pData, pixels.size());
+            ctx->Unmap(slot.staging.Get(), 0);
+            SubmitScreenshot(std::move(pixels), w, h, mapped.RowPitch, slot.bgra, slot.stem, slot.format);
+        }
     }
 
-    // Write BMP file
-    FILE* file = nullptr;
-    if (fopen_s(&file, filename, "wb") != 0 || !file) {
-        ctx->Unmap(staging.Get(), 0);
-        return false;
+    // Drop the staging textures (their device is going away)
+    void Reset() {
+        for (auto& slot : m_slots) slot = Slot{};
     }
 
-    uint32_t w = desc.Width;
-    uint32_t h = desc.Height;
-    uint32_t rowSize = w * 3;
-    uint32_t rowPadding = (4 - (rowSize % 4)) % 4;
-    uint32_t rowStride = rowSize + rowPadding;
-    uint32_t imageSize = rowStride * h;
-
-    // BMP Header (54 bytes)
-    uint8_t bmpHeader[54] = {
-        'B', 'M',           // Signature
-        0, 0, 0, 0,         // File size
-        0, 0, 0, 0,         // Reserved
-        54, 0, 0, 0,        // Data offset
-        40, 0, 0, 0,        // DIB header size
-        0, 0, 0, 0,         // Width
-        0, 0, 0, 0,         // Height
-        1, 0,               // Planes
-        24, 0,              // Bits per pixel
-        0, 0, 0, 0,         // Compression
-        0, 0, 0, 0,         // Image size
-        0, 0, 0, 0,         // X pixels/meter
-        0, 0, 0, 0,         // Y pixels/meter
-        0, 0, 0, 0,         // Colors in table
-        0, 0, 0, 0          // Important colors
+private:
+    static constexpr uint32_t kMaxFramesWaited = 8;
+    struct Slot {
+        ComPtr<ID3D11Device> device;
+        ComPtr<ID3D11Texture2D> staging;
+        D3D11_TEXTURE2D_DESC desc{};
+        bool pending = false;
+        bool bgra = false;
+        uint32_t framesWaited = 0;
+        screenshot::Format format = screenshot::Format::Bmp;
+        const char* stem = "screenshot";  // string literal
     };
+    Slot m_slots[kSlots];
+};
 
-    uint32_t fileSize = 54 + imageSize;
-    memcpy(bmpHeader + 2, &fileSize, 4);
-    memcpy(bmpHeader + 18, &w, 4);
-    memcpy(bmpHeader + 22, &h, 4);
-    memcpy(bmpHeader + 34, &imageSize, 4);
-
-    fwrite(bmpHeader, 1, 54, file);
-
-    // Write pixel data (BMP is bottom-up, BGR)
-    std::vector<uint8_t> row(rowStride, 0);
-    uint8_t* src = (uint8_t*)mapped.pData;
-
-    for (int y = h - 1; y >= 0; y--) {
-        uint8_t* srcRow = src + y * mapped.RowPitch;
-        for (uint32_t x = 0; x < w; x++) {
-            // Handle different DXGI formats
-            if (desc.Format == DXGI_FORMAT_R8G8B8A8_UNORM ||
-                desc.Format == DXGI_FORMAT_R8G8B8A8_UNORM_SRGB) {
-                row[x*3 + 0] = srcRow[x*4 + 2]; // B
-                row[x*3 + 1] = srcRow[x*4 + 1]; // G
-                row[x*3 + 2] = srcRow[x*4 + 0]; // R
-            } else if (desc.Format == DXGI_FORMAT_B8G8R8A8_UNORM ||
-                       desc.Format == DXGI_FORMAT_B8G8R8A8_UNORM_SRGB) {
-                row[x*3 + 0] = srcRow[x*4 + 0]; // B
-                row[x*3 + 1] = srcRow[x*4 + 1]; // G
-                row[x*3 + 2] = srcRow[x*4 + 2]; // R
-            } else {
-                // Fallback - assume RGBA
-                row[x*3 + 0] = srcRow[x*4 + 2];
-                row[x*3 + 1] = srcRow[x*4 + 1];
-                row[x*3 + 2] = srcRow[x*4 + 0];
-            }
-        }
-        fwrite(row.data(), 1, rowStride, file);
-    }
-
-    fclose(file);
-    ctx->Unmap(staging.Get(), 0);
-
-    McpLogf("Screenshot saved: %s (%ux%u)", filename, w, h);
-    return true;
-}
+inline AsyncCapture11 g_capture11;  // app thread (preview device of D3D11 / GL sessions)
 
-// Capture screenshot from preview swapchain (D3D11 path)
+// Capture screenshot from preview swapchain (D3D11 path); resolves in a later g_capture11.Poll
 inline void CaptureScreenshot(ID3D11Device* device, ID3D11DeviceContext* ctx,
                                IDXGISwapChain1* swapchain) {
     if (!swapchain) return;
@@ -214,230 +394,22 @@ inline void CaptureScreenshot(ID3D11Device* device, ID3D11DeviceContext* ctx,
         return;
     }
 
-    std::string outPath = GetSimulatorDataPath() + "\\screenshot.bmp";
-    SaveTextureToBMP(device, ctx, backbuffer.Get(), outPath.c_str());
-
-    g_screenshotRequested = false;
-}
-
-// Forward declaration - CaptureScreenshotD3D12 is defined after SavePixelsToBMP
-inline void CaptureScreenshotD3D12(ID3D12Device* device, ID3D12CommandQueue* queue,
-                                     ID3D12Resource* renderTarget,
-                                     ID3D12CommandAllocator* cmdAlloc,
-                                     ID3D12GraphicsCommandList* cmdList,
-                                     ID3D12Fence* fence, HANDLE fenceEvent,
-                                     UINT64& fenceValue);
-
-// Save raw RGBA pixel data to BMP (for OpenGL path)
-inline bool SavePixelsToBMP(const uint8_t* pixels, uint32_t width, uint32_t height,
-                             const char* filename) {
-    if (!pixels || width == 0 || height == 0) return false;
-
-    FILE* file = nullptr;
-    if (fopen_s(&file, filename, "wb") != 0 || !file) {
-        McpLogf("Failed to open file for writing: %s", filename);
-        return false;
-    }
-
-    uint32_t rowSize = width * 3;
-    uint32_t rowPadding = (4 - (rowSize % 4)) % 4;
-    uint32_t rowStride = rowSize + rowPadding;
-    uint32_t imageSize = rowStride * height;
-
-    // BMP Header (54 bytes)
-    uint8_t bmpHeader[54] = {
-        'B', 'M',           // Signature
-        0, 0, 0, 0,         // File size
-        0, 0, 0, 0,         // Reserved
-        54, 0, 0, 0,        // Data offset
-        40, 0, 0, 0,        // DIB header size
-        0, 0, 0, 0,         // Width
-        0, 0, 0, 0,         // Height
-        1, 0,               // Planes
-        24, 0,              // Bits per pixel
-        0, 0, 0, 0,         // Compression
-        0, 0, 0, 0,         // Image size
-        0, 0, 0, 0,         // X pixels/meter
-        0, 0, 0, 0,         // Y pixels/meter
-        0, 0, 0, 0,         // Colors in table
-        0, 0, 0, 0          // Important colors
-    };
-
-    uint32_t fileSize = 54 + imageSize;
-    memcpy(bmpHeader + 2, &fileSize, 4);
-    memcpy(bmpHeader + 18, &width, 4);
-    memcpy(bmpHeader + 22, &height, 4);
-    memcpy(bmpHeader + 34, &imageSize, 4);
-
-    fwrite(bmpHeader, 1, 54, file);
-
-    // Write pixel data (BMP is bottom-up, BGR)
-    std::vector<uint8_t> row(rowStride, 0);
-
-    for (int y = height - 1; y >= 0; y--) {
-        const uint8_t* srcRow = pixels + y * width * 4;
-        for (uint32_t x = 0; x < width; x++) {
-            // RGBA to BGR
-            row[x*3 + 0] = srcRow[x*4 + 2]; // B
-            row[x*3 + 1] = srcRow[x*4 + 1]; // G
-            row[x*3 + 2] = srcRow[x*4 + 0]; // R
-        }
-        fwrite(row.data(), 1, rowStride, file);
-    }
-
-    fclose(file);
-    McpLogf("Screenshot saved (pixels): %s (%ux%u)", filename, width, height);
-    return true;
+    g_capture11.Queue(device, ctx, backbuffer.Get(), "screenshot", g_screenshotFormat);
+    CompleteScreenshotRequest();
 }
 
-// Capture quad layer screenshot (implementation - forward declared above)
+// Capture quad layer screenshot
 inline void CaptureQuadScreenshot() {
     if (!g_quadLayerCaptured || g_quadLayerPixels.empty()) {
         McpLog("No quad layer pixels available for screenshot");
-        g_screenshotRequested = false;
+        CompleteScreenshotRequest();
         return;
     }
 
-    std::string outPath = GetSimulatorDataPath() + "\\screenshot_quad.bmp";
-    SavePixelsToBMP(g_quadLayerPixels.data(), g_quadLayerWidth, g_quadLayerHeight, outPath.c_str());
-    McpLogf("Quad layer screenshot saved: %s (%ux%u)", outPath.c_str(), g_quadLayerWidth, g_quadLayerHeight);
-    g_screenshotRequested = false;
-}
-
-// Capture screenshot from D3D12 offscreen render target (implementation)
-inline void CaptureScreenshotD3D12(ID3D12Device* device, ID3D12CommandQueue* queue,
-                                     ID3D12Resource* renderTarget,
-                                     ID3D12CommandAllocator* cmdAlloc,
-                                     ID3D12GraphicsCommandList* cmdList,
-                                     ID3D12Fence* fence, HANDLE fenceEvent,
-                                     UINT64& fenceValue) {
-    if (!device || !queue || !renderTarget || !cmdAlloc || !cmdList) {
-        McpLog("D3D12 screenshot: missing resources");
-        g_screenshotRequested = false;
-        return;
-    }
-
-    D3D12_RESOURCE_DESC desc = renderTarget->GetDesc();
-    uint32_t w = (uint32_t)desc.Width;
-    uint32_t h = (uint32_t)desc.Height;
-
-    // Calculate row pitch aligned to D3D12_TEXTURE_DATA_PITCH_ALIGNMENT (256 bytes)
-    UINT64 rowPitch = (w * 4 + D3D12_TEXTURE_DATA_PITCH_ALIGNMENT - 1) & ~(D3D12_TEXTURE_DATA_PITCH_ALIGNMENT - 1);
-    UINT64 totalSize = rowPitch * h;
-
-    // Create readback buffer
-    D3D12_HEAP_PROPERTIES heapProps = {};
-    heapProps.Type = D3D12_HEAP_TYPE_READBACK;
-    D3D12_RESOURCE_DESC bufDesc = {};
-    bufDesc.Dimension = D3D12_RESOURCE_DIMENSION_BUFFER;
-    bufDesc.Width = totalSize;
-    bufDesc.Height = 1;
-    bufDesc.DepthOrArraySize = 1;
-    bufDesc.MipLevels = 1;
-    bufDesc.SampleDesc.Count = 1;
-    bufDesc.Layout = D3D12_TEXTURE_LAYOUT_ROW_MAJOR;
-
-    ComPtr<ID3D12Resource> readback;
-    if (FAILED(device->CreateCommittedResource(&heapProps, D3D12_HEAP_FLAG_NONE, &bufDesc,
-                                                D3D12_RESOURCE_STATE_COPY_DEST, nullptr,
-                                                IID_PPV_ARGS(readback.GetAddressOf())))) {
-        McpLog("D3D12 screenshot: CreateCommittedResource (readback) failed");
-        g_screenshotRequested = false;
-        return;
-    }
-
-    // Wait for previous commands to finish before reusing the command allocator
-    if (fence && fenceValue > 1) {
-        if (fence->GetCompletedValue() < fenceValue - 1) {
-            fence->SetEventOnCompletion(fenceValue - 1, fenceEvent);
-            WaitForSingleObject(fenceEvent, 1000);
-        }
-    }
-
-    // Record copy commands
-    cmdAlloc->Reset();
-    cmdList->Reset(cmdAlloc, nullptr);
-
-    // Transition render target from COMMON to COPY_SOURCE
-    D3D12_RESOURCE_BARRIER barrier = {};
-    barrier.Type = D3D12_RESOURCE_BARRIER_TYPE_TRANSITION;
-    barrier.Transition.pResource = renderTarget;
-    barrier.Transition.StateBefore = D3D12_RESOURCE_STATE_COMMON;
-    barrier.Transition.StateAfter = D3D12_RESOURCE_STATE_COPY_SOURCE;
-    barrier.Transition.Subresource = D3D12_RESOURCE_BARRIER_ALL_SUBRESOURCES;
-    cmdList->ResourceBarrier(1, &barrier);
-
-    D3D12_TEXTURE_COPY_LOCATION srcLoc = {};
-    srcLoc.pResource = renderTarget;
-    srcLoc.Type = D3D12_TEXTURE_COPY_TYPE_SUBRESOURCE_INDEX;
-    srcLoc.SubresourceIndex = 0;
-
-    D3D12_TEXTURE_COPY_LOCATION dstLoc = {};
-    dstLoc.pResource = readback.Get();
-    dstLoc.Type = D3D12_TEXTURE_COPY_TYPE_PLACED_FOOTPRINT;
-    dstLoc.PlacedFootprint.Offset = 0;
-    dstLoc.PlacedFootprint.Footprint.Format = desc.Format;
-    dstLoc.PlacedFootprint.Footprint.Width = w;
-    dstLoc.PlacedFootprint.Footprint.Height = h;
-    dstLoc.PlacedFootprint.Footprint.Depth = 1;
-    dstLoc.PlacedFootprint.Footprint.RowPitch = (UINT)rowPitch;
-
-    cmdList->CopyTextureRegion(&dstLoc, 0, 0, 0, &srcLoc, nullptr);
-
-    // Transition render target back to COMMON
-    barrier.Transition.StateBefore = D3D12_RESOURCE_STATE_COPY_SOURCE;
-    barrier.Transition.StateAfter = D3D12_RESOURCE_STATE_COMMON;
-    cmdList->ResourceBarrier(1, &barrier);
-
-    cmdList->Close();
-    ID3D12CommandList* cmdLists[] = { cmdList };
-    queue->ExecuteCommandLists(1, cmdLists);
-
-    // Wait for copy to complete
-    queue->Signal(fence, fenceValue);
-    if (fence->GetCompletedValue() < fenceValue) {
-        fence->SetEventOnCompletion(fenceValue, fenceEvent);
-        WaitForSingleObject(fenceEvent, 2000);
-    }
-    fenceValue++;
-
-    // Map and read pixels
-    void* mappedData = nullptr;
-    D3D12_RANGE readRange = { 0, (SIZE_T)totalSize };
-    if (FAILED(readback->Map(0, &readRange, &mappedData))) {
-        McpLog("D3D12 screenshot: Map failed");
-        g_screenshotRequested = false;
-        return;
-    }
-
-    // Convert to tightly-packed RGBA for SavePixelsToBMP
-    std::vector<uint8_t> pixels(w * h * 4);
-    bool isBGRA = (desc.Format == DXGI_FORMAT_B8G8R8A8_UNORM ||
-                   desc.Format == DXGI_FORMAT_B8G8R8A8_UNORM_SRGB);
-
-    for (uint32_t y = 0; y < h; y++) {
-        const uint8_t* srcRow = (const uint8_t*)mappedData + y * rowPitch;
-        uint8_t* dstRow = pixels.data() + y * w * 4;
-        if (isBGRA) {
-            for (uint32_t x = 0; x < w; x++) {
-                dstRow[x * 4 + 0] = srcRow[x * 4 + 2]; // R
-                dstRow[x * 4 + 1] = srcRow[x * 4 + 1]; // G
-                dstRow[x * 4 + 2] = srcRow[x * 4 + 0]; // B
-                dstRow[x * 4 + 3] = srcRow[x * 4 + 3]; // A
-            }
-        } else {
-            memcpy(dstRow, srcRow, w * 4);
-        }
-    }
-
-    D3D12_RANGE writeRange = { 0, 0 };
-    readback->Unmap(0, &writeRange);
-
-    std::string outPath = GetSimulatorDataPath() + "\\screenshot.bmp";
-    SavePixelsToBMP(pixels.data(), w, h, outPath.c_str());
-    McpLogf("D3D12 screenshot captured: %ux%u format=%d", w, h, (int)desc.Format);
-
-    g_screenshotRequested = false;
+    std::vector<uint8_t> pixels = g_quadLayerPixels;
+    SubmitScreenshot(std::move(pixels), g_quadLayerWidth, g_quadLayerHeight, 0, false,
+                     "screenshot_quad", g_screenshotFormat);
+    CompleteScreenshotRequest();
 }
 
 // Capture screenshot from OpenGL pixel data (side-by-side left+right eyes)
@@ -445,7 +417,7 @@ inline void CaptureScreenshotGL(const uint8_t* leftPixels, const uint8_t* rightP
                                  uint32_t width, uint32_t height) {
     if (!leftPixels && !rightPixels) {
         McpLog("No pixel data for GL screenshot");
-        g_screenshotRequested = false;
+        CompleteScreenshotRequest();
         return;
     }
 
@@ -471,21 +443,160 @@ inline void CaptureScreenshotGL(const uint8_t* leftPixels, const uint8_t* rightP
         memcpy(combined.data(), rightPixels, width * height * 4);
     }
 
-    std::string outPath = GetSimulatorDataPath() + "\\screenshot.bmp";
-    SavePixelsToBMP(combined.data(), totalWidth, height, outPath.c_str());
+    SubmitScreenshot(std::move(combined), totalWidth, height, 0, false, "screenshot", g_screenshotFormat);
 
-    g_screenshotRequested = false;
+    CompleteScreenshotRequest();
+}
+
+// ---------- Telemetry block ----------
+//
+// Fixed-layout, versioned frame telemetry in a named mapping
+// (Local\\OpenXRSimulator_Telemetry), rewritten every xrEndFrame under a seqlock: the
+// writer makes seq odd, updates the fields, then makes it even again. Readers (the MCP
+// server, dashboards) copy the block and retry while seq is odd or changed during the
+// copy, so they never block the frame thread. New fields go at the end and bump version.
+
+constexpr uint32_t kTelemetryMagic   = 0x54525853;  // 'SXRT'
+constexpr uint32_t kTelemetryVersion = 2;  // 2: stereo analysis fields
+
+enum TelemetryStage : uint32_t {
+    StageWaitFrame = 0,  // time xrWaitFrame spent pacing
+    StageAppFrame,       // xrWaitFrame return -> xrEndFrame entry (app CPU work)
+    StageEndFrame,       // xrEndFrame composition + present
+    TelemetryStageSlots = 8
+};
+
+struct TelemetryBlock {
+    uint32_t magic;
+    uint32_t version;
+    uint32_t size;                // sizeof(TelemetryBlock)
+    std::atomic<uint32_t> seq;    // seqlock: odd while the runtime is writing
+    uint64_t frameIndex;
+    int64_t  qpcTimestamp;        // QueryPerformanceCounter at publish
+    int64_t  qpcFrequency;
+    uint32_t sessionState;        // XrSessionState
+    uint32_t previewWidth;
+    uint32_t previewHeight;
+    uint32_t stageCount;          // valid entries in stageMs
+    float    headPos[3];          // meters
+    float    headYaw, headPitch, headRoll;  // radians
+    float    headOrientation[4];  // x, y, z, w
+    float    frameIntervalMs;     // xrEndFrame to xrEndFrame
+    float    stageMs[TelemetryStageSlots];
+    uint32_t reserved0;
+    uint64_t logRecordsDropped;
+    // Version 2: the newest stereo::Analyzer result
+    uint64_t stereoFrameIndex;    // frameIndex at which it arrived (0: none yet)
+    uint32_t stereoFlags;         // stereo::Flags
+    uint32_t stereoEyeWidth;      // analysed eye width, preview pixels
+    float    stereoDisparityPx;   // negative for a correct pair
+    float    stereoMatchRms;      // luma 0..255
+    float    stereoTextureStd;
+    float    eyeMeanLuma[2];
+    uint32_t changedTiles;        // against the previous analysis
+    uint32_t tileCount;
+    uint32_t unchangedRun;        // consecutive analyses with no change
+};
+static_assert(offsetof(TelemetryBlock, frameIndex) == 16 && offsetof(TelemetryBlock, stageMs) == 100 &&
+              offsetof(TelemetryBlock, logRecordsDropped) == 136 && offsetof(TelemetryBlock, stereoFrameIndex) == 144 &&
+              offsetof(TelemetryBlock, unchangedRun) == 188 &&
+              sizeof(TelemetryBlock) == 192, "TelemetryBlock layout is shared with the MCP server");
+
+struct TelemetrySample {
+    uint64_t frameIndex = 0;
+    uint32_t sessionState = 0;
+    uint32_t previewWidth = 0, previewHeight = 0;
+    float headPos[3] = {0, 1.7f, 0};
+    float headYaw = 0, headPitch = 0, headRoll = 0;
+    float headOrientation[4] = {0, 0, 0, 1};
+    float frameIntervalMs = 0;
+    float stageMs[TelemetryStageSlots] = {};
+};
+
+inline TelemetryBlock* g_telemetry = nullptr;
+
+inline TelemetryBlock* OpenTelemetryBlock() {
+    static bool attempted = false;
+    if (attempted) return g_telemetry;
+    attempted = true;
+    HANDLE mapping = CreateFileMappingA(INVALID_HANDLE_VALUE, nullptr, PAGE_READWRITE, 0,
+                                        (DWORD)sizeof(TelemetryBlock),
+                                        runid::ObjectName("Local\\OpenXRSimulator_Telemetry").c_str());
+    if (mapping) {
+        // The mapping handle stays open for the life of the process
+        g_telemetry = (TelemetryBlock*)MapViewOfFile(mapping, FILE_MAP_ALL_ACCESS, 0, 0, sizeof(TelemetryBlock));
+    }
+    if (!g_telemetry) {
+        McpLogf("Telemetry block unavailable (error=%lu)", GetLastError());
+        return nullptr;
+    }
+    LARGE_INTEGER freq;
+    QueryPerformanceFrequency(&freq);
+    g_telemetry->seq.store(g_telemetry->seq.load(std::memory_order_relaxed) & ~1u, std::memory_order_relaxed);
+    g_telemetry->version = kTelemetryVersion;
+    g_telemetry->size = (uint32_t)sizeof(TelemetryBlock);
+    g_telemetry->qpcFrequency = freq.QuadPart;
+    g_telemetry->stageCount = StageEndFrame + 1;
+    g_telemetry->magic = kTelemetryMagic;
+    McpLog("Telemetry block created");
+    return g_telemetry;
 }
 
-// Write frame status JSON for MCP
+// Publish one frame's telemetry (xrEndFrame): plain stores between two seq updates,
+// no syscalls beyond the QPC read.
+inline void PublishTelemetry(const TelemetrySample& in) {
+    TelemetryBlock* t = OpenTelemetryBlock();
+    if (!t) return;
+    LARGE_INTEGER now;
+    QueryPerformanceCounter(&now);
+
+    const uint32_t seq = t->seq.load(std::memory_order_relaxed);
+    t->seq.store(seq + 1, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_release);
+
+    t->frameIndex = in.frameIndex;
+    t->qpcTimestamp = now.QuadPart;
+    t->sessionState = in.sessionState;
+    t->previewWidth = in.previewWidth;
+    t->previewHeight = in.previewHeight;
+    memcpy(t->headPos, in.headPos, sizeof(t->headPos));
+    t->headYaw = in.headYaw;
+    t->headPitch = in.headPitch;
+    t->headRoll = in.headRoll;
+    memcpy(t->headOrientation, in.headOrientation, sizeof(t->headOrientation));
+    t->frameIntervalMs = in.frameIntervalMs;
+    memcpy(t->stageMs, in.stageMs, sizeof(t->stageMs));
+    t->logRecordsDropped = logging::DroppedCount();
+    static uint64_t stereoAnalyses = 0;
+    const stereo::Result sr = stereo::Analyzer::Get().Latest();
+    if (sr.analyses != stereoAnalyses) {
+        stereoAnalyses = sr.analyses;
+        t->stereoFrameIndex = in.frameIndex;
+        t->stereoFlags = sr.flags;
+        t->stereoEyeWidth = sr.eyeWidth;
+        t->stereoDisparityPx = sr.disparityPx;
+        t->stereoMatchRms = sr.matchRms;
+        t->stereoTextureStd = sr.textureStd;
+        memcpy(t->eyeMeanLuma, sr.meanLuma, sizeof(t->eyeMeanLuma));
+        t->changedTiles = sr.changedTiles;
+        t->tileCount = sr.tileCount;
+        t->unchangedRun = sr.unchangedRun;
+    }
+
+    t->seq.store(seq + 2, std::memory_order_release);
+}
+
+// Write frame status JSON for MCP (legacy; the telemetry block is the per-frame source)
 inline void WriteFrameStatus(uint32_t frameCount, uint32_t width, uint32_t height,
                               const char* format, const char* sessionState,
                               float headYaw = 0, float headPitch = 0,
-                              float headX = 0, float headY = 1.7f, float headZ = 0) {
-    static uint32_t lastWrite = UINT32_MAX;
-    // Only write every 30 frames to reduce I/O (but always write the first frame)
-    if (lastWrite != UINT32_MAX && frameCount - lastWrite < 30) return;
-    lastWrite = frameCount;
+                              float headX = 0, float headY = 1.7f, float headZ = 0,
+                              float targetFps = 90.0f, float frameTimeMs = 11.1f) {
+    static ULONGLONG lastWriteMs = 0;
+    // Once per second (and on the first frame) for tools that still read the file
+    ULONGLONG nowMs = GetTickCount64();
+    if (lastWriteMs != 0 && nowMs - lastWriteMs < 1000) return;
+    lastWriteMs = nowMs;
 
     std::string path = GetSimulatorDataPath() + "\\runtime_status.json";
     FILE* file = nullptr;
@@ -503,8 +614,17 @@ inline void WriteFrameStatus(uint32_t frameCount, uint32_t width, uint32_t heigh
     fprintf(file, "  \"preview_height\": %u,\n", height);
     fprintf(file, "  \"format\": \"%s\",\n", format ? format : "unknown");
     fprintf(file, "  \"session_state\": \"%s\",\n", sessionState ? sessionState : "unknown");
-    fprintf(file, "  \"target_fps\": 90,\n");
-    fprintf(file, "  \"frame_time_ms\": 11.1,\n");
+    fprintf(file, "  \"target_fps\": %.1f,\n", targetFps);
+    fprintf(file, "  \"frame_time_ms\": %.2f,\n", frameTimeMs);
+    fprintf(file, "  \"log_records_dropped\": %llu,\n", (unsigned long long)logging::DroppedCount());
+    timing::WriteJson(file, "  ");
+    fprintf(file, ",\n");
+    recording::Recorder::Get().WriteJson(file, "  ");
+    fprintf(file, ",\n");
+    posehistory::g_error.WriteJson(file, "  ");
+    fprintf(file, ",\n");
+    stress::WriteJson(file, "  ");
+    fprintf(file, ",\n");
     fprintf(file, "  \"head_tracking\": {\n");
     fprintf(file, "    \"position\": {\"x\": %.3f, \"y\": %.3f, \"z\": %.3f},\n", headX, headY, headZ);
     fprintf(file, "    \"yaw\": %.3f,\n", headYaw);
@@ -568,13 +688,8 @@ inline bool JsonHasKey(const char* json, const char* key) {
 // "roll" is optional — omit to keep the simulator's current roll value.
 inline HeadPoseCommand CheckHeadPoseCommand() {
     HeadPoseCommand cmd;
-    std::string cmdPath = GetSimulatorDataPath() + "\\head_pose_command.json";
-    FILE* f = nullptr;
-    if (fopen_s(&f, cmdPath.c_str(), "r") == 0 && f) {
-        char buf[512];
-        size_t n = fread(buf, 1, sizeof(buf)-1, f);
-        buf[n] = 0;
-        fclose(f);
+    char buf[512];
+    if (TakeCommand(CmdHeadPose, "head_pose_command.json", buf, sizeof(buf))) {
 
         cmd.valid = true;
         cmd.x = ParseJsonFloat(buf, "x", 0.0f);
@@ -584,9 +699,6 @@ inline HeadPoseCommand CheckHeadPoseCommand() {
         cmd.pitch = ParseJsonFloat(buf, "pitch", 0.0f);
         cmd.hasRoll = JsonHasKey(buf, "roll");
         if (cmd.hasRoll) cmd.roll = ParseJsonFloat(buf, "roll", 0.0f);
-
-        // Delete the file after reading (one-shot command)
-        DeleteFileA(cmdPath.c_str());
         McpLogf("Head pose command: pos(%.2f, %.2f, %.2f) yaw=%.2f pitch=%.2f roll=%.2f",
                 cmd.x, cmd.y, cmd.z, cmd.yaw, cmd.pitch,
                 cmd.hasRoll ? cmd.roll : NAN);
@@ -617,14 +729,8 @@ struct FovCommand {
 // Or for clear: {"clear": true}
 inline FovCommand CheckFovCommand() {
     FovCommand cmd;
-    std::string p = GetSimulatorDataPath() + "\\fov_command.json";
-    FILE* f = nullptr;
-    if (fopen_s(&f, p.c_str(), "r") != 0 || !f) return cmd;
     char buf[1024];
-    size_t n = fread(buf, 1, sizeof(buf) - 1, f);
-    buf[n] = 0;
-    fclose(f);
-    DeleteFileA(p.c_str());
+    if (!TakeCommand(CmdFov, "fov_command.json", buf, sizeof(buf))) return cmd;
     cmd.valid = true;
     if (JsonHasKey(buf, "clear")) {
         cmd.clear = true;
@@ -661,14 +767,8 @@ struct IpdCommand {
 // File format: {"ipd_mm": 64} or {"clear": true}
 inline IpdCommand CheckIpdCommand() {
     IpdCommand cmd;
-    std::string p = GetSimulatorDataPath() + "\\ipd_command.json";
-    FILE* f = nullptr;
-    if (fopen_s(&f, p.c_str(), "r") != 0 || !f) return cmd;
     char buf[256];
-    size_t n = fread(buf, 1, sizeof(buf) - 1, f);
-    buf[n] = 0;
-    fclose(f);
-    DeleteFileA(p.c_str());
+    if (!TakeCommand(CmdIpd, "ipd_command.json", buf, sizeof(buf))) return cmd;
     cmd.valid = true;
     if (JsonHasKey(buf, "clear")) {
         cmd.clear = true;
@@ -690,14 +790,8 @@ struct HeadsetProfileCommand {
 
 inline HeadsetProfileCommand CheckHeadsetProfileCommand() {
     HeadsetProfileCommand cmd;
-    std::string p = GetSimulatorDataPath() + "\\headset_profile_command.json";
-    FILE* f = nullptr;
-    if (fopen_s(&f, p.c_str(), "r") != 0 || !f) return cmd;
     char buf[256];
-    size_t n = fread(buf, 1, sizeof(buf) - 1, f);
-    buf[n] = 0;
-    fclose(f);
-    DeleteFileA(p.c_str());
+    if (!TakeCommand(CmdHeadsetProfile, "headset_profile_command.json", buf, sizeof(buf))) return cmd;
     // Find "name":"value"
     const char* k = strstr(buf, "\"name\"");
     if (!k) return cmd;
@@ -728,14 +822,8 @@ struct PoseSweepCommand {
 
 inline PoseSweepCommand CheckPoseSweepCommand() {
     PoseSweepCommand cmd;
-    std::string p = GetSimulatorDataPath() + "\\pose_sweep_command.json";
-    FILE* f = nullptr;
-    if (fopen_s(&f, p.c_str(), "r") != 0 || !f) return cmd;
     char buf[256];
-    size_t n = fread(buf, 1, sizeof(buf) - 1, f);
-    buf[n] = 0;
-    fclose(f);
-    DeleteFileA(p.c_str());
+    if (!TakeCommand(CmdPoseSweep, "pose_sweep_command.json", buf, sizeof(buf))) return cmd;
     cmd.valid = true;
     cmd.enabled       = strstr(buf, "\"enabled\"") && strstr(buf, "true");
     cmd.yawAmpDeg     = ParseJsonFloat(buf, "yaw_amp_deg",   30.0f);
@@ -747,6 +835,99 @@ inline PoseSweepCommand CheckPoseSweepCommand() {
     return cmd;
 }
 
+struct RecordCommand {
+    bool valid = false;
+    bool start = false;
+    recording::Options options;  // the environment's defaults unless the request names them
+};
+
+// File format: {"action": "start", "source": "eyes", "codec": "hevc", "bitrate_mbps": 40}
+// or {"action": "stop"}
+inline RecordCommand CheckRecordCommand() {
+    RecordCommand cmd;
+    char buf[256];
+    if (!TakeCommand(CmdRecord, "record_command.json", buf, sizeof(buf))) return cmd;
+    cmd.valid = true;
+    const char* actionPos = strstr(buf, "\"action\"");
+    cmd.start = !(actionPos && strstr(actionPos, "\"stop\""));
+    cmd.options = recording::g_defaults;
+    const char* sourcePos = strstr(buf, "\"source\"");
+    if (sourcePos) {
+        if (strstr(sourcePos, "\"eyes\"")) cmd.options.source = recording::Source::Eyes;
+        else if (strstr(sourcePos, "\"preview\"")) cmd.options.source = recording::Source::Preview;
+    }
+    const char* codecPos = strstr(buf, "\"codec\"");
+    if (codecPos) {
+        if (strstr(codecPos, "\"hevc\"")) cmd.options.codec = recording::Codec::Hevc;
+        else if (strstr(codecPos, "\"h264\"")) cmd.options.codec = recording::Codec::H264;
+    }
+    const float mbps = ParseJsonFloat(buf, "bitrate_mbps", (float)cmd.options.bitrateMbps);
+    if (mbps >= 1.0f && mbps <= 500.0f) cmd.options.bitrateMbps = (uint32_t)mbps;
+    McpLogf("Record command: %s source=%s codec=%s bitrate=%u", cmd.start ? "start" : "stop",
+            recording::SourceName(cmd.options.source), recording::CodecName(cmd.options.codec),
+            cmd.options.bitrateMbps);
+    return cmd;
+}
+
+struct GLValidationCommand {
+    bool valid = false;
+    uint32_t checks = 0;  // glvalidation::Check bits
+};
+
+// File format: {"checks": "release,pixels"} ("all", "off" or a list of check names)
+inline GLValidationCommand CheckGLValidationCommand() {
+    GLValidationCommand cmd;
+    char buf[256];
+    if (!TakeCommand(CmdGLValidation, "gl_validation_command.json", buf, sizeof(buf))) return cmd;
+    cmd.valid = true;
+    char checks[128] = {0};
+    const char* pos = strstr(buf, "\"checks\"");
+    if (pos && (pos = strchr(pos + 8, ':')) && (pos = strchr(pos, '"'))) {
+        const char* end = strchr(++pos, '"');
+        if (end) {
+            size_t len = (size_t)(end - pos);
+            if (len >= sizeof(checks)) len = sizeof(checks) - 1;
+            memcpy(checks, pos, len);
+        }
+    }
+    cmd.checks = glvalidation::ParseChecks(checks);
+    char desc[64];
+    McpLogf("GL validation command: checks=%s", glvalidation::Describe(cmd.checks, desc, sizeof(desc)));
+    return cmd;
+}
+
+struct StressCommand {
+    bool valid = false;
+    stress::Config config;
+};
+
+// File format: {"enabled": true, "miss_every": 30, "miss_vsyncs": 1, "miss_chance": 0.0,
+// "jitter_ms": 1.5, "skip_render_every": 0, "cpu_load_ms": 0, "gpu_load_ms": 4, "seed": 1,
+// "frames": 0}. Omitted fields are off; {"enabled": false} stops stress.
+inline StressCommand CheckStressCommand() {
+    StressCommand cmd;
+    char buf[512];
+    if (!TakeCommand(CmdStress, "stress_command.json", buf, sizeof(buf))) return cmd;
+    cmd.valid = true;
+    auto count = [&](const char* key, float defaultVal) {
+        const float v = ParseJsonFloat(buf, key, defaultVal);
+        return v > 0.0f ? (uint32_t)v : 0u;
+    };
+    stress::Config& c = cmd.config;
+    c.enabled = strstr(buf, "\"enabled\"") && strstr(buf, "true");
+    c.missEvery = count("miss_every", 0.0f);
+    c.missVsyncs = count("miss_vsyncs", 1.0f);
+    c.missChance = ParseJsonFloat(buf, "miss_chance", 0.0f);
+    c.jitterMs = ParseJsonFloat(buf, "jitter_ms", 0.0f);
+    c.skipRenderEvery = count("skip_render_every", 0.0f);
+    c.cpuLoadMs = ParseJsonFloat(buf, "cpu_load_ms", 0.0f);
+    c.gpuLoadMs = ParseJsonFloat(buf, "gpu_load_ms", 0.0f);
+    c.seed = count("seed", 1.0f);
+    c.frames = count("frames", 0.0f);
+    McpLogf("Stress command: enabled=%d", c.enabled ? 1 : 0);
+    return cmd;
+}
+
 struct AnaglyphCommand {
     bool valid = false;
     bool enabled = false;
@@ -755,14 +936,8 @@ struct AnaglyphCommand {
 // File format: {"enabled": true} or {"enabled": false}
 inline AnaglyphCommand CheckAnaglyphCommand() {
     AnaglyphCommand cmd;
-    std::string p = GetSimulatorDataPath() + "\\anaglyph_command.json";
-    FILE* f = nullptr;
-    if (fopen_s(&f, p.c_str(), "r") != 0 || !f) return cmd;
     char buf[256];
-    size_t n = fread(buf, 1, sizeof(buf) - 1, f);
-    buf[n] = 0;
-    fclose(f);
-    DeleteFileA(p.c_str());
+    if (!TakeCommand(CmdAnaglyph, "anaglyph_command.json", buf, sizeof(buf))) return cmd;
     cmd.valid = true;
     // ParseJsonFloat returns 0.0f for false-ish, !=0 for true.
     cmd.enabled = strstr(buf, "\"enabled\"") && strstr(buf, "true");
@@ -822,12 +997,10 @@ inline void DumpProjectionLog() {
     fclose(f);
 }
 
-// MCP polls a ".dump_request" file to ask us to write the log.
+// MCP sends a dump command (or touches a ".dump_request" file) to ask us to write the log.
 inline bool CheckProjLogDumpRequest() {
-    std::string p = GetSimulatorDataPath() + "\\projection_log_dump_request";
-    if (GetFileAttributesA(p.c_str()) == INVALID_FILE_ATTRIBUTES) return false;
-    DeleteFileA(p.c_str());
-    return true;
+    char buf[64];
+    return TakeCommand(CmdProjLogDump, "projection_log_dump_request", buf, sizeof(buf));
 }
 
 // Controller pose control structure for MCP
@@ -849,13 +1022,8 @@ struct ControllerPoseCommand {
 // File format: {"hand": 1, "posX": 0.2, "posY": -0.3, "posZ": -0.4, "yaw": 0, "pitch": -0.3, "trigger": 0.0}
 inline ControllerPoseCommand CheckControllerPoseCommand() {
     ControllerPoseCommand cmd;
-    std::string cmdPath = GetSimulatorDataPath() + "\\controller_pose_command.json";
-    FILE* f = nullptr;
-    if (fopen_s(&f, cmdPath.c_str(), "r") == 0 && f) {
-        char buf[512];
-        size_t n = fread(buf, 1, sizeof(buf)-1, f);
-        buf[n] = 0;
-        fclose(f);
+    char buf[512];
+    if (TakeCommand(CmdControllerPose, "controller_pose_command.json", buf, sizeof(buf))) {
 
         cmd.valid = true;
         cmd.hand = (int)ParseJsonFloat(buf, "hand", 1.0f);
@@ -868,9 +1036,6 @@ inline ControllerPoseCommand CheckControllerPoseCommand() {
         cmd.triggerSet = (cmd.trigger >= 0.0f);
         if (!cmd.triggerSet) cmd.trigger = 0.0f;
         cmd.buttonA = (int)ParseJsonFloat(buf, "buttonA", -1.0f);
-
-        // Delete the file after reading (one-shot command)
-        DeleteFileA(cmdPath.c_str());
         McpLogf("Controller pose command: hand=%d pos(%.2f, %.2f, %.2f) yaw=%.2f pitch=%.2f trigger=%.1f",
                 cmd.hand, cmd.posX, cmd.posY, cmd.posZ, cmd.yaw, cmd.pitch, cmd.trigger);
     }
@@ -0,0 +1,200 @@
+// Time-indexed pose history for OpenXR Simulator
+// - xrWaitFrame pushes one sample per frame: the head and controller poses the simulator holds
+//   for that frame's predictedDisplayTime
+// - xrLocateViews / xrLocateSpace read the pose at the requested time: interpolated between
+//   the two samples around it, or extrapolated from the newest two (at most 50 ms ahead)
+// - A synthetic motion-to-photon latency shifts every lookup that far into the past, so the
+//   app renders with a pose older than the one "displayed"
+// - Each submitted projection layer's pose is compared with the history at the layer's
+//   displayTime, giving the angular/positional error the app's prediction left on screen
+// - Single writer (the frame thread), any number of readers: each slot is a seqlock, so a
+//   reader never blocks and retries a slot the writer is overwriting
+//
+// Environment:
+//   OPENXR_SIM_POSE_LATENCY_MS  synthetic latency in milliseconds (default 0, at most 500)
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+#include <cstdio>
+#include <cstdint>
+
+namespace posehistory {
+
+struct Pose {
+    float position[3] = {0, 0, 0};
+    float orientation[4] = {0, 0, 0, 1};  // x, y, z, w
+};
+
+struct Sample {
+    int64_t time = 0;  // XrTime
+    Pose head;
+    Pose controllers[2];  // left, right
+    float linearVelocity[2][3] = {};
+    float angularVelocity[2][3] = {};
+    bool tracked[2] = {false, false};
+};
+
+inline std::atomic<int64_t> g_latencyNs{0};
+
+inline Pose Interpolate(const Pose& a, const Pose& b, float u) {
+    Pose p;
+    for (int i = 0; i < 3; ++i) p.position[i] = a.position[i] + (b.position[i] - a.position[i]) * u;
+    // nlerp along the shorter arc; u > 1 extrapolates, which is fine for the small per-frame steps
+    float dot = 0.0f;
+    for (int i = 0; i < 4; ++i) dot += a.orientation[i] * b.orientation[i];
+    const float sign = dot < 0.0f ? -1.0f : 1.0f;
+    float len = 0.0f;
+    for (int i = 0; i < 4; ++i) {
+        p.orientation[i] = a.orientation[i] + (sign * b.orientation[i] - a.orientation[i]) * u;
+        len += p.orientation[i] * p.orientation[i];
+    }
+    len = sqrtf(len);
+    if (len > 1e-6f) {
+        for (float& c : p.orientation) c /= len;
+    } else {
+        p = b;
+    }
+    return p;
+}
+
+inline Sample Interpolate(const Sample& a, const Sample& b, float u, int64_t time) {
+    Sample s;
+    s.time = time;
+    s.head = Interpolate(a.head, b.head, u);
+    for (int c = 0; c < 2; ++c) {
+        s.controllers[c] = Interpolate(a.controllers[c], b.controllers[c], u);
+        for (int i = 0; i < 3; ++i) {
+            s.linearVelocity[c][i] = a.linearVelocity[c][i] + (b.linearVelocity[c][i] - a.linearVelocity[c][i]) * u;
+            s.angularVelocity[c][i] = a.angularVelocity[c][i] + (b.angularVelocity[c][i] - a.angularVelocity[c][i]) * u;
+        }
+        s.tracked[c] = u < 0.5f ? a.tracked[c] : b.tracked[c];
+    }
+    return s;
+}
+
+class History {
+public:
+    static constexpr uint32_t kCapacity = 256;                  // ~2.8 s at 90 Hz
+    static constexpr int64_t kMaxExtrapolationNs = 50000000;   // 50 ms
+
+    static History& Get() {
+        static History instance;
+        return instance;
+    }
+
+    // Frame thread only
+    void Push(const Sample& sample) {
+        const uint64_t index = m_count.load(std::memory_order_relaxed);
+        Slot& slot = m_slots[index % kCapacity];
+        const uint32_t seq = slot.seq.load(std::memory_order_relaxed);
+        slot.seq.store(seq + 1, std::memory_order_relaxed);  // odd: being written
+        std::atomic_thread_fence(std::memory_order_release);
+        slot.sample = sample;
+        slot.seq.store(seq + 2, std::memory_order_release);
+        m_count.store(index + 1, std::memory_order_release);
+    }
+
+    void Clear() { m_count.store(0, std::memory_order_release); }
+
+    bool Empty() const { return m_count.load(std::memory_order_acquire) == 0; }
+
+    // The state at time: interpolated, extrapolated from the newest samples, or the oldest one
+    // still held. False only when nothing has been recorded yet.
+    bool At(int64_t time, Sample& out) const {
+        const uint64_t count = m_count.load(std::memory_order_acquire);
+        if (count == 0) return false;
+        Sample newer;
+        if (!Read(count - 1, newer)) return false;
+        if (time >= newer.time) {
+            Sample older;
+            if (count < 2 || !Read(count - 2, older) || newer.time <= older.time || time == newer.time) {
+                out = newer;
+                return true;
+            }
+            const int64_t ahead = std::min<int64_t>(time - newer.time, kMaxExtrapolationNs);
+            const float u = 1.0f + (float)((double)ahead / (double)(newer.time - older.time));
+            out = Interpolate(older, newer, u, time);
+            return true;
+        }
+        // Walk back, keeping a margin from the slots the writer reuses next
+        const uint64_t oldest = count > kCapacity - 8 ? count - (kCapacity - 8) : 0;
+        for (uint64_t i = count - 1; i-- > oldest;) {
+            Sample older;
+            if (!Read(i, older)) break;
+            if (older.time <= time) {
+                const int64_t span = newer.time - older.time;
+                const float u = span > 0 ? (float)((double)(time - older.time) / (double)span) : 1.0f;
+                out = Interpolate(older, newer, u, time);
+                return true;
+            }
+            newer = older;
+        }
+        out = newer;  // older than the history: the oldest sample read
+        return true;
+    }
+
+private:
+    struct Slot {
+        std::atomic<uint32_t> seq{0};
+        Sample sample;
+    };
+
+    bool Read(uint64_t index, Sample& out) const {
+        const Slot& slot = m_slots[index % kCapacity];
+        for (int attempt = 0; attempt < 4; ++attempt) {
+            const uint32_t before = slot.seq.load(std::memory_order_acquire);
+            if (before & 1) continue;
+            out = slot.sample;
+            std::atomic_thread_fence(std::memory_order_acquire);
+            if (slot.seq.load(std::memory_order_relaxed) == before) return true;
+        }
+        return false;
+    }
+
+    Slot m_slots[kCapacity];
+    std::atomic<uint64_t> m_count{0};
+};
+
+// Error between the pose a layer was rendered with and the pose at its display time.
+// Frame thread only (xrEndFrame adds, the status writer reads).
+struct ErrorStats {
+    uint64_t frames = 0;
+    float lastDeg = 0, meanDeg = 0, maxDeg = 0;
+    float lastMm = 0, meanMm = 0, maxMm = 0;
+
+    void Add(const Pose& submitted, const Pose& actual) {
+        float dot = 0.0f;
+        for (int i = 0; i < 4; ++i) dot += submitted.orientation[i] * actual.orientation[i];
+        dot = std::min(fabsf(dot), 1.0f);
+        const float deg = 2.0f * acosf(dot) * 57.2957795f;
+        float d2 = 0.0f;
+        for (int i = 0; i < 3; ++i) {
+            const float d = submitted.position[i] - actual.position[i];
+            d2 += d * d;
+        }
+        const float mm = sqrtf(d2) * 1000.0f;
+        ++frames;
+        // Running mean over roughly the last 100 frames
+        const float alpha = frames < 100 ? 1.0f / (float)frames : 0.01f;
+        lastDeg = deg;
+        lastMm = mm;
+        meanDeg += (deg - meanDeg) * alpha;
+        meanMm += (mm - meanMm) * alpha;
+        maxDeg = std::max(maxDeg, deg);
+        maxMm = std::max(maxMm, mm);
+    }
+
+    void WriteJson(FILE* f, const char* indent) const {
+        fprintf(f, "%s\"pose_error\": {\"frames\": %llu, \"latency_ms\": %.2f, "
+                "\"last_deg\": %.4f, \"mean_deg\": %.4f, \"max_deg\": %.4f, "
+                "\"last_mm\": %.3f, \"mean_mm\": %.3f, \"max_mm\": %.3f}",
+                indent, (unsigned long long)frames, (double)g_latencyNs.load(std::memory_order_relaxed) * 1e-6,
+                lastDeg, meanDeg, maxDeg, lastMm, meanMm, maxMm);
+    }
+};
+
+inline ErrorStats g_error;
+
+} // namespace posehistory
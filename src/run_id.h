@@ -0,0 +1,61 @@
+// Per-run namespacing for OpenXR Simulator
+// - By default every process shares %LOCALAPPDATA%\OpenXR-Simulator, one log file and the
+//   Local\OpenXRSimulator_* shared-memory channels, so only one app can be driven at a time
+// - With a run ID, the data directory (log, status, command and capture files) becomes
+//   %LOCALAPPDATA%\OpenXR-Simulator\runs\<id> and the shared-memory names gain a _<id> suffix,
+//   so several simulated apps can run side by side, each with its own MCP server
+//
+// Environment:
+//   OPENXR_SIM_RUN_ID  unset (shared, default) | pid (the process ID) | any [A-Za-z0-9_-] name
+//                      up to 32 characters (other characters are dropped)
+#pragma once
+
+#include <windows.h>
+#include <string>
+#include <cstdio>
+
+namespace runid {
+
+// Resolved once per process; "" when no run ID is configured
+inline const std::string& Id() {
+    static const std::string id = [] {
+        char value[64] = {};
+        std::string result;
+        if (GetEnvironmentVariableA("OPENXR_SIM_RUN_ID", value, (DWORD)sizeof(value)) == 0) return result;
+        if (_stricmp(value, "pid") == 0) return std::to_string(GetCurrentProcessId());
+        for (const char* p = value; *p && result.size() < 32; ++p) {
+            const char c = *p;
+            if ((c >= 'A' && c <= 'Z') || (c >= 'a' && c <= 'z') || (c >= '0' && c <= '9') || c == '_' || c == '-') {
+                result += c;
+            }
+        }
+        return result;
+    }();
+    return id;
+}
+
+// The data directory, created on first use. "." when LOCALAPPDATA is unavailable.
+inline const std::string& DataDirectory() {
+    static const std::string dir = [] {
+        char base[MAX_PATH]{};
+        DWORD len = GetEnvironmentVariableA("LOCALAPPDATA", base, (DWORD)sizeof(base));
+        if (len == 0 || len >= sizeof(base)) return std::string(".");
+        std::string path = std::string(base) + "\\OpenXR-Simulator";
+        CreateDirectoryA(path.c_str(), nullptr);
+        if (!Id().empty()) {
+            path += "\\runs";
+            CreateDirectoryA(path.c_str(), nullptr);
+            path += "\\" + Id();
+            CreateDirectoryA(path.c_str(), nullptr);
+        }
+        return path;
+    }();
+    return dir;
+}
+
+// Named kernel object for this run: "Local\\OpenXRSimulator_Commands" -> "..._Commands_<id>"
+inline std::string ObjectName(const char* base) {
+    return Id().empty() ? std::string(base) : std::string(base) + "_" + Id();
+}
+
+} // namespace runid
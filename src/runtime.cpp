@@ -1,19 +1,20 @@
-// Minimal OpenXR Simulator Runtime (D3D11/D3D12/OpenGL)
+// Minimal OpenXR Simulator Runtime (D3D11/D3D12/OpenGL/Vulkan)
 // - Implements enough of the runtime interface to let OpenXR apps start and render into runtime-owned swapchains
 // - Opens a desktop window and presents the app's submitted images side-by-side
-// - Supports D3D11, D3D12, and OpenGL graphics APIs
+// - Supports D3D11, D3D12, and OpenGL graphics APIs, and Vulkan when built with the Vulkan headers
 
 #define XR_USE_PLATFORM_WIN32
 #define XR_USE_GRAPHICS_API_D3D11
 #define XR_USE_GRAPHICS_API_D3D12
 #define XR_USE_GRAPHICS_API_OPENGL
+// XR_USE_GRAPHICS_API_VULKAN comes from CMake when the Vulkan headers are found
 
 #include <windows.h>
 #include <wrl/client.h>
 #include <d3d11.h>
+#include <d3d11_1.h>
 #include <d3d12.h>
 #include <d3d11on12.h>
-#include <d3dcompiler.h>
 #include <dxgi.h>
 #include <dxgi1_6.h>
 
@@ -67,6 +68,36 @@
 #ifndef GL_FRAMEBUFFER_COMPLETE
 #define GL_FRAMEBUFFER_COMPLETE           0x8CD5
 #endif
+#ifndef GL_READ_FRAMEBUFFER
+#define GL_READ_FRAMEBUFFER               0x8CA8
+#endif
+#ifndef GL_READ_FRAMEBUFFER_BINDING
+#define GL_READ_FRAMEBUFFER_BINDING       0x8CAA
+#endif
+#ifndef GL_PIXEL_PACK_BUFFER
+#define GL_PIXEL_PACK_BUFFER              0x88EB
+#endif
+#ifndef GL_PIXEL_PACK_BUFFER_BINDING
+#define GL_PIXEL_PACK_BUFFER_BINDING      0x88ED
+#endif
+#ifndef GL_STREAM_READ
+#define GL_STREAM_READ                    0x88E1
+#endif
+#ifndef GL_MAP_READ_BIT
+#define GL_MAP_READ_BIT                   0x0001
+#endif
+#ifndef GL_SYNC_GPU_COMMANDS_COMPLETE
+#define GL_SYNC_GPU_COMMANDS_COMPLETE     0x9117
+#endif
+#ifndef GL_ALREADY_SIGNALED
+#define GL_ALREADY_SIGNALED               0x911A
+#endif
+#ifndef GL_CONDITION_SATISFIED
+#define GL_CONDITION_SATISFIED            0x911C
+#endif
+#ifndef WGL_ACCESS_READ_WRITE_NV
+#define WGL_ACCESS_READ_WRITE_NV          0x0001
+#endif
 
 // Function pointer types for GL extension functions
 typedef void (APIENTRY *PFNGLTEXIMAGE3DPROC)(GLenum target, GLint level, GLint internalformat, GLsizei width, GLsizei height, GLsizei depth, GLint border, GLenum format, GLenum type, const void* pixels);
@@ -76,6 +107,28 @@ typedef void (APIENTRY *PFNGLBINDFRAMEBUFFERPROC)(GLenum target, GLuint framebuf
 typedef void (APIENTRY *PFNGLFRAMEBUFFERTEXTURE2DPROC)(GLenum target, GLenum attachment, GLenum textarget, GLuint texture, GLint level);
 typedef GLenum (APIENTRY *PFNGLCHECKFRAMEBUFFERSTATUSPROC)(GLenum target);
 typedef void (APIENTRY *PFNGLREADPIXELSPROC)(GLint x, GLint y, GLsizei width, GLsizei height, GLenum format, GLenum type, void* pixels);
+typedef void (APIENTRY *PFNGLFRAMEBUFFERTEXTURELAYERPROC)(GLenum target, GLenum attachment, GLuint texture, GLint level, GLint layer);
+
+// Pixel buffer objects + sync objects (GL 3.2) for the asynchronous readback ring
+typedef struct __GLsync* GLsync;
+typedef void (APIENTRY *PFNGLGENBUFFERSPROC)(GLsizei n, GLuint* buffers);
+typedef void (APIENTRY *PFNGLDELETEBUFFERSPROC)(GLsizei n, const GLuint* buffers);
+typedef void (APIENTRY *PFNGLBINDBUFFERPROC)(GLenum target, GLuint buffer);
+typedef void (APIENTRY *PFNGLBUFFERDATAPROC)(GLenum target, ptrdiff_t size, const void* data, GLenum usage);
+typedef void* (APIENTRY *PFNGLMAPBUFFERRANGEPROC)(GLenum target, ptrdiff_t offset, ptrdiff_t length, GLbitfield access);
+typedef GLboolean (APIENTRY *PFNGLUNMAPBUFFERPROC)(GLenum target);
+typedef GLsync (APIENTRY *PFNGLFENCESYNCPROC)(GLenum condition, GLbitfield flags);
+typedef GLenum (APIENTRY *PFNGLCLIENTWAITSYNCPROC)(GLsync sync, GLbitfield flags, unsigned long long timeout);
+typedef void (APIENTRY *PFNGLDELETESYNCPROC)(GLsync sync);
+
+// WGL_ARB_extensions_string / WGL_NV_DX_interop2
+typedef const char* (WINAPI *PFNWGLGETEXTENSIONSSTRINGARBPROC)(HDC hdc);
+typedef HANDLE (WINAPI *PFNWGLDXOPENDEVICENVPROC)(void* dxDevice);
+typedef BOOL (WINAPI *PFNWGLDXCLOSEDEVICENVPROC)(HANDLE hDevice);
+typedef HANDLE (WINAPI *PFNWGLDXREGISTEROBJECTNVPROC)(HANDLE hDevice, void* dxObject, GLuint name, GLenum type, GLenum access);
+typedef BOOL (WINAPI *PFNWGLDXUNREGISTEROBJECTNVPROC)(HANDLE hDevice, HANDLE hObject);
+typedef BOOL (WINAPI *PFNWGLDXLOCKOBJECTSNVPROC)(HANDLE hDevice, GLint count, HANDLE* hObjects);
+typedef BOOL (WINAPI *PFNWGLDXUNLOCKOBJECTSNVPROC)(HANDLE hDevice, GLint count, HANDLE* hObjects);
 
 // GL function pointers (loaded at runtime)
 static PFNGLTEXIMAGE3DPROC g_glTexImage3D = nullptr;
@@ -84,6 +137,22 @@ static PFNGLDELETEFRAMEBUFFERSPROC g_glDeleteFramebuffers = nullptr;
 static PFNGLBINDFRAMEBUFFERPROC g_glBindFramebuffer = nullptr;
 static PFNGLFRAMEBUFFERTEXTURE2DPROC g_glFramebufferTexture2D = nullptr;
 static PFNGLCHECKFRAMEBUFFERSTATUSPROC g_glCheckFramebufferStatus = nullptr;
+static PFNGLFRAMEBUFFERTEXTURELAYERPROC g_glFramebufferTextureLayer = nullptr;
+static PFNGLGENBUFFERSPROC g_glGenBuffers = nullptr;
+static PFNGLDELETEBUFFERSPROC g_glDeleteBuffers = nullptr;
+static PFNGLBINDBUFFERPROC g_glBindBuffer = nullptr;
+static PFNGLBUFFERDATAPROC g_glBufferData = nullptr;
+static PFNGLMAPBUFFERRANGEPROC g_glMapBufferRange = nullptr;
+static PFNGLUNMAPBUFFERPROC g_glUnmapBuffer = nullptr;
+static PFNGLFENCESYNCPROC g_glFenceSync = nullptr;
+static PFNGLCLIENTWAITSYNCPROC g_glClientWaitSync = nullptr;
+static PFNGLDELETESYNCPROC g_glDeleteSync = nullptr;
+static PFNWGLDXOPENDEVICENVPROC g_wglDXOpenDeviceNV = nullptr;
+static PFNWGLDXCLOSEDEVICENVPROC g_wglDXCloseDeviceNV = nullptr;
+static PFNWGLDXREGISTEROBJECTNVPROC g_wglDXRegisterObjectNV = nullptr;
+static PFNWGLDXUNREGISTEROBJECTNVPROC g_wglDXUnregisterObjectNV = nullptr;
+static PFNWGLDXLOCKOBJECTSNVPROC g_wglDXLockObjectsNV = nullptr;
+static PFNWGLDXUNLOCKOBJECTSNVPROC g_wglDXUnlockObjectsNV = nullptr;
 #include <string>
 #include <vector>
 #include <unordered_map>
@@ -92,6 +161,8 @@ static PFNGLCHECKFRAMEBUFFERSTATUSPROC g_glCheckFramebufferStatus = nullptr;
 #include <cstdlib>
 #include <thread>
 #include <mutex>
+#include <condition_variable>
+#include <memory>
 #include <atomic>
 #include <deque>
 #include <algorithm>
@@ -100,17 +171,34 @@ static PFNGLCHECKFRAMEBUFFERSTATUSPROC g_glCheckFramebufferStatus = nullptr;
 #include <cstdio>
 #include <chrono>
 
+#ifdef XR_USE_GRAPHICS_API_VULKAN
+// Entry points come from the app's vkGetInstanceProcAddr; the runtime doesn't link vulkan-1
+#define VK_USE_PLATFORM_WIN32_KHR
+#define VK_NO_PROTOTYPES
+#include <vulkan/vulkan.h>
+#endif
 #include <openxr/openxr.h>
 #include <openxr/openxr_platform.h>
 #include <loader_interfaces.h>
+#include "async_log.h"
+#include "handle_table.h"
+#include "blit_shaders.h"
+#include "frame_timing.h"
+#include "frame_pacer.h"
 #include "mcp_integration.h"
 #include "ui_enhancements.h"
+#include "headless.h"
+#include "input_trace.h"
+#include "gl_validation.h"
+#include "pose_history.h"
+#include "stereo_analyzer.h"
+#include "stress.h"
+#include "vulkan_interop.h"
 
 using Microsoft::WRL::ComPtr;
 
 #pragma comment(lib, "dxgi.lib")
 #pragma comment(lib, "d3d11.lib")
-#pragma comment(lib, "d3dcompiler.lib")
 #pragma comment(lib, "d3d12.lib")
 #pragma comment(lib, "opengl32.lib")
 
@@ -120,28 +208,24 @@ inline UINT D3D12CalcSubresource(UINT MipSlice, UINT ArraySlice, UINT PlaneSlice
 }
 
 
-// Simple logging (debug output + file log)
-static FILE* g_LogFile = nullptr;
-static void EnsureLogFile() {
-    if (g_LogFile) return;
-    char base[MAX_PATH]{};
-    DWORD len = GetEnvironmentVariableA("LOCALAPPDATA", base, (DWORD)sizeof(base));
-    char path[MAX_PATH]{};
-    if (len > 0 && len < sizeof(base)) {
-        snprintf(path, sizeof(path), "%s\\OpenXR-Simulator", base);
-        CreateDirectoryA(path, nullptr);
-        snprintf(path, sizeof(path), "%s\\OpenXR-Simulator\\openxr_simulator.log", base);
-    } else {
-        snprintf(path, sizeof(path), ".\\openxr_simulator.log");
-    }
-    fopen_s(&g_LogFile, path, "a");
+// Logging (debug output + file log) goes through the async ring in async_log.h.
+// Log/Logf are CatGeneral at Info; hot paths use LogAt/LogAtf with a category and level
+// so they can be filtered with OPENXR_SIM_LOG_LEVEL / OPENXR_SIM_LOG_CATEGORIES.
+static void LogAt(uint32_t cat, logging::Level level, const char* msg) {
+    logging::Write(cat, level, msg);
+}
+static void LogAtf(uint32_t cat, logging::Level level, const char* fmt, ...) {
+    if (!logging::Enabled(cat, level)) return;
+    char buf[2048];
+    va_list ap; va_start(ap, fmt);
+    vsnprintf(buf, sizeof(buf), fmt, ap);
+    va_end(ap);
+    logging::Write(cat, level, buf);
 }
-static void Log(const char* msg) {
-    OutputDebugStringA(msg);
-    EnsureLogFile();
-    if (g_LogFile) { fputs(msg, g_LogFile); if (msg[0] && msg[strlen(msg)-1] != '\n') fputc('\n', g_LogFile); fflush(g_LogFile);} }
+static void Log(const char* msg) { LogAt(logging::CatGeneral, logging::Level::Info, msg); }
 static void Log(const std::string& msg) { Log(msg.c_str()); }
 static void Logf(const char* fmt, ...) {
+    if (!logging::Enabled(logging::CatGeneral, logging::Level::Info)) return;
     char buf[2048];
     va_list ap; va_start(ap, fmt);
     vsnprintf(buf, sizeof(buf), fmt, ap);
@@ -175,6 +259,64 @@ static bool EnsureGLFramebufferFuncs() {
     return true;
 }
 
+// PBO/sync entry points for the asynchronous GL readback ring. Without them (pre-3.2
+// contexts) the preview falls back to a synchronous glReadPixels into the upload texture.
+static bool EnsureGLPixelBufferFuncs() {
+    static int available = -1;  // -1 = not probed yet
+    if (available >= 0) return available == 1;
+    g_glFramebufferTextureLayer = (PFNGLFRAMEBUFFERTEXTURELAYERPROC)wglGetProcAddress("glFramebufferTextureLayer");
+    g_glGenBuffers = (PFNGLGENBUFFERSPROC)wglGetProcAddress("glGenBuffers");
+    g_glDeleteBuffers = (PFNGLDELETEBUFFERSPROC)wglGetProcAddress("glDeleteBuffers");
+    g_glBindBuffer = (PFNGLBINDBUFFERPROC)wglGetProcAddress("glBindBuffer");
+    g_glBufferData = (PFNGLBUFFERDATAPROC)wglGetProcAddress("glBufferData");
+    g_glMapBufferRange = (PFNGLMAPBUFFERRANGEPROC)wglGetProcAddress("glMapBufferRange");
+    g_glUnmapBuffer = (PFNGLUNMAPBUFFERPROC)wglGetProcAddress("glUnmapBuffer");
+    g_glFenceSync = (PFNGLFENCESYNCPROC)wglGetProcAddress("glFenceSync");
+    g_glClientWaitSync = (PFNGLCLIENTWAITSYNCPROC)wglGetProcAddress("glClientWaitSync");
+    g_glDeleteSync = (PFNGLDELETESYNCPROC)wglGetProcAddress("glDeleteSync");
+    available = (g_glFramebufferTextureLayer && g_glGenBuffers && g_glDeleteBuffers && g_glBindBuffer &&
+                 g_glBufferData && g_glMapBufferRange && g_glUnmapBuffer &&
+                 g_glFenceSync && g_glClientWaitSync && g_glDeleteSync) ? 1 : 0;
+    Log(available ? "[SimXR] GL PBO readback ring available"
+                  : "[SimXR] GL PBO/sync functions missing - using synchronous GL readback");
+    return available == 1;
+}
+
+// WGL_NV_DX_interop2 lets GL render straight into D3D11 textures, so the preview can
+// sample GL swapchain images without a CPU readback. Must be called with a GL context
+// current. Set OPENXR_SIM_GL_INTEROP=0 to force the readback path.
+static bool EnsureGLDXInterop(HDC hdc) {
+    static int available = -1;  // -1 = not probed yet
+    if (available >= 0) return available == 1;
+    available = 0;
+
+    char env[8] = {0};
+    if (GetEnvironmentVariableA("OPENXR_SIM_GL_INTEROP", env, (DWORD)sizeof(env)) > 0 && env[0] == '0') {
+        Log("[SimXR] GL interop disabled by OPENXR_SIM_GL_INTEROP=0 - using readback preview");
+        return false;
+    }
+    auto getExtensions = (PFNWGLGETEXTENSIONSSTRINGARBPROC)wglGetProcAddress("wglGetExtensionsStringARB");
+    const char* extensions = getExtensions ? getExtensions(hdc) : nullptr;
+    if (!extensions || !strstr(extensions, "WGL_NV_DX_interop2")) {
+        Log("[SimXR] WGL_NV_DX_interop2 not available - using GL readback preview");
+        return false;
+    }
+    g_wglDXOpenDeviceNV = (PFNWGLDXOPENDEVICENVPROC)wglGetProcAddress("wglDXOpenDeviceNV");
+    g_wglDXCloseDeviceNV = (PFNWGLDXCLOSEDEVICENVPROC)wglGetProcAddress("wglDXCloseDeviceNV");
+    g_wglDXRegisterObjectNV = (PFNWGLDXREGISTEROBJECTNVPROC)wglGetProcAddress("wglDXRegisterObjectNV");
+    g_wglDXUnregisterObjectNV = (PFNWGLDXUNREGISTEROBJECTNVPROC)wglGetProcAddress("wglDXUnregisterObjectNV");
+    g_wglDXLockObjectsNV = (PFNWGLDXLOCKOBJECTSNVPROC)wglGetProcAddress("wglDXLockObjectsNV");
+    g_wglDXUnlockObjectsNV = (PFNWGLDXUNLOCKOBJECTSNVPROC)wglGetProcAddress("wglDXUnlockObjectsNV");
+    if (!g_wglDXOpenDeviceNV || !g_wglDXCloseDeviceNV || !g_wglDXRegisterObjectNV ||
+        !g_wglDXUnregisterObjectNV || !g_wglDXLockObjectsNV || !g_wglDXUnlockObjectsNV) {
+        Log("[SimXR] Failed to load WGL_NV_DX_interop2 functions - using GL readback preview");
+        return false;
+    }
+    available = 1;
+    Log("[SimXR] WGL_NV_DX_interop2 available - GL swapchains will share D3D11 textures");
+    return true;
+}
+
 static XrQuaternionf QuatFromYawPitch(float yaw, float pitch) {
     const float cy = cosf(yaw * 0.5f);
     const float sy = sinf(yaw * 0.5f);
@@ -297,28 +439,93 @@ struct Session {
     HDC glDC{nullptr};
     HGLRC glRC{nullptr};
     bool usesOpenGL{false};
+    HANDLE glInteropDevice{nullptr};  // wglDXOpenDeviceNV handle for d3d11Device (GL zero-copy preview)
+    // Vulkan support: d3d11Device/d3d11Context are ours, on the Vulkan device's adapter, and
+    // sample the shared swapchain images (vulkan_interop.h)
+    bool usesVulkan{false};
+#ifdef XR_USE_GRAPHICS_API_VULKAN
+    vkinterop::Device vk;
+#endif
 
     // DX12 preview resources (GDI-based to avoid DXGI Present hook conflicts with Steam overlay / UEVR)
     ComPtr<ID3D12CommandQueue> previewQueue12;
     ComPtr<ID3D12Fence> crossQueueFence;
     UINT64 crossQueueFenceValue{0};
     ComPtr<ID3D12Resource> previewRT12;         // offscreen render target (replaces swapchain backbuffer)
-    ComPtr<ID3D12Resource> previewReadback12;   // CPU-readable buffer for GDI blit
     UINT previewReadbackPitch{0};               // row pitch aligned to D3D12_TEXTURE_DATA_PITCH_ALIGNMENT
-    ComPtr<ID3D12CommandAllocator> previewCmdAlloc;
+    ComPtr<ID3D12CommandAllocator> previewCmdAlloc;  // previewCmdList was created with it; frames record with the slot ring
     ComPtr<ID3D12GraphicsCommandList> previewCmdList;
     ComPtr<ID3D12Fence> previewFence;
     HANDLE previewFenceEvent{nullptr};
     UINT64 previewFenceValue{0};
 
+    // Pipelined readback ring. Frame N's copy is recorded into slot N % kPreviewSlots
+    // and the GDI paint uses the newest slot whose fence has already passed, so
+    // xrEndFrame never blocks on the GPU (one frame of preview latency). In
+    // low-latency mode the slot just submitted is waited on and painted instead.
+    static constexpr uint32_t kPreviewSlots = 3;
+    struct PreviewSlot12 {
+        ComPtr<ID3D12CommandAllocator> cmdAlloc;
+        ComPtr<ID3D12Resource> readback;        // CPU-readable buffer for GDI blit
+        UINT64 fenceValue{0};                   // 0 = never submitted
+        UINT width{0}, height{0};
+        bool timestampPending{false};           // begin/end timestamps resolved, not yet read
+        bool screenshotPending{false};          // MCP capture of this slot's readback, not yet taken
+        screenshot::Format screenshotFormat{screenshot::Format::Bmp};
+    };
+    PreviewSlot12 previewSlots12[kPreviewSlots];
+    uint32_t previewSlotNext{0};
+    UINT64 previewPaintedFence{0};              // fence value of the slot last painted via GDI
+    // GPU timestamps around each slot's copy work: queries 2*i and 2*i+1 resolve into
+    // bytes [16*i, 16*i+16) of the readback buffer, read once the slot's fence has passed
+    ComPtr<ID3D12QueryHeap> previewTimestampHeap;
+    ComPtr<ID3D12Resource> previewTimestampReadback;
+    UINT64 previewTimestampFreq{0};
+    // Composition: each eye is drawn scaled into previewRT12 (B8G8R8A8, window-sized) with
+    // the precompiled blit shaders, so readback and GDI cost follow the window, not the eyes.
+    // PSOs are built on first use per [blend][sRGB RTV][array source].
+    enum BlitBlend12 : uint32_t { BlendOpaque = 0, BlendAnaglyphRed, BlendAnaglyphCyan, BlendAlpha, BlendCount };
+    static constexpr uint32_t kPreviewSrvsPerSlot = 32;  // eyes + up to maxLayerCount layers in one frame
+    ComPtr<ID3D12RootSignature> blitRootSig12;
+    ComPtr<ID3D12PipelineState> blitPSO12[BlendCount][2][2];
+    ComPtr<ID3D12DescriptorHeap> previewRtvHeap12;  // [0] UNORM, [1] UNORM_SRGB view of previewRT12
+    ComPtr<ID3D12DescriptorHeap> previewSrvHeap12;  // shader-visible, kPreviewSrvsPerSlot per ring slot
+    UINT previewRtvStride12{0};
+    UINT previewSrvStride12{0};
+    uint32_t previewSrvUsed12{0};                  // descriptors used by the slot being recorded
+    bool previewRecording12{false};                // previewCmdList is open on previewSlotNext
+
+    // GPU timestamps for the compositor's D3D11 work on d3d11Context. Each frame gets a
+    // disjoint query plus up to kGpuTimerPairs begin/end pairs; frames are read back
+    // kGpuTimerFrames later with DONOTFLUSH, so neither the app nor we ever wait on them.
+    static constexpr uint32_t kGpuTimerFrames = 4;
+    static constexpr uint32_t kGpuTimerPairs = 8;
+    struct GpuTimerFrame11 {
+        ComPtr<ID3D11Query> disjoint;
+        ComPtr<ID3D11Query> stamps[kGpuTimerPairs * 2];
+        timing::Stage stages[kGpuTimerPairs] = {};
+        uint32_t pairCount{0};
+        bool pending{false};            // disjoint query ended, results not read yet
+    };
+    GpuTimerFrame11 gpuTimers11[kGpuTimerFrames];
+    uint32_t gpuTimerNext11{0};         // frame being recorded (when gpuTimerOpen11)
+    uint32_t gpuTimerOldest11{0};       // oldest frame that may still be pending
+    bool gpuTimerOpen11{false};
+    bool gpuTimerFailed11{false};       // query creation failed; stop trying
+
     // Blit resources
     ComPtr<ID3D11VertexShader> blitVS;
+    ComPtr<ID3D11VertexShader> blitVSFlipY;  // same quad with V flipped, for bottom-up GL images
     ComPtr<ID3D11PixelShader> blitPS;
     ComPtr<ID3D11SamplerState> samplerState;
     ComPtr<ID3D11RasterizerState> noCullRS;  // Rasterizer state with culling disabled
     ComPtr<ID3D11BlendState> anaglyphRedBS;
     ComPtr<ID3D11BlendState> anaglyphCyanBS;
     ComPtr<ID3D11BlendState> alphaBlendBS;
+    // Private pipeline state for the preview's work on the app's immediate context, swapped in
+    // with SwapDeviceContextState (D3D11StateScope). Null until first use or on 11.0 runtimes.
+    ComPtr<ID3DDeviceContextState> compositorState11;
+    bool compositorStateFailed11{false};
 
     // Desktop preview window (no thread - handled on main thread)
     HWND hwnd{nullptr};
@@ -336,21 +543,74 @@ struct Swapchain {
     uint32_t width{0}, height{0}, arraySize{2};
     uint32_t mipCount{1};
     // Backend type and images
-    enum class Backend { D3D11, D3D12, OpenGL } backend{Backend::D3D11};
+    enum class Backend { D3D11, D3D12, OpenGL, Vulkan } backend{Backend::D3D11};
     std::vector<ComPtr<ID3D11Texture2D>> images;      // D3D11 path
     std::vector<ComPtr<ID3D12Resource>> images12;     // D3D12 path
     std::vector<D3D12_RESOURCE_STATES> imageStates12;
+    // Per-image consumer fence: the previewFence value of the last preview submit that sampled
+    // image i. xrWaitSwapchainImage makes the app's queue wait for it on the GPU before the app
+    // renders into the image again, so a pipelined preview never reads an image being rewritten.
+    std::vector<UINT64> readFence12;
     std::vector<GLuint> imagesGL;                     // OpenGL path
     GLenum glInternalFormat{GL_RGBA8};                // OpenGL internal format
+    // OpenGL zero-copy path: imagesGL[i] aliases images[i] through WGL_NV_DX_interop2.
+    // An image is locked for GL between acquire and release; the preview only reads
+    // the last released (unlocked) image.
+    bool glInterop{false};
+    std::vector<HANDLE> glInteropHandles;
+    std::vector<bool> glInteropLocked;
+    // OpenGL readback fallback (no interop): per-eye ring of pixel-pack buffers. Each frame
+    // reads the released image into the next PBO behind a fence sync, and the PBO written
+    // two frames ago is copied into a persistent dynamic texture, so GL never stalls.
+    static constexpr uint32_t kGLReadbackSlots = 3;
+    struct GLReadbackRing {
+        GLuint fbo{0};
+        GLuint pbos[kGLReadbackSlots] = {};
+        GLsync fences[kGLReadbackSlots] = {};
+        uint32_t next{0};
+        ComPtr<ID3D11Texture2D> uploadTex;          // DYNAMIC, written with Map(WRITE_DISCARD)
+        ComPtr<ID3D11ShaderResourceView> uploadSRV;
+        bool hasContent{false};
+    };
+    GLReadbackRing glReadback[2];  // indexed by eye; both eyes may share one swapchain
+#ifdef XR_USE_GRAPHICS_API_VULKAN
+    // Vulkan path: the app renders into vk.images; when vk.shared, images[i] is the D3D11
+    // texture vk.images[i] is bound to, and the D3D11 preview samples it as is
+    vkinterop::Chain vk;
+#endif
     uint32_t nextIndex{0};
+    uint32_t acquiredCount{0};          // acquired and not yet released; images are released in acquire order
     uint32_t lastAcquired{UINT32_MAX};  // Initialize to invalid
     uint32_t lastReleased{UINT32_MAX};  // Initialize to invalid
     uint32_t imageCount{3};
+    // Preview sampling views per (image, array slice, typed format), built on first use and
+    // dropped in xrDestroySwapchain. A direct view samples the swapchain image itself; the
+    // others sample a persistent single-slice copy that is refreshed every frame.
+    struct BlitView {
+        ComPtr<ID3D11Texture2D> copy;
+        ComPtr<ID3D11ShaderResourceView> srv;
+        UINT width{0}, height{0};   // copy size
+        bool direct{false};
+        bool directFailed{false};   // the image was still bound as an output; always copy
+    };
+    std::unordered_map<uint64_t, BlitView> blitViews;
 };
 
 static Instance g_instance{};
 static Session g_session{};
-static std::unordered_map<XrSwapchain, Swapchain> g_swapchains;
+// Images per swapchain (OPENXR_SIM_SWAPCHAIN_IMAGES, 2..8). More images give a pipelined
+// preview more room before xrWaitSwapchainImage has to make the app's queue wait.
+static uint32_t g_swapchainImageCount = 3;
+// OPENXR_SIM_D3D11_STATE=backup: save and restore the app's bindings around the preview's
+// D3D11 work one by one instead of swapping in a private context state
+static bool g_d3d11StateBackup = false;
+static handles::HandleTable<XrSwapchain, Swapchain, 1> g_swapchains;
+
+static XrSwapchain AddSwapchain(Swapchain&& chain) {
+    const XrSwapchain handle = g_swapchains.Insert(std::move(chain));
+    g_swapchains.Find(handle)->handle = handle;
+    return handle;
+}
 
 // Head tracking state for mouse look and WASD movement
 static XrVector3f g_headPos = {0.0f, 1.7f, 0.0f};  // Start at standing eye height
@@ -441,17 +701,39 @@ static ControllerState g_rightController = {
     {0.0f, 0.0f, 0.0f}, {0.0f, 0.0f, 0.0f}, {0.0f, 0.0f, 0.0f}, 0.0f, 0.0f  // Velocity tracking
 };
 
-// Map XrSpace handles to controller type (0=none, 1=left grip, 2=left aim, 3=right grip, 4=right aim)
-static std::unordered_map<XrSpace, int> g_controllerSpaces;
+// Every XrSpace the runtime handed out; controller is 0 for reference spaces and action spaces
+// without a hand, 1 = left, 2 = right
+struct SpaceRecord {
+    int controller{0};
+    XrReferenceSpaceType referenceType{XR_REFERENCE_SPACE_TYPE_LOCAL};
+};
+static handles::HandleTable<XrSpace, SpaceRecord, 2> g_spaces;
 
 // Map XrPath to path string for controller detection
 static std::unordered_map<XrPath, std::string> g_pathStrings;
 
-// Map XrAction to action name for input mapping
-static std::unordered_map<XrAction, std::string> g_actionNames;
+// Controller input an action reads, resolved once when the action is created (name
+// heuristics) and again from the app's suggested binding paths, which take precedence
+enum class InputSource : uint8_t {
+    None, Trigger, Grip, Menu, Primary, Secondary, Thumbstick, ThumbstickX, ThumbstickY
+};
+
+// Hand bits of ActionBinding::hands
+enum HandMask : uint8_t { HandAny = 0, HandLeft = 1, HandRight = 2 };
 
-// Map XrAction to which hand it's bound to (0=both/any, 1=left, 2=right)
-static std::unordered_map<XrAction, int> g_actionHand;
+struct ActionBinding {
+    XrActionType type{XR_ACTION_TYPE_BOOLEAN_INPUT};
+    InputSource source{InputSource::None};
+    uint8_t hands{HandAny};    // from subactionPaths, else from the bound paths
+    bool subactionHands{false};
+    bool fromBindings{false};  // source came from xrSuggestInteractionProfileBindings
+};
+
+static handles::HandleTable<XrAction, ActionBinding, 3> g_actions;
+
+// /user/hand/* paths, the only subaction paths the simulator distinguishes
+static XrPath g_leftHandPath = XR_NULL_PATH;
+static XrPath g_rightHandPath = XR_NULL_PATH;
 
 // Time tracking for velocity calculation
 static XrTime g_lastFrameTime = 0;
@@ -532,68 +814,18 @@ static inline XrVector3f RotateVectorByQuaternion(const XrQuaternionf& q, const
 
 // Initialize shader resources for blitting
 bool InitBlitResources(Session& s) {
-    if (s.blitVS && s.blitPS && s.samplerState && s.noCullRS &&
+    if (s.blitVS && s.blitVSFlipY && s.blitPS && s.samplerState && s.noCullRS &&
         s.anaglyphRedBS && s.anaglyphCyanBS && s.alphaBlendBS) {
         return true;
     }
 
-    // Compile shaders
-    const char* shaderSource = R"(
-        Texture2D txDiffuse : register(t0);
-        SamplerState samLinear : register(s0);
-
-        struct VS_OUTPUT {
-            float4 Pos : SV_POSITION;
-            float2 Tex : TEXCOORD;
-        };
-
-        // Vertex Shader (generates fullscreen quad with correct UV mapping)
-        VS_OUTPUT VSMain(uint vertexId : SV_VertexID) {
-            VS_OUTPUT output;
-            // Generate (0,0), (2,0), (0,2), (2,2) pattern
-            float2 xy = float2((vertexId << 1) & 2, vertexId & 2);
-
-            // Clip-space position: xy goes 0-2, we need -1 to 1
-            // x: 0->-1, 2->1  means x_clip = xy.x - 1
-            // y: 0->1, 2->-1  means y_clip = 1 - xy.y
-            output.Pos = float4(xy.x - 1.0, 1.0 - xy.y, 0.0, 1.0);
-
-            // Normalized UVs (0-1 range, not 0-2)
-            output.Tex = xy * 0.5;
-
-            return output;
-        }
-
-        // Pixel Shader - GPU handles sRGB conversion automatically with proper formats
-        float4 PSMain(VS_OUTPUT input) : SV_TARGET {
-            return txDiffuse.Sample(samLinear, input.Tex);
-        }
-    )";
-
-    ComPtr<ID3DBlob> vsBlob, psBlob, errorBlob;
-    HRESULT hr;
-    UINT compileFlags = D3DCOMPILE_OPTIMIZATION_LEVEL3;
-
-    // Compile VS
-    hr = D3DCompile(shaderSource, strlen(shaderSource), "BlitShader", nullptr, nullptr, 
-                    "VSMain", "vs_5_0", compileFlags, 0, vsBlob.GetAddressOf(), errorBlob.GetAddressOf());
-    if (FAILED(hr)) {
-        Logf("[SimXR] Failed to compile VS: %s", errorBlob ? (char*)errorBlob->GetBufferPointer() : "Unknown error");
-        return false;
-    }
-    hr = s.d3d11Device->CreateVertexShader(vsBlob->GetBufferPointer(), vsBlob->GetBufferSize(), 
-                                           nullptr, s.blitVS.GetAddressOf());
+    // Shaders are precompiled at build time (src/shaders/blit.hlsl -> blit_shaders.h)
+    const int64_t initStart = timing::Now();
+    HRESULT hr = s.d3d11Device->CreateVertexShader(g_blitVS, sizeof(g_blitVS), nullptr, s.blitVS.GetAddressOf());
     if (FAILED(hr)) { Logf("[SimXR] Failed to create VS: 0x%08X", hr); return false; }
-
-    // Compile PS
-    hr = D3DCompile(shaderSource, strlen(shaderSource), "BlitShader", nullptr, nullptr, 
-                    "PSMain", "ps_5_0", compileFlags, 0, psBlob.GetAddressOf(), errorBlob.GetAddressOf());
-    if (FAILED(hr)) {
-        Logf("[SimXR] Failed to compile PS: %s", errorBlob ? (char*)errorBlob->GetBufferPointer() : "Unknown error");
-        return false;
-    }
-    hr = s.d3d11Device->CreatePixelShader(psBlob->GetBufferPointer(), psBlob->GetBufferSize(), 
-                                          nullptr, s.blitPS.GetAddressOf());
+    hr = s.d3d11Device->CreateVertexShader(g_blitVSFlipY, sizeof(g_blitVSFlipY), nullptr, s.blitVSFlipY.GetAddressOf());
+    if (FAILED(hr)) { Logf("[SimXR] Failed to create flipped VS: 0x%08X", hr); return false; }
+    hr = s.d3d11Device->CreatePixelShader(g_blitPS, sizeof(g_blitPS), nullptr, s.blitPS.GetAddressOf());
     if (FAILED(hr)) { Logf("[SimXR] Failed to create PS: 0x%08X", hr); return false; }
 
     // Create Sampler State
@@ -649,18 +881,66 @@ bool InitBlitResources(Session& s) {
     hr = s.d3d11Device->CreateBlendState(&alphaBlendDesc, s.alphaBlendBS.GetAddressOf());
     if (FAILED(hr)) { Logf("[SimXR] Failed to create alpha blend state: 0x%08X", hr); return false; }
 
-    Log("[SimXR] Blit resources initialized successfully.");
+    Logf("[SimXR] Blit resources initialized in %.2f ms", timing::TicksToMs(timing::Now() - initStart));
     return true;
 }
 
-static void ResetD3D12PreviewResources(rt::Session& s) {
+// D3D12 screenshots reuse the preview readback ring: a captured slot's pixels are handed to the
+// writer thread once its fence has passed, so a capture costs a memcpy rather than a new
+// readback buffer, a copy and a fence wait.
+static void ResolveD3D12Screenshots(rt::Session& s) {
+    if (!s.previewFence) return;
+    const UINT64 completed = s.previewFence->GetCompletedValue();
+    for (auto& slot : s.previewSlots12) {
+        if (!slot.screenshotPending || slot.fenceValue > completed || !slot.readback) continue;
+        slot.screenshotPending = false;
+        const SIZE_T bytes = (SIZE_T)s.previewReadbackPitch * slot.height;
+        void* mapped = nullptr;
+        D3D12_RANGE readRange = { 0, bytes };
+        if (FAILED(slot.readback->Map(0, &readRange, &mapped)) || !mapped) continue;
+        std::vector<uint8_t> pixels(bytes);
+        memcpy(pixels.data(), mapped, bytes);
+        D3D12_RANGE writeRange = { 0, 0 };
+        slot.readback->Unmap(0, &writeRange);
+        mcp::SubmitScreenshot(std::move(pixels), slot.width, slot.height, s.previewReadbackPitch, true,
+                              "screenshot", slot.screenshotFormat);
+    }
+}
+
+// keepPipeline: a resize only replaces the size-dependent resources; PSOs stay valid
+static void ResetD3D12PreviewResources(rt::Session& s, bool keepPipeline = false) {
+    // Pipelined slots may still be in flight; drain the preview queue before releasing them
+    if (s.previewQueue12 && s.previewFence && s.previewFenceEvent && s.previewFenceValue > 0) {
+        s.previewQueue12->Signal(s.previewFence.Get(), s.previewFenceValue);
+        if (s.previewFence->GetCompletedValue() < s.previewFenceValue) {
+            s.previewFence->SetEventOnCompletion(s.previewFenceValue, s.previewFenceEvent);
+            WaitForSingleObject(s.previewFenceEvent, 1000);
+        }
+        s.previewFenceValue++;
+    }
+    ResolveD3D12Screenshots(s);
     s.previewRT12.Reset();
-    s.previewReadback12.Reset();
     s.previewReadbackPitch = 0;
+    s.previewRtvHeap12.Reset();
+    s.previewSrvHeap12.Reset();
+    s.previewSrvUsed12 = 0;
+    s.previewRecording12 = false;
+    if (!keepPipeline) {
+        for (auto& pso : s.blitPSO12) for (auto& byFormat : pso) for (auto& p : byFormat) p.Reset();
+        s.blitRootSig12.Reset();
+    }
+    for (auto& slot : s.previewSlots12) {
+        slot = {};
+    }
+    s.previewSlotNext = 0;
+    s.previewPaintedFence = 0;
     s.previewCmdAlloc.Reset();
     s.previewCmdList.Reset();
     s.previewFence.Reset();
     s.previewFenceValue = 0;
+    // The next fence starts over at 0; a value recorded against this one would make the app's
+    // queue wait (xrWaitSwapchainImage) for a value the new fence reaches frames later
+    g_swapchains.ForEach([](Swapchain& ch) { std::fill(ch.readFence12.begin(), ch.readFence12.end(), 0); });
     s.previewQueue12.Reset();
     s.crossQueueFence.Reset();
     s.crossQueueFenceValue = 0;
@@ -668,6 +948,800 @@ static void ResetD3D12PreviewResources(rt::Session& s) {
         CloseHandle(s.previewFenceEvent);
         s.previewFenceEvent = nullptr;
     }
+    s.previewTimestampHeap.Reset();
+    s.previewTimestampReadback.Reset();
+    s.previewTimestampFreq = 0;
+}
+
+// ---------- D3D12 preview composition pipeline ----------
+
+static bool IsSrgbFormat(DXGI_FORMAT format) {
+    return format == DXGI_FORMAT_R8G8B8A8_UNORM_SRGB || format == DXGI_FORMAT_B8G8R8A8_UNORM_SRGB ||
+           format == DXGI_FORMAT_B8G8R8X8_UNORM_SRGB;
+}
+
+// PSO for one blend mode, RTV format (sRGB views re-encode what sRGB sources decode) and source
+// view dimension. The root signature and PSOs come from the build-time bytecode in blit_shaders.h.
+static ID3D12PipelineState* GetBlitPSO12(Session& s, uint32_t blend, bool srgb, bool arraySource) {
+    if (!s.d3d12Device || blend >= Session::BlendCount) return nullptr;
+    if (!s.blitRootSig12) {
+        HRESULT hr = s.d3d12Device->CreateRootSignature(0, g_blitRootSig, sizeof(g_blitRootSig),
+                                                        IID_PPV_ARGS(s.blitRootSig12.GetAddressOf()));
+        if (FAILED(hr)) {
+            Logf("[SimXR] D3D12 blit: CreateRootSignature failed 0x%08X", (unsigned)hr);
+            return nullptr;
+        }
+    }
+    auto& pso = s.blitPSO12[blend][srgb ? 1 : 0][arraySource ? 1 : 0];
+    if (pso) return pso.Get();
+
+    D3D12_GRAPHICS_PIPELINE_STATE_DESC desc = {};
+    desc.pRootSignature = s.blitRootSig12.Get();
+    desc.VS = { g_blitVSRect, sizeof(g_blitVSRect) };
+    desc.PS = arraySource ? D3D12_SHADER_BYTECODE{ g_blitPSArray12, sizeof(g_blitPSArray12) }
+                          : D3D12_SHADER_BYTECODE{ g_blitPS12, sizeof(g_blitPS12) };
+    auto& target = desc.BlendState.RenderTarget[0];
+    target.SrcBlend = D3D12_BLEND_ONE;
+    target.DestBlend = D3D12_BLEND_ZERO;
+    target.BlendOp = D3D12_BLEND_OP_ADD;
+    target.SrcBlendAlpha = D3D12_BLEND_ONE;
+    target.DestBlendAlpha = D3D12_BLEND_ZERO;
+    target.BlendOpAlpha = D3D12_BLEND_OP_ADD;
+    target.LogicOp = D3D12_LOGIC_OP_NOOP;
+    target.RenderTargetWriteMask = D3D12_COLOR_WRITE_ENABLE_ALL;
+    switch (blend) {
+        case Session::BlendAnaglyphRed:
+            // Left eye: red channel only
+            target.RenderTargetWriteMask = D3D12_COLOR_WRITE_ENABLE_RED;
+            break;
+        case Session::BlendAnaglyphCyan:
+            // Right eye: green + blue channels (cyan)
+            target.RenderTargetWriteMask = D3D12_COLOR_WRITE_ENABLE_GREEN | D3D12_COLOR_WRITE_ENABLE_BLUE;
+            break;
+        case Session::BlendAlpha:
+            // Layer overlay
+            target.BlendEnable = TRUE;
+            target.SrcBlend = D3D12_BLEND_SRC_ALPHA;
+            target.DestBlend = D3D12_BLEND_INV_SRC_ALPHA;
+            target.DestBlendAlpha = D3D12_BLEND_INV_SRC_ALPHA;
+            break;
+        default:
+            break;
+    }
+    desc.SampleMask = UINT_MAX;
+    desc.RasterizerState.FillMode = D3D12_FILL_MODE_SOLID;
+    desc.RasterizerState.CullMode = D3D12_CULL_MODE_NONE;
+    desc.RasterizerState.DepthClipEnable = TRUE;
+    desc.DepthStencilState.DepthEnable = FALSE;
+    desc.DepthStencilState.StencilEnable = FALSE;
+    desc.PrimitiveTopologyType = D3D12_PRIMITIVE_TOPOLOGY_TYPE_TRIANGLE;
+    desc.NumRenderTargets = 1;
+    desc.RTVFormats[0] = srgb ? DXGI_FORMAT_B8G8R8A8_UNORM_SRGB : DXGI_FORMAT_B8G8R8A8_UNORM;
+    desc.SampleDesc.Count = 1;
+    HRESULT hr = s.d3d12Device->CreateGraphicsPipelineState(&desc, IID_PPV_ARGS(pso.GetAddressOf()));
+    if (FAILED(hr)) {
+        Logf("[SimXR] D3D12 blit: CreateGraphicsPipelineState(blend=%u srgb=%d array=%d) failed 0x%08X",
+             blend, (int)srgb, (int)arraySource, (unsigned)hr);
+        return nullptr;
+    }
+    return pso.Get();
+}
+
+// ---------- GPU timestamps (D3D11 compositor work) ----------
+
+static void ResetGpuTimers11(rt::Session& s) {
+    for (auto& frame : s.gpuTimers11) frame = {};
+    s.gpuTimerNext11 = 0;
+    s.gpuTimerOldest11 = 0;
+    s.gpuTimerOpen11 = false;
+    s.gpuTimerFailed11 = false;
+}
+
+// Read back every finished frame, oldest first; stops at the first one the GPU hasn't reached
+static void ResolveGpuTimers11(rt::Session& s) {
+    auto* ctx = s.d3d11Context.Get();
+    while (ctx && s.gpuTimers11[s.gpuTimerOldest11].pending) {
+        auto& frame = s.gpuTimers11[s.gpuTimerOldest11];
+        D3D11_QUERY_DATA_TIMESTAMP_DISJOINT dj{};
+        if (ctx->GetData(frame.disjoint.Get(), &dj, sizeof(dj), D3D11_ASYNC_GETDATA_DONOTFLUSH) != S_OK) return;
+
+        bool valid = !dj.Disjoint && dj.Frequency != 0;
+        float stageMs[timing::StageCount] = {};
+        float totalMs = 0.0f;
+        for (uint32_t i = 0; valid && i < frame.pairCount; ++i) {
+            UINT64 begin = 0, end = 0;
+            if (ctx->GetData(frame.stamps[i * 2].Get(), &begin, sizeof(begin), D3D11_ASYNC_GETDATA_DONOTFLUSH) != S_OK ||
+                ctx->GetData(frame.stamps[i * 2 + 1].Get(), &end, sizeof(end), D3D11_ASYNC_GETDATA_DONOTFLUSH) != S_OK) {
+                valid = false;
+                break;
+            }
+            float ms = (end > begin) ? (float)((double)(end - begin) * 1000.0 / (double)dj.Frequency) : 0.0f;
+            stageMs[frame.stages[i]] += ms;
+            totalMs += ms;
+        }
+        if (valid && frame.pairCount > 0) {
+            for (uint32_t st = 0; st < timing::StageCount; ++st) {
+                if (stageMs[st] > 0.0f) timing::FrameTimers::Get().AddSample((timing::Stage)st, stageMs[st]);
+            }
+            timing::FrameTimers::Get().AddSample(timing::StGpuCompositor, totalMs);
+        }
+        frame.pending = false;
+        s.gpuTimerOldest11 = (s.gpuTimerOldest11 + 1) % rt::Session::kGpuTimerFrames;
+    }
+}
+
+// Returns the pair index to pass to GpuTimerEnd11, or UINT32_MAX if not timing
+static uint32_t GpuTimerBegin11(rt::Session& s, timing::Stage stage) {
+    auto* ctx = s.d3d11Context.Get();
+    if (!ctx || !s.d3d11Device || s.gpuTimerFailed11) return UINT32_MAX;
+
+    if (!s.gpuTimerOpen11) {
+        auto& frame = s.gpuTimers11[s.gpuTimerNext11];
+        if (frame.pending) {
+            // The GPU is more than kGpuTimerFrames behind; give up on that frame's numbers
+            ResolveGpuTimers11(s);
+            if (frame.pending) {
+                frame.pending = false;
+                s.gpuTimerOldest11 = (s.gpuTimerNext11 + 1) % rt::Session::kGpuTimerFrames;
+            }
+        }
+        if (!frame.disjoint) {
+            D3D11_QUERY_DESC qd{D3D11_QUERY_TIMESTAMP_DISJOINT, 0};
+            HRESULT hr = s.d3d11Device->CreateQuery(&qd, frame.disjoint.GetAddressOf());
+            qd.Query = D3D11_QUERY_TIMESTAMP;
+            for (uint32_t i = 0; SUCCEEDED(hr) && i < rt::Session::kGpuTimerPairs * 2; ++i) {
+                hr = s.d3d11Device->CreateQuery(&qd, frame.stamps[i].GetAddressOf());
+            }
+            if (FAILED(hr)) {
+                Logf("[SimXR] GPU timers: CreateQuery failed 0x%08X; GPU timing disabled", (unsigned)hr);
+                s.gpuTimerFailed11 = true;
+                return UINT32_MAX;
+            }
+        }
+        ctx->Begin(frame.disjoint.Get());
+        frame.pairCount = 0;
+        s.gpuTimerOpen11 = true;
+    }
+
+    auto& frame = s.gpuTimers11[s.gpuTimerNext11];
+    if (frame.pairCount >= rt::Session::kGpuTimerPairs) return UINT32_MAX;
+    uint32_t pair = frame.pairCount++;
+    frame.stages[pair] = stage;
+    ctx->End(frame.stamps[pair * 2].Get());
+    return pair;
+}
+
+static void GpuTimerEnd11(rt::Session& s, uint32_t pair) {
+    if (pair == UINT32_MAX || !s.gpuTimerOpen11 || !s.d3d11Context) return;
+    s.d3d11Context->End(s.gpuTimers11[s.gpuTimerNext11].stamps[pair * 2 + 1].Get());
+}
+
+// Close the frame's disjoint query and pick up whatever earlier frames have finished (xrEndFrame)
+static void GpuTimerEndFrame11(rt::Session& s) {
+    if (s.gpuTimerOpen11 && s.d3d11Context) {
+        auto& frame = s.gpuTimers11[s.gpuTimerNext11];
+        s.d3d11Context->End(frame.disjoint.Get());
+        frame.pending = true;
+        s.gpuTimerNext11 = (s.gpuTimerNext11 + 1) % rt::Session::kGpuTimerFrames;
+        s.gpuTimerOpen11 = false;
+    }
+    ResolveGpuTimers11(s);
+}
+
+struct GpuScope11 {
+    GpuScope11(rt::Session& s, timing::Stage stage) : session(s), pair(GpuTimerBegin11(s, stage)) {}
+    ~GpuScope11() { GpuTimerEnd11(session, pair); }
+    GpuScope11(const GpuScope11&) = delete;
+    GpuScope11& operator=(const GpuScope11&) = delete;
+    rt::Session& session;
+    uint32_t pair;
+};
+
+// Read the copy-work timestamps of every D3D12 preview slot whose fence has passed
+static void ResolveD3D12Timestamps(rt::Session& s) {
+    if (!s.previewTimestampReadback || !s.previewFence || s.previewTimestampFreq == 0) return;
+    const UINT64 completed = s.previewFence->GetCompletedValue();
+    for (uint32_t i = 0; i < rt::Session::kPreviewSlots; ++i) {
+        auto& slot = s.previewSlots12[i];
+        if (!slot.timestampPending || slot.fenceValue > completed) continue;
+        slot.timestampPending = false;
+        void* mapped = nullptr;
+        D3D12_RANGE readRange = { (SIZE_T)i * 16, (SIZE_T)i * 16 + 16 };
+        if (FAILED(s.previewTimestampReadback->Map(0, &readRange, &mapped)) || !mapped) continue;
+        const UINT64* stamps = (const UINT64*)((const uint8_t*)mapped + i * 16);
+        const UINT64 begin = stamps[0], end = stamps[1];
+        D3D12_RANGE writeRange = { 0, 0 };
+        s.previewTimestampReadback->Unmap(0, &writeRange);
+        if (end <= begin) continue;
+        float ms = (float)((double)(end - begin) * 1000.0 / (double)s.previewTimestampFreq);
+        timing::FrameTimers::Get().AddSample(timing::StGpuD3D12Copy, ms);
+        timing::FrameTimers::Get().AddSample(timing::StGpuCompositor, ms);
+    }
+}
+
+// ---------- Cached preview views of swapchain images ----------
+
+// SRV format for a swapchain image; typeless images take the sRGB-ness of the swapchain format
+static DXGI_FORMAT TypedViewFormat(DXGI_FORMAT textureFormat, DXGI_FORMAT chainFormat) {
+    switch (textureFormat) {
+        case DXGI_FORMAT_R8G8B8A8_TYPELESS:
+            return (chainFormat == DXGI_FORMAT_R8G8B8A8_UNORM_SRGB) ? DXGI_FORMAT_R8G8B8A8_UNORM_SRGB : DXGI_FORMAT_R8G8B8A8_UNORM;
+        case DXGI_FORMAT_B8G8R8A8_TYPELESS:
+            return (chainFormat == DXGI_FORMAT_B8G8R8A8_UNORM_SRGB) ? DXGI_FORMAT_B8G8R8A8_UNORM_SRGB : DXGI_FORMAT_B8G8R8A8_UNORM;
+        case DXGI_FORMAT_R16G16B16A16_TYPELESS:
+            return DXGI_FORMAT_R16G16B16A16_FLOAT;
+        case DXGI_FORMAT_R32G32B32A32_TYPELESS:
+            return DXGI_FORMAT_R32G32B32A32_FLOAT;
+        case DXGI_FORMAT_R10G10B10A2_TYPELESS:
+            return DXGI_FORMAT_R10G10B10A2_UNORM;
+        default:
+            return textureFormat;  // Already typed or unknown
+    }
+}
+
+// Cached view of one image slice. With allowDirect, single-sample non-array images that have
+// SRV binding are sampled in place (the app released them, so it isn't writing to them).
+// Otherwise the entry owns a copyWidth x copyHeight copy target the caller fills before drawing.
+static Swapchain::BlitView* GetBlitView(Session& s, Swapchain& chain, uint32_t image, uint32_t slice,
+                                        DXGI_FORMAT typedFormat, bool allowDirect,
+                                        UINT copyWidth, UINT copyHeight) {
+    if (image >= chain.images.size() || !chain.images[image] || !s.d3d11Device) return nullptr;
+    const uint64_t key = (uint64_t)image | ((uint64_t)slice << 16) | ((uint64_t)typedFormat << 32);
+    auto& view = chain.blitViews[key];
+
+    D3D11_TEXTURE2D_DESC srcDesc;
+    chain.images[image]->GetDesc(&srcDesc);
+    const bool direct = allowDirect && !view.directFailed && srcDesc.SampleDesc.Count == 1 &&
+                        srcDesc.ArraySize == 1 && (srcDesc.BindFlags & D3D11_BIND_SHADER_RESOURCE);
+    if (view.srv && view.direct == direct &&
+        (direct || (view.width == copyWidth && view.height == copyHeight))) {
+        return &view;
+    }
+
+    view.srv.Reset();
+    view.copy.Reset();
+    view.direct = direct;
+    view.width = view.height = 0;
+
+    D3D11_SHADER_RESOURCE_VIEW_DESC srvDesc = {};
+    srvDesc.Format = typedFormat;
+    srvDesc.ViewDimension = D3D11_SRV_DIMENSION_TEXTURE2D;
+    srvDesc.Texture2D.MostDetailedMip = 0;
+    srvDesc.Texture2D.MipLevels = 1;
+    HRESULT hr;
+    if (direct) {
+        hr = s.d3d11Device->CreateShaderResourceView(chain.images[image].Get(), &srvDesc, view.srv.GetAddressOf());
+    } else {
+        D3D11_TEXTURE2D_DESC copyDesc = {};
+        copyDesc.Width = copyWidth;
+        copyDesc.Height = copyHeight;
+        copyDesc.MipLevels = 1;
+        copyDesc.ArraySize = 1;
+        copyDesc.Format = typedFormat;
+        copyDesc.SampleDesc.Count = 1;
+        copyDesc.Usage = D3D11_USAGE_DEFAULT;
+        copyDesc.BindFlags = D3D11_BIND_SHADER_RESOURCE;
+        hr = s.d3d11Device->CreateTexture2D(&copyDesc, nullptr, view.copy.GetAddressOf());
+        if (SUCCEEDED(hr)) {
+            hr = s.d3d11Device->CreateShaderResourceView(view.copy.Get(), &srvDesc, view.srv.GetAddressOf());
+        }
+        view.width = copyWidth;
+        view.height = copyHeight;
+    }
+    if (FAILED(hr)) {
+        Logf("[SimXR] GetBlitView: %s view for image %u slice %u fmt=%d failed 0x%08X",
+             direct ? "direct" : "copy", image, slice, (int)typedFormat, (unsigned)hr);
+        chain.blitViews.erase(key);
+        return nullptr;
+    }
+    LogAtf(logging::CatFrame, logging::Level::Debug, "[SimXR] Blit view cached: image %u slice %u fmt=%d (%s)",
+           image, slice, (int)typedFormat, direct ? "direct" : "copy");
+    return &view;
+}
+
+// ---------- Compositor thread (optional, D3D11 sessions) ----------
+//
+// With OPENXR_SIM_COMPOSITOR_THREAD=1, xrEndFrame only copies the released eye images into
+// keyed-mutex shared textures on the app's context and posts the frame. A compositor thread
+// with its own D3D11 device on the same adapter composes the preview and does the vsync'd
+// Present, so a slow desktop compositor never throttles the app. Latest frame wins: a frame
+// the compositor hasn't picked up yet is replaced by the next one. The window and its
+// message pump stay on the app thread; the compositor thread owns the preview swapchain.
+struct CompositorThread {
+    static constexpr uint32_t kSlots = 3;   // one being read, one pending, one being written
+    enum class SlotState { Free, Ready, Reading };
+    struct Eye {
+        ComPtr<ID3D11Texture2D> tex;        // on the app's device
+        ComPtr<IDXGIKeyedMutex> mutex;
+        HANDLE shared{nullptr};
+        UINT width{0}, height{0};
+        DXGI_FORMAT format{DXGI_FORMAT_UNKNOWN};
+        UINT64 key{0};                      // key the next AcquireSync must use
+    };
+    struct Slot {
+        Eye eyes[2];
+        SlotState state{SlotState::Free};
+    };
+    struct Frame {
+        uint32_t slot{0};
+        bool used[2]{};
+        HANDLE shared[2]{};
+        UINT64 keys[2]{};                   // key the producer released with
+        XrRect2Di rects[2]{};
+        DXGI_FORMAT chainFormats[2]{};
+        ui::ViewMode viewMode{ui::ViewMode::BothEyes};
+        ui::DisplayLayout layout{ui::DisplayLayout::SideBySide};
+        UINT width{0}, height{0};           // preview size
+        bool screenshot{false};
+        screenshot::Format screenshotFormat{screenshot::Format::Bmp};
+        XrTime displayTime{0};              // for the video recorder
+        int64_t periodNs{0};
+    };
+
+    bool requested{false};                  // OPENXR_SIM_COMPOSITOR_THREAD, read at xrCreateInstance
+    bool running{false};
+    std::thread thread;
+    std::mutex mutex;                       // guards slot states, pending and stop
+    std::condition_variable cv;
+    bool stop{false};
+    Slot slots[kSlots];
+    int pending{-1};
+    Frame pendingFrame;
+    HWND hwnd{nullptr};
+    ComPtr<IDXGIAdapter> adapter;           // the app device's adapter
+    std::atomic<int> fps{0};
+    std::atomic<uint64_t> superseded{0};    // frames replaced before the compositor took them
+
+    // Process exit without xrDestroySession leaves the thread running; StopCompositorThread
+    // is the orderly path, joining here could deadlock under the loader lock
+    ~CompositorThread() { if (thread.joinable()) thread.detach(); }
+};
+static CompositorThread g_compositor;
+
+static bool CompositorThreadActive(const Session& s) {
+    return g_compositor.requested && !s.usesD3D12 && !s.usesOpenGL && s.d3d11Device;
+}
+
+// Join the compositor thread (it releases its device and swapchain on the way out) and drop
+// the shared textures. Must run before the app device or the window goes away.
+static void StopCompositorThread() {
+    auto& c = g_compositor;
+    if (!c.running) return;
+    {
+        std::lock_guard<std::mutex> lock(c.mutex);
+        c.stop = true;
+    }
+    c.cv.notify_all();
+    // The compositor may be inside Present, which can message the window; keep pumping
+    HANDLE h = (HANDLE)c.thread.native_handle();
+    while (WaitForSingleObject(h, 10) == WAIT_TIMEOUT) {
+        MSG msg;
+        while (PeekMessageW(&msg, nullptr, 0, 0, PM_REMOVE)) { TranslateMessage(&msg); DispatchMessageW(&msg); }
+    }
+    c.thread.join();
+    for (auto& slot : c.slots) slot = {};
+    c.pending = -1;
+    c.adapter.Reset();
+    c.hwnd = nullptr;
+    c.running = false;
+    Logf("[SimXR] Compositor thread stopped (%llu frames superseded)",
+         (unsigned long long)c.superseded.load(std::memory_order_relaxed));
+}
+
+#ifdef XR_USE_GRAPHICS_API_VULKAN
+// Swapchains the app didn't destroy go with the session; their images live on the app's device,
+// which outlives it, so they have to be destroyed while the function table is still there
+static void CloseVulkanDevice(rt::Session& s) {
+    g_swapchains.ForEach([&s](Swapchain& ch) {
+        if (ch.backend == Swapchain::Backend::Vulkan) vkinterop::DestroyChain(s.vk, ch.vk);
+    });
+    vkinterop::Close(s.vk);
+}
+#endif
+
+// GL and Vulkan sessions have no app D3D11 device; the preview (and the interop textures) use
+// our own. Vulkan passes the adapter its device runs on, so textures can be shared with it.
+static bool EnsureRuntimeD3D11Device(rt::Session& s, IDXGIAdapter* adapter = nullptr) {
+    if (s.d3d11Device) return true;
+    const char* api = s.usesVulkan ? "Vulkan" : "OpenGL";
+    D3D_FEATURE_LEVEL featureLevel;
+    UINT flags = 0;
+    #ifdef _DEBUG
+    flags |= D3D11_CREATE_DEVICE_DEBUG;
+    #endif
+    HRESULT hr = D3D11CreateDevice(adapter, adapter ? D3D_DRIVER_TYPE_UNKNOWN : D3D_DRIVER_TYPE_HARDWARE, nullptr, flags,
+                                   nullptr, 0, D3D11_SDK_VERSION,
+                                   &s.d3d11Device, &featureLevel, &s.d3d11Context);
+    if (FAILED(hr)) {
+        Logf("[SimXR] Failed to create D3D11 device for %s preview: 0x%08X", api, hr);
+        return false;
+    }
+    Logf("[SimXR] Created D3D11 device for %s preview", api);
+
+    // Force shader recompilation by resetting blit resources
+    s.blitVS.Reset();
+    s.blitVSFlipY.Reset();
+    s.blitPS.Reset();
+    s.samplerState.Reset();
+    s.noCullRS.Reset();
+    s.anaglyphRedBS.Reset();
+    s.anaglyphCyanBS.Reset();
+    s.alphaBlendBS.Reset();
+    Log("[SimXR] Reset blit resources for fresh shader compilation");
+    return true;
+}
+
+// Typed D3D11 format matching a GL internal format, for interop-backed swapchain images
+static DXGI_FORMAT GLInternalFormatToDXGI(GLenum internalFormat) {
+    switch (internalFormat) {
+        case GL_RGBA8:        return DXGI_FORMAT_R8G8B8A8_UNORM;
+        case GL_SRGB8_ALPHA8: return DXGI_FORMAT_R8G8B8A8_UNORM_SRGB;
+        case GL_RGBA16F:      return DXGI_FORMAT_R16G16B16A16_FLOAT;
+        case GL_RGBA32F:      return DXGI_FORMAT_R32G32B32A32_FLOAT;
+        case GL_RGB10_A2:     return DXGI_FORMAT_R10G10B10A2_UNORM;
+        default:              return DXGI_FORMAT_UNKNOWN;
+    }
+}
+
+// Unregister and free interop images. GL context must be current.
+static void ReleaseGLInteropImages(rt::Session& s, rt::Swapchain& chain) {
+    for (size_t i = 0; i < chain.glInteropHandles.size(); ++i) {
+        HANDLE h = chain.glInteropHandles[i];
+        if (!h) continue;
+        if (i < chain.glInteropLocked.size() && chain.glInteropLocked[i]) {
+            g_wglDXUnlockObjectsNV(s.glInteropDevice, 1, &h);
+        }
+        g_wglDXUnregisterObjectNV(s.glInteropDevice, h);
+    }
+    for (GLuint tex : chain.imagesGL) {
+        glDeleteTextures(1, &tex);
+    }
+    chain.glInteropHandles.clear();
+    chain.glInteropLocked.clear();
+    chain.imagesGL.clear();
+    chain.images.clear();
+    chain.glInterop = false;
+}
+
+// Back each GL swapchain image with a D3D11 texture registered via wglDXRegisterObjectNV.
+// GL context must be current and s.glInteropDevice open. On failure nothing is left behind
+// and the caller falls back to plain GL textures.
+static bool CreateGLInteropImages(rt::Session& s, rt::Swapchain& chain, DXGI_FORMAT format) {
+    D3D11_TEXTURE2D_DESC td{};
+    td.Width = chain.width;
+    td.Height = chain.height;
+    td.MipLevels = 1;
+    td.ArraySize = 1;
+    td.Format = format;
+    td.SampleDesc.Count = 1;
+    td.Usage = D3D11_USAGE_DEFAULT;
+    td.BindFlags = D3D11_BIND_SHADER_RESOURCE | D3D11_BIND_RENDER_TARGET;
+
+    for (uint32_t i = 0; i < chain.imageCount; ++i) {
+        ComPtr<ID3D11Texture2D> tex;
+        HRESULT hr = s.d3d11Device->CreateTexture2D(&td, nullptr, tex.GetAddressOf());
+        if (FAILED(hr)) {
+            Logf("[SimXR] GL interop: CreateTexture2D[%u] failed 0x%08X", i, (unsigned)hr);
+            ReleaseGLInteropImages(s, chain);
+            return false;
+        }
+        GLuint name = 0;
+        glGenTextures(1, &name);
+        HANDLE h = g_wglDXRegisterObjectNV(s.glInteropDevice, tex.Get(), name, GL_TEXTURE_2D, WGL_ACCESS_READ_WRITE_NV);
+        if (!h) {
+            Logf("[SimXR] GL interop: wglDXRegisterObjectNV[%u] failed (error=%lu)", i, GetLastError());
+            glDeleteTextures(1, &name);
+            ReleaseGLInteropImages(s, chain);
+            return false;
+        }
+        glBindTexture(GL_TEXTURE_2D, name);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+        glBindTexture(GL_TEXTURE_2D, 0);
+
+        chain.images.push_back(std::move(tex));
+        chain.imagesGL.push_back(name);
+        chain.glInteropHandles.push_back(h);
+        chain.glInteropLocked.push_back(false);
+    }
+    chain.glInterop = true;
+    return true;
+}
+
+// ---------- GL validation layer ----------
+// Diagnostic readbacks of GL swapchain images. Each runs only while its glvalidation check is
+// enabled (OPENXR_SIM_GL_VALIDATION or the MCP set_gl_validation tool); the production path
+// never calls into them.
+
+// One pixel of a GL texture through a temporary FBO. Returns false if the FBO is incomplete.
+static bool ReadGLTexturePixel(GLuint tex, GLint x, GLint y, uint8_t pixel[4]) {
+    if (!EnsureGLFramebufferFuncs()) return false;
+    GLuint fbo = 0;
+    g_glGenFramebuffers(1, &fbo);
+    g_glBindFramebuffer(GL_FRAMEBUFFER, fbo);
+    g_glFramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_TEXTURE_2D, tex, 0);
+    const bool complete = g_glCheckFramebufferStatus(GL_FRAMEBUFFER) == GL_FRAMEBUFFER_COMPLETE;
+    if (complete) glReadPixels(x, y, 1, 1, GL_RGBA, GL_UNSIGNED_BYTE, pixel);
+    g_glBindFramebuffer(GL_FRAMEBUFFER, 0);
+    g_glDeleteFramebuffers(1, &fbo);
+    return complete;
+}
+
+// xrCreateSwapchain: the centre pixel of a freshly created color texture
+static void ValidateCreatedGLImage(const rt::Swapchain& chain, GLuint tex) {
+    uint8_t pixel[4] = {0};
+    if (ReadGLTexturePixel(tex, (GLint)chain.width / 2, (GLint)chain.height / 2, pixel)) {
+        LogAtf(logging::CatGLDebug, logging::Level::Debug, "[SimXR]   Immediate readback tex=%u: pixel=[%d,%d,%d,%d]",
+               tex, pixel[0], pixel[1], pixel[2], pixel[3]);
+    } else {
+        LogAtf(logging::CatGLDebug, logging::Level::Debug, "[SimXR]   Immediate readback tex=%u: FBO incomplete", tex);
+    }
+}
+
+// xrEnumerateSwapchainImages: the first image still reads back after being handed out
+static void ValidateEnumeratedGLImage(GLuint tex) {
+    uint8_t pixel[4] = {0};
+    if (ReadGLTexturePixel(tex, 0, 0, pixel)) {
+        LogAtf(logging::CatGLDebug, logging::Level::Debug, "[SimXR]   After enumerate: tex=%u pixel=[%d,%d,%d,%d]",
+               tex, pixel[0], pixel[1], pixel[2], pixel[3]);
+    }
+}
+
+// xrReleaseSwapchainImage: GL context, bound FBO, texture parameters and the first pixel read
+// both through an FBO and glGetTexImage. Makes the session context current, glFinish()es and
+// issues a full memory barrier, so it stalls the app's GL queue; never interop images (they
+// are unlocked to D3D11 by now and must not be touched from GL).
+static void ValidateReleasedGLImage(const rt::Swapchain& ch) {
+    GLuint glTex = ch.imagesGL[ch.lastReleased];
+
+    HGLRC savedRC = wglGetCurrentContext();
+    HDC savedDC = wglGetCurrentDC();
+    LogAtf(logging::CatGLDebug, logging::Level::Debug, "[SimXR]   At release: currentRC=%p, currentDC=%p, sessionRC=%p, sessionDC=%p",
+           savedRC, savedDC, rt::g_session.glRC, rt::g_session.glDC);
+    if (savedRC != rt::g_session.glRC && rt::g_session.glRC && rt::g_session.glDC) {
+        LogAt(logging::CatGLDebug, logging::Level::Debug, "[SimXR]   At release: Switching to session GL context");
+        wglMakeCurrent(rt::g_session.glDC, rt::g_session.glRC);
+    }
+
+    glFinish();
+    typedef void (APIENTRY *PFNGLMEMORYBARRIERPROC)(GLbitfield);
+    static PFNGLMEMORYBARRIERPROC glMemoryBarrier = nullptr;
+    if (!glMemoryBarrier) {
+        glMemoryBarrier = (PFNGLMEMORYBARRIERPROC)wglGetProcAddress("glMemoryBarrier");
+    }
+    if (glMemoryBarrier) {
+        glMemoryBarrier(0xFFFFFFFF);  // GL_ALL_BARRIER_BITS
+    }
+    while (glGetError() != GL_NO_ERROR) {}
+
+    GLboolean isValidTex = glIsTexture(glTex);
+
+    // The FBO the app left bound (usually its own render target)
+    GLint currentBoundFBO = 0;
+    glGetIntegerv(0x8CA6, &currentBoundFBO);  // GL_FRAMEBUFFER_BINDING
+    uint8_t currentFboPixel[4] = {0};
+    if (currentBoundFBO != 0) {
+        glReadPixels(0, 0, 1, 1, GL_RGBA, GL_UNSIGNED_BYTE, currentFboPixel);
+    }
+    GLenum glError1 = glGetError();
+
+    if (EnsureGLFramebufferFuncs()) {
+        uint8_t fboPixel[4] = {0};
+        ReadGLTexturePixel(glTex, 0, 0, fboPixel);
+
+        GLint texWidth = 0, texHeight = 0, texFormat = 0;
+        glBindTexture(GL_TEXTURE_2D, glTex);
+        glGetTexLevelParameteriv(GL_TEXTURE_2D, 0, GL_TEXTURE_WIDTH, &texWidth);
+        glGetTexLevelParameteriv(GL_TEXTURE_2D, 0, GL_TEXTURE_HEIGHT, &texHeight);
+        glGetTexLevelParameteriv(GL_TEXTURE_2D, 0, GL_TEXTURE_INTERNAL_FORMAT, &texFormat);
+
+        // glGetTexImage reads the whole level, so cap it at 16 MB
+        uint8_t texPixel[4] = {0};
+        if (texWidth > 0 && texHeight > 0) {
+            size_t bufSize = (size_t)texWidth * texHeight * 4;
+            if (bufSize <= 16 * 1024 * 1024) {
+                std::vector<uint8_t> texData(bufSize);
+                glGetTexImage(GL_TEXTURE_2D, 0, GL_RGBA, GL_UNSIGNED_BYTE, texData.data());
+                memcpy(texPixel, texData.data(), 4);
+            }
+        }
+        glBindTexture(GL_TEXTURE_2D, 0);
+
+        GLenum glError2 = glGetError();
+        LogAtf(logging::CatGLDebug, logging::Level::Debug, "[SimXR]   At release: tex=%u isValid=%d err1=0x%X err2=0x%X boundFBO=%d currPx=[%d,%d,%d,%d] newPx=[%d,%d,%d,%d] texPx=[%d,%d,%d,%d] size=%dx%d fmt=0x%X",
+               glTex, (int)isValidTex, glError1, glError2, currentBoundFBO,
+               currentFboPixel[0], currentFboPixel[1], currentFboPixel[2], currentFboPixel[3],
+               fboPixel[0], fboPixel[1], fboPixel[2], fboPixel[3],
+               texPixel[0], texPixel[1], texPixel[2], texPixel[3],
+               texWidth, texHeight, texFormat);
+    }
+
+    if (savedRC != rt::g_session.glRC && savedRC && savedDC) {
+        wglMakeCurrent(savedDC, savedRC);
+    }
+}
+
+// Sum of the first sumBytes bytes (tells a black frame from real content) and the middle pixel
+// of an RGBA8 image already on the CPU
+static void LogGLPixelStats(const char* what, uint32_t eye, const uint8_t* data, size_t rowPitch,
+                            uint32_t w, uint32_t h, size_t sumBytes) {
+    uint32_t sum = 0;
+    for (size_t i = 0; i < sumBytes; i++) sum += data[i];
+    const uint8_t* mid = data + (size_t)(h / 2) * rowPitch + (size_t)(w / 2) * 4;
+    LogAtf(logging::CatGLDebug, logging::Level::Debug, "[SimXR] %s: eye=%u pixelSum=%u (first %zu bytes), middle pixel (RGBA)=[%d,%d,%d,%d]",
+           what, eye, sum, sumBytes, mid[0], mid[1], mid[2], mid[3]);
+}
+
+// Free the per-eye PBO rings of a readback GL swapchain. GL context must be current.
+static void ReleaseGLReadbackRings(rt::Swapchain& chain) {
+    for (auto& ring : chain.glReadback) {
+        for (uint32_t i = 0; i < rt::Swapchain::kGLReadbackSlots; ++i) {
+            if (ring.fences[i]) g_glDeleteSync(ring.fences[i]);
+            ring.fences[i] = nullptr;
+        }
+        if (ring.pbos[0]) g_glDeleteBuffers(rt::Swapchain::kGLReadbackSlots, ring.pbos);
+        for (GLuint& pbo : ring.pbos) pbo = 0;
+        if (ring.fbo) g_glDeleteFramebuffers(1, &ring.fbo);
+        ring.fbo = 0;
+        ring.next = 0;
+        ring.uploadSRV.Reset();
+        ring.uploadTex.Reset();
+        ring.hasContent = false;
+    }
+}
+
+// Queue an asynchronous readback of one eye of a GL swapchain and return an SRV holding the
+// newest completed frame (nullptr until the ring has produced one). glReadPixels goes into
+// pbos[next] behind a fence; the slot written two frames ago is mapped only once its fence
+// has signalled, so neither GL nor the preview waits. The mapped rows are copied bottom-up
+// into a persistent dynamic texture (the preview VS flips Y) and, when screenshotPixels is
+// given, top-down into that buffer. GL context must be current and s.d3d11Device valid.
+static ID3D11ShaderResourceView* ReadbackGLEyeAsync(rt::Session& s, rt::Swapchain& chain, uint32_t eye,
+                                                    GLuint tex, uint32_t slice,
+                                                    std::vector<uint8_t>* screenshotPixels, bool logStats) {
+    auto& ring = chain.glReadback[eye];
+    const uint32_t w = chain.width, h = chain.height;
+    const size_t rowBytes = (size_t)w * 4;
+    if (tex == 0 || w == 0 || h == 0 || !EnsureGLFramebufferFuncs()) {
+        return ring.hasContent ? ring.uploadSRV.Get() : nullptr;
+    }
+    const bool async = EnsureGLPixelBufferFuncs();
+
+    if (!ring.uploadTex) {
+        D3D11_TEXTURE2D_DESC td{};
+        td.Width = w;
+        td.Height = h;
+        td.MipLevels = 1;
+        td.ArraySize = 1;
+        td.Format = DXGI_FORMAT_R8G8B8A8_UNORM;
+        td.SampleDesc.Count = 1;
+        td.Usage = D3D11_USAGE_DYNAMIC;
+        td.BindFlags = D3D11_BIND_SHADER_RESOURCE;
+        td.CPUAccessFlags = D3D11_CPU_ACCESS_WRITE;
+        HRESULT hr = s.d3d11Device->CreateTexture2D(&td, nullptr, ring.uploadTex.GetAddressOf());
+        if (SUCCEEDED(hr)) {
+            hr = s.d3d11Device->CreateShaderResourceView(ring.uploadTex.Get(), nullptr, ring.uploadSRV.GetAddressOf());
+        }
+        if (FAILED(hr)) {
+            Logf("[SimXR] GL readback: failed to create upload texture %ux%u: 0x%08X", w, h, (unsigned)hr);
+            ring.uploadTex.Reset();
+            ring.uploadSRV.Reset();
+            return nullptr;
+        }
+        g_glGenFramebuffers(1, &ring.fbo);
+        if (async) {
+            g_glGenBuffers(rt::Swapchain::kGLReadbackSlots, ring.pbos);
+            GLint prevPack = 0;
+            glGetIntegerv(GL_PIXEL_PACK_BUFFER_BINDING, &prevPack);
+            for (GLuint pbo : ring.pbos) {
+                g_glBindBuffer(GL_PIXEL_PACK_BUFFER, pbo);
+                g_glBufferData(GL_PIXEL_PACK_BUFFER, (ptrdiff_t)(rowBytes * h), nullptr, GL_STREAM_READ);
+            }
+            g_glBindBuffer(GL_PIXEL_PACK_BUFFER, (GLuint)prevPack);
+        }
+        Logf("[SimXR] GL readback ring created: eye=%u %ux%u slots=%u mode=%s",
+             eye, w, h, async ? rt::Swapchain::kGLReadbackSlots : 1u, async ? "async PBO" : "sync");
+    }
+
+    // Preserve the app's read framebuffer / pack buffer bindings and pack layout
+    GLint prevReadFbo = 0, prevPack = 0, prevRowLength = 0, prevAlignment = 4;
+    glGetIntegerv(GL_READ_FRAMEBUFFER_BINDING, &prevReadFbo);
+    if (async) glGetIntegerv(GL_PIXEL_PACK_BUFFER_BINDING, &prevPack);
+    glGetIntegerv(GL_PACK_ROW_LENGTH, &prevRowLength);
+    glGetIntegerv(GL_PACK_ALIGNMENT, &prevAlignment);
+    glPixelStorei(GL_PACK_ROW_LENGTH, 0);  // tightly packed rows in the PBOs
+    glPixelStorei(GL_PACK_ALIGNMENT, 4);
+
+    g_glBindFramebuffer(GL_READ_FRAMEBUFFER, ring.fbo);
+    if (chain.arraySize > 1 && g_glFramebufferTextureLayer) {
+        g_glFramebufferTextureLayer(GL_READ_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, tex, 0, (GLint)slice);
+    } else {
+        g_glFramebufferTexture2D(GL_READ_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_TEXTURE_2D, tex, 0);
+    }
+    const bool complete = g_glCheckFramebufferStatus(GL_READ_FRAMEBUFFER) == GL_FRAMEBUFFER_COMPLETE;
+
+    const uint8_t* src = nullptr;  // bottom-up rows of the frame being uploaded
+    if (!complete) {
+        static int incompleteCount = 0;
+        if (++incompleteCount % 60 == 1) {
+            Logf("[SimXR] GL readback: FBO incomplete for tex=%u slice=%u", tex, slice);
+        }
+    } else if (async) {
+        const uint32_t writeSlot = ring.next;
+        g_glBindBuffer(GL_PIXEL_PACK_BUFFER, ring.pbos[writeSlot]);
+        glReadPixels(0, 0, (GLsizei)w, (GLsizei)h, GL_RGBA, GL_UNSIGNED_BYTE, nullptr);
+        if (ring.fences[writeSlot]) g_glDeleteSync(ring.fences[writeSlot]);
+        ring.fences[writeSlot] = g_glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+        ring.next = (writeSlot + 1) % rt::Swapchain::kGLReadbackSlots;
+
+        // The slot after the one just written is the oldest, queued two frames ago
+        const uint32_t readSlot = ring.next;
+        if (ring.fences[readSlot]) {
+            GLenum status = g_glClientWaitSync(ring.fences[readSlot], 0, 0);
+            if (status == GL_ALREADY_SIGNALED || status == GL_CONDITION_SATISFIED) {
+                g_glDeleteSync(ring.fences[readSlot]);
+                ring.fences[readSlot] = nullptr;
+                g_glBindBuffer(GL_PIXEL_PACK_BUFFER, ring.pbos[readSlot]);
+                src = (const uint8_t*)g_glMapBufferRange(GL_PIXEL_PACK_BUFFER, 0, (ptrdiff_t)(rowBytes * h), GL_MAP_READ_BIT);
+            }
+        }
+    }
+
+    bool uploaded = false;
+    D3D11_MAPPED_SUBRESOURCE mapped{};
+    if (complete && (src || !async) &&
+        SUCCEEDED(s.d3d11Context->Map(ring.uploadTex.Get(), 0, D3D11_MAP_WRITE_DISCARD, 0, &mapped))) {
+        uint8_t* dst = (uint8_t*)mapped.pData;
+        if (src) {
+            for (uint32_t y = 0; y < h; ++y) {
+                memcpy(dst + (size_t)y * mapped.RowPitch, src + y * rowBytes, rowBytes);
+            }
+        } else {
+            // Synchronous fallback: read straight into the mapped texture
+            glPixelStorei(GL_PACK_ROW_LENGTH, (GLint)(mapped.RowPitch / 4));
+            glReadPixels(0, 0, (GLsizei)w, (GLsizei)h, GL_RGBA, GL_UNSIGNED_BYTE, dst);
+        }
+        if (screenshotPixels) {
+            screenshotPixels->resize(rowBytes * h);
+            for (uint32_t y = 0; y < h; ++y) {
+                memcpy(screenshotPixels->data() + (size_t)(h - 1 - y) * rowBytes, dst + (size_t)y * mapped.RowPitch, rowBytes);
+            }
+        }
+        if (logStats && glvalidation::Enabled(glvalidation::CheckPixels)) {
+            LogGLPixelStats("GL PREVIEW", eye, dst, mapped.RowPitch, w, h, std::min((size_t)1000, rowBytes));
+        }
+        s.d3d11Context->Unmap(ring.uploadTex.Get(), 0);
+        ring.hasContent = true;
+        uploaded = true;
+    }
+    if (src) g_glUnmapBuffer(GL_PIXEL_PACK_BUFFER);
+    if (logStats && !uploaded) {
+        LogAtf(logging::CatFrame, logging::Level::Debug, "[SimXR] GL PREVIEW: eye=%u readback still in flight, showing previous frame", eye);
+    }
+
+    glPixelStorei(GL_PACK_ROW_LENGTH, prevRowLength);
+    glPixelStorei(GL_PACK_ALIGNMENT, prevAlignment);
+    if (async) g_glBindBuffer(GL_PIXEL_PACK_BUFFER, (GLuint)prevPack);
+    g_glBindFramebuffer(GL_READ_FRAMEBUFFER, (GLuint)prevReadFbo);
+    return ring.hasContent ? ring.uploadSRV.Get() : nullptr;
+}
+
+// Video recording into the simulator data directory, recording_<timestamp>_<stream>.mp4
+static void StartRecording(const recording::Options& options) {
+    const std::string dir = mcp::GetSimulatorDataPath();
+    CreateDirectoryA(dir.c_str(), nullptr);
+    SYSTEMTIME st;
+    GetLocalTime(&st);
+    char name[64];
+    snprintf(name, sizeof(name), "\\recording_%04u%02u%02u_%02u%02u%02u", st.wYear, st.wMonth, st.wDay,
+             st.wHour, st.wMinute, st.wSecond);
+    recording::Recorder::Get().Start(options, dir + name);
+    ui::g_uiState.recording = true;
+}
+
+static void StopRecording() {
+    recording::Recorder::Get().Stop();
+    ui::g_uiState.recording = false;
 }
 
 static LRESULT CALLBACK WndProc(HWND hWnd, UINT msg, WPARAM wParam, LPARAM lParam) {
@@ -753,7 +1827,8 @@ static LRESULT CALLBACK WndProc(HWND hWnd, UINT msg, WPARAM wParam, LPARAM lPara
             if (ui::HandleMenuCommand(hWnd, wParam,
                 []() { /* Resize handled by presentProjection based on zoom */ },
                 []() { mcp::g_screenshotRequested = true; },
-                []() { rt::g_headPos = {0, 1.7f, 0}; rt::g_headYaw = 0; rt::g_headPitch = 0; rt::g_headRoll = 0; }
+                []() { rt::g_headPos = {0, 1.7f, 0}; rt::g_headYaw = 0; rt::g_headPitch = 0; rt::g_headRoll = 0; },
+                []() { if (recording::Recorder::Get().Recording()) StopRecording(); else StartRecording(recording::g_defaults); }
             )) {
                 return 0;
             }
@@ -763,7 +1838,8 @@ static LRESULT CALLBACK WndProc(HWND hWnd, UINT msg, WPARAM wParam, LPARAM lPara
                 if (ui::HandleKeyboardShortcut(hWnd, wParam,
                     []() { /* Resize handled by presentProjection based on zoom */ },
                     []() { mcp::g_screenshotRequested = true; },
-                    []() { rt::g_headPos = {0, 1.7f, 0}; rt::g_headYaw = 0; rt::g_headPitch = 0; rt::g_headRoll = 0; }
+                    []() { rt::g_headPos = {0, 1.7f, 0}; rt::g_headYaw = 0; rt::g_headPitch = 0; rt::g_headRoll = 0; },
+                    []() { if (recording::Recorder::Get().Recording()) StopRecording(); else StartRecording(recording::g_defaults); }
                 )) {
                     return 0;
                 }
@@ -814,10 +1890,14 @@ static void ensurePreview(Session& s) {
 
 static XrResult XRAPI_PTR xrGetInstanceProcAddr_runtime(XrInstance, const char* name, PFN_xrVoidFunction* fn);
 
+// Startup cost: xrGetInstanceProcAddr lookups and the xrCreateInstance timestamp, reported
+// once with the first xrEndFrame
+static std::atomic<uint32_t> g_procLookups{0};
+static LARGE_INTEGER g_instanceCreateQpc{};
+
 extern "C" __declspec(dllexport) XrResult XRAPI_CALL xrNegotiateLoaderRuntimeInterface(const XrNegotiateLoaderInfo* loaderInfo,
                                                                             XrNegotiateRuntimeRequest* runtimeRequest) {
     try {
-        EnsureLogFile();
         Log("\n[SimXR] ========== OpenXR Simulator Runtime Starting ==========\n");
         if (!loaderInfo || !runtimeRequest) {
             Log("[SimXR] xrNegotiateLoaderRuntimeInterface: ERROR - null parameters");
@@ -994,12 +2074,115 @@ static XrResult XRAPI_PTR xrGetOpenGLGraphicsRequirementsKHR_runtime(
     return XR_SUCCESS;
 }
 
-// --- Minimal implementations ---
-
+#ifdef XR_USE_GRAPHICS_API_VULKAN
+// xrGetVulkanGraphicsRequirements2KHR (XR_KHR_vulkan_enable2)
+static XrResult XRAPI_PTR xrGetVulkanGraphicsRequirements2KHR_runtime(
+    XrInstance instance, XrSystemId systemId, XrGraphicsRequirementsVulkan2KHR* req) {
+    Logf("[SimXR] xrGetVulkanGraphicsRequirements2KHR called: instance=%p, systemId=%llu, req=%p",
+         instance, (unsigned long long)systemId, req);
+    if (!req) return XR_ERROR_VALIDATION_FAILURE;
+
+    memset(req, 0, sizeof(*req));
+    req->type = XR_TYPE_GRAPHICS_REQUIREMENTS_VULKAN2_KHR;
+    req->next = nullptr;
+    // External memory and semaphores are core in 1.1; the win32 handle types are extensions
+    req->minApiVersionSupported = XR_MAKE_VERSION(1, 1, 0);
+    req->maxApiVersionSupported = XR_MAKE_VERSION(1, 3, 0);
+    Log("[SimXR] xrGetVulkanGraphicsRequirements2KHR: min=1.1.0, max=1.3.0");
+    return XR_SUCCESS;
+}
+
+// xrCreateVulkanInstanceKHR: the app's instance, raised to Vulkan 1.1 if it asked for less
+static XrResult XRAPI_PTR xrCreateVulkanInstanceKHR_runtime(XrInstance, const XrVulkanInstanceCreateInfoKHR* ci,
+                                                            VkInstance* vulkanInstance, VkResult* vulkanResult) {
+    if (!ci || !ci->vulkanCreateInfo || !ci->pfnGetInstanceProcAddr || !vulkanInstance || !vulkanResult) {
+        return XR_ERROR_VALIDATION_FAILURE;
+    }
+    vkinterop::g_getInstanceProcAddr = ci->pfnGetInstanceProcAddr;
+    auto create = (PFN_vkCreateInstance)ci->pfnGetInstanceProcAddr(VK_NULL_HANDLE, "vkCreateInstance");
+    if (!create) {
+        Log("[SimXR] xrCreateVulkanInstanceKHR: ERROR - vkCreateInstance unavailable");
+        return XR_ERROR_RUNTIME_FAILURE;
+    }
+    vkinterop::InstanceCreateInfo info(*ci->vulkanCreateInfo);
+    *vulkanResult = create(&info.info, ci->vulkanAllocator, vulkanInstance);
+    if (*vulkanResult == VK_SUCCESS) vkinterop::g_instance = *vulkanInstance;
+    Logf("[SimXR] xrCreateVulkanInstanceKHR: apiVersion=%u.%u, %u extensions, VkResult=%d",
+         VK_API_VERSION_MAJOR(info.app.apiVersion), VK_API_VERSION_MINOR(info.app.apiVersion),
+         info.info.enabledExtensionCount, (int)*vulkanResult);
+    return XR_SUCCESS;
+}
+
+// xrGetVulkanGraphicsDevice2KHR: the GPU on the adapter the D3D requirements report (the first
+// hardware one), so the preview's D3D11 device can share its images
+static XrResult XRAPI_PTR xrGetVulkanGraphicsDevice2KHR_runtime(XrInstance, const XrVulkanGraphicsDeviceGetInfoKHR* getInfo,
+                                                                VkPhysicalDevice* physicalDevice) {
+    if (!getInfo || !getInfo->vulkanInstance || !physicalDevice) return XR_ERROR_VALIDATION_FAILURE;
+    vkinterop::g_instance = getInfo->vulkanInstance;
+    vkinterop::Functions fn;
+    if (!fn.LoadInstance(getInfo->vulkanInstance)) {
+        Log("[SimXR] xrGetVulkanGraphicsDevice2KHR: ERROR - Vulkan instance functions unavailable");
+        return XR_ERROR_RUNTIME_FAILURE;
+    }
+    if (!rt::g_adapterLuidSet) {
+        ComPtr<IDXGIFactory1> f;
+        if (SUCCEEDED(CreateDXGIFactory1(IID_PPV_ARGS(f.GetAddressOf())))) {
+            for (UINT i = 0;; ++i) {
+                ComPtr<IDXGIAdapter1> a;
+                if (f->EnumAdapters1(i, a.GetAddressOf()) == DXGI_ERROR_NOT_FOUND) break;
+                DXGI_ADAPTER_DESC1 d{}; a->GetDesc1(&d);
+                if (d.Flags & DXGI_ADAPTER_FLAG_SOFTWARE) continue;
+                rt::g_adapterLuid = d.AdapterLuid;
+                rt::g_adapterLuidSet = true;
+                break;
+            }
+        }
+    }
+    *physicalDevice = vkinterop::SelectPhysicalDevice(fn, getInfo->vulkanInstance,
+                                                      rt::g_adapterLuidSet ? &rt::g_adapterLuid : nullptr);
+    if (!*physicalDevice) {
+        Log("[SimXR] xrGetVulkanGraphicsDevice2KHR: ERROR - no Vulkan physical device");
+        return XR_ERROR_RUNTIME_FAILURE;
+    }
+    VkPhysicalDeviceProperties props{};
+    fn.vkGetPhysicalDeviceProperties(*physicalDevice, &props);
+    Logf("[SimXR] xrGetVulkanGraphicsDevice2KHR: %s (Vulkan %u.%u)", props.deviceName,
+         VK_API_VERSION_MAJOR(props.apiVersion), VK_API_VERSION_MINOR(props.apiVersion));
+    return XR_SUCCESS;
+}
+
+// xrCreateVulkanDeviceKHR: the app's device plus the external memory/semaphore extensions and
+// the timeline semaphore feature, where the GPU has them
+static XrResult XRAPI_PTR xrCreateVulkanDeviceKHR_runtime(XrInstance, const XrVulkanDeviceCreateInfoKHR* ci,
+                                                          VkDevice* vulkanDevice, VkResult* vulkanResult) {
+    if (!ci || !ci->vulkanCreateInfo || !ci->vulkanPhysicalDevice || !ci->pfnGetInstanceProcAddr ||
+        !vulkanDevice || !vulkanResult) {
+        return XR_ERROR_VALIDATION_FAILURE;
+    }
+    vkinterop::g_getInstanceProcAddr = ci->pfnGetInstanceProcAddr;
+    vkinterop::Functions fn;
+    if (!fn.LoadInstance(vkinterop::g_instance)) {
+        Log("[SimXR] xrCreateVulkanDeviceKHR: ERROR - no Vulkan instance (call xrGetVulkanGraphicsDevice2KHR first)");
+        return XR_ERROR_CALL_ORDER_INVALID;
+    }
+    vkinterop::DeviceCreateInfo info(fn, ci->vulkanPhysicalDevice, *ci->vulkanCreateInfo);
+    *vulkanResult = fn.vkCreateDevice(ci->vulkanPhysicalDevice, &info.info, ci->vulkanAllocator, vulkanDevice);
+    if (*vulkanResult == VK_SUCCESS) vkinterop::g_createdDevice = {*vulkanDevice, info.interop, info.timeline};
+    Logf("[SimXR] xrCreateVulkanDeviceKHR: %u extensions, interop=%d, timeline=%d, VkResult=%d",
+         info.info.enabledExtensionCount, (int)info.interop, (int)info.timeline, (int)*vulkanResult);
+    return XR_SUCCESS;
+}
+#endif
+
+// --- Minimal implementations ---
+
 static const char* kSupportedExtensions[] = {
     XR_KHR_D3D11_ENABLE_EXTENSION_NAME,
     XR_KHR_D3D12_ENABLE_EXTENSION_NAME,
     XR_KHR_OPENGL_ENABLE_EXTENSION_NAME,  // OpenGL support
+#ifdef XR_USE_GRAPHICS_API_VULKAN
+    XR_KHR_VULKAN_ENABLE2_EXTENSION_NAME,  // Vulkan support (external-memory interop)
+#endif
     XR_KHR_COMPOSITION_LAYER_DEPTH_EXTENSION_NAME,
     XR_KHR_COMPOSITION_LAYER_CYLINDER_EXTENSION_NAME,  // UEVR uses this for UI layers
     "XR_KHR_win32_convert_performance_counter_time"    // Unity often requires this
@@ -1034,6 +2217,9 @@ static XrResult XRAPI_PTR xrEnumerateInstanceExtensionProperties_runtime(const c
 
 static XrResult XRAPI_PTR xrCreateInstance_runtime(const XrInstanceCreateInfo* createInfo, XrInstance* instance) {
     if (!createInfo || !instance) return XR_ERROR_VALIDATION_FAILURE;
+    QueryPerformanceCounter(&g_instanceCreateQpc);
+    // Per-frame logging goes through the writer thread from here until xrDestroyInstance
+    logging::Logger::Get().Start();
     // applicationName may not be null-terminated
     char appName[XR_MAX_APPLICATION_NAME_SIZE + 1] = {0};
     memcpy(appName, createInfo->applicationInfo.applicationName, XR_MAX_APPLICATION_NAME_SIZE);
@@ -1062,6 +2248,139 @@ static XrResult XRAPI_PTR xrCreateInstance_runtime(const XrInstanceCreateInfo* c
     }
     rt::g_instance.handle = (XrInstance)1;  // Set a valid handle
     *instance = rt::g_instance.handle;
+
+    // Run namespacing (resolved on first use by the logger and the MCP files)
+    if (!runid::Id().empty()) {
+        Logf("[SimXR] xrCreateInstance: run id=%s, data directory %s", runid::Id().c_str(),
+             runid::DataDirectory().c_str());
+    }
+
+    // D3D12 preview readback mode: "pipelined" (default) paints the previous frame's
+    // readback so xrEndFrame never waits on the GPU; "lowlatency" waits for the current one.
+    char readbackMode[32] = {0};
+    if (GetEnvironmentVariableA("OPENXR_SIM_D3D12_READBACK", readbackMode, (DWORD)sizeof(readbackMode)) > 0) {
+        ui::g_uiState.lowLatencyPreview = (_stricmp(readbackMode, "lowlatency") == 0 ||
+                                           _stricmp(readbackMode, "sync") == 0);
+        Logf("[SimXR] xrCreateInstance: D3D12 preview readback mode=%s",
+             ui::g_uiState.lowLatencyPreview ? "low-latency" : "pipelined");
+    }
+    // Compositor thread: compose and Present the preview off the app's thread (D3D11 sessions)
+    char compositorThread[8] = {0};
+    if (GetEnvironmentVariableA("OPENXR_SIM_COMPOSITOR_THREAD", compositorThread, (DWORD)sizeof(compositorThread)) > 0) {
+        rt::g_compositor.requested = (compositorThread[0] == '1');
+        Logf("[SimXR] xrCreateInstance: compositor thread %s", rt::g_compositor.requested ? "enabled" : "disabled");
+    }
+    // D3D11 preview state isolation: "swap" (default) or "backup"
+    char d3d11State[16] = {0};
+    if (GetEnvironmentVariableA("OPENXR_SIM_D3D11_STATE", d3d11State, (DWORD)sizeof(d3d11State)) > 0) {
+        rt::g_d3d11StateBackup = (_stricmp(d3d11State, "backup") == 0);
+        Logf("[SimXR] xrCreateInstance: D3D11 preview state %s", rt::g_d3d11StateBackup ? "backup" : "swap");
+    }
+    // Swapchain ring depth for every backend
+    char swapchainImages[8] = {0};
+    if (GetEnvironmentVariableA("OPENXR_SIM_SWAPCHAIN_IMAGES", swapchainImages, (DWORD)sizeof(swapchainImages)) > 0) {
+        const int images = atoi(swapchainImages);
+        if (images >= 2 && images <= 8) rt::g_swapchainImageCount = (uint32_t)images;
+        Logf("[SimXR] xrCreateInstance: swapchain image count=%u", rt::g_swapchainImageCount);
+    }
+    // Synthetic motion-to-photon latency: xrLocateViews/xrLocateSpace report the pose this long ago
+    char poseLatency[16] = {0};
+    if (GetEnvironmentVariableA("OPENXR_SIM_POSE_LATENCY_MS", poseLatency, (DWORD)sizeof(poseLatency)) > 0) {
+        const float ms = std::clamp((float)atof(poseLatency), 0.0f, 500.0f);
+        posehistory::g_latencyNs.store((int64_t)(ms * 1e6f));
+        Logf("[SimXR] xrCreateInstance: pose latency=%.2f ms", ms);
+    }
+    // Native stereo / frame-diff analysis of the preview: every Nth presented frame, 0 = off
+    char stereoAnalyze[16] = {0};
+    if (GetEnvironmentVariableA("OPENXR_SIM_STEREO_ANALYZE", stereoAnalyze, (DWORD)sizeof(stereoAnalyze)) > 0) {
+        const int every = std::clamp(atoi(stereoAnalyze), 0, 1000);
+        stereo::g_every.store((uint32_t)every);
+        Logf("[SimXR] xrCreateInstance: stereo analysis every=%d frames%s", every, every ? "" : " (off)");
+    }
+    // Screenshot file format for requests that don't name one: "bmp" (default) or "png"
+    char screenshotFormat[8] = {0};
+    if (GetEnvironmentVariableA("OPENXR_SIM_SCREENSHOT_FORMAT", screenshotFormat, (DWORD)sizeof(screenshotFormat)) > 0) {
+        const bool png = (_stricmp(screenshotFormat, "png") == 0);
+        screenshot::g_defaultFormat.store(png ? screenshot::Format::Png : screenshot::Format::Bmp);
+        mcp::g_screenshotFormat = screenshot::g_defaultFormat.load();
+        Logf("[SimXR] xrCreateInstance: screenshot format=%s", png ? "png" : "bmp");
+    }
+
+    // GL validation readbacks (off unless asked for; MCP set_gl_validation can change them)
+    glvalidation::Configure();
+    if (glvalidation::g_checks.load() != 0) {
+        char checks[64];
+        Logf("[SimXR] xrCreateInstance: GL validation checks=%s",
+             glvalidation::Describe(glvalidation::g_checks.load(), checks, sizeof(checks)));
+    }
+
+    // Video recording defaults for Tools > Record Video (F9); MCP requests may override them
+    char recordSource[16] = {0}, recordCodec[16] = {0}, recordBitrate[16] = {0};
+    if (GetEnvironmentVariableA("OPENXR_SIM_RECORD_SOURCE", recordSource, (DWORD)sizeof(recordSource)) > 0) {
+        recording::g_defaults.source = (_stricmp(recordSource, "eyes") == 0) ? recording::Source::Eyes
+                                                                              : recording::Source::Preview;
+    }
+    if (GetEnvironmentVariableA("OPENXR_SIM_RECORD_CODEC", recordCodec, (DWORD)sizeof(recordCodec)) > 0) {
+        const bool hevc = (_stricmp(recordCodec, "hevc") == 0 || _stricmp(recordCodec, "h265") == 0);
+        recording::g_defaults.codec = hevc ? recording::Codec::Hevc : recording::Codec::H264;
+    }
+    if (GetEnvironmentVariableA("OPENXR_SIM_RECORD_BITRATE", recordBitrate, (DWORD)sizeof(recordBitrate)) > 0) {
+        const int mbps = atoi(recordBitrate);
+        if (mbps > 0 && mbps <= 500) recording::g_defaults.bitrateMbps = (uint32_t)mbps;
+    }
+    if (recordSource[0] || recordCodec[0] || recordBitrate[0]) {
+        Logf("[SimXR] xrCreateInstance: recording source=%s codec=%s bitrate=%u Mbit/s",
+             recording::SourceName(recording::g_defaults.source), recording::CodecName(recording::g_defaults.codec),
+             recording::g_defaults.bitrateMbps);
+    }
+
+    // Headless mode: no preview window and no vsync; runs unlocked unless a rate is given
+    headless::LoadConfig();
+    if (headless::Enabled()) {
+        ui::g_uiState.framePacing = ui::FramePacing::Unlocked;
+        const int hz = headless::g_config.refreshRateHz;
+        if (hz >= 10 && hz <= 1000) {
+            ui::g_uiState.framePacing = ui::FramePacing::Fixed;
+            ui::g_uiState.refreshRateHz = hz;
+        }
+        Logf("[SimXR] xrCreateInstance: headless mode, capture every %u frames (%s)",
+             headless::g_config.captureEvery, headless::g_config.capture == headless::CaptureMode::Save ? "save" : "hash");
+    }
+
+    // Input traces: record this run's poses and inputs, or replay a recorded run
+    char tracePath[MAX_PATH] = {0};
+    char traceLoop[8] = {0};
+    GetEnvironmentVariableA("OPENXR_SIM_TRACE_LOOP", traceLoop, (DWORD)sizeof(traceLoop));
+    if (GetEnvironmentVariableA("OPENXR_SIM_TRACE_PLAY", tracePath, (DWORD)sizeof(tracePath)) > 0) {
+        trace::Player::Get().Open(rt::TracePath(tracePath), strcmp(traceLoop, "1") == 0);
+    }
+    if (GetEnvironmentVariableA("OPENXR_SIM_TRACE_RECORD", tracePath, (DWORD)sizeof(tracePath)) > 0) {
+        trace::Recorder::Get().Start(rt::TracePath(tracePath));
+    }
+
+    // Frame pacing: "72" / "90" / "120" / "144" (or any rate in Hz), "unlocked", or "vblank"
+    char refreshMode[32] = {0};
+    if (GetEnvironmentVariableA("OPENXR_SIM_REFRESH_RATE", refreshMode, (DWORD)sizeof(refreshMode)) > 0) {
+        if (_stricmp(refreshMode, "unlocked") == 0) {
+            ui::g_uiState.framePacing = ui::FramePacing::Unlocked;
+        } else if (_stricmp(refreshMode, "vblank") == 0) {
+            ui::g_uiState.framePacing = ui::FramePacing::VBlank;
+        } else {
+            int hz = atoi(refreshMode);
+            if (hz >= 10 && hz <= 1000) {
+                ui::g_uiState.framePacing = ui::FramePacing::Fixed;
+                ui::g_uiState.refreshRateHz = hz;
+            }
+        }
+    }
+    if (headless::Enabled() && ui::g_uiState.framePacing == ui::FramePacing::VBlank) {
+        Log("[SimXR] xrCreateInstance: vblank pacing needs the preview window; headless runs unlocked");
+        ui::g_uiState.framePacing = ui::FramePacing::Unlocked;
+    }
+    Logf("[SimXR] xrCreateInstance: frame pacing=%s (%d Hz), high-resolution timer=%d",
+         ui::g_uiState.framePacing == ui::FramePacing::Unlocked ? "unlocked" :
+         ui::g_uiState.framePacing == ui::FramePacing::VBlank ? "vblank" : "fixed",
+         ui::g_uiState.refreshRateHz, (int)pacing::FramePacer::Get().HighResolutionTimer());
     Log("[SimXR] xrCreateInstance: SUCCESS");
     return XR_SUCCESS;
 }
@@ -1077,6 +2396,8 @@ static XrResult XRAPI_PTR xrDestroyInstance_runtime(XrInstance instance) {
         // MUST destroy the window before DLL unloads!
         // The OpenXR loader may unload our DLL after this call.
         // If the window stays alive, its WndProc points to unloaded code = crash.
+        recording::Recorder::Get().Shutdown();
+        rt::StopCompositorThread();
         {
             std::lock_guard<std::mutex> lock(rt::g_windowMutex);
             if (rt::g_persistentWindow) {
@@ -1102,6 +2423,14 @@ static XrResult XRAPI_PTR xrDestroyInstance_runtime(XrInstance instance) {
 
     Log("[SimXR] xrDestroyInstance: SUCCESS - Returning XR_SUCCESS");
     Log("[SimXR] ========== Instance Destroyed - Waiting for new instance ==========");
+
+    // The loader may unload the DLL after this returns, so the writer threads must not outlive it
+    // (recorder and screenshots first: both log through the logger)
+    recording::Recorder::Get().Shutdown();
+    trace::Recorder::Get().Stop();
+    trace::Player::Get().Close();
+    screenshot::Writer::Get().Shutdown();
+    logging::Logger::Get().Shutdown();
     return XR_SUCCESS;
 }
 
@@ -1193,6 +2522,10 @@ static XrResult XRAPI_PTR xrCreateSession_runtime(XrInstance instance, const XrS
             (unsigned long long)rt::g_session.handle, rt::g_session.state);
         // For now, reset the existing session to allow the new one
         // Reset session manually
+        recording::Recorder::Get().Shutdown();
+        rt::StopCompositorThread();
+        mcp::g_capture11.Reset();
+        stereo::g_readback11.Reset();
         rt::g_session.handle = XR_NULL_HANDLE;
         rt::g_session.state = XR_SESSION_STATE_IDLE;
         rt::g_session.d3d11Device.Reset();
@@ -1202,6 +2535,14 @@ static XrResult XRAPI_PTR xrCreateSession_runtime(XrInstance instance, const XrS
         rt::g_session.d3d12Device.Reset();
         rt::g_session.d3d12Queue.Reset();
         rt::ResetD3D12PreviewResources(rt::g_session);
+        rt::ResetGpuTimers11(rt::g_session);
+        rt::g_session.compositorState11.Reset();
+        rt::g_session.compositorStateFailed11 = false;
+        stress::ReleaseGpuLoad();
+#ifdef XR_USE_GRAPHICS_API_VULKAN
+        rt::CloseVulkanDevice(rt::g_session);
+#endif
+        rt::g_session.usesVulkan = false;
         rt::g_session.previewWidth = 1920;
         rt::g_session.previewHeight = 540;
         rt::g_session.isFocused = false;
@@ -1270,10 +2611,43 @@ static XrResult XRAPI_PTR xrCreateSession_runtime(XrInstance instance, const XrS
                  (unsigned long long)rt::g_session.handle, bGL->hDC, bGL->hGLRC);
             rt::PushState(rt::g_session.handle, XR_SESSION_STATE_READY);
             return XR_SUCCESS;
+#ifdef XR_USE_GRAPHICS_API_VULKAN
+        } else if (entry->type == XR_TYPE_GRAPHICS_BINDING_VULKAN2_KHR) {
+            const auto* bVk = reinterpret_cast<const XrGraphicsBindingVulkan2KHR*>(entry);
+            auto& s = rt::g_session;
+            s.usesVulkan = true;
+            s.usesOpenGL = false;
+            s.usesD3D12 = false;
+            s.d3d11Device.Reset();
+            s.d3d11Context.Reset();
+            s.d3d12Device.Reset();
+            s.d3d12Queue.Reset();
+            s.previewSwapchain.Reset();
+            if (!vkinterop::Open(s.vk, bVk->instance, bVk->physicalDevice, bVk->device,
+                                 bVk->queueFamilyIndex, bVk->queueIndex)) {
+                Log("[SimXR] xrCreateSession: ERROR - Vulkan device or queue unusable");
+                s.usesVulkan = false;
+                return XR_ERROR_GRAPHICS_DEVICE_INVALID;
+            }
+            // The preview device lives on the Vulkan device's adapter so the images can be shared
+            ComPtr<IDXGIAdapter1> adapter = vkinterop::FindAdapter(s.vk);
+            if (!adapter) Log("[SimXR] xrCreateSession: Vulkan device LUID has no DXGI adapter; no preview");
+            if (rt::EnsureRuntimeD3D11Device(s, adapter.Get()) && adapter) {
+                vkinterop::OpenInterop(s.vk, s.d3d11Device.Get(), s.d3d11Context.Get());
+            }
+            s.handle = (XrSession)(uintptr_t)(0x1000 + sessionCount);
+            s.state = XR_SESSION_STATE_IDLE;
+            *session = s.handle;
+            Logf("[SimXR] xrCreateSession: SUCCESS (Vulkan, handle=%llu, queue family %u, preview %s)",
+                 (unsigned long long)s.handle, bVk->queueFamilyIndex,
+                 !s.vk.interop ? "off" : s.vk.timeline ? "shared, timeline semaphores" : "shared, D3D12 fence semaphores");
+            rt::PushState(s.handle, XR_SESSION_STATE_READY);
+            return XR_SUCCESS;
+#endif
         }
         entry = entry->next;
     }
-    Log("[SimXR] xrCreateSession: ERROR - No supported graphics binding found (D3D11/D3D12/OpenGL)");
+    Log("[SimXR] xrCreateSession: ERROR - No supported graphics binding found (D3D11/D3D12/OpenGL/Vulkan)");
     return XR_ERROR_GRAPHICS_DEVICE_INVALID;
 }
 
@@ -1285,6 +2659,8 @@ static XrResult XRAPI_PTR xrDestroySession_runtime(XrSession s) {
              (unsigned long long)rt::g_session.handle);
         return XR_ERROR_HANDLE_INVALID;
     }
+    // A later session starts a new timeline; don't interpolate across the gap
+    posehistory::History::Get().Clear();
     
     // Transfer window and swapchain to global persistent storage
     // Unity likes to create/destroy sessions rapidly for compatibility checks
@@ -1305,7 +2681,28 @@ static XrResult XRAPI_PTR xrDestroySession_runtime(XrSession s) {
         }
     }
     
-    // Reset session but don't destroy the window
+    // Close the GL interop device before the D3D11 device it wraps goes away
+    if (rt::g_session.glInteropDevice) {
+        HGLRC prevRC = wglGetCurrentContext();
+        HDC prevDC = wglGetCurrentDC();
+        if (rt::g_session.glDC && rt::g_session.glRC) {
+            wglMakeCurrent(rt::g_session.glDC, rt::g_session.glRC);
+        }
+        g_wglDXCloseDeviceNV(rt::g_session.glInteropDevice);
+        rt::g_session.glInteropDevice = nullptr;
+        if (prevRC) wglMakeCurrent(prevDC, prevRC);
+    }
+
+    // Reset session but don't destroy the window. A recording is finalized first; its shared
+    // textures live on the session's devices.
+    recording::Recorder::Get().Shutdown();
+    rt::StopCompositorThread();
+    mcp::g_capture11.Poll(rt::g_session.d3d11Context.Get(), true);  // hand over in-flight captures
+    mcp::g_capture11.Reset();
+    stereo::g_readback11.Reset();
+    headless::g_capture11.Poll(rt::g_session.d3d11Context.Get(), true);
+    headless::g_capture11.Reset();
+    headless::g_capture12.Reset();  // waits for and reports its in-flight copies
     rt::g_session.handle = XR_NULL_HANDLE;
     rt::g_session.state = XR_SESSION_STATE_IDLE;
     rt::g_session.d3d11Device.Reset();
@@ -1314,6 +2711,14 @@ static XrResult XRAPI_PTR xrDestroySession_runtime(XrSession s) {
     rt::g_session.d3d12Device.Reset();
     rt::g_session.d3d12Queue.Reset();
     rt::ResetD3D12PreviewResources(rt::g_session);
+    rt::ResetGpuTimers11(rt::g_session);
+    rt::g_session.compositorState11.Reset();
+    rt::g_session.compositorStateFailed11 = false;
+    stress::ReleaseGpuLoad();
+#ifdef XR_USE_GRAPHICS_API_VULKAN
+    rt::CloseVulkanDevice(rt::g_session);  // the app's device outlives the session
+#endif
+    rt::g_session.usesVulkan = false;
     // Reset OpenGL state
     rt::g_session.usesOpenGL = false;
     rt::g_session.glDC = nullptr;
@@ -1352,6 +2757,22 @@ static XrResult XRAPI_PTR xrEnumerateSwapchainFormats_runtime(XrSession, uint32_
         return XR_SUCCESS;
     }
 
+#ifdef XR_USE_GRAPHICS_API_VULKAN
+    // Vulkan path - return VkFormats; color formats with a DXGI twin are shared with the preview
+    if (rt::g_session.usesVulkan) {
+        const uint32_t formatCount = (uint32_t)(sizeof(vkinterop::kSwapchainFormats) / sizeof(vkinterop::kSwapchainFormats[0]));
+        if (count) *count = formatCount;
+        if (capacity > 0 && formats) {
+            uint32_t copyCount = (capacity < formatCount) ? capacity : formatCount;
+            for (uint32_t i = 0; i < copyCount; ++i) {
+                formats[i] = vkinterop::kSwapchainFormats[i];
+            }
+            Logf("[SimXR] xrEnumerateSwapchainFormats(Vulkan): Returned %u formats (first: %d)", copyCount, (int)formats[0]);
+        }
+        return XR_SUCCESS;
+    }
+#endif
+
     // D3D11/D3D12 path - return DXGI formats
     const int64_t supportedFormats[] = {
         DXGI_FORMAT_R8G8B8A8_UNORM_SRGB,  // Unity often prefers sRGB
@@ -1411,7 +2832,6 @@ static XrResult XRAPI_PTR xrCreateSwapchain_runtime(XrSession, const XrSwapchain
     Log("[SimXR] ============================================");
     if (!ci || !sc) return XR_ERROR_VALIDATION_FAILURE;
     rt::Swapchain chain{}; 
-    chain.handle = (XrSwapchain)(uintptr_t)(rt::g_swapchains.size() + 2);
     chain.format = (DXGI_FORMAT)ci->format;  // Store the original requested format
     chain.width = ci->width; 
     chain.height = ci->height; 
@@ -1421,7 +2841,7 @@ static XrResult XRAPI_PTR xrCreateSwapchain_runtime(XrSession, const XrSwapchain
     // Create textures on appropriate backend
     if (rt::g_session.usesD3D12) {
         chain.backend = rt::Swapchain::Backend::D3D12;
-        chain.imageCount = 3;
+        chain.imageCount = rt::g_swapchainImageCount;
         for (uint32_t i = 0; i < chain.imageCount; ++i) {
             D3D12_RESOURCE_DESC rd = {};
             rd.Dimension = D3D12_RESOURCE_DIMENSION_TEXTURE2D;
@@ -1492,16 +2912,16 @@ static XrResult XRAPI_PTR xrCreateSwapchain_runtime(XrSession, const XrSwapchain
             }
             chain.images12.push_back(res);
             chain.imageStates12.push_back(init);
+            chain.readFence12.push_back(0);
         }
-        rt::g_swapchains.emplace(chain.handle, std::move(chain));
-        *sc = chain.handle;
+        *sc = rt::AddSwapchain(std::move(chain));
         Logf("[SimXR] xrCreateSwapchain(D3D12): sc=%p fmt=%d %ux%u array=%u samples=%u", *sc, (int)ci->format, ci->width, ci->height, ci->arraySize, ci->sampleCount);
         return XR_SUCCESS;
     }
     // OpenGL path
     if (rt::g_session.usesOpenGL) {
         chain.backend = rt::Swapchain::Backend::OpenGL;
-        chain.imageCount = 3;
+        chain.imageCount = rt::g_swapchainImageCount;
 
         // Check the current GL context state
         HGLRC currentRC = wglGetCurrentContext();
@@ -1563,6 +2983,30 @@ static XrResult XRAPI_PTR xrCreateSwapchain_runtime(XrSession, const XrSwapchain
                               glInternalFormat == GL_DEPTH24_STENCIL8 ||
                               glInternalFormat == GL_DEPTH_COMPONENT16);
 
+        // Zero-copy path: share D3D11 textures with GL so the preview blit samples them
+        // directly. The extension has no 2D-array or multisample texture type, so those
+        // swapchains (and depth) keep the plain GL textures + readback path.
+        DXGI_FORMAT interopFormat = GLInternalFormatToDXGI(glInternalFormat);
+        if (!isDepthFormat && chain.arraySize == 1 && ci->sampleCount <= 1 &&
+            interopFormat != DXGI_FORMAT_UNKNOWN &&
+            EnsureGLDXInterop(rt::g_session.glDC) && rt::EnsureRuntimeD3D11Device(rt::g_session)) {
+            if (!rt::g_session.glInteropDevice) {
+                rt::g_session.glInteropDevice = g_wglDXOpenDeviceNV(rt::g_session.d3d11Device.Get());
+                if (!rt::g_session.glInteropDevice) {
+                    Logf("[SimXR] GL interop: wglDXOpenDeviceNV failed (error=%lu)", GetLastError());
+                }
+            }
+            if (rt::g_session.glInteropDevice &&
+                rt::CreateGLInteropImages(rt::g_session, chain, interopFormat)) {
+                if (contextSwitched) wglMakeCurrent(prevDC, prevRC);
+                *sc = rt::AddSwapchain(std::move(chain));
+                Logf("[SimXR] xrCreateSwapchain(OpenGL interop): sc=%p fmt=0x%X dxgi=%d %ux%u imageCount=%u",
+                     *sc, (unsigned)ci->format, (int)interopFormat, ci->width, ci->height, chain.imageCount);
+                return XR_SUCCESS;
+            }
+            Log("[SimXR] GL interop: falling back to GL textures + readback preview");
+        }
+
         // Load glTexImage3D if needed for array textures
         if (chain.arraySize > 1 && !EnsureGLTexImage3D()) {
             wglMakeCurrent(prevDC, prevRC);
@@ -1622,24 +3066,8 @@ static XrResult XRAPI_PTR xrCreateSwapchain_runtime(XrSession, const XrSwapchain
             chain.imagesGL.push_back(tex);
             Logf("[SimXR] Created GL texture[%u]: %u (format=0x%X, valid=%d)", i, tex, glInternalFormat, isValid);
 
-            // DEBUG: Immediately read back the texture to verify it has the correct content
-            if (!isDepthFormat && EnsureGLFramebufferFuncs()) {
-                GLuint verifyFBO = 0;
-                g_glGenFramebuffers(1, &verifyFBO);
-                g_glBindFramebuffer(GL_FRAMEBUFFER, verifyFBO);
-                g_glFramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_TEXTURE_2D, tex, 0);
-
-                if (g_glCheckFramebufferStatus(GL_FRAMEBUFFER) == GL_FRAMEBUFFER_COMPLETE) {
-                    uint8_t pixel[4] = {0};
-                    glReadPixels(chain.width/2, chain.height/2, 1, 1, GL_RGBA, GL_UNSIGNED_BYTE, pixel);
-                    Logf("[SimXR]   Immediate readback tex=%u: pixel=[%d,%d,%d,%d]",
-                         tex, pixel[0], pixel[1], pixel[2], pixel[3]);
-                } else {
-                    Logf("[SimXR]   Immediate readback tex=%u: FBO incomplete", tex);
-                }
-
-                g_glBindFramebuffer(GL_FRAMEBUFFER, 0);
-                g_glDeleteFramebuffers(1, &verifyFBO);
+            if (!isDepthFormat && glvalidation::Enabled(glvalidation::CheckCreate)) {
+                ValidateCreatedGLImage(chain, tex);
             }
         }
 
@@ -1649,12 +3077,39 @@ static XrResult XRAPI_PTR xrCreateSwapchain_runtime(XrSession, const XrSwapchain
             wglMakeCurrent(prevDC, prevRC);
         }
 
-        rt::g_swapchains.emplace(chain.handle, std::move(chain));
-        *sc = chain.handle;
+        *sc = rt::AddSwapchain(std::move(chain));
         Logf("[SimXR] xrCreateSwapchain(OpenGL): sc=%p fmt=%d %ux%u array=%u imageCount=%u",
              *sc, (int)ci->format, ci->width, ci->height, ci->arraySize, chain.imageCount);
         return XR_SUCCESS;
     }
+#ifdef XR_USE_GRAPHICS_API_VULKAN
+    // Vulkan path: D3D11 textures imported into Vulkan where they can be shared, so the D3D11
+    // preview samples chain.images without a copy
+    if (rt::g_session.usesVulkan) {
+        auto& s = rt::g_session;
+        chain.backend = rt::Swapchain::Backend::Vulkan;
+        chain.imageCount = rt::g_swapchainImageCount;
+        chain.mipCount = ci->mipCount ? ci->mipCount : 1;
+        vkinterop::ImageDesc desc;
+        desc.format = (VkFormat)ci->format;
+        desc.width = chain.width;
+        desc.height = chain.height;
+        desc.arraySize = chain.arraySize;
+        desc.mipCount = chain.mipCount;
+        desc.sampleCount = ci->sampleCount ? ci->sampleCount : 1;
+        desc.usage = ci->usageFlags;
+        chain.format = vkinterop::ToDXGI(desc.format);  // what the preview and recorder see
+        if (!vkinterop::CreateChain(s.vk, s.d3d11Device.Get(), desc, chain.imageCount, chain.vk, chain.images)) {
+            Logf("[SimXR] xrCreateSwapchain(Vulkan): FAILED fmt=%d %ux%u", (int)ci->format, ci->width, ci->height);
+            return XR_ERROR_RUNTIME_FAILURE;
+        }
+        const bool shared = chain.vk.shared;
+        *sc = rt::AddSwapchain(std::move(chain));
+        Logf("[SimXR] xrCreateSwapchain(Vulkan): sc=%p fmt=%d %ux%u array=%u samples=%u %s", *sc, (int)ci->format,
+             ci->width, ci->height, ci->arraySize, ci->sampleCount, shared ? "shared" : "not shared (no preview)");
+        return XR_SUCCESS;
+    }
+#endif
     // D3D11 path
     D3D11_TEXTURE2D_DESC td{};
 
@@ -1719,7 +3174,7 @@ static XrResult XRAPI_PTR xrCreateSwapchain_runtime(XrSession, const XrSwapchain
     // Log the texture description for debugging
     Logf("[SimXR] Creating swapchain textures: Format=%d, %ux%u, Array=%u, Mips=%u, Samples=%u",
          td.Format, td.Width, td.Height, td.ArraySize, td.MipLevels, td.SampleDesc.Count);
-    chain.imageCount = 3;
+    chain.imageCount = rt::g_swapchainImageCount;
     for (uint32_t i = 0; i < chain.imageCount; ++i) {
         ComPtr<ID3D11Texture2D> tex; 
         HRESULT hr = rt::g_session.d3d11Device->CreateTexture2D(&td, nullptr, tex.GetAddressOf());
@@ -1741,62 +3196,58 @@ static XrResult XRAPI_PTR xrCreateSwapchain_runtime(XrSession, const XrSwapchain
         Logf("[SimXR] Created swapchain texture[%u]: %p", i, tex.Get());
         chain.images.push_back(std::move(tex));
     }
-    rt::g_swapchains.emplace(chain.handle, std::move(chain));
-    *sc = chain.handle;
+    *sc = rt::AddSwapchain(std::move(chain));
     Logf("[SimXR] xrCreateSwapchain: sc=%p fmt=%d %ux%u array=%u samples=%u", *sc, (int)ci->format, ci->width, ci->height, ci->arraySize, ci->sampleCount);
     return XR_SUCCESS;
 }
 
 static XrResult XRAPI_PTR xrEnumerateSwapchainImages_runtime(XrSwapchain sc, uint32_t capacity, uint32_t* count, XrSwapchainImageBaseHeader* images) {
-    auto it = rt::g_swapchains.find(sc); if (it == rt::g_swapchains.end()) return XR_ERROR_HANDLE_INVALID;
-    if (it->second.backend == rt::Swapchain::Backend::D3D12) {
-        const uint32_t n = (uint32_t)it->second.images12.size();
+    rt::Swapchain* it = rt::g_swapchains.Find(sc); if (!it) return XR_ERROR_HANDLE_INVALID;
+    if (it->backend == rt::Swapchain::Backend::D3D12) {
+        const uint32_t n = (uint32_t)it->images12.size();
         if (count) *count = n;
         if (capacity >= n && images) {
             auto* arr = reinterpret_cast<XrSwapchainImageD3D12KHR*>(images);
-            for (uint32_t i = 0; i < n; ++i) { arr[i].type = XR_TYPE_SWAPCHAIN_IMAGE_D3D12_KHR; arr[i].texture = it->second.images12[i].Get(); }
+            for (uint32_t i = 0; i < n; ++i) { arr[i].type = XR_TYPE_SWAPCHAIN_IMAGE_D3D12_KHR; arr[i].texture = it->images12[i].Get(); }
         }
         Logf("[SimXR] xrEnumerateSwapchainImages(D3D12): sc=%p count=%u", sc, n);
         return XR_SUCCESS;
-    } else if (it->second.backend == rt::Swapchain::Backend::OpenGL) {
-        const uint32_t n = (uint32_t)it->second.imagesGL.size();
+    } else if (it->backend == rt::Swapchain::Backend::OpenGL) {
+        const uint32_t n = (uint32_t)it->imagesGL.size();
         if (count) *count = n;
         if (capacity >= n && images) {
             auto* arr = reinterpret_cast<XrSwapchainImageOpenGLKHR*>(images);
             for (uint32_t i = 0; i < n; ++i) {
                 arr[i].type = XR_TYPE_SWAPCHAIN_IMAGE_OPENGL_KHR;
-                arr[i].image = it->second.imagesGL[i];
+                arr[i].image = it->imagesGL[i];
             }
-            // DEBUG: Log the texture IDs being returned AND verify content still matches
             Logf("[SimXR] xrEnumerateSwapchainImages(OpenGL): sc=%p texIDs=[%u,%u,%u]",
                  sc, n > 0 ? arr[0].image : 0, n > 1 ? arr[1].image : 0, n > 2 ? arr[2].image : 0);
 
-            // DEBUG: Read first texture to verify it still has content
-            if (n > 0 && EnsureGLFramebufferFuncs()) {
-                GLuint checkTex = arr[0].image;
-                GLuint checkFBO = 0;
-                g_glGenFramebuffers(1, &checkFBO);
-                g_glBindFramebuffer(GL_FRAMEBUFFER, checkFBO);
-                g_glFramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_TEXTURE_2D, checkTex, 0);
-                if (g_glCheckFramebufferStatus(GL_FRAMEBUFFER) == GL_FRAMEBUFFER_COMPLETE) {
-                    uint8_t pixel[4] = {0};
-                    glReadPixels(0, 0, 1, 1, GL_RGBA, GL_UNSIGNED_BYTE, pixel);
-                    Logf("[SimXR]   After enumerate: tex=%u pixel=[%d,%d,%d,%d]",
-                         checkTex, pixel[0], pixel[1], pixel[2], pixel[3]);
-                }
-                g_glBindFramebuffer(GL_FRAMEBUFFER, 0);
-                g_glDeleteFramebuffers(1, &checkFBO);
+            if (n > 0 && !it->glInterop && glvalidation::Enabled(glvalidation::CheckEnumerate)) {
+                ValidateEnumeratedGLImage(arr[0].image);
             }
         } else {
             Logf("[SimXR] xrEnumerateSwapchainImages(OpenGL): sc=%p count=%u (query only)", sc, n);
         }
         return XR_SUCCESS;
+#ifdef XR_USE_GRAPHICS_API_VULKAN
+    } else if (it->backend == rt::Swapchain::Backend::Vulkan) {
+        const uint32_t n = (uint32_t)it->vk.images.size();
+        if (count) *count = n;
+        if (capacity >= n && images) {
+            auto* arr = reinterpret_cast<XrSwapchainImageVulkan2KHR*>(images);
+            for (uint32_t i = 0; i < n; ++i) { arr[i].type = XR_TYPE_SWAPCHAIN_IMAGE_VULKAN2_KHR; arr[i].image = it->vk.images[i].image; }
+        }
+        Logf("[SimXR] xrEnumerateSwapchainImages(Vulkan): sc=%p count=%u", sc, n);
+        return XR_SUCCESS;
+#endif
     } else {
-        const uint32_t n = (uint32_t)it->second.images.size();
+        const uint32_t n = (uint32_t)it->images.size();
         if (count) *count = n;
         if (capacity >= n && images) {
             auto* arr = reinterpret_cast<XrSwapchainImageD3D11KHR*>(images);
-            for (uint32_t i = 0; i < n; ++i) { arr[i].type = XR_TYPE_SWAPCHAIN_IMAGE_D3D11_KHR; arr[i].texture = it->second.images[i].Get(); }
+            for (uint32_t i = 0; i < n; ++i) { arr[i].type = XR_TYPE_SWAPCHAIN_IMAGE_D3D11_KHR; arr[i].texture = it->images[i].Get(); }
         }
         Logf("[SimXR] xrEnumerateSwapchainImages(D3D11): sc=%p count=%u", sc, n);
         return XR_SUCCESS;
@@ -1804,27 +3255,78 @@ static XrResult XRAPI_PTR xrEnumerateSwapchainImages_runtime(XrSwapchain sc, uin
 }
 
 static XrResult XRAPI_PTR xrAcquireSwapchainImage_runtime(XrSwapchain sc, const XrSwapchainImageAcquireInfo*, uint32_t* index) {
-    auto it = rt::g_swapchains.find(sc); if (it == rt::g_swapchains.end()) return XR_ERROR_HANDLE_INVALID;
-    auto& ch = it->second;
+    rt::Swapchain* it = rt::g_swapchains.Find(sc); if (!it) return XR_ERROR_HANDLE_INVALID;
+    auto& ch = *it;
+    if (ch.acquiredCount >= ch.imageCount) return XR_ERROR_CALL_ORDER_INVALID;  // every image is out
     uint32_t i = ch.nextIndex;
     ch.nextIndex = (ch.nextIndex + 1) % ch.imageCount;
+    ++ch.acquiredCount;
     ch.lastAcquired = i;  // Track what we just gave to the app
     if (index) *index = i; 
+
+    // GL interop: hand the shared texture to GL until the app releases it
+    if (ch.glInterop && i < ch.glInteropHandles.size() && !ch.glInteropLocked[i]) {
+        if (g_wglDXLockObjectsNV(rt::g_session.glInteropDevice, 1, &ch.glInteropHandles[i])) {
+            ch.glInteropLocked[i] = true;
+        } else {
+            Logf("[SimXR] xrAcquireSwapchainImage: wglDXLockObjectsNV failed (error=%lu)", GetLastError());
+        }
+    }
+
+#ifdef XR_USE_GRAPHICS_API_VULKAN
+    // Vulkan: the app's queue takes the image back once the preview has finished reading it
+    if (ch.backend == rt::Swapchain::Backend::Vulkan) vkinterop::Acquire(rt::g_session.vk, ch.vk, i);
+#endif
     
     static int acquireCount = 0;
     if (++acquireCount % 60 == 1) {  // Log every 60 calls
-        Logf("[SimXR] xrAcquireSwapchainImage: sc=%p idx=%u (format=%d, %ux%u)", 
+        LogAtf(logging::CatSwapchain, logging::Level::Debug, "[SimXR] xrAcquireSwapchainImage: sc=%p idx=%u (format=%d, %ux%u)",
              sc, i, (int)ch.format, ch.width, ch.height);
     }
     return XR_SUCCESS;
 }
-static XrResult XRAPI_PTR xrWaitSwapchainImage_runtime(XrSwapchain, const XrSwapchainImageWaitInfo*) { return XR_SUCCESS; }
+// The oldest acquired image is the one the app waits on and then releases
+static uint32_t OldestAcquiredImage(const rt::Swapchain& ch) {
+    return (ch.nextIndex + ch.imageCount - ch.acquiredCount) % ch.imageCount;
+}
+
+// Wait until the runtime has finished reading the image the app is about to render into.
+// D3D11 and GL previews read the app's images on the app's own context/device, so their
+// reads are already ordered before the app's next writes. The D3D12 preview samples them on
+// its own queue up to kPreviewSlots frames behind; the app's queue is made to wait on the
+// preview fence on the GPU, so the CPU never blocks and the queue only stalls when the app
+// gets a full ring ahead of the preview. Vulkan images already made the app's queue wait for
+// the preview in xrAcquireSwapchainImage (the queue may only be used there and on release).
+static XrResult XRAPI_PTR xrWaitSwapchainImage_runtime(XrSwapchain sc, const XrSwapchainImageWaitInfo*) {
+    rt::Swapchain* it = rt::g_swapchains.Find(sc);
+    if (!it) return XR_ERROR_HANDLE_INVALID;
+    auto& ch = *it;
+    if (ch.acquiredCount == 0) return XR_ERROR_CALL_ORDER_INVALID;
+    const uint32_t i = OldestAcquiredImage(ch);
+    auto& s = rt::g_session;
+    if (ch.backend == rt::Swapchain::Backend::D3D12 && i < ch.readFence12.size() && ch.readFence12[i] != 0 &&
+        ch.readFence12[i] <= s.previewFenceValue && s.d3d12Queue && s.previewFence) {
+        static uint32_t overruns = 0;
+        if (s.previewFence->GetCompletedValue() < ch.readFence12[i]) {
+            s.d3d12Queue->Wait(s.previewFence.Get(), ch.readFence12[i]);
+            if (++overruns % 60 == 1) {
+                LogAtf(logging::CatSwapchain, logging::Level::Debug,
+                       "[SimXR] xrWaitSwapchainImage: sc=%p idx=%u still read by the preview (fence %llu > %llu), queue waits (%u times)",
+                       sc, i, (unsigned long long)ch.readFence12[i],
+                       (unsigned long long)s.previewFence->GetCompletedValue(), overruns);
+            }
+        }
+    }
+    return XR_SUCCESS;
+}
 static XrResult XRAPI_PTR xrReleaseSwapchainImage_runtime(XrSwapchain sc, const XrSwapchainImageReleaseInfo*) {
-    auto it = rt::g_swapchains.find(sc);
-    if (it == rt::g_swapchains.end()) return XR_ERROR_HANDLE_INVALID;
-    auto& ch = it->second;
-    // The app just released the image it acquired earlier
-    ch.lastReleased = ch.lastAcquired;
+    rt::Swapchain* it = rt::g_swapchains.Find(sc);
+    if (!it) return XR_ERROR_HANDLE_INVALID;
+    auto& ch = *it;
+    if (ch.acquiredCount == 0) return XR_ERROR_CALL_ORDER_INVALID;
+    // The app just released the oldest image it acquired
+    ch.lastReleased = OldestAcquiredImage(ch);
+    --ch.acquiredCount;
 
     // For D3D12: the app has finished using this image, reset our tracked state to COMMON.
     // D3D12 implicit state promotion/decay means COMMON is always safe after a GPU sync point.
@@ -1832,115 +3334,27 @@ static XrResult XRAPI_PTR xrReleaseSwapchainImage_runtime(XrSwapchain sc, const
         ch.imageStates12[ch.lastReleased] = D3D12_RESOURCE_STATE_COMMON;
     }
 
-    static int releaseCount = 0;
-    bool shouldLog = (++releaseCount <= 10);
-    if (shouldLog || releaseCount % 60 == 1) {
-        Logf("[SimXR] xrReleaseSwapchainImage: sc=%p released=%u", sc, ch.lastReleased);
-
-        // DEBUG: Read texture content at release time to verify it has content
-        if (ch.backend == rt::Swapchain::Backend::OpenGL && !ch.imagesGL.empty() && ch.lastReleased < ch.imagesGL.size()) {
-            GLuint glTex = ch.imagesGL[ch.lastReleased];
-
-            // Check and log current GL context
-            HGLRC currentRC = wglGetCurrentContext();
-            HDC currentDC = wglGetCurrentDC();
-            Logf("[SimXR]   At release: currentRC=%p, currentDC=%p, sessionRC=%p, sessionDC=%p",
-                 currentRC, currentDC, rt::g_session.glRC, rt::g_session.glDC);
-
-            // Ensure the session's GL context is current before reading
-            HGLRC savedRC = currentRC;
-            HDC savedDC = currentDC;
-            if (currentRC != rt::g_session.glRC && rt::g_session.glRC && rt::g_session.glDC) {
-                Logf("[SimXR]   At release: Switching to session GL context");
-                wglMakeCurrent(rt::g_session.glDC, rt::g_session.glRC);
-            }
-
-            // Read a single pixel to see what's there
-            glFinish();  // Make sure rendering is done
-
-            // Try memory barrier to ensure texture writes are visible
-            // GL_TEXTURE_UPDATE_BARRIER_BIT = 0x00000100
-            // GL_FRAMEBUFFER_BARRIER_BIT = 0x00000400
-            // GL_ALL_BARRIER_BITS = 0xFFFFFFFF
-            typedef void (APIENTRY *PFNGLMEMORYBARRIERPROC)(GLbitfield);
-            static PFNGLMEMORYBARRIERPROC glMemoryBarrier = nullptr;
-            if (!glMemoryBarrier) {
-                glMemoryBarrier = (PFNGLMEMORYBARRIERPROC)wglGetProcAddress("glMemoryBarrier");
-            }
-            if (glMemoryBarrier) {
-                glMemoryBarrier(0xFFFFFFFF);  // GL_ALL_BARRIER_BITS
-            }
-
-            // Clear any pending GL errors
-            while (glGetError() != GL_NO_ERROR) {}
-
-            // Check if texture is valid
-            GLboolean isValidTex = glIsTexture(glTex);
-
-            // First, check what FBO is currently bound (might be game's FBO)
-            GLint currentBoundFBO = 0;
-            glGetIntegerv(0x8CA6, &currentBoundFBO);  // GL_FRAMEBUFFER_BINDING = 0x8CA6
-
-            // Read from current FBO (game's)
-            uint8_t currentFboPixel[4] = {0};
-            if (currentBoundFBO != 0) {
-                glReadPixels(0, 0, 1, 1, GL_RGBA, GL_UNSIGNED_BYTE, currentFboPixel);
-            }
-
-            GLenum glError1 = glGetError();
-
-            // Method 1: Read via new FBO attached to swapchain texture
-            if (EnsureGLFramebufferFuncs()) {
-                GLuint readFBO = 0;
-                g_glGenFramebuffers(1, &readFBO);
-                g_glBindFramebuffer(GL_FRAMEBUFFER, readFBO);
-                g_glFramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_TEXTURE_2D, glTex, 0);
-
-                uint8_t fboPixel[4] = {0};
-                if (g_glCheckFramebufferStatus(GL_FRAMEBUFFER) == GL_FRAMEBUFFER_COMPLETE) {
-                    glReadPixels(0, 0, 1, 1, GL_RGBA, GL_UNSIGNED_BYTE, fboPixel);
-                }
+    // GL interop: unlocking flushes GL's writes and makes the texture readable by D3D11
+    if (ch.glInterop && ch.lastReleased < ch.glInteropHandles.size() && ch.glInteropLocked[ch.lastReleased]) {
+        g_wglDXUnlockObjectsNV(rt::g_session.glInteropDevice, 1, &ch.glInteropHandles[ch.lastReleased]);
+        ch.glInteropLocked[ch.lastReleased] = false;
+    }
 
-                g_glBindFramebuffer(GL_FRAMEBUFFER, 0);
-                g_glDeleteFramebuffers(1, &readFBO);
-
-                // Check if texture exists and has expected properties
-                GLint texWidth = 0, texHeight = 0, texFormat = 0;
-                glBindTexture(GL_TEXTURE_2D, glTex);
-                glGetTexLevelParameteriv(GL_TEXTURE_2D, 0, GL_TEXTURE_WIDTH, &texWidth);
-                glGetTexLevelParameteriv(GL_TEXTURE_2D, 0, GL_TEXTURE_HEIGHT, &texHeight);
-                glGetTexLevelParameteriv(GL_TEXTURE_2D, 0, GL_TEXTURE_INTERNAL_FORMAT, &texFormat);
-
-                // Method 2: Read via glGetTexImage (need full buffer for entire texture)
-                uint8_t texPixel[4] = {0};
-                if (texWidth > 0 && texHeight > 0) {
-                    size_t bufSize = (size_t)texWidth * texHeight * 4;
-                    if (bufSize <= 16 * 1024 * 1024) {  // Limit to 16MB
-                        std::vector<uint8_t> texData(bufSize);
-                        glGetTexImage(GL_TEXTURE_2D, 0, GL_RGBA, GL_UNSIGNED_BYTE, texData.data());
-                        // Get first pixel
-                        texPixel[0] = texData[0];
-                        texPixel[1] = texData[1];
-                        texPixel[2] = texData[2];
-                        texPixel[3] = texData[3];
-                    }
-                }
-                glBindTexture(GL_TEXTURE_2D, 0);
+#ifdef XR_USE_GRAPHICS_API_VULKAN
+    // Vulkan: hand the image to the preview and signal "rendered" behind the app's work
+    if (ch.backend == rt::Swapchain::Backend::Vulkan) vkinterop::Release(rt::g_session.vk, ch.vk, ch.lastReleased);
+#endif
 
-                GLenum glError2 = glGetError();
-                Logf("[SimXR]   At release: tex=%u isValid=%d err1=0x%X err2=0x%X boundFBO=%d currPx=[%d,%d,%d,%d] newPx=[%d,%d,%d,%d] texPx=[%d,%d,%d,%d] size=%dx%d fmt=0x%X",
-                     glTex, (int)isValidTex, glError1, glError2, currentBoundFBO,
-                     currentFboPixel[0], currentFboPixel[1], currentFboPixel[2], currentFboPixel[3],
-                     fboPixel[0], fboPixel[1], fboPixel[2], fboPixel[3],
-                     texPixel[0], texPixel[1], texPixel[2], texPixel[3],
-                     texWidth, texHeight, texFormat);
-            }
+    static int releaseCount = 0;
+    if (++releaseCount <= 10 || releaseCount % 60 == 1) {
+        LogAtf(logging::CatSwapchain, logging::Level::Debug, "[SimXR] xrReleaseSwapchainImage: sc=%p released=%u", sc, ch.lastReleased);
+    }
 
-            // Restore original GL context if we switched
-            if (savedRC != rt::g_session.glRC && savedRC && savedDC) {
-                wglMakeCurrent(savedDC, savedRC);
-            }
-        }
+    // Stalls the app's GL queue, so only while the release check is on
+    static uint32_t releaseValidations = 0;
+    if (ch.backend == rt::Swapchain::Backend::OpenGL && !ch.glInterop && ch.lastReleased < ch.imagesGL.size() &&
+        glvalidation::Enabled(glvalidation::CheckRelease) && glvalidation::Sample(releaseValidations)) {
+        ValidateReleasedGLImage(ch);
     }
     return XR_SUCCESS;
 }
@@ -2030,7 +3444,263 @@ private:
     UINT vs_num_class_instances = 0;
 };
 
+// The preview's private ID3DDeviceContextState, created on first use with the app device's
+// feature level. Fails (once, then stays null) where ID3D11Device1 is unavailable.
+static ID3DDeviceContextState* CompositorContextState11(rt::Session& s) {
+    if (s.compositorState11 || s.compositorStateFailed11 || !s.d3d11Device) return s.compositorState11.Get();
+    ComPtr<ID3D11Device1> device1;
+    HRESULT hr = s.d3d11Device.As(&device1);
+    if (SUCCEEDED(hr)) {
+        const D3D_FEATURE_LEVEL level = s.d3d11Device->GetFeatureLevel();
+        const UINT flags = (s.d3d11Device->GetCreationFlags() & D3D11_CREATE_DEVICE_SINGLETHREADED)
+                               ? D3D11_1_CREATE_DEVICE_CONTEXT_STATE_SINGLETHREADED : 0;
+        hr = device1->CreateDeviceContextState(flags, &level, 1, D3D11_SDK_VERSION, __uuidof(ID3D11Device1),
+                                               nullptr, s.compositorState11.GetAddressOf());
+    }
+    if (FAILED(hr)) {
+        Logf("[SimXR] D3D11 context state unavailable (0x%08X); preview work saves and restores app state", hr);
+        s.compositorStateFailed11 = true;
+        return nullptr;
+    }
+    Log("[SimXR] D3D11 preview work uses a private device context state");
+    return s.compositorState11.Get();
+}
+
+// Isolates the preview's D3D11 work from the app's pipeline state for the scope's lifetime.
+// Normally two SwapDeviceContextState calls swap a private state object in and the app's back
+// out: constant cost, and bindings the backup does not cover (constant buffers, other shader
+// stages, UAVs) cannot leak either way. Falls back to D3D11StateBackup on 11.0 runtimes or
+// with OPENXR_SIM_D3D11_STATE=backup. Our own state persists between frames, so everything the
+// preview draws with must be bound explicitly, as it already is.
+class D3D11StateScope {
+public:
+    explicit D3D11StateScope(rt::Session& s) {
+        ID3DDeviceContextState* state = rt::g_d3d11StateBackup ? nullptr : CompositorContextState11(s);
+        if (state && SUCCEEDED(s.d3d11Context.As(&context1_))) {
+            context1_->SwapDeviceContextState(state, appState_.GetAddressOf());
+            return;
+        }
+        backup_.emplace(s.d3d11Context.Get());
+    }
+    ~D3D11StateScope() {
+        if (appState_) context1_->SwapDeviceContextState(appState_.Get(), nullptr);
+    }
+    D3D11StateScope(const D3D11StateScope&) = delete;
+    D3D11StateScope& operator=(const D3D11StateScope&) = delete;
+
+private:
+    ComPtr<ID3D11DeviceContext1> context1_;
+    ComPtr<ID3DDeviceContextState> appState_;
+    std::optional<D3D11StateBackup> backup_;
+};
+
 namespace rt {
+    // QPC marks used for the per-frame stage timings published to the telemetry block
+    struct FrameTiming {
+        LARGE_INTEGER waitReturn{};    // xrWaitFrame returned to the app
+        LARGE_INTEGER lastEndFrame{};  // previous xrEndFrame exit
+        float waitMs = 0.0f;           // pacing sleep in the last xrWaitFrame
+        int64_t periodNs = 11111111;   // predictedDisplayPeriod of the last xrWaitFrame
+        float intervalMs = 0.0f;       // last xrEndFrame-to-xrEndFrame interval
+        XrTime displayTime = 0;        // display time of the frame being composed (recording timestamps)
+    };
+    static FrameTiming g_frameTiming;
+
+    // Output the preview swapchain is on, for vblank pacing. Refreshed when the swapchain
+    // changes; if the compositor holds the preview lock the cached output is reused.
+    static IDXGIOutput* PreviewOutputForPacing(Session& s) {
+        static ComPtr<IDXGISwapChain1> cachedSwapchain;
+        static ComPtr<IDXGIOutput> cachedOutput;
+        std::unique_lock<std::mutex> lock(s.previewMutex, std::try_to_lock);
+        if (lock.owns_lock() && s.previewSwapchain.Get() != cachedSwapchain.Get()) {
+            cachedSwapchain = s.previewSwapchain;
+            cachedOutput.Reset();
+            if (cachedSwapchain) cachedSwapchain->GetContainingOutput(cachedOutput.GetAddressOf());
+        }
+        return cachedOutput.Get();
+    }
+
+    static float QpcDeltaMs(const LARGE_INTEGER& from, const LARGE_INTEGER& to) {
+        static const LARGE_INTEGER freq = [](){ LARGE_INTEGER f; QueryPerformanceFrequency(&f); return f; }();
+        if (from.QuadPart == 0) return 0.0f;
+        return (float)((double)(to.QuadPart - from.QuadPart) * 1000.0 / (double)freq.QuadPart);
+    }
+
+    // Trace files: relative paths live in the simulator data directory
+    static std::string TracePath(const char* path) {
+        if (path[0] == '\\' || path[0] == '/' || (path[0] && path[1] == ':')) return path;
+        const std::string dir = mcp::GetSimulatorDataPath();
+        CreateDirectoryA(dir.c_str(), nullptr);
+        return dir + "\\" + path;
+    }
+
+    // View angles of a replayed trace frame; xrLocateViews reports these instead of sweeping
+    static bool g_traceViewValid = false;
+    static float g_traceView[3] = { 0, 0, 0 };
+
+    // Head yaw/pitch/roll xrLocateViews reports: the head state, or the pose sweep's sine
+    // waves when it is running, or the recorded angles during trace playback
+    static void EffectiveHeadAngles(float& yaw, float& pitch, float& roll) {
+        yaw = g_headYaw;
+        pitch = g_headPitch;
+        roll = g_headRoll;
+        if (g_traceViewValid) {
+            yaw = g_traceView[0];
+            pitch = g_traceView[1];
+            roll = g_traceView[2];
+        } else if (g_poseSweepEnabled) {
+            float t = (float)GetTickCount64() * 0.001f - g_poseSweepStartT;
+            const float TWO_PI = 6.2831853f;
+            float w = TWO_PI * g_poseSweepFreq;
+            yaw   = g_poseSweepYawAmp   * sinf(w * t);
+            pitch = g_poseSweepPitchAmp * sinf(w * t + 1.0f);
+            roll  = g_poseSweepRollAmp  * sinf(w * t + 2.0f);
+        }
+    }
+
+    static trace::ControllerSample ToTrace(const ControllerState& c) {
+        trace::ControllerSample out = {};
+        out.posOffset[0] = c.posOffset.x; out.posOffset[1] = c.posOffset.y; out.posOffset[2] = c.posOffset.z;
+        out.yawOffset = c.yawOffset;
+        out.pitchOffset = c.pitchOffset;
+        out.buttons = (c.triggerPressed ? trace::BtnTrigger : 0) | (c.gripPressed ? trace::BtnGrip : 0) |
+                      (c.menuPressed ? trace::BtnMenu : 0) | (c.primaryPressed ? trace::BtnPrimary : 0) |
+                      (c.secondaryPressed ? trace::BtnSecondary : 0) |
+                      (c.thumbstickPressed ? trace::BtnThumbstick : 0) | (c.isTracking ? trace::BtnTracking : 0);
+        out.triggerValue = c.triggerValue;
+        out.gripValue = c.gripValue;
+        out.thumbstick[0] = c.thumbstick.x; out.thumbstick[1] = c.thumbstick.y;
+        for (int i = 0; i < 3; ++i) {
+            out.linearVelocity[i] = (&c.linearVelocity.x)[i];
+            out.angularVelocity[i] = (&c.angularVelocity.x)[i];
+        }
+        return out;
+    }
+
+    static void FromTrace(const trace::ControllerSample& in, ControllerState& c) {
+        c.posOffset = { in.posOffset[0], in.posOffset[1], in.posOffset[2] };
+        c.yawOffset = in.yawOffset;
+        c.pitchOffset = in.pitchOffset;
+        c.isTracking = (in.buttons & trace::BtnTracking) != 0;
+        c.triggerPressed = (in.buttons & trace::BtnTrigger) != 0;
+        c.gripPressed = (in.buttons & trace::BtnGrip) != 0;
+        c.menuPressed = (in.buttons & trace::BtnMenu) != 0;
+        c.primaryPressed = (in.buttons & trace::BtnPrimary) != 0;
+        c.secondaryPressed = (in.buttons & trace::BtnSecondary) != 0;
+        c.thumbstickPressed = (in.buttons & trace::BtnThumbstick) != 0;
+        c.triggerValue = in.triggerValue;
+        c.gripValue = in.gripValue;
+        c.thumbstick = { in.thumbstick[0], in.thumbstick[1] };
+        c.linearVelocity = { in.linearVelocity[0], in.linearVelocity[1], in.linearVelocity[2] };
+        c.angularVelocity = { in.angularVelocity[0], in.angularVelocity[1], in.angularVelocity[2] };
+    }
+
+    // End of xrWaitFrame: the state the app will sample for this frame
+    static void RecordTraceFrame(const XrFrameState& state) {
+        trace::Frame f = {};
+        f.displayTimeNs = state.predictedDisplayTime;
+        f.periodNs = state.predictedDisplayPeriod;
+        f.headPos[0] = g_headPos.x; f.headPos[1] = g_headPos.y; f.headPos[2] = g_headPos.z;
+        f.headYaw = g_headYaw; f.headPitch = g_headPitch; f.headRoll = g_headRoll;
+        EffectiveHeadAngles(f.viewYaw, f.viewPitch, f.viewRoll);
+        f.controllers[0] = ToTrace(g_leftController);
+        f.controllers[1] = ToTrace(g_rightController);
+        trace::Recorder::Get().Append(f);
+    }
+
+    // Replayed display times run on base + recorded time. The base is set when playback starts
+    // and again in each new session, so the first replayed frame lands on the live display time.
+    struct TraceClock {
+        XrSession session{XR_NULL_HANDLE};
+        bool based{false};
+        XrTime base{0};
+        int64_t liveOffsetNs{0};  // last replayed display time minus the live one
+    };
+    static TraceClock g_traceClock;
+
+    // Replace this frame's inputs and display timing with the next trace frame. Display times
+    // keep the recorded spacing; once a non-looping trace has finished, live pacing resumes from
+    // the last replayed time instead of stepping back to the live clock.
+    static void ApplyTraceFrame(XrFrameState* state) {
+        auto& player = trace::Player::Get();
+        auto& clock = g_traceClock;
+        const XrTime live = state->predictedDisplayTime;
+        const bool rebase = !clock.based || clock.session != g_session.handle || player.Position() == 0;
+        const bool finished = player.Finished();
+        const trace::Frame* f = player.Next();
+        if (!f) return;
+        g_headPos = { f->headPos[0], f->headPos[1], f->headPos[2] };
+        g_headYaw = f->headYaw;
+        g_headPitch = f->headPitch;
+        g_headRoll = f->headRoll;
+        g_traceView[0] = f->viewYaw;
+        g_traceView[1] = f->viewPitch;
+        g_traceView[2] = f->viewRoll;
+        g_traceViewValid = true;
+        FromTrace(f->controllers[0], g_leftController);
+        FromTrace(f->controllers[1], g_rightController);
+        if (finished && !rebase) {
+            state->predictedDisplayTime = live + clock.liveOffsetNs;
+            return;
+        }
+        const XrTime recorded = f->displayTimeNs + player.LoopOffsetNs();
+        if (rebase) {
+            clock.session = g_session.handle;
+            clock.based = true;
+            clock.base = live - recorded;
+        }
+        state->predictedDisplayTime = clock.base + recorded;
+        clock.liveOffsetNs = state->predictedDisplayTime - live;
+        if (finished) return;
+        state->predictedDisplayPeriod = f->periodNs;
+        g_frameTiming.periodNs = f->periodNs;
+    }
+
+    static posehistory::Pose ToHistoryPose(const XrPosef& pose) {
+        posehistory::Pose out;
+        out.position[0] = pose.position.x; out.position[1] = pose.position.y; out.position[2] = pose.position.z;
+        out.orientation[0] = pose.orientation.x; out.orientation[1] = pose.orientation.y;
+        out.orientation[2] = pose.orientation.z; out.orientation[3] = pose.orientation.w;
+        return out;
+    }
+
+    static XrPosef FromHistoryPose(const posehistory::Pose& pose) {
+        XrPosef out;
+        out.position = { pose.position[0], pose.position[1], pose.position[2] };
+        out.orientation = { pose.orientation[0], pose.orientation[1], pose.orientation[2], pose.orientation[3] };
+        return out;
+    }
+
+    // End of xrWaitFrame: the head and controller poses for this frame's display time
+    static void RecordPoseSample(XrTime displayTime) {
+        posehistory::Sample sample;
+        sample.time = displayTime;
+        float yaw, pitch, roll;
+        EffectiveHeadAngles(yaw, pitch, roll);
+        XrPosef head;
+        head.orientation = QuatFromYawPitchRoll(yaw, pitch, roll);
+        head.position = g_headPos;
+        sample.head = ToHistoryPose(head);
+        const ControllerState* controllers[2] = { &g_leftController, &g_rightController };
+        for (int c = 0; c < 2; ++c) {
+            XrPosef pose;
+            GetControllerPose(*controllers[c], &pose);
+            sample.controllers[c] = ToHistoryPose(pose);
+            for (int i = 0; i < 3; ++i) {
+                sample.linearVelocity[c][i] = (&controllers[c]->linearVelocity.x)[i];
+                sample.angularVelocity[c][i] = (&controllers[c]->angularVelocity.x)[i];
+            }
+            sample.tracked[c] = controllers[c]->isTracking;
+        }
+        posehistory::History::Get().Push(sample);
+    }
+
+    // The poses the app sees for a requested time, shifted back by the synthetic latency.
+    // False before the first xrWaitFrame; callers then use the live state.
+    static bool PoseAt(XrTime time, posehistory::Sample& out) {
+        return posehistory::History::Get().At(time - posehistory::g_latencyNs.load(std::memory_order_relaxed), out);
+    }
+
     static XrSessionState g_state = XR_SESSION_STATE_IDLE;
     static std::vector<XrEventDataBuffer> g_eventQueue;
     void PushState(XrSession s, XrSessionState ns) {
@@ -2064,13 +3734,13 @@ static XrResult XRAPI_PTR xrPollEvent_runtime(XrInstance, XrEventDataBuffer* b)
     pollCount++;
     
     if (pollCount <= 5) {  // Log first few polls
-        Logf("[SimXR] xrPollEvent called (#%d), queue size=%zu", pollCount, rt::g_eventQueue.size());
+        LogAtf(logging::CatGeneral, logging::Level::Debug, "[SimXR] xrPollEvent called (#%d), queue size=%zu", pollCount, rt::g_eventQueue.size());
     }
     
     if (!b) return XR_ERROR_VALIDATION_FAILURE;
     if (rt::g_eventQueue.empty()) {
         if (pollCount <= 5) {
-            Log("[SimXR] xrPollEvent: No events available (XR_EVENT_UNAVAILABLE)");
+            LogAt(logging::CatGeneral, logging::Level::Debug, "[SimXR] xrPollEvent: No events available (XR_EVENT_UNAVAILABLE)");
         }
         return XR_EVENT_UNAVAILABLE;
     }
@@ -2116,15 +3786,19 @@ static XrResult XRAPI_PTR xrEndSession_runtime(XrSession s) { Log("[SimXR] xrEnd
 static XrResult XRAPI_PTR xrRequestExitSession_runtime(XrSession s) { rt::PushState(s, XR_SESSION_STATE_EXITING); return XR_SUCCESS; }
 static XrResult XRAPI_PTR xrWaitFrame_runtime(XrSession, const XrFrameWaitInfo*, XrFrameState* s) {
     if (!s) return XR_ERROR_VALIDATION_FAILURE;
-    // Message pump so the preview window stays responsive
-    MSG msg; while (PeekMessage(&msg, nullptr, 0, 0, PM_REMOVE)) { TranslateMessage(&msg); DispatchMessage(&msg); }
-    static LARGE_INTEGER freq = [](){ LARGE_INTEGER f; QueryPerformanceFrequency(&f); return f; }();
+    // Message pump so the preview window stays responsive (headless has no window of its own)
+    if (!headless::Enabled()) {
+        timing::ScopedStage pumpTimer(timing::StWaitPump);
+        MSG msg; while (PeekMessage(&msg, nullptr, 0, 0, PM_REMOVE)) { TranslateMessage(&msg); DispatchMessage(&msg); }
+    }
+    // Movement integrates over the period reported by the previous wait
     static double periodSec = 1.0 / 90.0;
-    static long long periodNs = (long long)(periodSec * 1e9);
-    static double nextTick = [](){ LARGE_INTEGER t; QueryPerformanceCounter(&t); return (double)t.QuadPart; }();
-    
-    // Handle WASD keyboard input for movement (relative to head orientation)
-    if (rt::g_session.isFocused) {
+
+    // Handle WASD keyboard input for movement (relative to head orientation); headless runs
+    // take poses only from MCP so a benchmark is not perturbed by whatever has keyboard focus.
+    // A replayed trace sets every input below itself.
+    const bool tracePlayback = trace::Player::Get().Active();
+    if (rt::g_session.isFocused && !headless::Enabled() && !tracePlayback) {
         const float moveSpeed = 3.0f;  // meters per second
         float deltaTime = (float)periodSec;
 
@@ -2335,8 +4009,10 @@ static XrResult XRAPI_PTR xrWaitFrame_runtime(XrSession, const XrFrameWaitInfo*,
 
     }
 
-    // MCP commands work regardless of window focus (file-based IPC)
+    // MCP commands work regardless of window focus (shared-memory channel + legacy files)
     {
+        timing::ScopedStage mcpTimer(timing::StWaitMcp);
+        mcp::PollCommandChannel();
         mcp::HeadPoseCommand cmd = mcp::CheckHeadPoseCommand();
         if (cmd.valid) {
             rt::g_headPos.x = cmd.x;
@@ -2457,6 +4133,27 @@ static XrResult XRAPI_PTR xrWaitFrame_runtime(XrSession, const XrFrameWaitInfo*,
             mcp::WriteCommandAck("pose_sweep", true);
         }
 
+        // Video recording: start (restarting with the requested options) or stop
+        mcp::RecordCommand recordCmd = mcp::CheckRecordCommand();
+        if (recordCmd.valid) {
+            if (recordCmd.start) rt::StartRecording(recordCmd.options);
+            else rt::StopRecording();
+            mcp::WriteCommandAck("record", true);
+        }
+
+        mcp::GLValidationCommand glValidationCmd = mcp::CheckGLValidationCommand();
+        if (glValidationCmd.valid) {
+            glvalidation::Set(glValidationCmd.checks);
+            mcp::WriteCommandAck("gl_validation", true);
+        }
+
+        mcp::StressCommand stressCmd = mcp::CheckStressCommand();
+        if (stressCmd.valid) {
+            stress::Apply(stressCmd.config);
+            if (!stress::Enabled() || stressCmd.config.gpuLoadMs <= 0.0f) stress::ReleaseGpuLoad();
+            mcp::WriteCommandAck("stress", true);
+        }
+
         mcp::ControllerPoseCommand ctrlCmd = mcp::CheckControllerPoseCommand();
         if (ctrlCmd.valid) {
             rt::ControllerState& ctrl = (ctrlCmd.hand == 0) ? rt::g_leftController : rt::g_rightController;
@@ -2476,27 +4173,53 @@ static XrResult XRAPI_PTR xrWaitFrame_runtime(XrSession, const XrFrameWaitInfo*,
         }
     }
 
-    for (;;) {
-        LARGE_INTEGER now; QueryPerformanceCounter(&now);
-        double dt = (nextTick - (double)now.QuadPart) / (double)freq.QuadPart;
-        if (dt <= 0.0) break;
-        double ms = dt * 1000.0;
-        if (ms > 5.0) ms = 5.0;
-        if (ms < 0.0) ms = 0.0;
-        Sleep((DWORD)ms);
-    }
-    nextTick += periodSec * (double)freq.QuadPart;
+    LARGE_INTEGER waitStart; QueryPerformanceCounter(&waitStart);
+    const auto pacingMode = ui::g_uiState.framePacing;
+    auto waitForFrame = [&] {
+        return pacing::FramePacer::Get().Wait(
+            pacingMode == ui::FramePacing::Unlocked ? pacing::Mode::Unlocked :
+            pacingMode == ui::FramePacing::VBlank   ? pacing::Mode::VBlank : pacing::Mode::Fixed,
+            (double)ui::g_uiState.refreshRateHz,
+            pacingMode == ui::FramePacing::VBlank ? rt::PreviewOutputForPacing(rt::g_session) : nullptr);
+    };
+    pacing::FrameTiming paced = waitForFrame();
+    // Stress mode: a missed frame blocks through the next boundaries, as a compositor that fell
+    // behind would (unlocked pacing has no boundaries, so only the display time moves)
+    const stress::FramePlan stressPlan = stress::NextFrame(paced.periodNs);
+    int64_t missedNs = 0;
+    for (uint32_t i = 0; i < stressPlan.extraVsyncs; ++i) {
+        if (pacingMode == ui::FramePacing::Unlocked) {
+            missedNs += paced.periodNs;
+        } else {
+            paced = waitForFrame();
+        }
+    }
+    periodSec = (double)paced.periodNs * 1e-9;
+    rt::g_frameTiming.periodNs = paced.periodNs;
     LARGE_INTEGER now; QueryPerformanceCounter(&now);
+    rt::g_frameTiming.waitMs = rt::QpcDeltaMs(waitStart, now);
+    timing::FrameTimers::Get().Add(timing::StWaitSleep, now.QuadPart - waitStart.QuadPart);
+    rt::g_frameTiming.waitReturn = now;
     // Convert QPC to nanoseconds using double to avoid overflow on MSVC
-    XrTime nowTime = (XrTime)((double)now.QuadPart * 1000000000.0 / (double)freq.QuadPart);
-    s->type = XR_TYPE_FRAME_STATE; s->shouldRender = XR_TRUE; s->predictedDisplayPeriod = periodNs; s->predictedDisplayTime = nowTime + periodNs;
+    const double qpcFreq = (double)pacing::FramePacer::Get().Frequency();
+    XrTime frameTime = (XrTime)((double)paced.qpc * 1000000000.0 / qpcFreq);
+    s->type = XR_TYPE_FRAME_STATE; s->shouldRender = stressPlan.shouldRender ? XR_TRUE : XR_FALSE;
+    s->predictedDisplayPeriod = paced.periodNs;
+    s->predictedDisplayTime = frameTime + paced.periodNs + missedNs;
+    if (tracePlayback) rt::ApplyTraceFrame(s);
+    s->predictedDisplayTime += stressPlan.jitterNs;
+    if (trace::Recorder::Get().Active()) rt::RecordTraceFrame(*s);
+    rt::RecordPoseSample(s->predictedDisplayTime);
+    rt::g_frameTiming.displayTime = s->predictedDisplayTime;
     return XR_SUCCESS;
 }
 static XrResult XRAPI_PTR xrBeginFrame_runtime(XrSession, const XrFrameBeginInfo*) { return XR_SUCCESS; }
 
 static void ensurePreviewSized(rt::Session& s, UINT width, UINT height, DXGI_FORMAT format) {
     if (!s.usesD3D12) {
-        if (s.previewSwapchain && s.previewWidth == width && s.previewHeight == height && s.previewFormat == format) return;
+        // With the compositor thread the swapchain lives on that thread; only the window is ours
+        const bool haveTarget = rt::CompositorThreadActive(s) ? (s.hwnd != nullptr) : (bool)s.previewSwapchain;
+        if (haveTarget && s.previewWidth == width && s.previewHeight == height && s.previewFormat == format) return;
     } else {
         if (s.previewRT12 && s.previewWidth == width && s.previewHeight == height && s.previewFormat == format) return;
     }
@@ -2504,7 +4227,7 @@ static void ensurePreviewSized(rt::Session& s, UINT width, UINT height, DXGI_FOR
     // IMPORTANT: Release ALL swapchain references before creating a new one
     // DXGI only allows one swapchain per window
     s.previewSwapchain.Reset();
-    rt::ResetD3D12PreviewResources(s);
+    rt::ResetD3D12PreviewResources(s, true);
     {
         std::lock_guard<std::mutex> lock(rt::g_windowMutex);
         rt::g_persistentSwapchain.Reset();
@@ -2605,6 +4328,7 @@ static void ensurePreviewSized(rt::Session& s, UINT width, UINT height, DXGI_FOR
         Logf("[SimXR] Resized preview window: hwnd=%p size=%ux%u", s.hwnd, width, height);
     }
     if (!s.usesD3D12) {
+        if (rt::CompositorThreadActive(s)) return;
         ComPtr<IDXGIDevice> dxgiDev; s.d3d11Device.As(&dxgiDev);
         ComPtr<IDXGIAdapter> adapter; dxgiDev->GetAdapter(adapter.GetAddressOf());
         ComPtr<IDXGIFactory2> factory; adapter->GetParent(IID_PPV_ARGS(factory.GetAddressOf()));
@@ -2640,27 +4364,59 @@ static void ensurePreviewSized(rt::Session& s, UINT width, UINT height, DXGI_FOR
             Log("[SimXR] DX12 preview: Created command queue + cross-queue fence");
         }
 
-        // Create offscreen render target
+        // Create the window-sized offscreen render target. BGRA is what GDI consumes, and
+        // typeless so both UNORM and UNORM_SRGB RTVs can write it.
         D3D12_RESOURCE_DESC rtDesc = {};
         rtDesc.Dimension = D3D12_RESOURCE_DIMENSION_TEXTURE2D;
         rtDesc.Width = width;
         rtDesc.Height = height;
         rtDesc.DepthOrArraySize = 1;
         rtDesc.MipLevels = 1;
-        rtDesc.Format = format;
+        rtDesc.Format = DXGI_FORMAT_B8G8R8A8_TYPELESS;
         rtDesc.SampleDesc.Count = 1;
         rtDesc.Layout = D3D12_TEXTURE_LAYOUT_UNKNOWN;
-        rtDesc.Flags = D3D12_RESOURCE_FLAG_NONE;
+        rtDesc.Flags = D3D12_RESOURCE_FLAG_ALLOW_RENDER_TARGET;
         D3D12_HEAP_PROPERTIES defaultHeap = {};
         defaultHeap.Type = D3D12_HEAP_TYPE_DEFAULT;
+        D3D12_CLEAR_VALUE rtClear = {};
+        rtClear.Format = DXGI_FORMAT_B8G8R8A8_UNORM;
+        rtClear.Color[0] = 0.1f; rtClear.Color[1] = 0.1f; rtClear.Color[2] = 0.2f; rtClear.Color[3] = 1.0f;
         HRESULT hr = s.d3d12Device->CreateCommittedResource(&defaultHeap, D3D12_HEAP_FLAG_NONE,
-            &rtDesc, D3D12_RESOURCE_STATE_COMMON, nullptr, IID_PPV_ARGS(s.previewRT12.GetAddressOf()));
+            &rtDesc, D3D12_RESOURCE_STATE_COMMON, &rtClear, IID_PPV_ARGS(s.previewRT12.GetAddressOf()));
         if (FAILED(hr)) {
             Logf("[SimXR] DX12 preview: CreateCommittedResource (RT) failed 0x%08X", (unsigned)hr);
             return;
         }
 
-        // Create readback buffer (aligned row pitch)
+        // RTVs ([0] UNORM, [1] UNORM_SRGB) and the per-slot shader-visible SRV ranges
+        D3D12_DESCRIPTOR_HEAP_DESC rtvHeapDesc = {};
+        rtvHeapDesc.Type = D3D12_DESCRIPTOR_HEAP_TYPE_RTV;
+        rtvHeapDesc.NumDescriptors = 2;
+        D3D12_DESCRIPTOR_HEAP_DESC srvHeapDesc = {};
+        srvHeapDesc.Type = D3D12_DESCRIPTOR_HEAP_TYPE_CBV_SRV_UAV;
+        srvHeapDesc.NumDescriptors = rt::Session::kPreviewSlots * rt::Session::kPreviewSrvsPerSlot;
+        srvHeapDesc.Flags = D3D12_DESCRIPTOR_HEAP_FLAG_SHADER_VISIBLE;
+        hr = s.d3d12Device->CreateDescriptorHeap(&rtvHeapDesc, IID_PPV_ARGS(s.previewRtvHeap12.GetAddressOf()));
+        if (SUCCEEDED(hr)) {
+            hr = s.d3d12Device->CreateDescriptorHeap(&srvHeapDesc, IID_PPV_ARGS(s.previewSrvHeap12.GetAddressOf()));
+        }
+        if (FAILED(hr)) {
+            Logf("[SimXR] DX12 preview: CreateDescriptorHeap failed 0x%08X", (unsigned)hr);
+            rt::ResetD3D12PreviewResources(s, true);
+            return;
+        }
+        s.previewRtvStride12 = s.d3d12Device->GetDescriptorHandleIncrementSize(D3D12_DESCRIPTOR_HEAP_TYPE_RTV);
+        s.previewSrvStride12 = s.d3d12Device->GetDescriptorHandleIncrementSize(D3D12_DESCRIPTOR_HEAP_TYPE_CBV_SRV_UAV);
+        D3D12_CPU_DESCRIPTOR_HANDLE rtvHandle = s.previewRtvHeap12->GetCPUDescriptorHandleForHeapStart();
+        for (uint32_t i = 0; i < 2; ++i) {
+            D3D12_RENDER_TARGET_VIEW_DESC rtvDesc = {};
+            rtvDesc.Format = i ? DXGI_FORMAT_B8G8R8A8_UNORM_SRGB : DXGI_FORMAT_B8G8R8A8_UNORM;
+            rtvDesc.ViewDimension = D3D12_RTV_DIMENSION_TEXTURE2D;
+            s.d3d12Device->CreateRenderTargetView(s.previewRT12.Get(), &rtvDesc, rtvHandle);
+            rtvHandle.ptr += s.previewRtvStride12;
+        }
+
+        // Create one readback buffer + allocator per ring slot (aligned row pitch)
         UINT rowPitch = ((width * 4 + D3D12_TEXTURE_DATA_PITCH_ALIGNMENT - 1)
                         / D3D12_TEXTURE_DATA_PITCH_ALIGNMENT) * D3D12_TEXTURE_DATA_PITCH_ALIGNMENT;
         s.previewReadbackPitch = rowPitch;
@@ -2675,12 +4431,35 @@ static void ensurePreviewSized(rt::Session& s, UINT width, UINT height, DXGI_FOR
         readbackDesc.Layout = D3D12_TEXTURE_LAYOUT_ROW_MAJOR;
         D3D12_HEAP_PROPERTIES readbackHeap = {};
         readbackHeap.Type = D3D12_HEAP_TYPE_READBACK;
-        hr = s.d3d12Device->CreateCommittedResource(&readbackHeap, D3D12_HEAP_FLAG_NONE,
-            &readbackDesc, D3D12_RESOURCE_STATE_COPY_DEST, nullptr, IID_PPV_ARGS(s.previewReadback12.GetAddressOf()));
-        if (FAILED(hr)) {
-            Logf("[SimXR] DX12 preview: CreateCommittedResource (readback) failed 0x%08X", (unsigned)hr);
-            s.previewRT12.Reset();
-            return;
+        for (uint32_t i = 0; i < rt::Session::kPreviewSlots; ++i) {
+            auto& slot = s.previewSlots12[i];
+            hr = s.d3d12Device->CreateCommittedResource(&readbackHeap, D3D12_HEAP_FLAG_NONE,
+                &readbackDesc, D3D12_RESOURCE_STATE_COPY_DEST, nullptr, IID_PPV_ARGS(slot.readback.GetAddressOf()));
+            if (SUCCEEDED(hr)) {
+                hr = s.d3d12Device->CreateCommandAllocator(D3D12_COMMAND_LIST_TYPE_DIRECT,
+                    IID_PPV_ARGS(slot.cmdAlloc.GetAddressOf()));
+            }
+            if (FAILED(hr)) {
+                Logf("[SimXR] DX12 preview: slot %u readback/allocator creation failed 0x%08X", i, (unsigned)hr);
+                rt::ResetD3D12PreviewResources(s, true);
+                return;
+            }
+        }
+
+        // Timestamp queries for the copy work (optional: the preview works without them)
+        D3D12_QUERY_HEAP_DESC qhd = {};
+        qhd.Type = D3D12_QUERY_HEAP_TYPE_TIMESTAMP;
+        qhd.Count = rt::Session::kPreviewSlots * 2;
+        D3D12_RESOURCE_DESC tsDesc = readbackDesc;
+        tsDesc.Width = (UINT64)rt::Session::kPreviewSlots * 16;
+        if (FAILED(s.previewQueue12->GetTimestampFrequency(&s.previewTimestampFreq)) ||
+            FAILED(s.d3d12Device->CreateQueryHeap(&qhd, IID_PPV_ARGS(s.previewTimestampHeap.GetAddressOf()))) ||
+            FAILED(s.d3d12Device->CreateCommittedResource(&readbackHeap, D3D12_HEAP_FLAG_NONE, &tsDesc,
+                D3D12_RESOURCE_STATE_COPY_DEST, nullptr, IID_PPV_ARGS(s.previewTimestampReadback.GetAddressOf())))) {
+            Log("[SimXR] DX12 preview: timestamp queries unavailable; GPU copy timing disabled");
+            s.previewTimestampHeap.Reset();
+            s.previewTimestampReadback.Reset();
+            s.previewTimestampFreq = 0;
         }
 
         // Command allocator/list
@@ -2691,7 +4470,9 @@ static void ensurePreviewSized(rt::Session& s, UINT width, UINT height, DXGI_FOR
         s.d3d12Device->CreateFence(0, D3D12_FENCE_FLAG_NONE, IID_PPV_ARGS(s.previewFence.GetAddressOf()));
         s.previewFenceValue = 1;
         s.previewFenceEvent = CreateEvent(nullptr, FALSE, FALSE, nullptr);
-        Logf("[SimXR] DX12 preview: GDI-based rendering initialized (%ux%u, pitch=%u)", width, height, rowPitch);
+        Logf("[SimXR] DX12 preview: GPU composition + GDI paint initialized (%ux%u, pitch=%u, %u readback slots, %s)",
+             width, height, rowPitch, rt::Session::kPreviewSlots,
+             ui::g_uiState.lowLatencyPreview ? "low-latency" : "pipelined");
         return;
     }
 }
@@ -2703,11 +4484,23 @@ static void blitViewToHalf(rt::Session& s, rt::Swapchain& chain, uint32_t srcInd
         Log("[SimXR] blitViewToHalf: rtv is null!");
         return;
     }
+#ifdef XR_USE_GRAPHICS_API_VULKAN
+    // Unshared Vulkan images (unmapped formats, no interop) have no D3D11 side to sample
+    if (chain.backend == rt::Swapchain::Backend::Vulkan && !chain.vk.shared) {
+        static bool logged = false;
+        if (!logged) {
+            Logf("[SimXR] blitViewToHalf: Vulkan swapchain %p has unshared images; not previewed", chain.handle);
+            logged = true;
+        }
+        return;
+    }
+#endif
 
     if (!rt::InitBlitResources(s)) {
         Log("[SimXR] Cannot blit, blit resources failed to initialize.");
         return;
     }
+    rt::GpuScope11 gpuTimer(s, timing::StGpuBlit);
 
     // Check if we have a valid image
     if (srcIndex >= chain.images.size()) {
@@ -2742,56 +4535,9 @@ static void blitViewToHalf(rt::Session& s, rt::Swapchain& chain, uint32_t srcInd
         return;
     }
     
-    // Choose a typed format for SRV and temp texture  
-    // Preserve sRGB if original was sRGB to enable auto-conversion
-    DXGI_FORMAT typedFormat = srcDesc.Format;
-    switch (srcDesc.Format) {
-        case DXGI_FORMAT_R8G8B8A8_TYPELESS:
-            typedFormat = (chain.format == DXGI_FORMAT_R8G8B8A8_UNORM_SRGB) ? DXGI_FORMAT_R8G8B8A8_UNORM_SRGB : DXGI_FORMAT_R8G8B8A8_UNORM;
-            break;
-        case DXGI_FORMAT_B8G8R8A8_TYPELESS:
-            typedFormat = (chain.format == DXGI_FORMAT_B8G8R8A8_UNORM_SRGB) ? DXGI_FORMAT_B8G8R8A8_UNORM_SRGB : DXGI_FORMAT_B8G8R8A8_UNORM;
-            break;
-        case DXGI_FORMAT_R16G16B16A16_TYPELESS: 
-            typedFormat = DXGI_FORMAT_R16G16B16A16_FLOAT; 
-            break;
-        case DXGI_FORMAT_R32G32B32A32_TYPELESS: 
-            typedFormat = DXGI_FORMAT_R32G32B32A32_FLOAT; 
-            break;
-        case DXGI_FORMAT_R10G10B10A2_TYPELESS: 
-            typedFormat = DXGI_FORMAT_R10G10B10A2_UNORM; 
-            break;
-        default: 
-            break; // Already typed or unknown
-    }
-    
-    
-    // ALWAYS create a temp texture to avoid SRV/RTV binding conflicts
-    // The app may still have this texture bound as an RTV, and D3D11 will null the SRV if we try to use it directly
-    ComPtr<ID3D11Texture2D> viewTexture;
-    
-    // Always make an SRV-only single-slice, single-sample texture
-    // Use the typed format to avoid CreateShaderResourceView failures
-    D3D11_TEXTURE2D_DESC tempDesc = {};
-    tempDesc.Width = srcDesc.Width;
-    tempDesc.Height = srcDesc.Height;
-    tempDesc.MipLevels = 1;
-    tempDesc.ArraySize = 1;
-    tempDesc.Format = typedFormat;  // Make temp texture in same format as SRV (may be *_SRGB)
-    tempDesc.SampleDesc.Count = 1;
-    tempDesc.SampleDesc.Quality = 0;
-    tempDesc.BindFlags = D3D11_BIND_SHADER_RESOURCE;
-    tempDesc.Usage = D3D11_USAGE_DEFAULT;
-    tempDesc.CPUAccessFlags = 0;
-    tempDesc.MiscFlags = 0;
-
-    HRESULT hr = s.d3d11Device->CreateTexture2D(&tempDesc, nullptr, viewTexture.GetAddressOf());
-    if (FAILED(hr)) {
-        Logf("[SimXR] Failed to create temp texture for blit: 0x%08X", hr);
-        return;
-    }
+    // Choose a typed format for the SRV; preserve sRGB if the swapchain was sRGB
+    DXGI_FORMAT typedFormat = rt::TypedViewFormat(srcDesc.Format, chain.format);
 
-    // Copy the correct subresource (handles array slice)
     UINT srcSubresource = D3D11CalcSubresource(0, arraySlice, chain.mipCount);
     
     // Handle imageRect cropping for better visual accuracy
@@ -2824,19 +4570,17 @@ static void blitViewToHalf(rt::Session& s, rt::Swapchain& chain, uint32_t srcInd
                       srcDesc.SampleDesc.Count == 1 &&
                       rectValid &&
                       (rectW < srcW || rectH < srcH || rectX != 0 || rectY != 0);
-    if (shouldCrop) {
-        
-        // Recreate temp texture with rect size for cropped copying
-        tempDesc.Width  = rectW;
-        tempDesc.Height = rectH;
-        tempDesc.Format = typedFormat;  // Ensure format stays correct
-        viewTexture.Reset();
-        HRESULT hr = s.d3d11Device->CreateTexture2D(&tempDesc, nullptr, viewTexture.GetAddressOf());
-        if (FAILED(hr)) {
-            Logf("[SimXR] Failed to create cropped temp texture: 0x%08X", hr);
-            return;
-        }
-        
+
+    // Sample the released image in place when nothing needs cropping, resolving or slicing;
+    // otherwise copy into the cached single-slice texture for this image
+    const UINT viewW = shouldCrop ? (UINT)rectW : srcDesc.Width;
+    const UINT viewH = shouldCrop ? (UINT)rectH : srcDesc.Height;
+    rt::Swapchain::BlitView* view = rt::GetBlitView(s, chain, srcIndex, arraySlice, typedFormat, !shouldCrop, viewW, viewH);
+    if (!view) return;
+
+    if (view->direct) {
+        // Nothing to copy
+    } else if (shouldCrop) {
         // Copy only the specified rect
         D3D11_BOX box{};
         box.left = rectX;
@@ -2846,48 +4590,48 @@ static void blitViewToHalf(rt::Session& s, rt::Swapchain& chain, uint32_t srcInd
         box.front = 0; 
         box.back = 1;
         
-        s.d3d11Context->CopySubresourceRegion(viewTexture.Get(), 0, 0, 0, 0, sourceTexture.Get(), srcSubresource, &box);
-        
-        if (rectClamped) {
-            Logf("[SimXR] Applied clamped imageRect: %dx%d from (%d,%d)",
-                 rectW, rectH, rectX, rectY);
-        } else {
-            Logf("[SimXR] Applied imageRect cropping: %dx%d from (%d,%d)",
-                 rectW, rectH, rectX, rectY);
+        s.d3d11Context->CopySubresourceRegion(view->copy.Get(), 0, 0, 0, 0, sourceTexture.Get(), srcSubresource, &box);
+
+        static int cropLogCount = 0;
+        if (++cropLogCount % 120 == 1) {
+            LogAtf(logging::CatFrame, logging::Level::Debug, "[SimXR] Applied %simageRect cropping: %dx%d from (%d,%d)",
+                   rectClamped ? "clamped " : "", rectW, rectH, rectX, rectY);
         }
     } else {
         // Copy full texture or handle MSAA
         if (srcDesc.SampleDesc.Count > 1) {
             // If app used MSAA, resolve it first using the typed format
-            s.d3d11Context->ResolveSubresource(viewTexture.Get(), 0, sourceTexture.Get(), srcSubresource, typedFormat);
+            s.d3d11Context->ResolveSubresource(view->copy.Get(), 0, sourceTexture.Get(), srcSubresource, typedFormat);
         } else {
-            // Otherwise just copy the full texture
-            s.d3d11Context->CopySubresourceRegion(viewTexture.Get(), 0, 0, 0, 0, sourceTexture.Get(), srcSubresource, nullptr);
+            // Otherwise just copy the slice
+            s.d3d11Context->CopySubresourceRegion(view->copy.Get(), 0, 0, 0, 0, sourceTexture.Get(), srcSubresource, nullptr);
         }
     }
 
-    // Create Shader Resource View
-    D3D11_SHADER_RESOURCE_VIEW_DESC srvDesc = {};
-    srvDesc.Format = typedFormat; // Use the proper typed format
-    srvDesc.ViewDimension = D3D11_SRV_DIMENSION_TEXTURE2D;
-    srvDesc.Texture2D.MipLevels = 1;
-    srvDesc.Texture2D.MostDetailedMip = 0;
-
-    ComPtr<ID3D11ShaderResourceView> srv;
-    hr = s.d3d11Device->CreateShaderResourceView(viewTexture.Get(), &srvDesc, srv.GetAddressOf());
-    if (FAILED(hr)) {
-        Logf("[SimXR] Failed to create SRV: 0x%08X", hr);
-        return;
-    }
-
     s.d3d11Context->RSSetViewports(1, &vp);
 
     // Set shaders and resources
     s.d3d11Context->VSSetShader(s.blitVS.Get(), nullptr, 0);
     s.d3d11Context->PSSetShader(s.blitPS.Get(), nullptr, 0);
 
-    ID3D11ShaderResourceView* srvs[] = { srv.Get() };
+    // Bind the render target first: it replaces the app's RTVs, so a direct view of an image
+    // the app left bound as a render target isn't nulled when we bind it as an SRV
+    ID3D11RenderTargetView* rtvs[1] = { rtv };
+    s.d3d11Context->OMSetRenderTargets(1, rtvs, nullptr);
+
+    ID3D11ShaderResourceView* srvs[] = { view->srv.Get() };
     s.d3d11Context->PSSetShaderResources(0, 1, srvs);
+    if (view->direct) {
+        // Still bound as an output elsewhere (e.g. a UAV): D3D11 refused the SRV. Copy from now on.
+        ComPtr<ID3D11ShaderResourceView> bound;
+        s.d3d11Context->PSGetShaderResources(0, 1, bound.GetAddressOf());
+        if (!bound) {
+            Logf("[SimXR] blitViewToHalf: image %u is bound as an output; falling back to a copy", srcIndex);
+            view->directFailed = true;
+            view->srv.Reset();
+            return;
+        }
+    }
     ID3D11SamplerState* samplers[] = { s.samplerState.Get() };
     s.d3d11Context->PSSetSamplers(0, 1, samplers);
 
@@ -2898,10 +4642,6 @@ static void blitViewToHalf(rt::Session& s, rt::Swapchain& chain, uint32_t srcInd
     s.d3d11Context->OMSetDepthStencilState(nullptr, 0);
     s.d3d11Context->RSSetState(s.noCullRS.Get());  // Use no-cull rasterizer state to prevent triangle culling
 
-    // Bind render target
-    ID3D11RenderTargetView* rtvs[1] = { rtv };
-    s.d3d11Context->OMSetRenderTargets(1, rtvs, nullptr);
-
     // Draw fullscreen quad
     s.d3d11Context->Draw(4, 0);
     
@@ -2911,291 +4651,968 @@ static void blitViewToHalf(rt::Session& s, rt::Swapchain& chain, uint32_t srcInd
     
     static int debugCount = 0;
     if (++debugCount % 120 == 1) {
-        Logf("[SimXR] blitViewToHalf: srcIdx=%u slice=%u typedFmt=%d srcFmt=%d",
+        LogAtf(logging::CatFrame, logging::Level::Debug, "[SimXR] blitViewToHalf: srcIdx=%u slice=%u typedFmt=%d srcFmt=%d",
              srcIndex, arraySlice, typedFormat, srcDesc.Format);
-        Logf("[SimXR]   viewport: x=%.0f y=%.0f w=%.0f h=%.0f", vp.TopLeftX, vp.TopLeftY, vp.Width, vp.Height);
-        Logf("[SimXR]   srcSize: %ux%u, tempSize: %ux%u", srcDesc.Width, srcDesc.Height, tempDesc.Width, tempDesc.Height);
+        LogAtf(logging::CatFrame, logging::Level::Debug, "[SimXR]   viewport: x=%.0f y=%.0f w=%.0f h=%.0f", vp.TopLeftX, vp.TopLeftY, vp.Width, vp.Height);
+        LogAtf(logging::CatFrame, logging::Level::Debug, "[SimXR]   srcSize: %ux%u, viewSize: %ux%u (%s)", srcDesc.Width, srcDesc.Height,
+               viewW, viewH, view->direct ? "direct" : "copy");
     }
 }
 
-// D3D12 blit function - copies swapchain textures to offscreen RT, reads back to CPU, paints via GDI.
+// D3D12 preview: views and layers are drawn scaled into the window-sized previewRT12, which is
+// read back and painted via GDI. Recorded in three steps so layers can be drawn after the eyes:
+// BeginD3D12Preview (claim a ring slot, clear), DrawD3D12Image (per view / layer), and
+// FinishD3D12Preview (readback, submit, paint the newest retired slot).
 // Uses GDI instead of DXGI Present to avoid hook conflicts with Steam overlay / UEVR.
-static void blitD3D12ToPreview(rt::Session& s,
-                                rt::Swapchain& chainL, uint32_t leftIdx, uint32_t leftSlice,
-                                rt::Swapchain* chainR, uint32_t rightIdx, uint32_t rightSlice,
-                                ui::DisplayLayout layout, ui::ViewMode viewMode) {
-    if (!s.previewRT12 || !s.previewReadback12 || !s.previewCmdList || !s.previewCmdAlloc) {
+static bool BeginD3D12Preview(rt::Session& s, bool anaglyph) {
+    const uint32_t slotIndex = s.previewSlotNext;
+    auto& slot = s.previewSlots12[slotIndex];
+    if (!s.previewRT12 || !slot.readback || !slot.cmdAlloc || !s.previewCmdList ||
+        !s.previewRtvHeap12 || !s.previewSrvHeap12) {
         Log("[SimXR] blitD3D12ToPreview: Missing D3D12 preview resources");
-        return;
+        return false;
     }
-
-    // Skip depth-only swapchains
-    bool isDepthFormat = (chainL.format == DXGI_FORMAT_D32_FLOAT ||
-                          chainL.format == DXGI_FORMAT_D32_FLOAT_S8X24_UINT ||
-                          chainL.format == DXGI_FORMAT_D24_UNORM_S8_UINT ||
-                          chainL.format == DXGI_FORMAT_D16_UNORM);
-    if (isDepthFormat) {
-        return;
+    if (!rt::GetBlitPSO12(s, rt::Session::BlendOpaque, false, false)) return false;
+
+    // Cross-queue sync: make the preview queue wait for the game queue to finish rendering
+    // the projection and layer images before the draws that sample them. One signal covers
+    // every image the frame samples, since they were all released before xrEndFrame.
+    if (s.crossQueueFence) {
+        s.crossQueueFenceValue++;
+        s.d3d12Queue->Signal(s.crossQueueFence.Get(), s.crossQueueFenceValue);
+        s.previewQueue12->Wait(s.crossQueueFence.Get(), s.crossQueueFenceValue);
     }
 
-    // Wait for previous frame to finish
-    if (s.previewFence->GetCompletedValue() < s.previewFenceValue - 1) {
-        s.previewFence->SetEventOnCompletion(s.previewFenceValue - 1, s.previewFenceEvent);
+    // Reusing a slot requires its previous work to have retired. With kPreviewSlots
+    // in the ring this only blocks if the GPU is more than two frames behind.
+    if (slot.fenceValue != 0 && s.previewFence->GetCompletedValue() < slot.fenceValue) {
+        timing::ScopedStage waitTimer(timing::StD3D12FenceWait);
+        s.previewFence->SetEventOnCompletion(slot.fenceValue, s.previewFenceEvent);
         WaitForSingleObject(s.previewFenceEvent, 1000);
     }
+    ResolveD3D12Timestamps(s);
+    rt::ResolveD3D12Screenshots(s);
 
-    ID3D12Resource* renderTarget = s.previewRT12.Get();
+    timing::ScopedStage submitTimer(timing::StD3D12Submit);
 
-    // Reset command allocator and list
-    HRESULT hr = s.previewCmdAlloc->Reset();
+    // Reset this slot's allocator; the shared list can be re-recorded once it was closed
+    HRESULT hr = slot.cmdAlloc->Reset();
     if (FAILED(hr)) {
         Logf("[SimXR] blitD3D12ToPreview: CmdAlloc Reset failed 0x%08X", hr);
-        return;
+        return false;
     }
-    hr = s.previewCmdList->Reset(s.previewCmdAlloc.Get(), nullptr);
+    hr = s.previewCmdList->Reset(slot.cmdAlloc.Get(), nullptr);
     if (FAILED(hr)) {
         Logf("[SimXR] blitD3D12ToPreview: CmdList Reset failed 0x%08X", hr);
-        return;
+        return false;
+    }
+    if (s.previewTimestampHeap) {
+        s.previewCmdList->EndQuery(s.previewTimestampHeap.Get(), D3D12_QUERY_TYPE_TIMESTAMP, slotIndex * 2);
     }
 
-    // Transition offscreen RT to copy dest (COMMON → COPY_DEST via implicit promotion)
     D3D12_RESOURCE_BARRIER barrier = {};
     barrier.Type = D3D12_RESOURCE_BARRIER_TYPE_TRANSITION;
-    barrier.Transition.pResource = renderTarget;
+    barrier.Transition.pResource = s.previewRT12.Get();
     barrier.Transition.StateBefore = D3D12_RESOURCE_STATE_COMMON;
-    barrier.Transition.StateAfter = D3D12_RESOURCE_STATE_COPY_DEST;
+    barrier.Transition.StateAfter = D3D12_RESOURCE_STATE_RENDER_TARGET;
     barrier.Transition.Subresource = D3D12_RESOURCE_BARRIER_ALL_SUBRESOURCES;
     s.previewCmdList->ResourceBarrier(1, &barrier);
 
-    auto transition = [&](ID3D12Resource* res, D3D12_RESOURCE_STATES& state, D3D12_RESOURCE_STATES newState) {
-        if (!res || state == newState) return;
+    const float clearColorDefault[4] = {0.1f, 0.1f, 0.2f, 1.0f};
+    const float clearColorAnaglyph[4] = {0.0f, 0.0f, 0.0f, 1.0f};
+    s.previewCmdList->ClearRenderTargetView(s.previewRtvHeap12->GetCPUDescriptorHandleForHeapStart(),
+                                            anaglyph ? clearColorAnaglyph : clearColorDefault, 0, nullptr);
+
+    ID3D12DescriptorHeap* heaps[] = { s.previewSrvHeap12.Get() };
+    s.previewCmdList->SetDescriptorHeaps(1, heaps);
+    s.previewCmdList->SetGraphicsRootSignature(s.blitRootSig12.Get());
+    s.previewCmdList->IASetPrimitiveTopology(D3D_PRIMITIVE_TOPOLOGY_TRIANGLESTRIP);
+    s.previewSrvUsed12 = 0;
+    s.previewRecording12 = true;
+    return true;
+}
+
+// Draw one slice of a swapchain image into each of vpCount viewports, sharing one descriptor.
+// rect is the sub-image to sample (nullptr or Tools > Show Full Render: the whole image).
+static bool DrawD3D12Image(rt::Session& s, rt::Swapchain& chain, uint32_t idx, uint32_t slice,
+                           const XrRect2Di* rect, const D3D12_VIEWPORT* vps, uint32_t vpCount,
+                           uint32_t blend, const char* label) {
+    if (vpCount == 0) return false;
+    if (!s.previewRecording12) return false;
+    if (idx >= chain.images12.size() || !chain.images12[idx]) return false;
+    if (chain.imageStates12.size() <= idx) {
+        Logf("[SimXR] blitD3D12ToPreview: %s missing state tracking", label);
+        return false;
+    }
+    if (chain.format == DXGI_FORMAT_D32_FLOAT || chain.format == DXGI_FORMAT_D32_FLOAT_S8X24_UINT ||
+        chain.format == DXGI_FORMAT_D24_UNORM_S8_UINT || chain.format == DXGI_FORMAT_D16_UNORM) {
+        return false;  // depth swapchains aren't previewable
+    }
+    ID3D12Resource* srcTex = chain.images12[idx].Get();
+    D3D12_RESOURCE_DESC srcDesc = srcTex->GetDesc();
+    if (srcDesc.SampleDesc.Count > 1) {
+        static bool loggedMsaa = false;
+        if (!loggedMsaa) {
+            Logf("[SimXR] blitD3D12ToPreview: %s is multisampled (%u); not previewed", label, srcDesc.SampleDesc.Count);
+            loggedMsaa = true;
+        }
+        return false;
+    }
+    if (slice >= srcDesc.DepthOrArraySize) {
+        Logf("[SimXR] blitD3D12ToPreview: %s slice %u out of range (arraySize=%u)", label, slice, (unsigned)srcDesc.DepthOrArraySize);
+        return false;
+    }
+    if (s.previewSrvUsed12 >= rt::Session::kPreviewSrvsPerSlot) return false;
+
+    const DXGI_FORMAT viewFormat = rt::TypedViewFormat(srcDesc.Format, chain.format);
+    const bool srgb = rt::IsSrgbFormat(viewFormat);
+    const bool arraySource = srcDesc.DepthOrArraySize > 1;
+    ID3D12PipelineState* pso = rt::GetBlitPSO12(s, blend, srgb, arraySource);
+    if (!pso) return false;
+
+    // This slot's descriptor range; the slot isn't re-recorded until its fence has passed
+    const UINT descriptor = s.previewSlotNext * rt::Session::kPreviewSrvsPerSlot + s.previewSrvUsed12++;
+    D3D12_CPU_DESCRIPTOR_HANDLE srvCpu = s.previewSrvHeap12->GetCPUDescriptorHandleForHeapStart();
+    D3D12_GPU_DESCRIPTOR_HANDLE srvGpu = s.previewSrvHeap12->GetGPUDescriptorHandleForHeapStart();
+    srvCpu.ptr += (SIZE_T)descriptor * s.previewSrvStride12;
+    srvGpu.ptr += (UINT64)descriptor * s.previewSrvStride12;
+    D3D12_SHADER_RESOURCE_VIEW_DESC srvDesc = {};
+    srvDesc.Format = viewFormat;
+    srvDesc.Shader4ComponentMapping = D3D12_DEFAULT_SHADER_4_COMPONENT_MAPPING;
+    if (arraySource) {
+        srvDesc.ViewDimension = D3D12_SRV_DIMENSION_TEXTURE2DARRAY;
+        srvDesc.Texture2DArray.MipLevels = 1;
+        srvDesc.Texture2DArray.FirstArraySlice = slice;
+        srvDesc.Texture2DArray.ArraySize = 1;
+    } else {
+        srvDesc.ViewDimension = D3D12_SRV_DIMENSION_TEXTURE2D;
+        srvDesc.Texture2D.MipLevels = 1;
+    }
+    s.d3d12Device->CreateShaderResourceView(srcTex, &srvDesc, srvCpu);
+    // FinishD3D12Preview signals previewFenceValue after this frame's draws
+    if (idx < chain.readFence12.size()) chain.readFence12[idx] = s.previewFenceValue;
+
+    // Sample only the submitted sub-image unless the full render is requested
+    float uv[4] = { 0.0f, 0.0f, 1.0f, 1.0f };  // offset.xy, scale.xy
+    const int32_t srcW = (int32_t)srcDesc.Width;
+    const int32_t srcH = (int32_t)srcDesc.Height;
+    if (rect && !ui::g_uiState.showFullRender && rect->extent.width > 0 && rect->extent.height > 0) {
+        int32_t x = std::max(rect->offset.x, 0);
+        int32_t y = std::max(rect->offset.y, 0);
+        int32_t w = std::min(rect->extent.width, srcW - x);
+        int32_t h = std::min(rect->extent.height, srcH - y);
+        if (w > 0 && h > 0) {
+            uv[0] = (float)x / (float)srcW;
+            uv[1] = (float)y / (float)srcH;
+            uv[2] = (float)w / (float)srcW;
+            uv[3] = (float)h / (float)srcH;
+        }
+    }
+
+    auto transition = [&](D3D12_RESOURCE_STATES newState) {
+        D3D12_RESOURCE_STATES& state = chain.imageStates12[idx];
+        if (state == newState) return;
         D3D12_RESOURCE_BARRIER b = {};
         b.Type = D3D12_RESOURCE_BARRIER_TYPE_TRANSITION;
-        b.Transition.pResource = res;
+        b.Transition.pResource = srcTex;
         b.Transition.StateBefore = state;
         b.Transition.StateAfter = newState;
         b.Transition.Subresource = D3D12_RESOURCE_BARRIER_ALL_SUBRESOURCES;
         s.previewCmdList->ResourceBarrier(1, &b);
         state = newState;
     };
+    // From COMMON (reset on release) to shader resource, and back so the app can use
+    // implicit promotion next frame
+    transition(D3D12_RESOURCE_STATE_PIXEL_SHADER_RESOURCE);
+
+    D3D12_CPU_DESCRIPTOR_HANDLE rtv = s.previewRtvHeap12->GetCPUDescriptorHandleForHeapStart();
+    if (srgb) rtv.ptr += s.previewRtvStride12;
+    s.previewCmdList->OMSetRenderTargets(1, &rtv, FALSE, nullptr);
+    s.previewCmdList->SetPipelineState(pso);
+    s.previewCmdList->SetGraphicsRoot32BitConstants(0, 4, uv, 0);
+    s.previewCmdList->SetGraphicsRootDescriptorTable(1, srvGpu);
+    for (uint32_t i = 0; i < vpCount; ++i) {
+        const D3D12_VIEWPORT& vp = vps[i];
+        D3D12_RECT scissor = { (LONG)vp.TopLeftX, (LONG)vp.TopLeftY,
+                               (LONG)(vp.TopLeftX + vp.Width), (LONG)(vp.TopLeftY + vp.Height) };
+        s.previewCmdList->RSSetViewports(1, &vp);
+        s.previewCmdList->RSSetScissorRects(1, &scissor);
+        s.previewCmdList->DrawInstanced(4, 1, 0, 0);
+    }
 
-    auto calcSubresource = [](const rt::Swapchain& chain, uint32_t slice, const char* label) -> UINT {
-        uint32_t arraySize = chain.arraySize ? chain.arraySize : 1;
-        uint32_t mipLevels = chain.mipCount ? chain.mipCount : 1;
-        if (slice >= arraySize) {
-            Logf("[SimXR] blitD3D12ToPreview: %s slice %u out of range (arraySize=%u)", label, slice, arraySize);
-            return UINT_MAX;
-        }
-        return D3D12CalcSubresource(0, slice, 0, mipLevels, arraySize);
-    };
+    transition(D3D12_RESOURCE_STATE_COMMON);
+    return true;
+}
+
+// What the stereo analyzer can read from a preview composed with this view mode and layout
+static stereo::Layout PreviewStereoLayout(ui::ViewMode viewMode, ui::DisplayLayout layout) {
+    if (viewMode != ui::ViewMode::BothEyes) return stereo::Layout::Single;
+    if (layout == ui::DisplayLayout::SideBySide) return stereo::Layout::SideBySide;
+    if (layout == ui::DisplayLayout::OverUnder) return stereo::Layout::OverUnder;
+    return stereo::Layout::None;
+}
 
-    // Get render target dimensions for clipping (CopyTextureRegion doesn't scale)
+static void FinishD3D12Preview(rt::Session& s) {
+    if (!s.previewRecording12) return;
+    s.previewRecording12 = false;
+    const uint32_t slotIndex = s.previewSlotNext;
+    auto& slot = s.previewSlots12[slotIndex];
+    ID3D12Resource* renderTarget = s.previewRT12.Get();
     D3D12_RESOURCE_DESC rtDesc = renderTarget->GetDesc();
-    UINT rtWidth = (UINT)rtDesc.Width;
-    UINT rtHeight = rtDesc.Height;
-
-    auto copyEye = [&](rt::Swapchain& chain, uint32_t idx, uint32_t slice,
-                       UINT dstX, UINT dstY, const char* label) -> bool {
-        if (idx >= chain.images12.size() || !chain.images12[idx]) return false;
-        if (chain.imageStates12.size() <= idx) {
-            Logf("[SimXR] blitD3D12ToPreview: %s missing state tracking", label);
-            return false;
-        }
-        UINT subresource = calcSubresource(chain, slice, label);
-        if (subresource == UINT_MAX) return false;
-
-        ID3D12Resource* srcTex = chain.images12[idx].Get();
-        // Transition from COMMON (reset on release) to COPY_SOURCE
-        // D3D12 supports implicit promotion from COMMON, but explicit barrier is safer
-        transition(srcTex, chain.imageStates12[idx], D3D12_RESOURCE_STATE_COPY_SOURCE);
-
-        D3D12_TEXTURE_COPY_LOCATION dst = {};
-        dst.pResource = renderTarget;
-        dst.Type = D3D12_TEXTURE_COPY_TYPE_SUBRESOURCE_INDEX;
-        dst.SubresourceIndex = 0;
-
-        D3D12_TEXTURE_COPY_LOCATION src = {};
-        src.pResource = srcTex;
-        src.Type = D3D12_TEXTURE_COPY_TYPE_SUBRESOURCE_INDEX;
-        src.SubresourceIndex = subresource;
-
-        // Clip source box to fit within render target (CopyTextureRegion is 1:1 pixel copy, no scaling)
-        UINT copyW = chain.width;
-        UINT copyH = chain.height;
-        if (dstX + copyW > rtWidth)  copyW = (dstX < rtWidth)  ? rtWidth  - dstX : 0;
-        if (dstY + copyH > rtHeight) copyH = (dstY < rtHeight) ? rtHeight - dstY : 0;
-        if (copyW == 0 || copyH == 0) return false;
-
-        D3D12_BOX srcBox = {};
-        srcBox.left = 0;
-        srcBox.top = 0;
-        srcBox.front = 0;
-        srcBox.right = copyW;
-        srcBox.bottom = copyH;
-        srcBox.back = 1;
-
-        s.previewCmdList->CopyTextureRegion(&dst, dstX, dstY, 0, &src, &srcBox);
-        // Transition back to COMMON so the app can use implicit promotion next frame
-        transition(srcTex, chain.imageStates12[idx], D3D12_RESOURCE_STATE_COMMON);
-        return true;
-    };
+    const UINT rtWidth = (UINT)rtDesc.Width;
+    const UINT rtHeight = rtDesc.Height;
 
-    const bool singleEye = (viewMode != ui::ViewMode::BothEyes);
-    bool forceSingleEye = false;
-    static bool loggedAnaglyph = false;
-    ui::DisplayLayout effectiveLayout = layout;
-    if (!singleEye && layout == ui::DisplayLayout::Anaglyph) {
-        if (!loggedAnaglyph) {
-            Log("[SimXR] blitD3D12ToPreview: Anaglyph not supported on D3D12 path; showing left eye only");
-            loggedAnaglyph = true;
+    timing::ScopedStage submitTimer(timing::StD3D12Submit);
+
+    // Transition RT: RENDER_TARGET → COPY_SOURCE for readback
+    D3D12_RESOURCE_BARRIER barrier = {};
+    barrier.Type = D3D12_RESOURCE_BARRIER_TYPE_TRANSITION;
+    barrier.Transition.pResource = renderTarget;
+    barrier.Transition.StateBefore = D3D12_RESOURCE_STATE_RENDER_TARGET;
+    barrier.Transition.StateAfter = D3D12_RESOURCE_STATE_COPY_SOURCE;
+    barrier.Transition.Subresource = D3D12_RESOURCE_BARRIER_ALL_SUBRESOURCES;
+    s.previewCmdList->ResourceBarrier(1, &barrier);
+
+    // Copy render target to readback buffer
+    D3D12_TEXTURE_COPY_LOCATION readbackDst = {};
+    readbackDst.pResource = slot.readback.Get();
+    readbackDst.Type = D3D12_TEXTURE_COPY_TYPE_PLACED_FOOTPRINT;
+    readbackDst.PlacedFootprint.Offset = 0;
+    readbackDst.PlacedFootprint.Footprint.Format = DXGI_FORMAT_B8G8R8A8_UNORM;
+    readbackDst.PlacedFootprint.Footprint.Width = rtWidth;
+    readbackDst.PlacedFootprint.Footprint.Height = rtHeight;
+    readbackDst.PlacedFootprint.Footprint.Depth = 1;
+    readbackDst.PlacedFootprint.Footprint.RowPitch = s.previewReadbackPitch;
+
+    D3D12_TEXTURE_COPY_LOCATION readbackSrc = {};
+    readbackSrc.pResource = renderTarget;
+    readbackSrc.Type = D3D12_TEXTURE_COPY_TYPE_SUBRESOURCE_INDEX;
+    readbackSrc.SubresourceIndex = 0;
+
+    s.previewCmdList->CopyTextureRegion(&readbackDst, 0, 0, 0, &readbackSrc, nullptr);
+    recording::Recorder::Get().Record12(recording::StreamPreview, s.d3d12Device.Get(), s.previewCmdList.Get(),
+                                        renderTarget, 0, nullptr, rt::g_frameTiming.displayTime,
+                                        rt::g_frameTiming.periodNs);
+
+    // Transition RT back to COMMON for next frame
+    barrier.Transition.StateBefore = D3D12_RESOURCE_STATE_COPY_SOURCE;
+    barrier.Transition.StateAfter = D3D12_RESOURCE_STATE_COMMON;
+    s.previewCmdList->ResourceBarrier(1, &barrier);
+
+    ID3D12QueryHeap* timestampHeap = s.previewTimestampHeap.Get();
+    if (timestampHeap) {
+        s.previewCmdList->EndQuery(timestampHeap, D3D12_QUERY_TYPE_TIMESTAMP, slotIndex * 2 + 1);
+        s.previewCmdList->ResolveQueryData(timestampHeap, D3D12_QUERY_TYPE_TIMESTAMP, slotIndex * 2, 2,
+                                           s.previewTimestampReadback.Get(), (UINT64)slotIndex * 16);
+        slot.timestampPending = true;
+    }
+
+    // Submit this frame's work into the current slot
+    s.previewCmdList->Close();
+    ID3D12CommandList* cmdLists[] = { s.previewCmdList.Get() };
+    s.previewQueue12->ExecuteCommandLists(1, cmdLists);
+    s.previewQueue12->Signal(s.previewFence.Get(), s.previewFenceValue);
+    recording::Recorder::Get().Commit12(s.previewFence.Get(), s.previewFenceValue);
+    slot.fenceValue = s.previewFenceValue++;
+    slot.width = rtWidth;
+    slot.height = rtHeight;
+    s.previewSlotNext = (s.previewSlotNext + 1) % rt::Session::kPreviewSlots;
+    submitTimer.Stop();
+
+    // Low-latency mode: wait for the frame just submitted (the original blocking behaviour)
+    if (ui::g_uiState.lowLatencyPreview && s.previewFence->GetCompletedValue() < slot.fenceValue) {
+        timing::ScopedStage waitTimer(timing::StD3D12FenceWait);
+        s.previewFence->SetEventOnCompletion(slot.fenceValue, s.previewFenceEvent);
+        WaitForSingleObject(s.previewFenceEvent, 1000);
+    }
+
+    // Paint the newest slot whose work has already retired; if nothing newer than the
+    // last painted frame is ready the window simply keeps showing it.
+    const UINT64 completed = s.previewFence->GetCompletedValue();
+    rt::Session::PreviewSlot12* paintSlot = nullptr;
+    for (auto& candidate : s.previewSlots12) {
+        if (candidate.fenceValue == 0 || candidate.fenceValue > completed) continue;
+        if (candidate.fenceValue <= s.previewPaintedFence) continue;
+        if (!paintSlot || candidate.fenceValue > paintSlot->fenceValue) paintSlot = &candidate;
+    }
+
+    // Map readback buffer and paint to window via GDI (bypasses all DXGI Present hooks)
+    if (paintSlot) {
+        const UINT paintW = paintSlot->width;
+        const UINT paintH = paintSlot->height;
+        void* mapped = nullptr;
+        D3D12_RANGE readRange = { 0, (SIZE_T)s.previewReadbackPitch * paintH };
+        timing::ScopedStage mapTimer(timing::StD3D12Map);
+        HRESULT hr = paintSlot->readback->Map(0, &readRange, &mapped);
+        mapTimer.Stop();
+        if (SUCCEEDED(hr) && mapped && s.hwnd) {
+            HDC hdc = GetDC(s.hwnd);
+            if (hdc) {
+                // The DIB is as wide as the aligned row pitch and only paintW columns are
+                // painted, so the readback is used in place with no row repacking
+                BITMAPINFO bmi = {};
+                bmi.bmiHeader.biSize = sizeof(BITMAPINFOHEADER);
+                bmi.bmiHeader.biWidth = (LONG)(s.previewReadbackPitch / 4);
+                bmi.bmiHeader.biHeight = -(LONG)paintH;  // top-down
+                bmi.bmiHeader.biPlanes = 1;
+                bmi.bmiHeader.biBitCount = 32;
+                bmi.bmiHeader.biCompression = BI_RGB;
+
+                timing::ScopedStage paintTimer(timing::StD3D12Paint);
+                StretchDIBits(hdc, 0, 0, paintW, paintH,
+                              0, 0, paintW, paintH,
+                              mapped, &bmi, DIB_RGB_COLORS, SRCCOPY);
+                ReleaseDC(s.hwnd, hdc);
+            }
+            // The slot is already mapped for painting, so stereo analysis costs only the CPU pass
+            static uint64_t analyzeTick = 0;
+            if (stereo::Due(++analyzeTick)) {
+                stereo::Analyzer::Get().Analyze((const uint8_t*)mapped, s.previewReadbackPitch, paintW, paintH, true,
+                                                PreviewStereoLayout(ui::g_uiState.viewMode, ui::g_uiState.displayLayout),
+                                                rt::g_frameTiming.displayTime);
+            }
+            D3D12_RANGE writeRange = { 0, 0 };
+            paintSlot->readback->Unmap(0, &writeRange);
         }
-        forceSingleEye = true;
+        s.previewPaintedFence = paintSlot->fenceValue;
+    }
+
+    // Process window messages
+    MSG msg;
+    while (PeekMessageW(&msg, s.hwnd, 0, 0, PM_REMOVE)) { TranslateMessage(&msg); DispatchMessageW(&msg); }
+}
+
+// Left/right viewports of the preview for a layout, shared by the D3D12 eye and layer draws
+static void PreviewEyeViewports12(const rt::Session& s, ui::DisplayLayout layout, bool singleEye,
+                                  D3D12_VIEWPORT& leftVp, D3D12_VIEWPORT& rightVp) {
+    const float w = (float)s.previewWidth;
+    const float h = (float)s.previewHeight;
+    leftVp = { 0.0f, 0.0f, w, h, 0.0f, 1.0f };
+    rightVp = leftVp;
+    if (singleEye) return;
+    if (layout == ui::DisplayLayout::SideBySide) {
+        leftVp.Width = rightVp.Width = w / 2.0f;
+        rightVp.TopLeftX = w / 2.0f;
+    } else if (layout == ui::DisplayLayout::OverUnder) {
+        leftVp.Height = rightVp.Height = h / 2.0f;
+        rightVp.TopLeftY = h / 2.0f;
     }
-    if (effectiveLayout == ui::DisplayLayout::Anaglyph) {
-        effectiveLayout = ui::DisplayLayout::SideBySide;
+}
+
+// Region of an eye image a video recording keeps: the submitted imageRect, clamped
+template <typename Box>
+static Box RecordingBox(const XrRect2Di& rect, UINT width, UINT height) {
+    Box box = { 0, 0, 0, width, height, 1 };
+    if (rect.extent.width <= 0 || rect.extent.height <= 0) return box;
+    box.left = (UINT)std::min<int32_t>(std::max(rect.offset.x, 0), (int32_t)width);
+    box.top = (UINT)std::min<int32_t>(std::max(rect.offset.y, 0), (int32_t)height);
+    box.right = std::min(box.left + (UINT)rect.extent.width, width);
+    box.bottom = std::min(box.top + (UINT)rect.extent.height, height);
+    return box;
+}
+
+// D3D12 eye stream of a video recording: a copy recorded into the open preview list, handed
+// to the recorder by FinishD3D12Preview once the list is submitted
+static void RecordEyeD3D12(rt::Session& s, rt::Swapchain& chain, uint32_t idx, uint32_t slice,
+                           const XrRect2Di* rect, uint32_t stream) {
+    auto& recorder = recording::Recorder::Get();
+    if (!recorder.Wants(stream) || !s.previewRecording12) return;
+    if (idx >= chain.images12.size() || !chain.images12[idx] || chain.imageStates12.size() <= idx) return;
+    ID3D12Resource* srcTex = chain.images12[idx].Get();
+    const D3D12_RESOURCE_DESC desc = srcTex->GetDesc();
+    if (slice >= desc.DepthOrArraySize) return;
+    const D3D12_BOX box = rect ? RecordingBox<D3D12_BOX>(*rect, (UINT)desc.Width, desc.Height)
+                               : D3D12_BOX{ 0, 0, 0, (UINT)desc.Width, desc.Height, 1 };
+
+    // Same state handling as DrawD3D12Image: from COMMON and back, for implicit promotion
+    D3D12_RESOURCE_STATES& state = chain.imageStates12[idx];
+    D3D12_RESOURCE_BARRIER barrier = {};
+    barrier.Type = D3D12_RESOURCE_BARRIER_TYPE_TRANSITION;
+    barrier.Transition.pResource = srcTex;
+    barrier.Transition.Subresource = D3D12_RESOURCE_BARRIER_ALL_SUBRESOURCES;
+    if (state != D3D12_RESOURCE_STATE_COPY_SOURCE) {
+        barrier.Transition.StateBefore = state;
+        barrier.Transition.StateAfter = D3D12_RESOURCE_STATE_COPY_SOURCE;
+        s.previewCmdList->ResourceBarrier(1, &barrier);
     }
+    recorder.Record12(stream, s.d3d12Device.Get(), s.previewCmdList.Get(), srcTex,
+                      D3D12CalcSubresource(0, slice, 0, desc.MipLevels, desc.DepthOrArraySize), &box,
+                      rt::g_frameTiming.displayTime, rt::g_frameTiming.periodNs);
+    barrier.Transition.StateBefore = D3D12_RESOURCE_STATE_COPY_SOURCE;
+    barrier.Transition.StateAfter = D3D12_RESOURCE_STATE_COMMON;
+    s.previewCmdList->ResourceBarrier(1, &barrier);
+    state = D3D12_RESOURCE_STATE_COMMON;
+}
+
+// Compose the projection views into the D3D12 preview, then read back and paint. With
+// deferFinish the list is left recording for renderOverlayLayersD3D12.
+static void blitD3D12ToPreview(rt::Session& s,
+                                rt::Swapchain& chainL, uint32_t leftIdx, uint32_t leftSlice, const XrRect2Di* leftRect,
+                                rt::Swapchain* chainR, uint32_t rightIdx, uint32_t rightSlice, const XrRect2Di* rightRect,
+                                ui::DisplayLayout layout, ui::ViewMode viewMode, bool deferFinish) {
+    const bool singleEye = (viewMode != ui::ViewMode::BothEyes);
+    const bool anaglyph = !singleEye && layout == ui::DisplayLayout::Anaglyph;
+    if (!BeginD3D12Preview(s, anaglyph)) return;
+
+    D3D12_VIEWPORT leftVp, rightVp;
+    PreviewEyeViewports12(s, layout, singleEye, leftVp, rightVp);
+    const uint32_t leftBlend = anaglyph ? rt::Session::BlendAnaglyphRed : rt::Session::BlendOpaque;
+    const uint32_t rightBlend = anaglyph ? rt::Session::BlendAnaglyphCyan : rt::Session::BlendOpaque;
 
     const bool hasLeft = leftIdx < chainL.images12.size() && chainL.images12[leftIdx];
     const bool hasRight = chainR && rightIdx < chainR->images12.size() && chainR->images12[rightIdx];
 
-    // Single-eye mode: render selected eye full-screen
-    if (singleEye || forceSingleEye) {
-        if (viewMode == ui::ViewMode::RightEyeOnly && hasRight) {
-            copyEye(*chainR, rightIdx, rightSlice, 0, 0, "R");
-        } else if (hasLeft) {
-            copyEye(chainL, leftIdx, leftSlice, 0, 0, "L");
-        } else if (hasRight) {
-            copyEye(*chainR, rightIdx, rightSlice, 0, 0, "R");
+    {
+        timing::ScopedStage submitTimer(timing::StD3D12Submit);
+        if (singleEye) {
+            // Single-eye mode: render selected eye full-screen
+            if (viewMode == ui::ViewMode::RightEyeOnly && hasRight) {
+                DrawD3D12Image(s, *chainR, rightIdx, rightSlice, rightRect, &rightVp, 1, rightBlend, "R");
+            } else if (hasLeft) {
+                DrawD3D12Image(s, chainL, leftIdx, leftSlice, leftRect, &leftVp, 1, leftBlend, "L");
+            } else if (hasRight) {
+                DrawD3D12Image(s, *chainR, rightIdx, rightSlice, rightRect, &rightVp, 1, rightBlend, "R");
+            }
+        } else {
+            if (hasLeft) {
+                DrawD3D12Image(s, chainL, leftIdx, leftSlice, leftRect, &leftVp, 1, leftBlend, "L");
+            }
+            if (hasRight) {
+                DrawD3D12Image(s, *chainR, rightIdx, rightSlice, rightRect, &rightVp, 1, rightBlend, "R");
+            } else if (hasLeft) {
+                DrawD3D12Image(s, chainL, leftIdx, leftSlice, leftRect, &rightVp, 1, rightBlend, "L");
+            }
         }
-    } else {
-        UINT rightX = (effectiveLayout == ui::DisplayLayout::OverUnder) ? 0 : (UINT)(s.previewWidth / 2);
-        UINT rightY = (effectiveLayout == ui::DisplayLayout::OverUnder) ? (UINT)(s.previewHeight / 2) : 0;
+    }
+
+    if (hasLeft) RecordEyeD3D12(s, chainL, leftIdx, leftSlice, leftRect, recording::StreamLeft);
+    if (hasRight) RecordEyeD3D12(s, *chainR, rightIdx, rightSlice, rightRect, recording::StreamRight);
 
-        if (hasLeft) {
-            copyEye(chainL, leftIdx, leftSlice, 0, 0, "L");
+    if (!deferFinish) FinishD3D12Preview(s);
+
+    static int blitCount = 0;
+    if (++blitCount % 60 == 1) {
+        LogAtf(logging::CatFrame, logging::Level::Debug, "[SimXR] blitD3D12ToPreview: composed L[%u] R[%u] into %ux%u",
+               leftIdx, rightIdx, s.previewWidth, s.previewHeight);
+    }
+}
+
+// Compose one handed-off frame on the compositor thread's device and Present it
+static void ComposeCompositorFrame(rt::Session& v, const rt::CompositorThread::Frame& f,
+                                   ComPtr<ID3D11Texture2D> (&views)[2], HANDLE (&viewHandles)[2],
+                                   rt::Swapchain (&proxies)[2], mcp::AsyncCapture11& capture,
+                                   stereo::Readback11& analysis) {
+    capture.Poll(v.d3d11Context.Get());
+    analysis.Poll(v.d3d11Context.Get());
+
+    // (Re)create or resize the swapchain to the size the app thread laid the window out for
+    if (!v.previewSwapchain || v.previewWidth != f.width || v.previewHeight != f.height) {
+        if (v.previewSwapchain) {
+            HRESULT hr = v.previewSwapchain->ResizeBuffers(0, f.width, f.height, DXGI_FORMAT_UNKNOWN, 0);
+            if (FAILED(hr)) {
+                Logf("[SimXR] Compositor: ResizeBuffers failed 0x%08X", (unsigned)hr);
+                v.previewSwapchain.Reset();
+            }
         }
-        if (hasRight) {
-            copyEye(*chainR, rightIdx, rightSlice, rightX, rightY, "R");
-        } else if (hasLeft) {
-            copyEye(chainL, leftIdx, leftSlice, rightX, rightY, "L");
+        if (!v.previewSwapchain) {
+            ComPtr<IDXGIFactory2> factory;
+            rt::g_compositor.adapter->GetParent(IID_PPV_ARGS(factory.GetAddressOf()));
+            DXGI_SWAP_CHAIN_DESC1 desc{};
+            desc.Format = DXGI_FORMAT_R8G8B8A8_UNORM;
+            desc.Width = f.width;
+            desc.Height = f.height;
+            desc.BufferUsage = DXGI_USAGE_RENDER_TARGET_OUTPUT;
+            desc.BufferCount = 2;
+            desc.SwapEffect = DXGI_SWAP_EFFECT_FLIP_DISCARD;
+            desc.SampleDesc.Count = 1;
+            HRESULT hr = factory ? factory->CreateSwapChainForHwnd(v.d3d11Device.Get(), v.hwnd, &desc, nullptr, nullptr,
+                                                                  v.previewSwapchain.GetAddressOf())
+                                 : E_FAIL;
+            if (FAILED(hr)) {
+                Logf("[SimXR] Compositor: CreateSwapChainForHwnd failed 0x%08X", (unsigned)hr);
+                return;
+            }
+            Logf("[SimXR] Compositor: swapchain %ux%u created", f.width, f.height);
         }
+        v.previewWidth = f.width;
+        v.previewHeight = f.height;
+        v.previewFormat = DXGI_FORMAT_R8G8B8A8_UNORM;
     }
 
-    // Transition RT: COPY_DEST → COPY_SOURCE for readback
-    barrier.Transition.StateBefore = D3D12_RESOURCE_STATE_COPY_DEST;
-    barrier.Transition.StateAfter = D3D12_RESOURCE_STATE_COPY_SOURCE;
-    s.previewCmdList->ResourceBarrier(1, &barrier);
+    // Open (or reopen, after the app side recreated them) this frame's shared textures
+    ComPtr<IDXGIKeyedMutex> mutexes[2];
+    for (uint32_t e = 0; e < 2; ++e) {
+        if (!f.used[e]) continue;
+        if (f.shared[e] != viewHandles[e] || !views[e]) {
+            views[e].Reset();
+            viewHandles[e] = nullptr;
+            if (FAILED(v.d3d11Device->OpenSharedResource(f.shared[e], IID_PPV_ARGS(views[e].GetAddressOf())))) {
+                Log("[SimXR] Compositor: OpenSharedResource failed");
+                continue;
+            }
+            viewHandles[e] = f.shared[e];
+            proxies[e].blitViews.clear();
+            D3D11_TEXTURE2D_DESC d;
+            views[e]->GetDesc(&d);
+            proxies[e].images = { views[e] };
+            proxies[e].width = d.Width;
+            proxies[e].height = d.Height;
+            proxies[e].imageCount = 1;
+            proxies[e].arraySize = 1;
+            proxies[e].mipCount = 1;
+        }
+        proxies[e].format = f.chainFormats[e];
+        if (views[e]) views[e].As(&mutexes[e]);
+    }
+    for (uint32_t e = 0; e < 2; ++e) {
+        if (mutexes[e] && mutexes[e]->AcquireSync(f.keys[e], 100) != S_OK) mutexes[e].Reset();
+    }
+
+    ComPtr<ID3D11Texture2D> bb;
+    ComPtr<ID3D11RenderTargetView> rtv;
+    if (SUCCEEDED(v.previewSwapchain->GetBuffer(0, IID_PPV_ARGS(bb.GetAddressOf())))) {
+        D3D11_RENDER_TARGET_VIEW_DESC rtvDesc = {};
+        rtvDesc.Format = DXGI_FORMAT_R8G8B8A8_UNORM_SRGB;
+        rtvDesc.ViewDimension = D3D11_RTV_DIMENSION_TEXTURE2D;
+        if (FAILED(v.d3d11Device->CreateRenderTargetView(bb.Get(), &rtvDesc, rtv.GetAddressOf()))) {
+            v.d3d11Device->CreateRenderTargetView(bb.Get(), nullptr, rtv.GetAddressOf());
+        }
+    }
+
+    if (rtv) {
+        const bool singleEye = (f.viewMode != ui::ViewMode::BothEyes);
+        const bool showLeft = (f.viewMode != ui::ViewMode::RightEyeOnly);
+        const bool showRight = (f.viewMode != ui::ViewMode::LeftEyeOnly);
+        const bool anaglyph = !singleEye && f.layout == ui::DisplayLayout::Anaglyph;
+        const float clearColorDefault[4] = {0.1f, 0.1f, 0.2f, 1.0f};
+        const float clearColorAnaglyph[4] = {0.0f, 0.0f, 0.0f, 1.0f};
+        v.d3d11Context->ClearRenderTargetView(rtv.Get(), anaglyph ? clearColorAnaglyph : clearColorDefault);
+
+        D3D11_VIEWPORT fullVp = { 0.0f, 0.0f, (float)f.width, (float)f.height, 0.0f, 1.0f };
+        D3D11_VIEWPORT leftVp = fullVp, rightVp = fullVp;
+        if (!singleEye && f.layout == ui::DisplayLayout::SideBySide) {
+            leftVp.Width = rightVp.Width = (float)f.width / 2.0f;
+            rightVp.TopLeftX = (float)f.width / 2.0f;
+        } else if (!singleEye && f.layout == ui::DisplayLayout::OverUnder) {
+            leftVp.Height = rightVp.Height = (float)f.height / 2.0f;
+            rightVp.TopLeftY = (float)f.height / 2.0f;
+        }
+        if (rt::InitBlitResources(v)) {
+            ID3D11BlendState* leftBlend = anaglyph ? v.anaglyphRedBS.Get() : nullptr;
+            ID3D11BlendState* rightBlend = anaglyph ? v.anaglyphCyanBS.Get() : nullptr;
+            timing::ScopedStage blitTimer(timing::StProjBlit);
+            if (showLeft && mutexes[0]) {
+                blitViewToHalf(v, proxies[0], 0, 0, f.rects[0], rtv.Get(), leftVp, leftBlend);
+            }
+            if (showRight && mutexes[1]) {
+                blitViewToHalf(v, proxies[1], 0, 0, f.rects[1], rtv.Get(), rightVp, rightBlend);
+            } else if (showRight && !showLeft && mutexes[0]) {
+                // Mirror left eye if right-only mode but only one view
+                blitViewToHalf(v, proxies[0], 0, 0, f.rects[0], rtv.Get(), rightVp, rightBlend);
+            }
+        }
+        rt::GpuTimerEndFrame11(v);
+        if (f.screenshot) {
+            timing::ScopedStage screenshotTimer(timing::StProjScreenshot);
+            capture.Queue(v.d3d11Device.Get(), v.d3d11Context.Get(), bb.Get(), "screenshot", f.screenshotFormat);
+        }
+    }
+
+    // Hand the textures back before the (possibly blocking) Present
+    for (uint32_t e = 0; e < 2; ++e) {
+        if (mutexes[e]) mutexes[e]->ReleaseSync(f.keys[e] + 1);
+    }
+    recording::Recorder::Get().Submit11(recording::StreamPreview, v.d3d11Device.Get(), v.d3d11Context.Get(),
+                                        bb.Get(), 0, nullptr, false, f.displayTime, f.periodNs);
+    if (bb) analysis.Queue(v.d3d11Device.Get(), v.d3d11Context.Get(), bb.Get(), PreviewStereoLayout(f.viewMode, f.layout), f.displayTime);
+    rtv.Reset();
+    bb.Reset();
+
+    timing::ScopedStage presentTimer(timing::StPresent);
+    v.previewSwapchain->Present(1, 0);
+}
+
+static void CompositorThreadMain() {
+    auto& c = rt::g_compositor;
+    auto view = std::make_unique<rt::Session>();
+    rt::Session& v = *view;
+    v.hwnd = c.hwnd;
+
+    UINT flags = D3D11_CREATE_DEVICE_BGRA_SUPPORT;
+    HRESULT hr = D3D11CreateDevice(c.adapter.Get(), D3D_DRIVER_TYPE_UNKNOWN, nullptr, flags, nullptr, 0,
+                                   D3D11_SDK_VERSION, v.d3d11Device.GetAddressOf(), nullptr, v.d3d11Context.GetAddressOf());
+    if (FAILED(hr)) {
+        Logf("[SimXR] Compositor: D3D11CreateDevice failed 0x%08X; no preview", (unsigned)hr);
+    }
+
+    ComPtr<ID3D11Texture2D> views[rt::CompositorThread::kSlots][2];
+    HANDLE viewHandles[rt::CompositorThread::kSlots][2] = {};
+    rt::Swapchain proxies[rt::CompositorThread::kSlots][2];
+    mcp::AsyncCapture11 capture;  // screenshots of the compositor's backbuffer
+    stereo::Readback11 analysis;  // stereo analysis of the same
+    int framesThisPeriod = 0;
+    ULONGLONG periodStartMs = GetTickCount64();
+
+    for (;;) {
+        rt::CompositorThread::Frame f;
+        {
+            std::unique_lock<std::mutex> lock(c.mutex);
+            c.cv.wait(lock, [&] { return c.stop || c.pending >= 0; });
+            if (c.stop) break;
+            f = c.pendingFrame;
+            c.pending = -1;
+            c.slots[f.slot].state = rt::CompositorThread::SlotState::Reading;
+        }
+
+        if (v.d3d11Device) {
+            ComposeCompositorFrame(v, f, views[f.slot], viewHandles[f.slot], proxies[f.slot], capture, analysis);
+        }
+
+        {
+            std::lock_guard<std::mutex> lock(c.mutex);
+            auto& slot = c.slots[f.slot];
+            for (uint32_t e = 0; e < 2; ++e) {
+                if (f.used[e]) slot.eyes[e].key = f.keys[e] + 1;
+            }
+            slot.state = rt::CompositorThread::SlotState::Free;
+        }
+
+        ++framesThisPeriod;
+        ULONGLONG nowMs = GetTickCount64();
+        if (nowMs - periodStartMs >= 500) {
+            c.fps.store((int)(framesThisPeriod * 1000 / (nowMs - periodStartMs)), std::memory_order_relaxed);
+            framesThisPeriod = 0;
+            periodStartMs = nowMs;
+        }
+    }
+
+    // Everything on the compositor device (including the swapchain bound to the window) goes here
+    if (v.d3d11Context) {
+        v.d3d11Context->ClearState();
+        v.d3d11Context->Flush();
+    }
+}
+
+static bool StartCompositorThread(rt::Session& s) {
+    auto& c = rt::g_compositor;
+    if (c.running) return true;
+    if (!s.hwnd || !s.d3d11Device) return false;
+    ComPtr<IDXGIDevice> dxgiDev;
+    if (FAILED(s.d3d11Device.As(&dxgiDev)) || FAILED(dxgiDev->GetAdapter(c.adapter.ReleaseAndGetAddressOf()))) {
+        Log("[SimXR] Compositor: cannot get the app device's adapter");
+        c.requested = false;
+        return false;
+    }
+    c.hwnd = s.hwnd;
+    c.stop = false;
+    c.pending = -1;
+    c.superseded.store(0, std::memory_order_relaxed);
+    c.thread = std::thread(CompositorThreadMain);
+    c.running = true;
+    Log("[SimXR] Compositor thread started");
+    return true;
+}
+
+// App thread, inside xrEndFrame: copy the released eye images into a free slot and post it
+static void SubmitToCompositor(rt::Session& s, const XrCompositionLayerProjection& proj,
+                               rt::Swapchain& chL, const rt::Swapchain* chRPtr) {
+    auto& c = rt::g_compositor;
+    if (!StartCompositorThread(s)) return;
+
+    int slotIndex = -1;
+    {
+        std::lock_guard<std::mutex> lock(c.mutex);
+        for (uint32_t i = 0; i < rt::CompositorThread::kSlots; ++i) {
+            if (c.slots[i].state == rt::CompositorThread::SlotState::Free) { slotIndex = (int)i; break; }
+        }
+    }
+    if (slotIndex < 0) return;  // only if the compositor is stuck; never wait for it
+    auto& slot = c.slots[slotIndex];
+
+    timing::ScopedStage handoffTimer(timing::StCompositorHandoff);
+    rt::CompositorThread::Frame f;
+    f.slot = (uint32_t)slotIndex;
+    f.viewMode = ui::g_uiState.viewMode;
+    f.layout = ui::g_uiState.displayLayout;
+    f.width = s.previewWidth;
+    f.height = s.previewHeight;
+    f.displayTime = rt::g_frameTiming.displayTime;
+    f.periodNs = rt::g_frameTiming.periodNs;
+
+    // Both eyes may come from one array swapchain; each eye gets its own single-slice copy
+    const uint32_t eyeCount = (proj.viewCount > 1) ? 2 : 1;
+    for (uint32_t e = 0; e < eyeCount; ++e) {
+        auto& chain = (e == 0) ? chL : const_cast<rt::Swapchain&>(*chRPtr);
+        const auto& view = proj.views[e];
+        uint32_t idx = 0;
+        if (chain.lastReleased != UINT32_MAX && chain.lastReleased < chain.imageCount) {
+            idx = chain.lastReleased;
+        } else if (chain.lastAcquired != UINT32_MAX && chain.lastAcquired < chain.imageCount) {
+            idx = chain.lastAcquired;
+        }
+        if (idx >= chain.images.size() || !chain.images[idx]) continue;
+
+        D3D11_TEXTURE2D_DESC srcDesc;
+        chain.images[idx]->GetDesc(&srcDesc);
+        if (srcDesc.SampleDesc.Count > 1 || (srcDesc.BindFlags & D3D11_BIND_DEPTH_STENCIL)) continue;
+
+        auto& eye = slot.eyes[e];
+        if (!eye.tex || eye.width != srcDesc.Width || eye.height != srcDesc.Height || eye.format != srcDesc.Format) {
+            eye = {};
+            D3D11_TEXTURE2D_DESC desc = {};
+            desc.Width = srcDesc.Width;
+            desc.Height = srcDesc.Height;
+            desc.MipLevels = 1;
+            desc.ArraySize = 1;
+            desc.Format = srcDesc.Format;
+            desc.SampleDesc.Count = 1;
+            desc.Usage = D3D11_USAGE_DEFAULT;
+            desc.BindFlags = D3D11_BIND_SHADER_RESOURCE | D3D11_BIND_RENDER_TARGET;
+            desc.MiscFlags = D3D11_RESOURCE_MISC_SHARED_KEYEDMUTEX;
+            ComPtr<IDXGIResource> dxgiRes;
+            HRESULT hr = s.d3d11Device->CreateTexture2D(&desc, nullptr, eye.tex.GetAddressOf());
+            if (SUCCEEDED(hr)) hr = eye.tex.As(&eye.mutex);
+            if (SUCCEEDED(hr)) hr = eye.tex.As(&dxgiRes);
+            if (SUCCEEDED(hr)) hr = dxgiRes->GetSharedHandle(&eye.shared);
+            if (FAILED(hr)) {
+                Logf("[SimXR] Compositor: shared texture %ux%u fmt=%d failed 0x%08X",
+                     desc.Width, desc.Height, (int)desc.Format, (unsigned)hr);
+                eye = {};
+                continue;
+            }
+            eye.width = srcDesc.Width;
+            eye.height = srcDesc.Height;
+            eye.format = srcDesc.Format;
+        }
+
+        // The compositor released this key before marking the slot free, so this doesn't block
+        if (eye.mutex->AcquireSync(eye.key, 100) != S_OK) continue;
+        UINT srcSub = D3D11CalcSubresource(0, view.subImage.imageArrayIndex, chain.mipCount ? chain.mipCount : 1);
+        s.d3d11Context->CopySubresourceRegion(eye.tex.Get(), 0, 0, 0, 0, chain.images[idx].Get(), srcSub, nullptr);
+        eye.mutex->ReleaseSync(eye.key + 1);
+        f.used[e] = true;
+        f.shared[e] = eye.shared;
+        f.keys[e] = eye.key + 1;
+        f.rects[e] = view.subImage.imageRect;
+        f.chainFormats[e] = chain.format;
+        eye.key += 1;
+    }
+    if (!f.used[0] && !f.used[1]) return;
+
+    // Screenshots are taken by the compositor from the composed backbuffer
+    mcp::CheckScreenshotRequest();
+    if (mcp::g_screenshotRequested) {
+        f.screenshot = true;
+        f.screenshotFormat = mcp::g_screenshotFormat;
+        mcp::CompleteScreenshotRequest();
+    }
+
+    {
+        std::lock_guard<std::mutex> lock(c.mutex);
+        if (c.pending >= 0) {
+            if (c.pendingFrame.screenshot && !f.screenshot) {
+                f.screenshot = true;
+                f.screenshotFormat = c.pendingFrame.screenshotFormat;
+            }
+            c.slots[c.pending].state = rt::CompositorThread::SlotState::Free;
+            c.superseded.fetch_add(1, std::memory_order_relaxed);
+        }
+        slot.state = rt::CompositorThread::SlotState::Ready;
+        c.pending = slotIndex;
+        c.pendingFrame = f;
+    }
+    c.cv.notify_one();
+}
 
-    // Copy render target to readback buffer
-    D3D12_TEXTURE_COPY_LOCATION readbackDst = {};
-    readbackDst.pResource = s.previewReadback12.Get();
-    readbackDst.Type = D3D12_TEXTURE_COPY_TYPE_PLACED_FOOTPRINT;
-    readbackDst.PlacedFootprint.Offset = 0;
-    readbackDst.PlacedFootprint.Footprint.Format = rtDesc.Format;
-    readbackDst.PlacedFootprint.Footprint.Width = rtWidth;
-    readbackDst.PlacedFootprint.Footprint.Height = rtHeight;
-    readbackDst.PlacedFootprint.Footprint.Depth = 1;
-    readbackDst.PlacedFootprint.Footprint.RowPitch = s.previewReadbackPitch;
+// Flag to track if Present should be called (deferred until all layers rendered)
+static bool g_presentPending = false;
 
-    D3D12_TEXTURE_COPY_LOCATION readbackSrc = {};
-    readbackSrc.pResource = renderTarget;
-    readbackSrc.Type = D3D12_TEXTURE_COPY_TYPE_SUBRESOURCE_INDEX;
-    readbackSrc.SubresourceIndex = 0;
+// Preview title: fps, plus the heaviest frame stages (p50/p99) when Show Statistics (F3) is on
+static void UpdatePreviewTitle(HWND hwnd, int fps) {
+    wchar_t stats[256] = L"";
+    if (ui::g_uiState.showStats) timing::FormatSummary(stats, _countof(stats), 4);
+    ui::UpdateWindowTitle(hwnd, fps, 0, stats);
+}
 
-    s.previewCmdList->CopyTextureRegion(&readbackDst, 0, 0, 0, &readbackSrc, nullptr);
+// MCP screenshot of the composed D3D12 preview: tags the slot FinishD3D12Preview just
+// submitted, whose readback already holds the frame. rt::ResolveD3D12Screenshots takes the
+// pixels once that slot has retired, so the frame thread never waits for the GPU.
+static void CaptureD3D12PreviewScreenshot(rt::Session& s) {
+    timing::ScopedStage screenshotTimer(timing::StProjScreenshot);
+    mcp::CheckScreenshotRequest();
+    if (!mcp::g_screenshotRequested || !s.previewRT12) return;
+    const uint32_t last = (s.previewSlotNext + rt::Session::kPreviewSlots - 1) % rt::Session::kPreviewSlots;
+    auto& slot = s.previewSlots12[last];
+    if (slot.fenceValue == 0) return;  // nothing composed yet; keep the request pending
+    slot.screenshotPending = true;
+    slot.screenshotFormat = mcp::g_screenshotFormat;
+    mcp::CompleteScreenshotRequest();
+}
 
-    // Transition RT back to COMMON for next frame
-    barrier.Transition.StateBefore = D3D12_RESOURCE_STATE_COPY_SOURCE;
-    barrier.Transition.StateAfter = D3D12_RESOURCE_STATE_COMMON;
-    s.previewCmdList->ResourceBarrier(1, &barrier);
+// Preview stream of a video recording (D3D11 and GL): the composed backbuffer, just before
+// it is presented. D3D12 records in FinishD3D12Preview, the compositor thread in its frame.
+static void RecordPreview11(rt::Session& s) {
+    auto& recorder = recording::Recorder::Get();
+    if (!recorder.Wants(recording::StreamPreview) || !s.previewSwapchain || !s.d3d11Context) return;
+    ComPtr<ID3D11Texture2D> bb;
+    if (FAILED(s.previewSwapchain->GetBuffer(0, IID_PPV_ARGS(bb.GetAddressOf())))) return;
+    recorder.Submit11(recording::StreamPreview, s.d3d11Device.Get(), s.d3d11Context.Get(), bb.Get(), 0, nullptr,
+                      false, rt::g_frameTiming.displayTime, rt::g_frameTiming.periodNs);
+}
 
-    // Execute and wait for completion (we need the readback data immediately)
-    s.previewCmdList->Close();
-    ID3D12CommandList* cmdLists[] = { s.previewCmdList.Get() };
-    s.previewQueue12->ExecuteCommandLists(1, cmdLists);
-    s.previewQueue12->Signal(s.previewFence.Get(), s.previewFenceValue);
-    if (s.previewFence->GetCompletedValue() < s.previewFenceValue) {
-        s.previewFence->SetEventOnCompletion(s.previewFenceValue, s.previewFenceEvent);
-        WaitForSingleObject(s.previewFenceEvent, 1000);
-    }
-    s.previewFenceValue++;
+// Stereo analysis (D3D11 and GL): retire finished backbuffer copies, then queue this frame's
+// if it is due. Called next to RecordPreview11, just before Present.
+static void AnalyzePreview11(rt::Session& s) {
+    if (!stereo::g_every.load(std::memory_order_relaxed) || !s.previewSwapchain || !s.d3d11Context) return;
+    stereo::g_readback11.Poll(s.d3d11Context.Get());
+    ComPtr<ID3D11Texture2D> bb;
+    if (FAILED(s.previewSwapchain->GetBuffer(0, IID_PPV_ARGS(bb.GetAddressOf())))) return;
+    stereo::g_readback11.Queue(s.d3d11Device.Get(), s.d3d11Context.Get(), bb.Get(),
+                               PreviewStereoLayout(ui::g_uiState.viewMode, ui::g_uiState.displayLayout),
+                               rt::g_frameTiming.displayTime);
+}
 
-    // Map readback buffer and paint to window via GDI (bypasses all DXGI Present hooks)
-    void* mapped = nullptr;
-    D3D12_RANGE readRange = { 0, (SIZE_T)s.previewReadbackPitch * rtHeight };
-    hr = s.previewReadback12->Map(0, &readRange, &mapped);
-    if (SUCCEEDED(hr) && mapped && s.hwnd) {
-        HDC hdc = GetDC(s.hwnd);
-        if (hdc) {
-            BITMAPINFO bmi = {};
-            bmi.bmiHeader.biSize = sizeof(BITMAPINFOHEADER);
-            bmi.bmiHeader.biWidth = (LONG)rtWidth;
-            bmi.bmiHeader.biHeight = -(LONG)rtHeight;  // top-down
-            bmi.bmiHeader.biPlanes = 1;
-            bmi.bmiHeader.biBitCount = 32;
-            bmi.bmiHeader.biCompression = BI_RGB;
-
-            // Handle aligned row pitch: if pitch matches width*4, blit directly; otherwise copy rows
-            UINT expectedPitch = rtWidth * 4;
-            if (s.previewReadbackPitch == expectedPitch) {
-                StretchDIBits(hdc, 0, 0, rtWidth, rtHeight,
-                              0, 0, rtWidth, rtHeight,
-                              mapped, &bmi, DIB_RGB_COLORS, SRCCOPY);
-            } else {
-                // Copy rows with correct pitch to a contiguous buffer
-                std::vector<uint8_t> pixels(expectedPitch * rtHeight);
-                const uint8_t* src = (const uint8_t*)mapped;
-                for (UINT row = 0; row < rtHeight; ++row) {
-                    memcpy(pixels.data() + row * expectedPitch, src + row * s.previewReadbackPitch, expectedPitch);
-                }
-                StretchDIBits(hdc, 0, 0, rtWidth, rtHeight,
-                              0, 0, rtWidth, rtHeight,
-                              pixels.data(), &bmi, DIB_RGB_COLORS, SRCCOPY);
+// Eye streams of a video recording (D3D11 and GL) at full resolution. GL images, shared or
+// uploaded from the readback ring, are bottom-up and flipped by the recorder.
+static void RecordEyes11(rt::Session& s, const XrCompositionLayerProjection& proj,
+                         rt::Swapchain& chL, const rt::Swapchain* chRPtr) {
+    auto& recorder = recording::Recorder::Get();
+    if (!recorder.Wants(recording::StreamLeft) || !s.d3d11Context) return;
+    const uint32_t eyeCount = (proj.viewCount > 1 && chRPtr) ? 2 : 1;
+    for (uint32_t e = 0; e < eyeCount; ++e) {
+        auto& chain = (e == 0) ? chL : const_cast<rt::Swapchain&>(*chRPtr);
+        const auto& subImage = proj.views[e].subImage;
+        ID3D11Texture2D* source = nullptr;
+        UINT subresource = 0;
+        const bool glImage = (chain.backend == rt::Swapchain::Backend::OpenGL);
+        if (glImage && !chain.glInterop) {
+            // Single-slice upload of this eye, the same frame the preview shows
+            if (chain.glReadback[e].hasContent) source = chain.glReadback[e].uploadTex.Get();
+        } else {
+            uint32_t idx = chain.lastReleased;
+            if (idx == UINT32_MAX || idx >= chain.imageCount) idx = chain.lastAcquired;
+            if (idx < chain.images.size() && chain.images[idx]) {
+                source = chain.images[idx].Get();
+                subresource = D3D11CalcSubresource(0, subImage.imageArrayIndex, chain.mipCount ? chain.mipCount : 1);
             }
-            ReleaseDC(s.hwnd, hdc);
         }
-        D3D12_RANGE writeRange = { 0, 0 };
-        s.previewReadback12->Unmap(0, &writeRange);
+        if (!source) continue;
+        D3D11_TEXTURE2D_DESC desc;
+        source->GetDesc(&desc);
+        const D3D11_BOX box = RecordingBox<D3D11_BOX>(subImage.imageRect, desc.Width, desc.Height);
+        recorder.Submit11(e == 0 ? recording::StreamLeft : recording::StreamRight, s.d3d11Device.Get(),
+                          s.d3d11Context.Get(), source, subresource, &box, glImage,
+                          rt::g_frameTiming.displayTime, rt::g_frameTiming.periodNs);
     }
+}
 
-    // Process window messages
-    MSG msg;
-    while (PeekMessageW(&msg, s.hwnd, 0, 0, PM_REMOVE)) { TranslateMessage(&msg); DispatchMessageW(&msg); }
-
-    static int blitCount = 0;
-    if (++blitCount % 60 == 1) {
-        Logf("[SimXR] blitD3D12ToPreview: GDI blit L[%u] R[%u] (%ux%u)", leftIdx, rightIdx, rtWidth, rtHeight);
+// Headless validation capture of one GL eye without interop: a synchronous glReadPixels of
+// the imageRect. Captures are sparse (every Nth frame), so the stall is kept off other frames.
+static void CaptureHeadlessGL(rt::Session& s, rt::Swapchain& chain, GLuint tex, uint32_t slice, const XrRect2Di& rect,
+                              uint32_t frame, const char* eye) {
+    const D3D11_BOX box = RecordingBox<D3D11_BOX>(rect, chain.width, chain.height);
+    const uint32_t w = box.right - box.left, h = box.bottom - box.top;
+    if (tex == 0 || w == 0 || h == 0) return;
+    // Same context handling as the GL preview path
+    HGLRC savedRC = wglGetCurrentContext();
+    HDC savedDC = wglGetCurrentDC();
+    if (s.glRC && s.glDC && savedRC != s.glRC) wglMakeCurrent(s.glDC, s.glRC);
+    if (!EnsureGLFramebufferFuncs()) {
+        if (savedRC && savedRC != s.glRC) wglMakeCurrent(savedDC, savedRC);
+        return;
+    }
+    GLint prevReadFbo = 0;
+    glGetIntegerv(GL_READ_FRAMEBUFFER_BINDING, &prevReadFbo);
+    GLuint fbo = 0;
+    g_glGenFramebuffers(1, &fbo);
+    g_glBindFramebuffer(GL_READ_FRAMEBUFFER, fbo);
+    if (chain.arraySize > 1 && EnsureGLPixelBufferFuncs()) {
+        g_glFramebufferTextureLayer(GL_READ_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, tex, 0, (GLint)slice);
+    } else {
+        g_glFramebufferTexture2D(GL_READ_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_TEXTURE_2D, tex, 0);
+    }
+    if (g_glCheckFramebufferStatus(GL_READ_FRAMEBUFFER) == GL_FRAMEBUFFER_COMPLETE) {
+        std::vector<uint8_t> pixels((size_t)w * h * 4);
+        GLint prevPack = 0;
+        if (EnsureGLPixelBufferFuncs()) {
+            glGetIntegerv(GL_PIXEL_PACK_BUFFER_BINDING, &prevPack);
+            g_glBindBuffer(GL_PIXEL_PACK_BUFFER, 0);
+        }
+        // GL's imageRect origin is the bottom-left, so rows come back bottom-up
+        glReadPixels((GLint)box.left, (GLint)box.top, (GLsizei)w, (GLsizei)h, GL_RGBA, GL_UNSIGNED_BYTE, pixels.data());
+        if (prevPack) g_glBindBuffer(GL_PIXEL_PACK_BUFFER, (GLuint)prevPack);
+        headless::Report(frame, eye, w, h, DXGI_FORMAT_R8G8B8A8_UNORM, pixels.data(), w * 4, true);
     }
+    g_glBindFramebuffer(GL_READ_FRAMEBUFFER, (GLuint)prevReadFbo);
+    g_glDeleteFramebuffers(1, &fbo);
+    if (savedRC && savedRC != s.glRC) wglMakeCurrent(savedDC, savedRC);
 }
 
-// Flag to track if Present should be called (deferred until all layers rendered)
-static bool g_presentPending = false;
+// Headless stand-in for presentProjection: nothing is composed or presented. Every Nth frame
+// each eye's released image is queued for a validation readback; finished readbacks are
+// hashed as they complete.
+static void CaptureHeadlessProjection(rt::Session& s, const XrCompositionLayerProjection& proj, uint32_t frame) {
+    if (!headless::CaptureFrame(frame) || proj.viewCount < 1 || !proj.views) return;
+    const uint32_t eyeCount = proj.viewCount > 1 ? 2 : 1;
+    for (uint32_t e = 0; e < eyeCount; ++e) {
+        const auto& subImage = proj.views[e].subImage;
+        rt::Swapchain* it = rt::g_swapchains.Find(subImage.swapchain);
+        if (!it) continue;
+        auto& chain = *it;
+        const char* eye = e == 0 ? "left" : "right";
+        uint32_t idx = chain.lastReleased;
+        if (idx == UINT32_MAX || idx >= chain.imageCount) idx = chain.lastAcquired;
+        if (idx == UINT32_MAX) continue;
+        const uint32_t slice = subImage.imageArrayIndex;
+
+        if (chain.backend == rt::Swapchain::Backend::D3D12) {
+            if (idx >= chain.images12.size() || !chain.images12[idx]) continue;
+            ID3D12Resource* image = chain.images12[idx].Get();
+            const D3D12_RESOURCE_DESC desc = image->GetDesc();
+            if (slice >= desc.DepthOrArraySize) continue;
+            headless::g_capture12.Queue(s.d3d12Device.Get(), s.d3d12Queue.Get(), image,
+                                        D3D12CalcSubresource(0, slice, 0, desc.MipLevels, desc.DepthOrArraySize),
+                                        RecordingBox<D3D12_BOX>(subImage.imageRect, (UINT)desc.Width, desc.Height),
+                                        frame, eye);
+        } else if (chain.backend == rt::Swapchain::Backend::OpenGL && !chain.glInterop) {
+            if (idx < chain.imagesGL.size()) CaptureHeadlessGL(s, chain, chain.imagesGL[idx], slice, subImage.imageRect, frame, eye);
+        } else if (idx < chain.images.size() && chain.images[idx] && s.d3d11Context) {
+            D3D11_TEXTURE2D_DESC desc;
+            chain.images[idx]->GetDesc(&desc);
+            headless::g_capture11.Queue(s.d3d11Device.Get(), s.d3d11Context.Get(), chain.images[idx].Get(),
+                                        D3D11CalcSubresource(0, slice, chain.mipCount ? chain.mipCount : 1),
+                                        RecordingBox<D3D11_BOX>(subImage.imageRect, desc.Width, desc.Height),
+                                        frame, eye, chain.backend == rt::Swapchain::Backend::OpenGL);
+        }
+    }
+}
 
 static void presentProjection(rt::Session& s, const XrCompositionLayerProjection& proj, bool skipPresent = false) {
-    Log("[SimXR] ============================================");
-    Logf("[SimXR] presentProjection called: viewCount=%u, skipPresent=%d", proj.viewCount, (int)skipPresent);
-    Log("[SimXR] RENDERING FRAME TO PREVIEW WINDOW");
-    Log("[SimXR] ============================================");
+    timing::ScopedStage projectionTimer(timing::StProjection);
+    LogAt(logging::CatFrame, logging::Level::Trace, "[SimXR] ============================================");
+    LogAtf(logging::CatFrame, logging::Level::Trace, "[SimXR] presentProjection called: viewCount=%u, skipPresent=%d", proj.viewCount, (int)skipPresent);
+    LogAt(logging::CatFrame, logging::Level::Trace, "[SimXR] RENDERING FRAME TO PREVIEW WINDOW");
+    LogAt(logging::CatFrame, logging::Level::Trace, "[SimXR] ============================================");
     if (proj.viewCount < 1) {
         Log("[SimXR] presentProjection: No views, returning");
         return;
     }
     const auto& vL = proj.views[0];
-    auto itL = rt::g_swapchains.find(vL.subImage.swapchain); 
-    if (itL == rt::g_swapchains.end()) {
+    rt::Swapchain* itL = rt::g_swapchains.Find(vL.subImage.swapchain);
+    if (!itL) {
         Log("[SimXR] presentProjection: Left swapchain not found");
         return;
     }
-    auto& chL = itL->second;
+    auto& chL = *itL;
     uint32_t width = chL.width, height = chL.height;
     const rt::Swapchain* chRPtr = &chL;
     if (proj.viewCount > 1) {
         const auto& vR = proj.views[1];
-        auto itR = rt::g_swapchains.find(vR.subImage.swapchain);
-        if (itR != rt::g_swapchains.end()) {
-            chRPtr = &itR->second;
-            if (itR->second.width > width) width = itR->second.width;
-            if (itR->second.height > height) height = itR->second.height;
+        rt::Swapchain* itR = rt::g_swapchains.Find(vR.subImage.swapchain);
+        if (itR) {
+            chRPtr = itR;
+            if (itR->width > width) width = itR->width;
+            if (itR->height > height) height = itR->height;
         }
     }
     {
@@ -3207,22 +5624,28 @@ static void presentProjection(rt::Session& s, const XrCompositionLayerProjection
             glFrameCount++;
 
             if (glFrameCount % 60 == 1) {
-                Logf("[SimXR] GL PREVIEW: frame=%d, width=%u, height=%u", glFrameCount, width, height);
+                LogAtf(logging::CatFrame, logging::Level::Debug, "[SimXR] GL PREVIEW: frame=%d, width=%u, height=%u", glFrameCount, width, height);
             }
 
+            // Zero-copy path: both eyes are D3D11 textures shared with GL (WGL_NV_DX_interop2),
+            // so there is nothing to read back. Released images are unlocked and safe to sample.
+            const bool glInterop = chL.glInterop && chRPtr && chRPtr->glInterop;
+
             // Make the app's GL context current
             HGLRC savedRC = wglGetCurrentContext();
             HDC savedDC = wglGetCurrentDC();
 
             if (glFrameCount % 60 == 1) {
-                Logf("[SimXR] GL PREVIEW: savedRC=%p, savedDC=%p, s.glRC=%p, s.glDC=%p",
-                     savedRC, savedDC, s.glRC, s.glDC);
+                LogAtf(logging::CatFrame, logging::Level::Debug, "[SimXR] GL PREVIEW: savedRC=%p, savedDC=%p, s.glRC=%p, s.glDC=%p, interop=%d",
+                     savedRC, savedDC, s.glRC, s.glDC, (int)glInterop);
             }
 
-            if (s.glRC && s.glDC) {
+            if (glInterop) {
+                // No GL calls needed on this path
+            } else if (s.glRC && s.glDC) {
                 BOOL result = wglMakeCurrent(s.glDC, s.glRC);
                 if (glFrameCount % 60 == 1) {
-                    Logf("[SimXR] GL PREVIEW: wglMakeCurrent result=%d", result);
+                    LogAtf(logging::CatFrame, logging::Level::Debug, "[SimXR] GL PREVIEW: wglMakeCurrent result=%d", result);
                 }
             } else {
                 if (glFrameCount % 60 == 1) {
@@ -3230,150 +5653,94 @@ static void presentProjection(rt::Session& s, const XrCompositionLayerProjection
                 }
             }
 
-            // Read pixel data from GL textures into CPU buffers
-            std::vector<uint8_t> leftPixels(width * height * 4);
-            std::vector<uint8_t> rightPixels(width * height * 4);
-
             // Get left eye texture
             GLuint leftTex = 0;
+            uint32_t leftIdx = UINT32_MAX;
             if (chL.imagesGL.size() > 0) {
                 uint32_t idx = chL.lastReleased;
                 if (idx == UINT32_MAX || idx >= chL.imageCount) idx = chL.lastAcquired;
                 if (idx != UINT32_MAX && idx < chL.imagesGL.size()) {
                     leftTex = chL.imagesGL[idx];
+                    leftIdx = idx;
                 }
             }
 
             // Get right eye texture
             GLuint rightTex = 0;
+            uint32_t rightIdx = UINT32_MAX;
             if (chRPtr && chRPtr->imagesGL.size() > 0) {
                 uint32_t idx = chRPtr->lastReleased;
                 if (idx == UINT32_MAX || idx >= chRPtr->imageCount) idx = chRPtr->lastAcquired;
                 if (idx != UINT32_MAX && idx < chRPtr->imagesGL.size()) {
                     rightTex = chRPtr->imagesGL[idx];
+                    rightIdx = idx;
                 }
             }
 
-            // Read left eye pixels using glGetTexImage
-            if (leftTex != 0) {
-                glBindTexture(GL_TEXTURE_2D, leftTex);
-                glGetTexImage(GL_TEXTURE_2D, 0, GL_RGBA, GL_UNSIGNED_BYTE, leftPixels.data());
+            // Log progress
+            if (glFrameCount % 60 == 1) {
+                LogAtf(logging::CatFrame, logging::Level::Debug, "[SimXR] OpenGL frame #%d - leftTex=%u, rightTex=%u, size=%ux%u",
+                     glFrameCount, leftTex, rightTex, width, height);
             }
 
-            // Read right eye pixels
-            if (rightTex != 0) {
-                glBindTexture(GL_TEXTURE_2D, rightTex);
-                glGetTexImage(GL_TEXTURE_2D, 0, GL_RGBA, GL_UNSIGNED_BYTE, rightPixels.data());
+            // The readback uploads into D3D11 textures, so the preview device must exist first
+            if (!rt::EnsureRuntimeD3D11Device(s)) {
+                if (!glInterop && savedRC) wglMakeCurrent(savedDC, savedRC);
+                return;
             }
 
-            // Flip images vertically - OpenGL has Y=0 at bottom, D3D expects Y=0 at top
-            auto flipImageVertically = [](std::vector<uint8_t>& pixels, uint32_t width, uint32_t height) {
-                const uint32_t rowSize = width * 4;
-                std::vector<uint8_t> tempRow(rowSize);
-                for (uint32_t y = 0; y < height / 2; y++) {
-                    uint8_t* topRow = pixels.data() + y * rowSize;
-                    uint8_t* bottomRow = pixels.data() + (height - 1 - y) * rowSize;
-                    memcpy(tempRow.data(), topRow, rowSize);
-                    memcpy(topRow, bottomRow, rowSize);
-                    memcpy(bottomRow, tempRow.data(), rowSize);
-                }
-            };
-            if (leftTex != 0) flipImageVertically(leftPixels, width, height);
-            if (rightTex != 0) flipImageVertically(rightPixels, width, height);
+            // Readback path: queue this frame into the PBO rings and take back the frame queued
+            // two frames ago. Screenshot pixels come from the same mapped data, so a request
+            // stays pending until the ring has produced a frame.
+            if (!glInterop) {
+                timing::ScopedStage screenshotTimer(timing::StProjScreenshot);
+                mcp::CheckScreenshotRequest();
+            }
+            const bool wantPixels = !glInterop && mcp::g_screenshotRequested && mcp::g_screenshotLayer != "quad";
+            std::vector<uint8_t> leftPixels, rightPixels;
+            ID3D11ShaderResourceView* leftReadbackSRV = nullptr;
+            ID3D11ShaderResourceView* rightReadbackSRV = nullptr;
+            if (!glInterop) {
+                timing::ScopedStage readbackTimer(timing::StProjGLReadback);
+                auto& chR = const_cast<rt::Swapchain&>(*chRPtr);
+                const bool logStats = (glFrameCount % 60 == 1);
+                leftReadbackSRV = rt::ReadbackGLEyeAsync(s, chL, 0, leftTex, vL.subImage.imageArrayIndex,
+                                                         wantPixels ? &leftPixels : nullptr, logStats);
+                const uint32_t rightSlice = proj.viewCount > 1 ? proj.views[1].subImage.imageArrayIndex : 0;
+                rightReadbackSRV = rt::ReadbackGLEyeAsync(s, chR, 1, rightTex, rightSlice,
+                                                          wantPixels ? &rightPixels : nullptr, logStats);
+            }
 
-            // MCP Integration - check for screenshot requests and capture (OpenGL path)
-            mcp::CheckScreenshotRequest();
-            if (mcp::g_screenshotRequested) {
+            // MCP Integration - capture screenshots (OpenGL readback path).
+            // The interop path has no CPU pixels; it captures the preview backbuffer after the blit.
+            if (!glInterop && mcp::g_screenshotRequested) {
+                timing::ScopedStage screenshotTimer(timing::StProjScreenshot);
+                // CaptureScreenshotGL places both eyes side by side at the left eye's size
+                const bool rightMatches = !rightPixels.empty() &&
+                                          chRPtr->width == chL.width && chRPtr->height == chL.height;
                 if (mcp::g_screenshotLayer == "quad") {
                     // Capture only quad layer
                     mcp::CaptureQuadScreenshot();
-                } else if (mcp::g_screenshotLayer == "all") {
-                    // Capture both projection and quad layers
-                    mcp::CaptureScreenshotGL(
-                        leftTex != 0 ? leftPixels.data() : nullptr,
-                        rightTex != 0 ? rightPixels.data() : nullptr,
-                        width, height);
-                    // Also capture quad layer separately
-                    if (mcp::g_quadLayerCaptured) {
-                        std::string quadPath = mcp::GetSimulatorDataPath() + "\\screenshot_quad.bmp";
-                        mcp::SavePixelsToBMP(mcp::g_quadLayerPixels.data(),
-                            mcp::g_quadLayerWidth, mcp::g_quadLayerHeight, quadPath.c_str());
+                } else if (!leftPixels.empty()) {
+                    const screenshot::Format shotFormat = mcp::g_screenshotFormat;
+                    mcp::CaptureScreenshotGL(leftPixels.data(), rightMatches ? rightPixels.data() : nullptr,
+                                             chL.width, chL.height);
+                    if (mcp::g_screenshotLayer == "all") {
+                        // Also capture quad layer separately
+                        if (mcp::g_quadLayerCaptured) {
+                            std::vector<uint8_t> quadPixels = mcp::g_quadLayerPixels;
+                            mcp::SubmitScreenshot(std::move(quadPixels), mcp::g_quadLayerWidth, mcp::g_quadLayerHeight,
+                                                  0, false, "screenshot_quad", shotFormat);
+                        }
                     }
-                    mcp::g_screenshotRequested = false;
-                } else {
-                    // Default: capture projection layer
-                    mcp::CaptureScreenshotGL(
-                        leftTex != 0 ? leftPixels.data() : nullptr,
-                        rightTex != 0 ? rightPixels.data() : nullptr,
-                        width, height);
                 }
             }
 
             // Restore original GL context
-            if (savedRC) {
+            if (!glInterop && savedRC) {
                 wglMakeCurrent(savedDC, savedRC);
             }
 
-            // Log progress and check if pixel data is valid
-            if (glFrameCount % 60 == 1) {
-                Logf("[SimXR] OpenGL frame #%d - leftTex=%u, rightTex=%u, size=%ux%u",
-                     glFrameCount, leftTex, rightTex, width, height);
-
-                // Check if pixels are all zero (black) or have content
-                uint32_t leftSum = 0, rightSum = 0;
-                for (size_t i = 0; i < std::min((size_t)1000, leftPixels.size()); i++) {
-                    leftSum += leftPixels[i];
-                }
-                for (size_t i = 0; i < std::min((size_t)1000, rightPixels.size()); i++) {
-                    rightSum += rightPixels[i];
-                }
-                Logf("[SimXR] GL PREVIEW: leftPixelSum=%u, rightPixelSum=%u (first 1000 bytes)", leftSum, rightSum);
-
-                // Print first few pixel values (RGBA)
-                if (leftPixels.size() >= 16) {
-                    Logf("[SimXR] GL PREVIEW: First 4 pixels (RGBA): [%d,%d,%d,%d] [%d,%d,%d,%d] [%d,%d,%d,%d] [%d,%d,%d,%d]",
-                         leftPixels[0], leftPixels[1], leftPixels[2], leftPixels[3],
-                         leftPixels[4], leftPixels[5], leftPixels[6], leftPixels[7],
-                         leftPixels[8], leftPixels[9], leftPixels[10], leftPixels[11],
-                         leftPixels[12], leftPixels[13], leftPixels[14], leftPixels[15]);
-                }
-
-                // Check a pixel in the middle of the image
-                size_t midOffset = (height / 2) * width * 4 + (width / 2) * 4;
-                if (midOffset + 4 <= leftPixels.size()) {
-                    Logf("[SimXR] GL PREVIEW: Middle pixel (RGBA): [%d,%d,%d,%d]",
-                         leftPixels[midOffset], leftPixels[midOffset+1], leftPixels[midOffset+2], leftPixels[midOffset+3]);
-                }
-            }
-
-            // Now create/use D3D11 preview if we don't have one yet
-            if (!s.d3d11Device) {
-                // Create D3D11 device for preview window
-                D3D_FEATURE_LEVEL featureLevel;
-                UINT flags = 0;
-                #ifdef _DEBUG
-                flags |= D3D11_CREATE_DEVICE_DEBUG;
-                #endif
-                HRESULT hr = D3D11CreateDevice(nullptr, D3D_DRIVER_TYPE_HARDWARE, nullptr, flags,
-                                               nullptr, 0, D3D11_SDK_VERSION,
-                                               &s.d3d11Device, &featureLevel, &s.d3d11Context);
-                if (FAILED(hr)) {
-                    Logf("[SimXR] Failed to create D3D11 device for GL preview: 0x%08X", hr);
-                    return;
-                }
-                Log("[SimXR] Created D3D11 device for OpenGL preview");
-
-                // Force shader recompilation by resetting blit resources
-                s.blitVS.Reset();
-                s.blitPS.Reset();
-                s.samplerState.Reset();
-                s.noCullRS.Reset();
-                s.anaglyphRedBS.Reset();
-                s.anaglyphCyanBS.Reset();
-                s.alphaBlendBS.Reset();
-                Log("[SimXR] Reset blit resources for fresh shader compilation");
-            }
-
             // Use the standard preview path now that we have a D3D11 device
             DXGI_FORMAT displayFormat = DXGI_FORMAT_R8G8B8A8_UNORM;
             const auto viewMode = ui::g_uiState.viewMode;
@@ -3383,7 +5750,7 @@ static void presentProjection(rt::Session& s, const XrCompositionLayerProjection
             ui::CalculateWindowSize((int)width, (int)height, targetWidth, targetHeight);
 
             if (glFrameCount % 60 == 1) {
-                Logf("[SimXR] GL PREVIEW: targetSize=%dx%d, calling ensurePreviewSized", targetWidth, targetHeight);
+                LogAtf(logging::CatFrame, logging::Level::Debug, "[SimXR] GL PREVIEW: targetSize=%dx%d, calling ensurePreviewSized", targetWidth, targetHeight);
             }
 
             ensurePreviewSized(s, (UINT)targetWidth, (UINT)targetHeight, displayFormat);
@@ -3400,27 +5767,15 @@ static void presentProjection(rt::Session& s, const XrCompositionLayerProjection
                 return;
             }
 
-            // Create staging textures to upload GL pixel data
-            D3D11_TEXTURE2D_DESC texDesc = {};
-            texDesc.Width = width;
-            texDesc.Height = height;
-            texDesc.MipLevels = 1;
-            texDesc.ArraySize = 1;
-            texDesc.Format = DXGI_FORMAT_R8G8B8A8_UNORM;
-            texDesc.SampleDesc.Count = 1;
-            texDesc.Usage = D3D11_USAGE_DEFAULT;
-            texDesc.BindFlags = D3D11_BIND_SHADER_RESOURCE;
-
-            D3D11_SUBRESOURCE_DATA initData = {};
-            initData.pSysMem = leftPixels.data();
-            initData.SysMemPitch = width * 4;
-
             ComPtr<ID3D11Texture2D> leftTex2D;
-            s.d3d11Device->CreateTexture2D(&texDesc, &initData, &leftTex2D);
-
-            initData.pSysMem = rightPixels.data();
             ComPtr<ID3D11Texture2D> rightTex2D;
-            s.d3d11Device->CreateTexture2D(&texDesc, &initData, &rightTex2D);
+            bool srcIsSrgb = false;
+            if (glInterop) {
+                // Sample the shared textures directly
+                if (leftIdx < chL.images.size()) leftTex2D = chL.images[leftIdx];
+                if (rightIdx < chRPtr->images.size()) rightTex2D = chRPtr->images[rightIdx];
+                srcIsSrgb = (chL.glInternalFormat == GL_SRGB8_ALPHA8);
+            }
 
             // Use shader-based rendering for proper side-by-side display
             const bool singleEye = (viewMode != ui::ViewMode::BothEyes);
@@ -3433,15 +5788,19 @@ static void presentProjection(rt::Session& s, const XrCompositionLayerProjection
                 return;
             }
 
-            // Create render target view for the backbuffer
+            // Create render target view for the backbuffer. An sRGB interop source is decoded
+            // when sampled, so re-encode through an sRGB view to keep the bytes unchanged.
             ComPtr<ID3D11RenderTargetView> rtv;
-            if (FAILED(s.d3d11Device->CreateRenderTargetView(bb.Get(), nullptr, rtv.GetAddressOf()))) {
+            D3D11_RENDER_TARGET_VIEW_DESC rtvDesc = {};
+            rtvDesc.Format = DXGI_FORMAT_R8G8B8A8_UNORM_SRGB;
+            rtvDesc.ViewDimension = D3D11_RTV_DIMENSION_TEXTURE2D;
+            if (FAILED(s.d3d11Device->CreateRenderTargetView(bb.Get(), srcIsSrgb ? &rtvDesc : nullptr, rtv.GetAddressOf()))) {
                 Log("[SimXR] OpenGL preview: Failed to create RTV");
                 return;
             }
 
-            // Create SRVs for the uploaded textures
-            ComPtr<ID3D11ShaderResourceView> leftSRV, rightSRV;
+            // SRVs for the shared textures, or the readback rings' persistent upload textures
+            ComPtr<ID3D11ShaderResourceView> leftSRV = leftReadbackSRV, rightSRV = rightReadbackSRV;
             if (leftTex2D) {
                 HRESULT hr = s.d3d11Device->CreateShaderResourceView(leftTex2D.Get(), nullptr, leftSRV.GetAddressOf());
                 if (FAILED(hr) && glFrameCount % 60 == 1) {
@@ -3456,8 +5815,8 @@ static void presentProjection(rt::Session& s, const XrCompositionLayerProjection
             }
 
             if (glFrameCount % 60 == 1) {
-                Logf("[SimXR] GL PREVIEW: leftTex2D=%p rightTex2D=%p leftSRV=%p rightSRV=%p",
-                     leftTex2D.Get(), rightTex2D.Get(), leftSRV.Get(), rightSRV.Get());
+                LogAtf(logging::CatFrame, logging::Level::Debug, "[SimXR] GL PREVIEW: interop=%d leftSRV=%p rightSRV=%p",
+                     (int)glInterop, leftSRV.Get(), rightSRV.Get());
             }
 
             // Clear the render target
@@ -3497,7 +5856,7 @@ static void presentProjection(rt::Session& s, const XrCompositionLayerProjection
                 }
 
                 if (glFrameCount % 60 == 1) {
-                    Logf("[SimXR] GL PREVIEW: blitTexture - vp=(%.0f,%.0f,%.0f,%.0f) srv=%p",
+                    LogAtf(logging::CatFrame, logging::Level::Debug, "[SimXR] GL PREVIEW: blitTexture - vp=(%.0f,%.0f,%.0f,%.0f) srv=%p",
                          vp.TopLeftX, vp.TopLeftY, vp.Width, vp.Height, srv);
                 }
 
@@ -3506,7 +5865,8 @@ static void presentProjection(rt::Session& s, const XrCompositionLayerProjection
                 s.d3d11Context->OMSetRenderTargets(1, currentRTVs, nullptr);
 
                 s.d3d11Context->RSSetViewports(1, &vp);
-                s.d3d11Context->VSSetShader(s.blitVS.Get(), nullptr, 0);
+                // Interop images and readback uploads are both bottom-up; flip in the VS
+                s.d3d11Context->VSSetShader(s.blitVSFlipY.Get(), nullptr, 0);
                 s.d3d11Context->PSSetShader(s.blitPS.Get(), nullptr, 0);
 
                 ID3D11ShaderResourceView* srvs[] = { srv };
@@ -3528,6 +5888,7 @@ static void presentProjection(rt::Session& s, const XrCompositionLayerProjection
             };
 
             // Render the eyes
+            timing::ScopedStage blitTimer(timing::StProjBlit);
             if (singleEye) {
                 if (showLeft && leftSRV) {
                     blitTexture(leftSRV.Get(), fullVp);
@@ -3547,6 +5908,24 @@ static void presentProjection(rt::Session& s, const XrCompositionLayerProjection
                 }
             }
 
+            blitTimer.Stop();
+
+            // Interop path: screenshots come from the composed backbuffer
+            if (glInterop) {
+                timing::ScopedStage screenshotTimer(timing::StProjScreenshot);
+                mcp::g_capture11.Poll(s.d3d11Context.Get());
+                mcp::CheckScreenshotRequest();
+                if (mcp::g_screenshotRequested) {
+                    if (mcp::g_screenshotLayer == "quad") {
+                        mcp::CaptureQuadScreenshot();
+                    } else {
+                        mcp::CaptureScreenshot(s.d3d11Device.Get(), s.d3d11Context.Get(), s.previewSwapchain.Get());
+                    }
+                }
+            }
+
+            RecordEyes11(s, proj, chL, chRPtr);
+
             // Update window title with FPS
             static int glTitleFrameCount = 0;
             static auto glLastTitleUpdate = std::chrono::high_resolution_clock::now();
@@ -3558,7 +5937,7 @@ static void presentProjection(rt::Session& s, const XrCompositionLayerProjection
                 glLastFPS = (int)(glTitleFrameCount * 1000 / elapsed);
                 glTitleFrameCount = 0;
                 glLastTitleUpdate = now;
-                ui::UpdateWindowTitle(s.hwnd, glLastFPS, 0);
+                UpdatePreviewTitle(s.hwnd, glLastFPS);
             }
 
             // Present (may be deferred if overlays are pending)
@@ -3567,9 +5946,12 @@ static void presentProjection(rt::Session& s, const XrCompositionLayerProjection
                 while (PeekMessageW(&msg, s.hwnd, 0, 0, PM_REMOVE)) { TranslateMessage(&msg); DispatchMessageW(&msg); }
 
                 if (glFrameCount % 60 == 1) {
-                    Logf("[SimXR] GL PREVIEW: About to Present - hwnd=%p, swapchain=%p", s.hwnd, s.previewSwapchain.Get());
+                    LogAtf(logging::CatFrame, logging::Level::Debug, "[SimXR] GL PREVIEW: About to Present - hwnd=%p, swapchain=%p", s.hwnd, s.previewSwapchain.Get());
                 }
 
+                RecordPreview11(s);
+                AnalyzePreview11(s);
+                timing::ScopedStage presentTimer(timing::StPresent);
                 HRESULT presentHr = s.previewSwapchain->Present(1, 0);
                 if (FAILED(presentHr) && glFrameCount % 60 == 1) {
                     Logf("[SimXR] GL PREVIEW: Present FAILED with hr=0x%08X", presentHr);
@@ -3585,28 +5967,8 @@ static void presentProjection(rt::Session& s, const XrCompositionLayerProjection
         // We create SRGB RTVs for proper gamma when rendering
         DXGI_FORMAT displayFormat = DXGI_FORMAT_R8G8B8A8_UNORM;
 
-        // For D3D12: CopyTextureRegion requires format compatibility, so the preview
-        // swapchain must use the same channel layout as the source XR swapchain.
-        // Strip sRGB (not valid for FLIP_DISCARD) but keep the channel order.
-        if (s.usesD3D12) {
-            switch (chL.format) {
-                case DXGI_FORMAT_B8G8R8A8_UNORM:
-                case DXGI_FORMAT_B8G8R8A8_UNORM_SRGB:
-                case DXGI_FORMAT_B8G8R8A8_TYPELESS:
-                    displayFormat = DXGI_FORMAT_B8G8R8A8_UNORM;
-                    break;
-                case DXGI_FORMAT_R16G16B16A16_FLOAT:
-                case DXGI_FORMAT_R16G16B16A16_UNORM:
-                    displayFormat = DXGI_FORMAT_R16G16B16A16_FLOAT;
-                    break;
-                case DXGI_FORMAT_R10G10B10A2_UNORM:
-                    displayFormat = DXGI_FORMAT_R10G10B10A2_UNORM;
-                    break;
-                default:
-                    displayFormat = DXGI_FORMAT_R8G8B8A8_UNORM;
-                    break;
-            }
-        }
+        // D3D12 draws into its own BGRA target whatever the source format, so the format only
+        // matters for the D3D11 swapchain
 
         const auto viewMode = ui::g_uiState.viewMode;
         const auto layout = ui::g_uiState.displayLayout;
@@ -3628,16 +5990,26 @@ static void presentProjection(rt::Session& s, const XrCompositionLayerProjection
 
         static int blitCount = 0;
         if (++blitCount % 60 == 1) {  // Log every 60 frames
-            Logf("[SimXR] Blitting left eye: idx=%u (lastReleased=%u, lastAcquired=%u, imageCount=%u)",
+            LogAtf(logging::CatFrame, logging::Level::Debug, "[SimXR] Blitting left eye: idx=%u (lastReleased=%u, lastAcquired=%u, imageCount=%u)",
                  leftIdx, chL.lastReleased, chL.lastAcquired, chL.imageCount);
         }
 
-        if (!s.usesD3D12) {
+        if (!s.usesD3D12 && rt::CompositorThreadActive(s)) {
+            // ===== D3D11 PATH, COMPOSITOR THREAD =====
+            SubmitToCompositor(s, proj, chL, chRPtr);
+            RecordEyes11(s, proj, chL, chRPtr);
+            static ULONGLONG lastTitleMs = 0;
+            ULONGLONG nowMs = GetTickCount64();
+            if (nowMs - lastTitleMs >= 500) {
+                lastTitleMs = nowMs;
+                UpdatePreviewTitle(s.hwnd, rt::g_compositor.fps.load(std::memory_order_relaxed));
+            }
+        } else if (!s.usesD3D12) {
             // ===== D3D11 PATH =====
             if (!s.previewSwapchain) return;
 
-            // Save D3D11 context state - will auto-restore when stateBackup goes out of scope
-            D3D11StateBackup stateBackup(s.d3d11Context.Get());
+            // Isolate the app's context state; restored when stateScope goes out of scope
+            D3D11StateScope stateScope(s);
 
             // Get the backbuffer and create RTV
             ComPtr<ID3D11Texture2D> bb;
@@ -3704,6 +6076,7 @@ static void presentProjection(rt::Session& s, const XrCompositionLayerProjection
                 rightBlend = s.anaglyphCyanBS.Get();
             }
 
+            timing::ScopedStage blitTimer(timing::StProjBlit);
             if (showLeft) {
                 blitViewToHalf(s, chL, leftIdx, vL.subImage.imageArrayIndex, vL.subImage.imageRect,
                                rtv.Get(), leftVp, leftBlend);
@@ -3726,11 +6099,16 @@ static void presentProjection(rt::Session& s, const XrCompositionLayerProjection
                 blitViewToHalf(s, chL, leftIdx, vL.subImage.imageArrayIndex, vL.subImage.imageRect,
                                rtv.Get(), rightVp, rightBlend);
             }
+            blitTimer.Stop();
+            RecordEyes11(s, proj, chL, chRPtr);
 
             // Present D3D11 (may be deferred if overlays are pending)
             if (!skipPresent) {
                 MSG msg;
                 while (PeekMessageW(&msg, s.hwnd, 0, 0, PM_REMOVE)) { TranslateMessage(&msg); DispatchMessageW(&msg); }
+                RecordPreview11(s);
+                AnalyzePreview11(s);
+                timing::ScopedStage presentTimer(timing::StPresent);
                 s.previewSwapchain->Present(1, 0);
             } else {
                 g_presentPending = true;
@@ -3747,28 +6125,27 @@ static void presentProjection(rt::Session& s, const XrCompositionLayerProjection
                 lastFPS = (int)(titleFrameCount * 1000 / elapsed);
                 titleFrameCount = 0;
                 lastTitleUpdate = now;
-                ui::UpdateWindowTitle(s.hwnd, lastFPS, 0);
+                UpdatePreviewTitle(s.hwnd, lastFPS);
             }
 
-            // MCP Integration - check for screenshot requests and capture
-            mcp::CheckScreenshotRequest();
-            if (mcp::g_screenshotRequested) {
-                mcp::CaptureScreenshot(s.d3d11Device.Get(), s.d3d11Context.Get(), s.previewSwapchain.Get());
+            // MCP Integration - check for screenshot requests and queue the capture; earlier
+            // captures whose copies have finished are handed to the writer thread
+            {
+                timing::ScopedStage screenshotTimer(timing::StProjScreenshot);
+                mcp::g_capture11.Poll(s.d3d11Context.Get());
+                mcp::CheckScreenshotRequest();
+                if (mcp::g_screenshotRequested) {
+                    mcp::CaptureScreenshot(s.d3d11Device.Get(), s.d3d11Context.Get(), s.previewSwapchain.Get());
+                }
             }
 
         } else {
             // ===== D3D12 PATH (GDI-based presentation) =====
             if (!s.previewRT12) return;
 
-            // Cross-queue sync: make preview queue wait for game queue to finish
-            // rendering to the source textures before we copy from them
-            if (s.crossQueueFence && s.previewQueue12) {
-                s.crossQueueFenceValue++;
-                s.d3d12Queue->Signal(s.crossQueueFence.Get(), s.crossQueueFenceValue);
-                s.previewQueue12->Wait(s.crossQueueFence.Get(), s.crossQueueFenceValue);
-            }
-
-            // Blit using D3D12 copy commands → readback → GDI (no DXGI Present, no hook conflicts)
+            // Compose with D3D12 draws → readback → GDI (no DXGI Present, no hook conflicts).
+            // With overlays pending the command list stays open for the layer draws and
+            // xrEndFrame submits it once they are recorded.
             if (proj.viewCount > 1) {
                 const auto& vR = proj.views[1];
                 auto& chR = const_cast<rt::Swapchain&>(*chRPtr);
@@ -3778,15 +6155,15 @@ static void presentProjection(rt::Session& s, const XrCompositionLayerProjection
                 } else if (chR.lastAcquired != UINT32_MAX && chR.lastAcquired < chR.imageCount) {
                     rightIdx = chR.lastAcquired;
                 }
-                blitD3D12ToPreview(s, chL, leftIdx, vL.subImage.imageArrayIndex,
-                                   &chR, rightIdx, vR.subImage.imageArrayIndex,
-                                   layout, viewMode);
+                blitD3D12ToPreview(s, chL, leftIdx, vL.subImage.imageArrayIndex, &vL.subImage.imageRect,
+                                   &chR, rightIdx, vR.subImage.imageArrayIndex, &vR.subImage.imageRect,
+                                   layout, viewMode, skipPresent);
             } else {
-                blitD3D12ToPreview(s, chL, leftIdx, vL.subImage.imageArrayIndex,
-                                   nullptr, 0, 0, layout, viewMode);
+                blitD3D12ToPreview(s, chL, leftIdx, vL.subImage.imageArrayIndex, &vL.subImage.imageRect,
+                                   nullptr, 0, 0, nullptr, layout, viewMode, skipPresent);
             }
 
-            // No Present call needed - blitD3D12ToPreview handles GDI painting directly
+            // No Present call needed - FinishD3D12Preview handles GDI painting directly
 
             // Update window title with FPS stats
             static int d3d12TitleFrameCount = 0;
@@ -3799,46 +6176,78 @@ static void presentProjection(rt::Session& s, const XrCompositionLayerProjection
                 d3d12LastFPS = (int)(d3d12TitleFrameCount * 1000 / elapsed12);
                 d3d12TitleFrameCount = 0;
                 d3d12LastTitleUpdate = now12;
-                ui::UpdateWindowTitle(s.hwnd, d3d12LastFPS, 0);
+                UpdatePreviewTitle(s.hwnd, d3d12LastFPS);
             }
 
-            // MCP Integration - check for screenshot requests and capture (D3D12)
-            // Screenshots use the readback buffer that was just filled by blitD3D12ToPreview
-            mcp::CheckScreenshotRequest();
-            if (mcp::g_screenshotRequested && s.previewRT12 && s.previewCmdAlloc && s.previewCmdList) {
-                mcp::CaptureScreenshotD3D12(s.d3d12Device.Get(), s.previewQueue12.Get(),
-                                             s.previewRT12.Get(),
-                                             s.previewCmdAlloc.Get(), s.previewCmdList.Get(),
-                                             s.previewFence.Get(), s.previewFenceEvent,
-                                             s.previewFenceValue);
+            // Screenshots reuse previewCmdList, so they wait until the layers are submitted
+            if (skipPresent) {
+                g_presentPending = true;
+            } else {
+                CaptureD3D12PreviewScreenshot(s);
             }
         }
     }
 }
 
-// Render a quad layer as 2D overlay (supports both D3D11 and OpenGL)
-static void renderQuadLayer(rt::Session& s, const XrCompositionLayerQuad* quad) {
-    if (!quad) return;
-    // D3D12 sessions use previewRT12, not previewSwapchain
-    if (!s.previewSwapchain && !s.previewRT12) return;
+// Quad and cylinder layers are both previewed as a flat, aspect-correct rect centred in each
+// eye's viewport. A cylinder's aspectRatio is already width / height of the unrolled image.
+struct OverlayLayer {
+    const XrSwapchainSubImage* subImage;
+    float aspect;
+    XrEyeVisibility eyeVisibility;
+};
 
-    if (s.usesD3D12) {
-        static bool warnedD3D12 = false;
-        if (!warnedD3D12) {
-            Log("[SimXR] WARNING: Quad layer rendering not implemented for D3D12 sessions");
-            warnedD3D12 = true;
-        }
-        return;
+static bool GetOverlayLayer(const XrCompositionLayerBaseHeader* base, OverlayLayer& out) {
+    if (!base) return false;
+    if (base->type == XR_TYPE_COMPOSITION_LAYER_QUAD) {
+        const auto* quad = reinterpret_cast<const XrCompositionLayerQuad*>(base);
+        out = { &quad->subImage, quad->size.height > 0.0f ? quad->size.width / quad->size.height : 1.0f,
+                quad->eyeVisibility };
+        return true;
+    }
+    if (base->type == XR_TYPE_COMPOSITION_LAYER_CYLINDER_KHR) {
+        const auto* cyl = reinterpret_cast<const XrCompositionLayerCylinderKHR*>(base);
+        out = { &cyl->subImage, cyl->aspectRatio > 0.0f ? cyl->aspectRatio : 1.0f, cyl->eyeVisibility };
+        return true;
+    }
+    return false;
+}
+
+// Display rect for an overlay within one eye's viewport (90% of it, aspect preserved)
+template <typename Viewport>
+static Viewport OverlayViewport(const Viewport& eyeVp, float aspect) {
+    float displayW = eyeVp.Width * 0.9f;
+    float displayH = displayW / aspect;
+    if (displayH > eyeVp.Height * 0.9f) {
+        displayH = eyeVp.Height * 0.9f;
+        displayW = displayH * aspect;
     }
+    Viewport vp = eyeVp;
+    vp.TopLeftX = eyeVp.TopLeftX + (eyeVp.Width - displayW) / 2.0f;
+    vp.TopLeftY = eyeVp.TopLeftY + (eyeVp.Height - displayH) / 2.0f;
+    vp.Width = displayW;
+    vp.Height = displayH;
+    return vp;
+}
+
+// Render a quad or cylinder layer as 2D overlay (D3D11 and OpenGL; D3D12 sessions batch
+// theirs in renderOverlayLayersD3D12)
+static void renderQuadLayer(rt::Session& s, const XrCompositionLayerBaseHeader* layer) {
+    timing::ScopedStage quadTimer(timing::StQuadLayer);
+    rt::GpuScope11 gpuTimer(s, timing::StGpuQuadLayer);
+    OverlayLayer overlay;
+    if (!GetOverlayLayer(layer, overlay)) return;
+    const XrSwapchainSubImage& subImage = *overlay.subImage;
+    if (!s.previewSwapchain || s.usesD3D12) return;
 
-    auto it = rt::g_swapchains.find(quad->subImage.swapchain);
-    if (it == rt::g_swapchains.end()) return;
+    rt::Swapchain* it = rt::g_swapchains.Find(subImage.swapchain);
+    if (!it) return;
 
-    auto& chain = it->second;
+    auto& chain = *it;
 
     // Get texture dimensions from the quad subImage
-    uint32_t texWidth = quad->subImage.imageRect.extent.width;
-    uint32_t texHeight = quad->subImage.imageRect.extent.height;
+    uint32_t texWidth = subImage.imageRect.extent.width;
+    uint32_t texHeight = subImage.imageRect.extent.height;
     if (texWidth == 0) texWidth = chain.width;
     if (texHeight == 0) texHeight = chain.height;
 
@@ -3850,15 +6259,15 @@ static void renderQuadLayer(rt::Session& s, const XrCompositionLayerQuad* quad)
     bool shouldLog = (++quadLogCount % 60 == 1);
 
     if (shouldLog) {
-        Logf("[SimXR] Quad swapchain: handle=%llu, lastReleased=%u, lastAcquired=%u, texIdx=%u, imageCount=%u",
-             (unsigned long long)quad->subImage.swapchain, chain.lastReleased, chain.lastAcquired,
+        LogAtf(logging::CatFrame, logging::Level::Debug, "[SimXR] Quad swapchain: handle=%llu, lastReleased=%u, lastAcquired=%u, texIdx=%u, imageCount=%u",
+             (unsigned long long)subImage.swapchain, chain.lastReleased, chain.lastAcquired,
              texIdx, chain.imageCount);
     }
 
-    ComPtr<ID3D11Texture2D> quadTex;
+    ComPtr<ID3D11ShaderResourceView> srv;
 
-    // Check if using OpenGL
-    if (chain.backend == rt::Swapchain::Backend::OpenGL && !chain.imagesGL.empty()) {
+    // Check if using OpenGL (interop-backed GL swapchains take the D3D11 path below)
+    if (chain.backend == rt::Swapchain::Backend::OpenGL && !chain.glInterop && !chain.imagesGL.empty()) {
         if (texIdx >= chain.imagesGL.size()) return;
         GLuint glTex = chain.imagesGL[texIdx];
         if (glTex == 0) return;
@@ -3869,7 +6278,7 @@ static void renderQuadLayer(rt::Session& s, const XrCompositionLayerQuad* quad)
 
         // DEBUG: Log current context BEFORE switch
         if (shouldLog) {
-            Logf("[SimXR] Quad GL context: current={RC=%p,DC=%p}, stored={RC=%p,DC=%p}",
+            LogAtf(logging::CatFrame, logging::Level::Debug, "[SimXR] Quad GL context: current={RC=%p,DC=%p}, stored={RC=%p,DC=%p}",
                  savedRC, savedDC, s.glRC, s.glDC);
         }
 
@@ -3877,18 +6286,16 @@ static void renderQuadLayer(rt::Session& s, const XrCompositionLayerQuad* quad)
             BOOL switchResult = wglMakeCurrent(s.glDC, s.glRC);
             if (shouldLog) {
                 HGLRC afterRC = wglGetCurrentContext();
-                Logf("[SimXR] Quad GL context switch: result=%d, afterRC=%p (expected %p)",
+                LogAtf(logging::CatFrame, logging::Level::Debug, "[SimXR] Quad GL context switch: result=%d, afterRC=%p (expected %p)",
                      switchResult, afterRC, s.glRC);
             }
         }
 
-        // Ensure all GL commands are finished before reading
-        glFinish();
-
-        // DEBUG: Verify texture exists and is valid
-        if (shouldLog) {
+        // No glFinish: glReadPixels/glGetTexImage into client memory already wait for the
+        // texture's pending writes on this context
+        if (shouldLog && glvalidation::Enabled(glvalidation::CheckPixels)) {
             GLboolean isValid = glIsTexture(glTex);
-            Logf("[SimXR] Quad texture check: glTex=%u, glIsTexture=%d", glTex, isValid);
+            LogAtf(logging::CatFrame, logging::Level::Debug, "[SimXR] Quad texture check: glTex=%u, glIsTexture=%d", glTex, isValid);
         }
 
         // Read pixels from GL texture using FBO (more reliable than glGetTexImage)
@@ -3924,11 +6331,11 @@ static void renderQuadLayer(rt::Session& s, const XrCompositionLayerQuad* quad)
             glGetTexImage(GL_TEXTURE_2D, 0, GL_RGBA, GL_UNSIGNED_BYTE, pixels.data());
         }
 
-        // Debug: check pixel values before flip
-        if (shouldLog) {
+        // Pixel values before the flip
+        if (shouldLog && glvalidation::Enabled(glvalidation::CheckPixels)) {
             uint32_t pixelSum = 0;
             for (size_t i = 0; i < std::min((size_t)4000, pixels.size()); i++) pixelSum += pixels[i];
-            Logf("[SimXR] Quad GL pixels: sum=%u, first 4=[%d,%d,%d,%d][%d,%d,%d,%d][%d,%d,%d,%d][%d,%d,%d,%d]",
+            LogAtf(logging::CatGLDebug, logging::Level::Debug, "[SimXR] Quad GL pixels: sum=%u, first 4=[%d,%d,%d,%d][%d,%d,%d,%d][%d,%d,%d,%d][%d,%d,%d,%d]",
                  pixelSum, pixels[0], pixels[1], pixels[2], pixels[3],
                  pixels[4], pixels[5], pixels[6], pixels[7],
                  pixels[8], pixels[9], pixels[10], pixels[11],
@@ -3936,7 +6343,7 @@ static void renderQuadLayer(rt::Session& s, const XrCompositionLayerQuad* quad)
             // Check middle of image
             size_t midIdx = (texHeight/2 * texWidth + texWidth/2) * 4;
             if (midIdx + 3 < pixels.size()) {
-                Logf("[SimXR] Quad GL middle pixel: [%d,%d,%d,%d]",
+                LogAtf(logging::CatGLDebug, logging::Level::Debug, "[SimXR] Quad GL middle pixel: [%d,%d,%d,%d]",
                      pixels[midIdx], pixels[midIdx+1], pixels[midIdx+2], pixels[midIdx+3]);
             }
         }
@@ -3958,29 +6365,36 @@ static void renderQuadLayer(rt::Session& s, const XrCompositionLayerQuad* quad)
         // Restore GL context
         if (savedRC) wglMakeCurrent(savedDC, savedRC);
 
-        // Create D3D11 texture from pixel data
-        D3D11_TEXTURE2D_DESC texDesc = {};
-        texDesc.Width = texWidth;
-        texDesc.Height = texHeight;
-        texDesc.MipLevels = 1;
-        texDesc.ArraySize = 1;
-        texDesc.Format = DXGI_FORMAT_R8G8B8A8_UNORM;
-        texDesc.SampleDesc.Count = 1;
-        texDesc.Usage = D3D11_USAGE_DEFAULT;
-        texDesc.BindFlags = D3D11_BIND_SHADER_RESOURCE;
-
-        D3D11_SUBRESOURCE_DATA initData = {};
-        initData.pSysMem = pixels.data();
-        initData.SysMemPitch = texWidth * 4;
-
-        if (FAILED(s.d3d11Device->CreateTexture2D(&texDesc, &initData, quadTex.GetAddressOf()))) {
-            if (shouldLog) Log("[SimXR] renderQuadLayer: Failed to create D3D11 texture from GL pixels");
-            return;
+        // Upload into the cached texture for this GL image (GL swapchains have no D3D11 images,
+        // so the view is keyed and stored here rather than through GetBlitView)
+        const uint64_t key = (uint64_t)texIdx | ((uint64_t)DXGI_FORMAT_R8G8B8A8_UNORM << 32);
+        auto& view = chain.blitViews[key];
+        if (!view.copy || view.width != texWidth || view.height != texHeight) {
+            view = {};
+            D3D11_TEXTURE2D_DESC texDesc = {};
+            texDesc.Width = texWidth;
+            texDesc.Height = texHeight;
+            texDesc.MipLevels = 1;
+            texDesc.ArraySize = 1;
+            texDesc.Format = DXGI_FORMAT_R8G8B8A8_UNORM;
+            texDesc.SampleDesc.Count = 1;
+            texDesc.Usage = D3D11_USAGE_DEFAULT;
+            texDesc.BindFlags = D3D11_BIND_SHADER_RESOURCE;
+            if (FAILED(s.d3d11Device->CreateTexture2D(&texDesc, nullptr, view.copy.GetAddressOf())) ||
+                FAILED(s.d3d11Device->CreateShaderResourceView(view.copy.Get(), nullptr, view.srv.GetAddressOf()))) {
+                if (shouldLog) Log("[SimXR] renderQuadLayer: Failed to create D3D11 texture for GL pixels");
+                chain.blitViews.erase(key);
+                return;
+            }
+            view.width = texWidth;
+            view.height = texHeight;
         }
+        s.d3d11Context->UpdateSubresource(view.copy.Get(), 0, nullptr, pixels.data(), texWidth * 4, 0);
+        srv = view.srv;
 
         if (shouldLog) {
-            Logf("[SimXR] Rendering quad layer (OpenGL): size=%.2fx%.2f, texSize=%ux%u, glTex=%u",
-                 quad->size.width, quad->size.height, texWidth, texHeight, glTex);
+            LogAtf(logging::CatFrame, logging::Level::Debug, "[SimXR] Rendering quad layer (OpenGL): aspect=%.2f, texSize=%ux%u, glTex=%u",
+                 overlay.aspect, texWidth, texHeight, glTex);
         }
     } else if (!chain.images.empty()) {
         // D3D11 path
@@ -3995,47 +6409,28 @@ static void renderQuadLayer(rt::Session& s, const XrCompositionLayerQuad* quad)
         }
 
         // Convert typeless formats to typed formats for SRV creation
-        DXGI_FORMAT typedFormat = srcDesc.Format;
-        switch (srcDesc.Format) {
-            case DXGI_FORMAT_R8G8B8A8_TYPELESS:
-                typedFormat = (chain.format == DXGI_FORMAT_R8G8B8A8_UNORM_SRGB) ? DXGI_FORMAT_R8G8B8A8_UNORM_SRGB : DXGI_FORMAT_R8G8B8A8_UNORM;
-                break;
-            case DXGI_FORMAT_B8G8R8A8_TYPELESS:
-                typedFormat = (chain.format == DXGI_FORMAT_B8G8R8A8_UNORM_SRGB) ? DXGI_FORMAT_B8G8R8A8_UNORM_SRGB : DXGI_FORMAT_B8G8R8A8_UNORM;
-                break;
-            case DXGI_FORMAT_R16G16B16A16_TYPELESS:
-                typedFormat = DXGI_FORMAT_R16G16B16A16_FLOAT;
-                break;
-            case DXGI_FORMAT_R32G32B32A32_TYPELESS:
-                typedFormat = DXGI_FORMAT_R32G32B32A32_FLOAT;
-                break;
-            case DXGI_FORMAT_R10G10B10A2_TYPELESS:
-                typedFormat = DXGI_FORMAT_R10G10B10A2_UNORM;
-                break;
-            default:
-                break; // Already typed or unknown
+        DXGI_FORMAT typedFormat = rt::TypedViewFormat(srcDesc.Format, chain.format);
+
+        // Sample the image in place when the sub-image covers all of it; otherwise copy the
+        // rect into the cached texture for this image slice
+        const auto& rect = subImage.imageRect;
+        uint32_t arraySlice = subImage.imageArrayIndex;
+        const bool fullImage = rect.offset.x == 0 && rect.offset.y == 0 &&
+                               texWidth == srcDesc.Width && texHeight == srcDesc.Height;
+        rt::Swapchain::BlitView* view = rt::GetBlitView(s, chain, texIdx, arraySlice, typedFormat, fullImage,
+                                                        texWidth, texHeight);
+        if (!view) return;
+        if (!view->direct) {
+            D3D11_BOX box = { (UINT)rect.offset.x, (UINT)rect.offset.y, 0,
+                              (UINT)rect.offset.x + texWidth, (UINT)rect.offset.y + texHeight, 1 };
+            uint32_t srcSubresource = D3D11CalcSubresource(0, arraySlice, chain.mipCount);
+            s.d3d11Context->CopySubresourceRegion(view->copy.Get(), 0, 0, 0, 0, chain.images[texIdx].Get(), srcSubresource, &box);
         }
-
-        // Create temp texture for the quad content with typed format
-        D3D11_TEXTURE2D_DESC tempDesc = srcDesc;
-        tempDesc.Format = typedFormat;  // Use typed format for the temp texture
-        tempDesc.BindFlags = D3D11_BIND_SHADER_RESOURCE;
-        tempDesc.MiscFlags = 0;
-        tempDesc.SampleDesc.Count = 1;
-
-        if (FAILED(s.d3d11Device->CreateTexture2D(&tempDesc, nullptr, quadTex.GetAddressOf()))) return;
-
-        // Copy the quad texture (handle array index if needed)
-        const auto& rect = quad->subImage.imageRect;
-        uint32_t arraySlice = quad->subImage.imageArrayIndex;
-        D3D11_BOX box = { (UINT)rect.offset.x, (UINT)rect.offset.y, 0,
-                          (UINT)(rect.offset.x + rect.extent.width), (UINT)(rect.offset.y + rect.extent.height), 1 };
-        uint32_t srcSubresource = D3D11CalcSubresource(0, arraySlice, 1);
-        s.d3d11Context->CopySubresourceRegion(quadTex.Get(), 0, 0, 0, 0, chain.images[texIdx].Get(), srcSubresource, &box);
+        srv = view->srv;
 
         if (shouldLog) {
-            Logf("[SimXR] Rendering quad layer (D3D11): size=%.2fx%.2f, texSize=%ux%u, typedFmt=%d, srcFmt=%d, arraySlice=%u",
-                 quad->size.width, quad->size.height, srcDesc.Width, srcDesc.Height, typedFormat, srcDesc.Format, arraySlice);
+            LogAtf(logging::CatFrame, logging::Level::Debug, "[SimXR] Rendering quad layer (D3D11): aspect=%.2f, texSize=%ux%u, typedFmt=%d, srcFmt=%d, arraySlice=%u",
+                 overlay.aspect, srcDesc.Width, srcDesc.Height, typedFormat, srcDesc.Format, arraySlice);
         }
     } else {
         if (shouldLog) Log("[SimXR] renderQuadLayer: No valid images in swapchain");
@@ -4050,18 +6445,16 @@ static void renderQuadLayer(rt::Session& s, const XrCompositionLayerQuad* quad)
     ComPtr<ID3D11RenderTargetView> rtv;
     if (FAILED(s.d3d11Device->CreateRenderTargetView(bb.Get(), nullptr, rtv.GetAddressOf()))) return;
 
-    // Create SRV
-    ComPtr<ID3D11ShaderResourceView> srv;
-    if (FAILED(s.d3d11Device->CreateShaderResourceView(quadTex.Get(), nullptr, srv.GetAddressOf()))) return;
-
     // Calculate viewports matching the projection layer layout
     const auto layout = ui::g_uiState.displayLayout;
     const auto viewMode = ui::g_uiState.viewMode;
     float screenW = (float)s.previewWidth;
     float screenH = (float)s.previewHeight;
 
-    bool showLeft = (viewMode == ui::ViewMode::BothEyes || viewMode == ui::ViewMode::LeftEyeOnly);
-    bool showRight = (viewMode == ui::ViewMode::BothEyes || viewMode == ui::ViewMode::RightEyeOnly);
+    bool showLeft = (viewMode == ui::ViewMode::BothEyes || viewMode == ui::ViewMode::LeftEyeOnly) &&
+                    overlay.eyeVisibility != XR_EYE_VISIBILITY_RIGHT;
+    bool showRight = (viewMode == ui::ViewMode::BothEyes || viewMode == ui::ViewMode::RightEyeOnly) &&
+                     overlay.eyeVisibility != XR_EYE_VISIBILITY_LEFT;
     bool singleEye = (viewMode != ui::ViewMode::BothEyes);
 
     // Build left/right viewports to match projection layer layout
@@ -4079,26 +6472,18 @@ static void renderQuadLayer(rt::Session& s, const XrCompositionLayerQuad* quad)
         }
     }
 
-    // Calculate quad display rect within a given viewport
-    float quadAspect = quad->size.width / quad->size.height;
-    auto calcQuadVp = [&](const D3D11_VIEWPORT& eyeVp) -> D3D11_VIEWPORT {
-        float vpW = eyeVp.Width;
-        float vpH = eyeVp.Height;
-        float displayW = vpW * 0.9f;
-        float displayH = displayW / quadAspect;
-        if (displayH > vpH * 0.9f) {
-            displayH = vpH * 0.9f;
-            displayW = displayH * quadAspect;
-        }
-        float displayX = eyeVp.TopLeftX + (vpW - displayW) / 2.0f;
-        float displayY = eyeVp.TopLeftY + (vpH - displayH) / 2.0f;
-        return { displayX, displayY, displayW, displayH, 0.0f, 1.0f };
-    };
+    // D3D11 apps: keep the layer's draw off the app's pipeline state (the GL preview device is ours)
+    std::optional<D3D11StateScope> stateScope;
+    if (!s.usesOpenGL && !s.usesVulkan) stateScope.emplace(s);
 
-    // Set up shared render state
-    s.d3d11Context->VSSetShader(s.blitVS.Get(), nullptr, 0);
+    // Set up shared render state (GL interop images are bottom-up)
+    s.d3d11Context->VSSetShader(chain.glInterop ? s.blitVSFlipY.Get() : s.blitVS.Get(), nullptr, 0);
     s.d3d11Context->PSSetShader(s.blitPS.Get(), nullptr, 0);
 
+    // Render target before the SRV, so a directly sampled image isn't still bound as an output
+    ID3D11RenderTargetView* rtvs[1] = { rtv.Get() };
+    s.d3d11Context->OMSetRenderTargets(1, rtvs, nullptr);
+
     ID3D11ShaderResourceView* srvs[] = { srv.Get() };
     s.d3d11Context->PSSetShaderResources(0, 1, srvs);
     ID3D11SamplerState* samplers[] = { s.samplerState.Get() };
@@ -4112,19 +6497,16 @@ static void renderQuadLayer(rt::Session& s, const XrCompositionLayerQuad* quad)
     s.d3d11Context->OMSetDepthStencilState(nullptr, 0);
     s.d3d11Context->RSSetState(s.noCullRS.Get());
 
-    ID3D11RenderTargetView* rtvs[1] = { rtv.Get() };
-    s.d3d11Context->OMSetRenderTargets(1, rtvs, nullptr);
-
     // Draw quad into left eye viewport
     if (showLeft) {
-        D3D11_VIEWPORT quadVp = calcQuadVp(leftVp);
+        D3D11_VIEWPORT quadVp = OverlayViewport(leftVp, overlay.aspect);
         s.d3d11Context->RSSetViewports(1, &quadVp);
         s.d3d11Context->Draw(4, 0);
     }
 
     // Draw quad into right eye viewport
     if (showRight) {
-        D3D11_VIEWPORT quadVp = calcQuadVp(rightVp);
+        D3D11_VIEWPORT quadVp = OverlayViewport(rightVp, overlay.aspect);
         s.d3d11Context->RSSetViewports(1, &quadVp);
         s.d3d11Context->Draw(4, 0);
     }
@@ -4134,6 +6516,59 @@ static void renderQuadLayer(rt::Session& s, const XrCompositionLayerQuad* quad)
     s.d3d11Context->PSSetShaderResources(0, 1, nullSRV);
 }
 
+// Batch every quad / cylinder layer of the frame into the D3D12 preview: one alpha-blended
+// draw per visible eye, all recorded into the command list presentProjection left open (or a
+// fresh one for frames without a projection layer). xrEndFrame submits it once, so the layers
+// share the frame's crossQueueFence wait and the preview fence instead of their own submits.
+static void renderOverlayLayersD3D12(rt::Session& s, const XrFrameEndInfo& info) {
+    timing::ScopedStage quadTimer(timing::StQuadLayer);
+    std::lock_guard<std::mutex> lock(s.previewMutex);
+    if (!s.previewRT12) return;
+
+    const auto layout = ui::g_uiState.displayLayout;
+    const auto viewMode = ui::g_uiState.viewMode;
+    const bool singleEye = (viewMode != ui::ViewMode::BothEyes);
+    const bool anaglyph = !singleEye && layout == ui::DisplayLayout::Anaglyph;
+    if (!s.previewRecording12 && !BeginD3D12Preview(s, anaglyph)) return;
+
+    D3D12_VIEWPORT leftVp, rightVp;
+    PreviewEyeViewports12(s, layout, singleEye, leftVp, rightVp);
+    const bool showLeft = (viewMode == ui::ViewMode::BothEyes || viewMode == ui::ViewMode::LeftEyeOnly);
+    const bool showRight = (viewMode == ui::ViewMode::BothEyes || viewMode == ui::ViewMode::RightEyeOnly);
+
+    uint32_t drawn = 0;
+    timing::ScopedStage submitTimer(timing::StD3D12Submit);
+    for (uint32_t i = 0; i < info.layerCount; ++i) {
+        OverlayLayer overlay;
+        if (!GetOverlayLayer(info.layers[i], overlay)) continue;
+        rt::Swapchain* it = rt::g_swapchains.Find(overlay.subImage->swapchain);
+        if (!it) continue;
+        auto& chain = *it;
+        const uint32_t idx = (chain.lastReleased != UINT32_MAX) ? chain.lastReleased :
+                             (chain.lastAcquired != UINT32_MAX) ? chain.lastAcquired : 0;
+
+        // Anaglyph overlays both eyes in the same viewport; draw the layer there once
+        D3D12_VIEWPORT vps[2];
+        uint32_t vpCount = 0;
+        if (showLeft && overlay.eyeVisibility != XR_EYE_VISIBILITY_RIGHT) {
+            vps[vpCount++] = OverlayViewport(leftVp, overlay.aspect);
+        }
+        if (showRight && overlay.eyeVisibility != XR_EYE_VISIBILITY_LEFT && !(anaglyph && vpCount)) {
+            vps[vpCount++] = OverlayViewport(rightVp, overlay.aspect);
+        }
+        if (DrawD3D12Image(s, chain, idx, overlay.subImage->imageArrayIndex, &overlay.subImage->imageRect,
+                           vps, vpCount, rt::Session::BlendAlpha, "layer")) {
+            ++drawn;
+        }
+    }
+
+    static int layerLogCount = 0;
+    if (++layerLogCount % 60 == 1) {
+        LogAtf(logging::CatFrame, logging::Level::Debug, "[SimXR] renderOverlayLayersD3D12: %u of %u layers drawn",
+               drawn, info.layerCount);
+    }
+}
+
 static XrResult XRAPI_PTR xrEndFrame_runtime(XrSession, const XrFrameEndInfo* info) {
     // Reentrance guard: when our preview swapchain calls Present(), Steam's overlay
     // (gameoverlayrenderer64) hooks it, which can trigger UEVR to re-submit frames
@@ -4148,17 +6583,27 @@ static XrResult XRAPI_PTR xrEndFrame_runtime(XrSession, const XrFrameEndInfo* in
         return XR_SUCCESS;
     }
     inEndFrame = true;
+    LARGE_INTEGER endFrameStart; QueryPerformanceCounter(&endFrameStart);
 
     static int frameCount = 0;
     frameCount++;
+    if (frameCount == 1 && g_instanceCreateQpc.QuadPart != 0) {
+        LARGE_INTEGER freq; QueryPerformanceFrequency(&freq);
+        Logf("[SimXR] First xrEndFrame %.1f ms after xrCreateInstance (%u xrGetInstanceProcAddr lookups)",
+             (double)(endFrameStart.QuadPart - g_instanceCreateQpc.QuadPart) * 1000.0 / (double)freq.QuadPart,
+             g_procLookups.load(std::memory_order_relaxed));
+    }
 
     // Log every frame for first 10 frames, then every 60 frames
     bool shouldLog = (frameCount <= 10) || (frameCount % 60 == 1);
 
     if (shouldLog) {
-        Logf("[SimXR] xrEndFrame called (frame #%d)", frameCount);
+        LogAtf(logging::CatFrame, logging::Level::Debug, "[SimXR] xrEndFrame called (frame #%d)", frameCount);
     }
 
+    // Recordings are timestamped with the display time the app submitted for
+    if (info && info->displayTime != 0) rt::g_frameTiming.displayTime = info->displayTime;
+
     // Check D3D12 device status
     if (rt::g_session.usesD3D12 && rt::g_session.d3d12Device && shouldLog) {
         HRESULT reason = rt::g_session.d3d12Device->GetDeviceRemovedReason();
@@ -4173,8 +6618,27 @@ static XrResult XRAPI_PTR xrEndFrame_runtime(XrSession, const XrFrameEndInfo* in
         return XR_ERROR_VALIDATION_FAILURE;
     }
 
+    // Stress mode: the app's frame costs more CPU on this thread and more GPU on its queue
+    if (stress::Enabled()) {
+        stress::SpinCpu();
+        if (stress::g_config.gpuLoadMs > 0.0f) {
+            auto& session = rt::g_session;
+            if (session.usesD3D12) {
+                stress::g_gpuLoad12.Submit(session.d3d12Device.Get(), session.d3d12Queue.Get(), stress::g_config.gpuLoadMs);
+            } else if (!session.usesOpenGL && !session.usesVulkan) {
+                stress::g_gpuLoad11.Submit(session.d3d11Device.Get(), session.d3d11Context.Get(), stress::g_config.gpuLoadMs);
+            } else {
+                static bool glNoted = false;
+                if (!glNoted) {
+                    Log("[SimXR] Stress: GPU load is only available on D3D11 and D3D12 sessions");
+                    glNoted = true;
+                }
+            }
+        }
+    }
+
     if (shouldLog) {
-        Logf("[SimXR] xrEndFrame: layers=%u", info->layerCount);
+        LogAtf(logging::CatFrame, logging::Level::Debug, "[SimXR] xrEndFrame: layers=%u", info->layerCount);
     }
 
     // First pass: count layer types to know if we need to defer Present
@@ -4185,13 +6649,18 @@ static XrResult XRAPI_PTR xrEndFrame_runtime(XrSession, const XrFrameEndInfo* in
         switch (base->type) {
             case XR_TYPE_COMPOSITION_LAYER_PROJECTION: projectionCount++; break;
             case XR_TYPE_COMPOSITION_LAYER_QUAD: quadCount++; break;
-            case (XrStructureType)37: cylinderCount++; break; // XR_TYPE_COMPOSITION_LAYER_CYLINDER_KHR
+            case XR_TYPE_COMPOSITION_LAYER_CYLINDER_KHR: cylinderCount++; break;
             default: otherCount++; break;
         }
     }
 
-    // Determine if we need to defer Present for overlay layers
-    bool hasOverlays = (quadCount > 0 || cylinderCount > 0);
+#ifdef XR_USE_GRAPHICS_API_VULKAN
+    // Vulkan: the preview's context waits on the GPU for the images released this frame
+    if (rt::g_session.usesVulkan) vkinterop::BeginPreview(rt::g_session.vk);
+#endif
+
+    // Determine if we need to defer Present for overlay layers (headless composes nothing)
+    bool hasOverlays = !headless::Enabled() && (quadCount > 0 || cylinderCount > 0);
     g_presentPending = false;
 
     // Second pass: render projection layers (background)
@@ -4231,37 +6700,52 @@ static XrResult XRAPI_PTR xrEndFrame_runtime(XrSession, const XrFrameEndInfo* in
                 mcp::g_projLog[mcp::g_projLogHead] = e;
                 mcp::g_projLogHead = (mcp::g_projLogHead + 1) % mcp::PROJ_LOG_CAPACITY;
                 if (mcp::g_projLogCount < mcp::PROJ_LOG_CAPACITY) ++mcp::g_projLogCount;
+
+                // Rendered head pose vs the pose at the layer's display time (no synthetic
+                // latency: this is what a real display would show at that moment)
+                posehistory::Sample actual;
+                if (info && posehistory::History::Get().At(info->displayTime, actual)) {
+                    XrPosef submitted = proj->views[0].pose;
+                    if (cap == 2) {
+                        submitted.position.x = 0.5f * (proj->views[0].pose.position.x + proj->views[1].pose.position.x);
+                        submitted.position.y = 0.5f * (proj->views[0].pose.position.y + proj->views[1].pose.position.y);
+                        submitted.position.z = 0.5f * (proj->views[0].pose.position.z + proj->views[1].pose.position.z);
+                    }
+                    posehistory::g_error.Add(rt::ToHistoryPose(submitted), actual.head);
+                }
             }
 
-            presentProjection(rt::g_session, *proj, hasOverlays);  // skipPresent if overlays pending
+            if (headless::Enabled()) {
+                CaptureHeadlessProjection(rt::g_session, *proj, (uint32_t)frameCount);
+            } else {
+                presentProjection(rt::g_session, *proj, hasOverlays);  // skipPresent if overlays pending
+            }
         }
     }
 
-    // Third pass: render overlay layers (quad, cylinder) on top of the projection
-    for (uint32_t i = 0; i < info->layerCount; ++i) {
-        const XrCompositionLayerBaseHeader* base = info->layers[i];
-        if (!base) continue;
-
-        switch (base->type) {
-            case XR_TYPE_COMPOSITION_LAYER_QUAD: {
-                const auto* quad = reinterpret_cast<const XrCompositionLayerQuad*>(base);
-                renderQuadLayer(rt::g_session, quad);
-                break;
-            }
-            case (XrStructureType)37: {
-                // TODO: Implement cylinder layer rendering
-                break;
-            }
-            default:
-                break;
+    // Third pass: render overlay layers (quad, cylinder) on top of the projection.
+    // D3D12 records them all into the preview command list the projection left open.
+    if (hasOverlays && rt::g_session.usesD3D12) {
+        renderOverlayLayersD3D12(rt::g_session, *info);
+        g_presentPending = true;
+    } else if (hasOverlays) {
+        for (uint32_t i = 0; i < info->layerCount; ++i) {
+            renderQuadLayer(rt::g_session, info->layers[i]);
         }
     }
 
+    // Headless validation readbacks queued on earlier frames, collected once finished
+    if (headless::Enabled() && headless::g_config.captureEvery != 0) {
+        headless::g_capture11.Poll(rt::g_session.d3d11Context.Get());
+        headless::g_capture12.Poll();
+    }
+
     // MCP Integration - write frame status BEFORE Present (Present may block on D3D12)
     mcp::WriteFrameStatus(frameCount, rt::g_session.previewWidth, rt::g_session.previewHeight,
                           "RGBA8", mcp::GetSessionStateName((int)rt::g_session.state),
                           rt::g_headYaw, rt::g_headPitch,
-                          rt::g_headPos.x, rt::g_headPos.y, rt::g_headPos.z);
+                          rt::g_headPos.x, rt::g_headPos.y, rt::g_headPos.z,
+                          (float)(1e9 / (double)rt::g_frameTiming.periodNs), rt::g_frameTiming.intervalMs);
 
     // Drain MCP projection-log dump request if pending.
     if (mcp::CheckProjLogDumpRequest()) {
@@ -4275,16 +6759,31 @@ static XrResult XRAPI_PTR xrEndFrame_runtime(XrSession, const XrFrameEndInfo* in
         while (PeekMessageW(&msg, s.hwnd, 0, 0, PM_REMOVE)) { TranslateMessage(&msg); DispatchMessageW(&msg); }
 
         if (s.usesD3D12) {
-            // D3D12 GDI-based path: blitD3D12ToPreview already painted via GDI, nothing to do
-            Log("[SimXR] Deferred D3D12: GDI blit already done in blitD3D12ToPreview");
+            // D3D12 GDI-based path: submit the projection + layer draws in one list, then paint
+            {
+                std::lock_guard<std::mutex> lock(s.previewMutex);
+                FinishD3D12Preview(s);
+            }
+            CaptureD3D12PreviewScreenshot(s);
         } else if (s.previewSwapchain) {
+            RecordPreview11(s);
+            AnalyzePreview11(s);
+            timing::ScopedStage presentTimer(timing::StPresent);
             s.previewSwapchain->Present(1, 0);
         }
         g_presentPending = false;
     }
 
+    // Keep Tools > Record Video in step with recordings started or stopped over MCP
+    const bool recordingActive = recording::Recorder::Get().Recording();
+    if (recordingActive != ui::g_uiState.recording) {
+        ui::g_uiState.recording = recordingActive;
+        HMENU menu = rt::g_session.hwnd ? GetMenu(rt::g_session.hwnd) : nullptr;
+        if (menu) ui::UpdateMenuState(menu);
+    }
+
     if (shouldLog && (quadCount > 0 || cylinderCount > 0)) {
-        Logf("[SimXR] xrEndFrame: proj=%d quad=%d cyl=%d other=%d",
+        LogAtf(logging::CatFrame, logging::Level::Debug, "[SimXR] xrEndFrame: proj=%d quad=%d cyl=%d other=%d",
              projectionCount, quadCount, cylinderCount, otherCount);
     }
 
@@ -4292,6 +6791,36 @@ static XrResult XRAPI_PTR xrEndFrame_runtime(XrSession, const XrFrameEndInfo* in
         Log("[SimXR] xrEndFrame: WARNING - No projection layers found!");
     }
 
+#ifdef XR_USE_GRAPHICS_API_VULKAN
+    // ...and signals "composed" once every read of them is queued
+    if (rt::g_session.usesVulkan) vkinterop::EndPreview(rt::g_session.vk);
+#endif
+
+    rt::GpuTimerEndFrame11(rt::g_session);
+
+    // Close this frame's stage timers, then publish it to the shared telemetry block (seqlock, no I/O)
+    timing::FrameTimers::Get().EndFrame();
+    {
+        LARGE_INTEGER endFrameExit; QueryPerformanceCounter(&endFrameExit);
+        auto& marks = rt::g_frameTiming;
+        mcp::TelemetrySample t;
+        t.frameIndex = (uint64_t)frameCount;
+        t.sessionState = (uint32_t)rt::g_session.state;
+        t.previewWidth = rt::g_session.previewWidth;
+        t.previewHeight = rt::g_session.previewHeight;
+        t.headPos[0] = rt::g_headPos.x; t.headPos[1] = rt::g_headPos.y; t.headPos[2] = rt::g_headPos.z;
+        t.headYaw = rt::g_headYaw; t.headPitch = rt::g_headPitch; t.headRoll = rt::g_headRoll;
+        XrQuaternionf q = rt::QuatFromYawPitchRoll(rt::g_headYaw, rt::g_headPitch, rt::g_headRoll);
+        t.headOrientation[0] = q.x; t.headOrientation[1] = q.y; t.headOrientation[2] = q.z; t.headOrientation[3] = q.w;
+        t.frameIntervalMs = rt::QpcDeltaMs(marks.lastEndFrame, endFrameExit);
+        marks.intervalMs = t.frameIntervalMs;
+        t.stageMs[mcp::StageWaitFrame] = marks.waitMs;
+        t.stageMs[mcp::StageAppFrame] = rt::QpcDeltaMs(marks.waitReturn, endFrameStart);
+        t.stageMs[mcp::StageEndFrame] = rt::QpcDeltaMs(endFrameStart, endFrameExit);
+        mcp::PublishTelemetry(t);
+        marks.lastEndFrame = endFrameExit;
+    }
+
     inEndFrame = false;
     return XR_SUCCESS;
 }
@@ -4313,22 +6842,22 @@ static XrResult XRAPI_PTR xrLocateViews_runtime(XrSession, const XrViewLocateInf
     // a continuous range of orientations and any handedness/axis bug
     // produces a visible "world rotates wrong way" symptom instantly.
     // Each axis uses a different phase so the signal isn't degenerate.
-    float effYaw   = rt::g_headYaw;
-    float effPitch = rt::g_headPitch;
-    float effRoll  = rt::g_headRoll;
-    if (rt::g_poseSweepEnabled) {
-        float t = (float)GetTickCount64() * 0.001f - rt::g_poseSweepStartT;
-        const float TWO_PI = 6.2831853f;
-        float w = TWO_PI * rt::g_poseSweepFreq;
-        effYaw   = rt::g_poseSweepYawAmp   * sinf(w * t);
-        effPitch = rt::g_poseSweepPitchAmp * sinf(w * t + 1.0f);
-        effRoll  = rt::g_poseSweepRollAmp  * sinf(w * t + 2.0f);
-    }
+    float effYaw, effPitch, effRoll;
+    rt::EffectiveHeadAngles(effYaw, effPitch, effRoll);
 
     // Use dynamic head pose from mouse look (yaw + pitch) plus optional
     // MCP-injected roll so off-axis quaternion-handedness bugs (which
     // identity pose hides) actually surface in the simulator.
     XrQuaternionf orientation = rt::QuatFromYawPitchRoll(effYaw, effPitch, effRoll);
+    XrVector3f headPos = rt::g_headPos;
+
+    // The head pose at the requested display time, from the per-frame history
+    posehistory::Sample sample;
+    if (li && rt::PoseAt(li->displayTime, sample)) {
+        const XrPosef head = rt::FromHistoryPose(sample.head);
+        orientation = head.orientation;
+        headPos = head.position;
+    }
     
     // Helper function to rotate a vector by a quaternion
     auto rotateVector = [](XrQuaternionf q, XrVector3f v) -> XrVector3f {
@@ -4366,9 +6895,9 @@ static XrResult XRAPI_PTR xrLocateViews_runtime(XrSession, const XrViewLocateInf
         XrVector3f rotatedOffset = rotateVector(orientation, localEyeOffset);
         
         views[i].pose.position = {
-            rt::g_headPos.x + rotatedOffset.x,
-            rt::g_headPos.y + rotatedOffset.y,
-            rt::g_headPos.z + rotatedOffset.z
+            headPos.x + rotatedOffset.x,
+            headPos.y + rotatedOffset.y,
+            headPos.z + rotatedOffset.z
         };
         
         if (rt::g_useCustomFov) {
@@ -4388,7 +6917,7 @@ static XrResult XRAPI_PTR xrLocateViews_runtime(XrSession, const XrViewLocateInf
     }
     static int locateCount = 0;
     if (++locateCount % 90 == 1) {  // Log every 90 frames (~1 second)
-        Logf("[SimXR] xrLocateViews: pos=(%.2f,%.2f,%.2f) yaw=%.2f pitch=%.2f", 
+        LogAtf(logging::CatFrame, logging::Level::Debug, "[SimXR] xrLocateViews: pos=(%.2f,%.2f,%.2f) yaw=%.2f pitch=%.2f", 
              rt::g_headPos.x, rt::g_headPos.y, rt::g_headPos.z, 
              rt::g_headYaw, rt::g_headPitch);
     }
@@ -4398,33 +6927,48 @@ static XrResult XRAPI_PTR xrLocateViews_runtime(XrSession, const XrViewLocateInf
 // Add missing space/action functions for compatibility
 static XrResult XRAPI_PTR xrCreateReferenceSpace_runtime(XrSession, const XrReferenceSpaceCreateInfo* info, XrSpace* space) {
     if (!info || !space) return XR_ERROR_VALIDATION_FAILURE;
-    static uintptr_t nextSpace = 100;
-    *space = (XrSpace)(nextSpace++);
+    rt::SpaceRecord record;
+    record.referenceType = info->referenceSpaceType;
+    *space = rt::g_spaces.Insert(std::move(record));
     Logf("[SimXR] xrCreateReferenceSpace: type=%d space=%p", info->referenceSpaceType, *space);
     return XR_SUCCESS;
 }
 
 static XrResult XRAPI_PTR xrDestroySpace_runtime(XrSpace space) {
     Logf("[SimXR] xrDestroySpace: space=%p", space);
-    return XR_SUCCESS;
+    return rt::g_spaces.Erase(space) ? XR_SUCCESS : XR_ERROR_HANDLE_INVALID;
 }
 
 static XrResult XRAPI_PTR xrLocateSpace_runtime(XrSpace space, XrSpace baseSpace, XrTime time, XrSpaceLocation* location) {
     if (!location) return XR_ERROR_VALIDATION_FAILURE;
+    const rt::SpaceRecord* record = rt::g_spaces.Find(space);
+    if (!record || !rt::g_spaces.Find(baseSpace)) return XR_ERROR_HANDLE_INVALID;
     location->type = XR_TYPE_SPACE_LOCATION;
 
     // Check if this is a controller space
-    auto it = rt::g_controllerSpaces.find(space);
-    if (it != rt::g_controllerSpaces.end()) {
-        int ctrlType = it->second;
-        const rt::ControllerState& ctrl = (ctrlType == 1) ? rt::g_leftController : rt::g_rightController;
+    if (record->controller != 0) {
+        int ctrlType = record->controller;
+        const rt::ControllerState& live = (ctrlType == 1) ? rt::g_leftController : rt::g_rightController;
+
+        // The controller state at the requested time, from the per-frame history
+        rt::ControllerState ctrl = live;
+        XrPosef pose;
+        rt::GetControllerPose(live, &pose);
+        posehistory::Sample sample;
+        if (rt::PoseAt(time, sample)) {
+            const int c = ctrlType == 1 ? 0 : 1;
+            pose = rt::FromHistoryPose(sample.controllers[c]);
+            ctrl.linearVelocity = { sample.linearVelocity[c][0], sample.linearVelocity[c][1], sample.linearVelocity[c][2] };
+            ctrl.angularVelocity = { sample.angularVelocity[c][0], sample.angularVelocity[c][1], sample.angularVelocity[c][2] };
+            ctrl.isTracking = sample.tracked[c];
+        }
 
         if (ctrl.isTracking) {
             location->locationFlags = XR_SPACE_LOCATION_POSITION_VALID_BIT |
                                       XR_SPACE_LOCATION_ORIENTATION_VALID_BIT |
                                       XR_SPACE_LOCATION_POSITION_TRACKED_BIT |
                                       XR_SPACE_LOCATION_ORIENTATION_TRACKED_BIT;
-            rt::GetControllerPose(ctrl, &location->pose);
+            location->pose = pose;
 
             // Handle velocity if chained (XrSpaceVelocity)
             XrSpaceVelocity* velocity = (XrSpaceVelocity*)location->next;
@@ -4470,9 +7014,6 @@ static XrResult XRAPI_PTR xrEnumerateReferenceSpaces_runtime(XrSession, uint32_t
 
 static XrResult XRAPI_PTR xrCreateActionSpace_runtime(XrSession, const XrActionSpaceCreateInfo* info, XrSpace* space) {
     if (!info || !space) return XR_ERROR_VALIDATION_FAILURE;
-    static uintptr_t nextSpace = 200;
-    *space = (XrSpace)(nextSpace++);
-
     // Detect controller subaction paths and register the space
     int controllerType = 0;  // 0=none, 1=left, 2=right
     Logf("[SimXR] xrCreateActionSpace: subactionPath=%llu, g_pathStrings.size()=%zu",
@@ -4485,10 +7026,10 @@ static XrResult XRAPI_PTR xrCreateActionSpace_runtime(XrSession, const XrActionS
             Logf("[SimXR] xrCreateActionSpace: found path='%s'", pathStr.c_str());
             if (pathStr.find("/user/hand/left") != std::string::npos) {
                 controllerType = 1;  // Left controller
-                Logf("[SimXR] xrCreateActionSpace: LEFT controller space %llu", (unsigned long long)*space);
+                Log("[SimXR] xrCreateActionSpace: LEFT controller space");
             } else if (pathStr.find("/user/hand/right") != std::string::npos) {
                 controllerType = 2;  // Right controller
-                Logf("[SimXR] xrCreateActionSpace: RIGHT controller space %llu", (unsigned long long)*space);
+                Log("[SimXR] xrCreateActionSpace: RIGHT controller space");
             }
         } else {
             Logf("[SimXR] xrCreateActionSpace: path %llu NOT FOUND in g_pathStrings", (unsigned long long)info->subactionPath);
@@ -4497,11 +7038,10 @@ static XrResult XRAPI_PTR xrCreateActionSpace_runtime(XrSession, const XrActionS
         Log("[SimXR] xrCreateActionSpace: subactionPath is XR_NULL_PATH");
     }
 
-    if (controllerType > 0) {
-        rt::g_controllerSpaces[*space] = controllerType;
-    }
-
-    Log("[SimXR] xrCreateActionSpace");
+    rt::SpaceRecord record;
+    record.controller = controllerType;
+    *space = rt::g_spaces.Insert(std::move(record));
+    Logf("[SimXR] xrCreateActionSpace: space=%p", *space);
     return XR_SUCCESS;
 }
 
@@ -4521,44 +7061,105 @@ static XrResult XRAPI_PTR xrDestroyActionSet_runtime(XrActionSet set) {
     return XR_SUCCESS;
 }
 
+// Action-name fallback for apps whose bindings name no known component. Runs once per action.
+static rt::InputSource ClassifyActionName(const char* name, XrActionType type) {
+    char lower[XR_MAX_ACTION_NAME_SIZE + 1] = {0};
+    for (size_t i = 0; i < XR_MAX_ACTION_NAME_SIZE && name[i]; ++i) lower[i] = (char)tolower((unsigned char)name[i]);
+    auto has = [&](const char* pattern) { return strstr(lower, pattern) != nullptr; };
+    if (type == XR_ACTION_TYPE_VECTOR2F_INPUT) {
+        return (has("thumbstick") || has("joystick") || has("move") || has("turn")) ? rt::InputSource::Thumbstick
+                                                                                    : rt::InputSource::None;
+    }
+    if (has("trigger") || has("select") || has("fire")) return rt::InputSource::Trigger;
+    if (has("grip") || has("squeeze") || has("grab")) return rt::InputSource::Grip;
+    if (type == XR_ACTION_TYPE_FLOAT_INPUT) return rt::InputSource::None;
+    if (has("menu")) return rt::InputSource::Menu;
+    if (has("primary") || has("a_button") || has("x_button")) return rt::InputSource::Primary;
+    if (has("secondary") || has("b_button") || has("y_button")) return rt::InputSource::Secondary;
+    if (has("thumbstick") || has("joystick")) return rt::InputSource::Thumbstick;
+    return rt::InputSource::None;
+}
+
+// Hand and component of a binding path such as /user/hand/left/input/trigger/value
+static rt::InputSource ClassifyBindingPath(const std::string& path, uint8_t& hand) {
+    hand = rt::HandAny;
+    size_t component = std::string::npos;
+    if (path.compare(0, 16, "/user/hand/left/") == 0) { hand = rt::HandLeft; component = 16; }
+    else if (path.compare(0, 17, "/user/hand/right/") == 0) { hand = rt::HandRight; component = 17; }
+    if (component == std::string::npos || path.compare(component, 6, "input/") != 0) return rt::InputSource::None;
+    const std::string input = path.substr(component + 6);  // e.g. "trigger/value"
+    auto is = [&](const char* name) {
+        const size_t n = strlen(name);
+        return input.compare(0, n, name) == 0 && (input.size() == n || input[n] == '/');
+    };
+    if (is("trigger") || is("select")) return rt::InputSource::Trigger;
+    if (is("squeeze")) return rt::InputSource::Grip;
+    if (is("menu") || is("system")) return rt::InputSource::Menu;
+    if (is("a") || is("x")) return rt::InputSource::Primary;
+    if (is("b") || is("y")) return rt::InputSource::Secondary;
+    if (is("thumbstick") || is("trackpad") || is("joystick")) {
+        if (input.size() > 2 && input.compare(input.size() - 2, 2, "/x") == 0) return rt::InputSource::ThumbstickX;
+        if (input.size() > 2 && input.compare(input.size() - 2, 2, "/y") == 0) return rt::InputSource::ThumbstickY;
+        return rt::InputSource::Thumbstick;  // vector, or the click/touch of a boolean action
+    }
+    return rt::InputSource::None;
+}
+
+static rt::ActionBinding* FindAction(XrAction action) { return rt::g_actions.Find(action); }
+
 static XrResult XRAPI_PTR xrCreateAction_runtime(XrActionSet, const XrActionCreateInfo* info, XrAction* action) {
     if (!info || !action) return XR_ERROR_VALIDATION_FAILURE;
-    static uintptr_t nextAction = 400;
-    *action = (XrAction)(nextAction++);
     // actionName may not be null-terminated
     char actName[XR_MAX_ACTION_NAME_SIZE + 1] = {0};
     memcpy(actName, info->actionName, XR_MAX_ACTION_NAME_SIZE);
-    Logf("[SimXR] xrCreateAction: name=%s, type=%d", actName, info->actionType);
 
-    // Store action name for input mapping
-    rt::g_actionNames[*action] = actName;
+    rt::ActionBinding binding;
+    binding.type = info->actionType;
+    binding.source = ClassifyActionName(actName, info->actionType);
 
     // Detect which hand this action is bound to based on subactionPaths
-    int handBinding = 0;  // 0=both/any
     if (info->countSubactionPaths > 0 && info->subactionPaths) {
         for (uint32_t i = 0; i < info->countSubactionPaths; i++) {
-            auto it = rt::g_pathStrings.find(info->subactionPaths[i]);
-            if (it != rt::g_pathStrings.end()) {
-                if (it->second.find("left") != std::string::npos) handBinding |= 1;
-                if (it->second.find("right") != std::string::npos) handBinding |= 2;
-            }
+            if (info->subactionPaths[i] == rt::g_leftHandPath) binding.hands |= rt::HandLeft;
+            if (info->subactionPaths[i] == rt::g_rightHandPath) binding.hands |= rt::HandRight;
         }
+        binding.subactionHands = (binding.hands != rt::HandAny);
     }
-    rt::g_actionHand[*action] = handBinding;
-
+    Logf("[SimXR] xrCreateAction: name=%s, type=%d, source=%d, hands=%u", actName, info->actionType,
+         (int)binding.source, binding.hands);
+    *action = rt::g_actions.Insert(std::move(binding));
     return XR_SUCCESS;
 }
 
 static XrResult XRAPI_PTR xrDestroyAction_runtime(XrAction action) {
     Log("[SimXR] xrDestroyAction");
-    return XR_SUCCESS;
+    return rt::g_actions.Erase(action) ? XR_SUCCESS : XR_ERROR_HANDLE_INVALID;
 }
 
+// Resolve each suggested binding's component and hand into its action's record. The first
+// profile that names a known component decides the source; hands accumulate across profiles.
 static XrResult XRAPI_PTR xrSuggestInteractionProfileBindings_runtime(XrInstance, const XrInteractionProfileSuggestedBinding* bindings) {
     if (!bindings) return XR_ERROR_VALIDATION_FAILURE;
     // interactionProfile is an XrPath (integer), not a C-string
-    Logf("[SimXR] xrSuggestInteractionProfileBindings: profile=0x%llx",
-         (unsigned long long)bindings->interactionProfile);
+    Logf("[SimXR] xrSuggestInteractionProfileBindings: profile=0x%llx, bindings=%u",
+         (unsigned long long)bindings->interactionProfile, bindings->countSuggestedBindings);
+    if (bindings->countSuggestedBindings > 0 && !bindings->suggestedBindings) return XR_ERROR_VALIDATION_FAILURE;
+    uint32_t resolved = 0;
+    for (uint32_t i = 0; i < bindings->countSuggestedBindings; ++i) {
+        const XrActionSuggestedBinding& suggested = bindings->suggestedBindings[i];
+        rt::ActionBinding* action = FindAction(suggested.action);
+        auto pathIt = rt::g_pathStrings.find(suggested.binding);
+        if (!action || pathIt == rt::g_pathStrings.end()) continue;
+        uint8_t hand = rt::HandAny;
+        const rt::InputSource source = ClassifyBindingPath(pathIt->second, hand);
+        if (!action->subactionHands) action->hands |= hand;
+        if (source != rt::InputSource::None && !action->fromBindings) {
+            action->source = source;
+            action->fromBindings = true;
+            ++resolved;
+        }
+    }
+    if (resolved) Logf("[SimXR] xrSuggestInteractionProfileBindings: resolved %u actions from binding paths", resolved);
     return XR_SUCCESS;
 }
 
@@ -4568,33 +7169,14 @@ static XrResult XRAPI_PTR xrAttachSessionActionSets_runtime(XrSession, const XrS
     return XR_SUCCESS;
 }
 
-// Helper to get controller state based on action and subactionPath
-static rt::ControllerState* GetControllerForAction(XrAction action, XrPath subactionPath) {
-    // First check subactionPath
+// Controller an action query reads: the subaction path's hand, else the action's only bound
+// hand, else the right hand
+static const rt::ControllerState& ControllerFor(const rt::ActionBinding& action, XrPath subactionPath) {
     if (subactionPath != XR_NULL_PATH) {
-        auto pathIt = rt::g_pathStrings.find(subactionPath);
-        if (pathIt != rt::g_pathStrings.end()) {
-            if (pathIt->second.find("left") != std::string::npos) return &rt::g_leftController;
-            if (pathIt->second.find("right") != std::string::npos) return &rt::g_rightController;
-        }
-    }
-    // Fall back to action's hand binding
-    auto handIt = rt::g_actionHand.find(action);
-    if (handIt != rt::g_actionHand.end()) {
-        if (handIt->second == 1) return &rt::g_leftController;
-        if (handIt->second == 2) return &rt::g_rightController;
+        if (subactionPath == rt::g_leftHandPath) return rt::g_leftController;
+        if (subactionPath == rt::g_rightHandPath) return rt::g_rightController;
     }
-    // Default to right hand
-    return &rt::g_rightController;
-}
-
-// Helper to check if action name matches input type (case-insensitive substring match)
-static bool ActionNameMatches(const std::string& name, const char* pattern) {
-    std::string lower = name;
-    for (auto& c : lower) c = (char)tolower(c);
-    std::string patLower = pattern;
-    for (auto& c : patLower) c = (char)tolower(c);
-    return lower.find(patLower) != std::string::npos;
+    return action.hands == rt::HandLeft ? rt::g_leftController : rt::g_rightController;
 }
 
 static XrResult XRAPI_PTR xrGetActionStateBoolean_runtime(XrSession, const XrActionStateGetInfo* info, XrActionStateBoolean* state) {
@@ -4603,26 +7185,17 @@ static XrResult XRAPI_PTR xrGetActionStateBoolean_runtime(XrSession, const XrAct
     state->changedSinceLastSync = XR_FALSE;
     state->lastChangeTime = 0;
 
-    // Get controller for this action
-    rt::ControllerState* ctrl = GetControllerForAction(info->action, info->subactionPath);
-
-    // Get action name to determine input type
     bool buttonState = false;
-    auto nameIt = rt::g_actionNames.find(info->action);
-    if (nameIt != rt::g_actionNames.end()) {
-        const std::string& name = nameIt->second;
-        if (ActionNameMatches(name, "trigger") || ActionNameMatches(name, "select") || ActionNameMatches(name, "fire")) {
-            buttonState = ctrl->triggerPressed;
-        } else if (ActionNameMatches(name, "grip") || ActionNameMatches(name, "squeeze") || ActionNameMatches(name, "grab")) {
-            buttonState = ctrl->gripPressed;
-        } else if (ActionNameMatches(name, "menu")) {
-            buttonState = ctrl->menuPressed;
-        } else if (ActionNameMatches(name, "primary") || ActionNameMatches(name, "a_button") || ActionNameMatches(name, "x_button")) {
-            buttonState = ctrl->primaryPressed;
-        } else if (ActionNameMatches(name, "secondary") || ActionNameMatches(name, "b_button") || ActionNameMatches(name, "y_button")) {
-            buttonState = ctrl->secondaryPressed;
-        } else if (ActionNameMatches(name, "thumbstick") || ActionNameMatches(name, "joystick")) {
-            buttonState = ctrl->thumbstickPressed;
+    if (const rt::ActionBinding* action = FindAction(info->action)) {
+        const rt::ControllerState& ctrl = ControllerFor(*action, info->subactionPath);
+        switch (action->source) {
+            case rt::InputSource::Trigger:    buttonState = ctrl.triggerPressed; break;
+            case rt::InputSource::Grip:       buttonState = ctrl.gripPressed; break;
+            case rt::InputSource::Menu:       buttonState = ctrl.menuPressed; break;
+            case rt::InputSource::Primary:    buttonState = ctrl.primaryPressed; break;
+            case rt::InputSource::Secondary:  buttonState = ctrl.secondaryPressed; break;
+            case rt::InputSource::Thumbstick: buttonState = ctrl.thumbstickPressed; break;
+            default: break;
         }
     }
 
@@ -4637,18 +7210,15 @@ static XrResult XRAPI_PTR xrGetActionStateFloat_runtime(XrSession, const XrActio
     state->changedSinceLastSync = XR_FALSE;
     state->lastChangeTime = 0;
 
-    // Get controller for this action
-    rt::ControllerState* ctrl = GetControllerForAction(info->action, info->subactionPath);
-
-    // Get action name to determine input type
     float floatState = 0.0f;
-    auto nameIt = rt::g_actionNames.find(info->action);
-    if (nameIt != rt::g_actionNames.end()) {
-        const std::string& name = nameIt->second;
-        if (ActionNameMatches(name, "trigger") || ActionNameMatches(name, "select") || ActionNameMatches(name, "fire")) {
-            floatState = ctrl->triggerValue;
-        } else if (ActionNameMatches(name, "grip") || ActionNameMatches(name, "squeeze") || ActionNameMatches(name, "grab")) {
-            floatState = ctrl->gripValue;
+    if (const rt::ActionBinding* action = FindAction(info->action)) {
+        const rt::ControllerState& ctrl = ControllerFor(*action, info->subactionPath);
+        switch (action->source) {
+            case rt::InputSource::Trigger:     floatState = ctrl.triggerValue; break;
+            case rt::InputSource::Grip:        floatState = ctrl.gripValue; break;
+            case rt::InputSource::ThumbstickX: floatState = ctrl.thumbstick.x; break;
+            case rt::InputSource::ThumbstickY: floatState = ctrl.thumbstick.y; break;
+            default: break;
         }
     }
 
@@ -4670,21 +7240,10 @@ static XrResult XRAPI_PTR xrGetActionStateVector2f_runtime(XrSession, const XrAc
     state->changedSinceLastSync = XR_FALSE;
     state->lastChangeTime = 0;
 
-    // Get controller for this action
-    rt::ControllerState* ctrl = GetControllerForAction(info->action, info->subactionPath);
-
-    // Get action name to determine input type
-    auto nameIt = rt::g_actionNames.find(info->action);
-    if (nameIt != rt::g_actionNames.end()) {
-        const std::string& name = nameIt->second;
-        if (ActionNameMatches(name, "thumbstick") || ActionNameMatches(name, "joystick") ||
-            ActionNameMatches(name, "move") || ActionNameMatches(name, "turn")) {
-            state->currentState = ctrl->thumbstick;
-        } else {
-            state->currentState = {0.0f, 0.0f};
-        }
-    } else {
-        state->currentState = {0.0f, 0.0f};
+    state->currentState = {0.0f, 0.0f};
+    const rt::ActionBinding* action = FindAction(info->action);
+    if (action && action->source == rt::InputSource::Thumbstick) {
+        state->currentState = ControllerFor(*action, info->subactionPath).thumbstick;
     }
 
     state->isActive = XR_TRUE;
@@ -4706,6 +7265,8 @@ static XrResult XRAPI_PTR xrStringToPath_runtime(XrInstance, const char* pathStr
     *path = (XrPath)hash;
     // Store path string for controller detection
     rt::g_pathStrings[*path] = pathString;
+    if (strcmp(pathString, "/user/hand/left") == 0) rt::g_leftHandPath = *path;
+    else if (strcmp(pathString, "/user/hand/right") == 0) rt::g_rightHandPath = *path;
     Logf("[SimXR] xrStringToPath: %s -> %llu", pathString, (unsigned long long)*path);
     return XR_SUCCESS;
 }
@@ -4745,24 +7306,34 @@ static XrResult XRAPI_PTR xrGetInputSourceLocalizedName_runtime(XrSession, const
 }
 
 static XrResult XRAPI_PTR xrDestroySwapchain_runtime(XrSwapchain sc) {
-    auto it = rt::g_swapchains.find(sc);
-    if (it == rt::g_swapchains.end()) return XR_ERROR_HANDLE_INVALID;
+    rt::Swapchain* it = rt::g_swapchains.Find(sc);
+    if (!it) return XR_ERROR_HANDLE_INVALID;
 
     // For OpenGL swapchains, delete the textures
-    if (it->second.backend == rt::Swapchain::Backend::OpenGL && !it->second.imagesGL.empty()) {
+    if (it->backend == rt::Swapchain::Backend::OpenGL && !it->imagesGL.empty()) {
         // Make app's GL context current if available
         HGLRC prevRC = wglGetCurrentContext();
         HDC prevDC = wglGetCurrentDC();
         if (rt::g_session.glDC && rt::g_session.glRC) {
             wglMakeCurrent(rt::g_session.glDC, rt::g_session.glRC);
         }
-        for (GLuint tex : it->second.imagesGL) {
-            glDeleteTextures(1, &tex);
+        if (it->glInterop) {
+            rt::ReleaseGLInteropImages(rt::g_session, *it);
+        } else {
+            rt::ReleaseGLReadbackRings(*it);
+            for (GLuint tex : it->imagesGL) {
+                glDeleteTextures(1, &tex);
+            }
         }
         if (prevRC) wglMakeCurrent(prevDC, prevRC);
     }
 
-    rt::g_swapchains.erase(it);
+    // Cached preview views reference the images; drop them before the images go
+    it->blitViews.clear();
+#ifdef XR_USE_GRAPHICS_API_VULKAN
+    if (it->backend == rt::Swapchain::Backend::Vulkan) vkinterop::DestroyChain(rt::g_session.vk, it->vk);
+#endif
+    rt::g_swapchains.Erase(sc);
     Logf("[SimXR] xrDestroySwapchain: sc=%p", sc);
     return XR_SUCCESS;
 }
@@ -4838,101 +7409,148 @@ static XrResult XRAPI_PTR xrConvertTimeToWin32PerformanceCounterKHR_runtime(XrIn
 
 // ----------------------------------------------
 
-struct NameFn { const char* name; PFN_xrVoidFunction fn; };
-
-static const NameFn kFnTable[] = {
-    {"xrGetInstanceProcAddr", (PFN_xrVoidFunction)xrGetInstanceProcAddr_runtime},
-    {"xrEnumerateApiLayerProperties", (PFN_xrVoidFunction)xrEnumerateApiLayerProperties_runtime},
-    {"xrEnumerateInstanceExtensionProperties", (PFN_xrVoidFunction)xrEnumerateInstanceExtensionProperties_runtime},
-    {"xrCreateInstance", (PFN_xrVoidFunction)xrCreateInstance_runtime},
-    {"xrDestroyInstance", (PFN_xrVoidFunction)xrDestroyInstance_runtime},
-    {"xrGetInstanceProperties", (PFN_xrVoidFunction)xrGetInstanceProperties_runtime},
-    {"xrGetSystem", (PFN_xrVoidFunction)xrGetSystem_runtime},
-    {"xrGetSystemProperties", (PFN_xrVoidFunction)xrGetSystemProperties_runtime},
-    {"xrEnumerateViewConfigurations", (PFN_xrVoidFunction)xrEnumerateViewConfigurations_runtime},
-    {"xrEnumerateViewConfigurationViews", (PFN_xrVoidFunction)xrEnumerateViewConfigurationViews_runtime},
-    {"xrEnumerateEnvironmentBlendModes", (PFN_xrVoidFunction)xrEnumerateEnvironmentBlendModes_runtime},
-    {"xrCreateSession", (PFN_xrVoidFunction)xrCreateSession_runtime},
-    {"xrDestroySession", (PFN_xrVoidFunction)xrDestroySession_runtime},
-    {"xrEnumerateSwapchainFormats", (PFN_xrVoidFunction)xrEnumerateSwapchainFormats_runtime},
-    {"xrCreateSwapchain", (PFN_xrVoidFunction)xrCreateSwapchain_runtime},
-    {"xrDestroySwapchain", (PFN_xrVoidFunction)xrDestroySwapchain_runtime},
-    {"xrEnumerateSwapchainImages", (PFN_xrVoidFunction)xrEnumerateSwapchainImages_runtime},
-    {"xrAcquireSwapchainImage", (PFN_xrVoidFunction)xrAcquireSwapchainImage_runtime},
-    {"xrWaitSwapchainImage", (PFN_xrVoidFunction)xrWaitSwapchainImage_runtime},
-    {"xrReleaseSwapchainImage", (PFN_xrVoidFunction)xrReleaseSwapchainImage_runtime},
-    {"xrBeginSession", (PFN_xrVoidFunction)xrBeginSession_runtime},
-    {"xrEndSession", (PFN_xrVoidFunction)xrEndSession_runtime},
-    {"xrWaitFrame", (PFN_xrVoidFunction)xrWaitFrame_runtime},
-    {"xrBeginFrame", (PFN_xrVoidFunction)xrBeginFrame_runtime},
-    {"xrEndFrame", (PFN_xrVoidFunction)xrEndFrame_runtime},
-    {"xrPollEvent", (PFN_xrVoidFunction)xrPollEvent_runtime},
-    {"xrLocateViews", (PFN_xrVoidFunction)xrLocateViews_runtime},
-    {"xrGetD3D11GraphicsRequirementsKHR", (PFN_xrVoidFunction)xrGetD3D11GraphicsRequirementsKHR_runtime},
-    {"xrGetD3D12GraphicsRequirementsKHR", (PFN_xrVoidFunction)xrGetD3D12GraphicsRequirementsKHR_runtime},
-    {"xrGetOpenGLGraphicsRequirementsKHR", (PFN_xrVoidFunction)xrGetOpenGLGraphicsRequirementsKHR_runtime},
-    {"xrRequestExitSession", (PFN_xrVoidFunction)xrRequestExitSession_runtime},
-    // Space functions
-    {"xrCreateReferenceSpace", (PFN_xrVoidFunction)xrCreateReferenceSpace_runtime},
-    {"xrDestroySpace", (PFN_xrVoidFunction)xrDestroySpace_runtime},
-    {"xrLocateSpace", (PFN_xrVoidFunction)xrLocateSpace_runtime},
-    {"xrEnumerateReferenceSpaces", (PFN_xrVoidFunction)xrEnumerateReferenceSpaces_runtime},
-    {"xrCreateActionSpace", (PFN_xrVoidFunction)xrCreateActionSpace_runtime},
-    // Action functions
-    {"xrCreateActionSet", (PFN_xrVoidFunction)xrCreateActionSet_runtime},
-    {"xrDestroyActionSet", (PFN_xrVoidFunction)xrDestroyActionSet_runtime},
-    {"xrCreateAction", (PFN_xrVoidFunction)xrCreateAction_runtime},
-    {"xrDestroyAction", (PFN_xrVoidFunction)xrDestroyAction_runtime},
-    {"xrSuggestInteractionProfileBindings", (PFN_xrVoidFunction)xrSuggestInteractionProfileBindings_runtime},
-    {"xrAttachSessionActionSets", (PFN_xrVoidFunction)xrAttachSessionActionSets_runtime},
-    {"xrGetActionStateBoolean", (PFN_xrVoidFunction)xrGetActionStateBoolean_runtime},
-    {"xrGetActionStateFloat", (PFN_xrVoidFunction)xrGetActionStateFloat_runtime},
-    {"xrGetActionStatePose", (PFN_xrVoidFunction)xrGetActionStatePose_runtime},
-    {"xrGetActionStateVector2f", (PFN_xrVoidFunction)xrGetActionStateVector2f_runtime},
-    {"xrSyncActions", (PFN_xrVoidFunction)xrSyncActions_runtime},
-    // Path functions
-    {"xrStringToPath", (PFN_xrVoidFunction)xrStringToPath_runtime},
-    {"xrPathToString", (PFN_xrVoidFunction)xrPathToString_runtime},
-    // Interaction functions
-    {"xrGetCurrentInteractionProfile", (PFN_xrVoidFunction)xrGetCurrentInteractionProfile_runtime},
-    {"xrEnumerateBoundSourcesForAction", (PFN_xrVoidFunction)xrEnumerateBoundSourcesForAction_runtime},
-    {"xrGetInputSourceLocalizedName", (PFN_xrVoidFunction)xrGetInputSourceLocalizedName_runtime},
-    // Utility functions
-    {"xrResultToString", (PFN_xrVoidFunction)xrResultToString_runtime},
-    {"xrStructureTypeToString", (PFN_xrVoidFunction)xrStructureTypeToString_runtime},
-    {"xrGetReferenceSpaceBoundsRect", (PFN_xrVoidFunction)xrGetReferenceSpaceBoundsRect_runtime},
-    {"xrGetViewConfigurationProperties", (PFN_xrVoidFunction)xrGetViewConfigurationProperties_runtime},
-    // Haptic functions
-    {"xrApplyHapticFeedback", (PFN_xrVoidFunction)xrApplyHapticFeedback_runtime},
-    {"xrStopHapticFeedback", (PFN_xrVoidFunction)xrStopHapticFeedback_runtime},
-    // Time conversion functions
-    {"xrConvertWin32PerformanceCounterToTimeKHR", (PFN_xrVoidFunction)xrConvertWin32PerformanceCounterToTimeKHR_runtime},
-    {"xrConvertTimeToWin32PerformanceCounterKHR", (PFN_xrVoidFunction)xrConvertTimeToWin32PerformanceCounterKHR_runtime},
-};
+// Every entry point xrGetInstanceProcAddr hands out; X(name) expands once per function
+// (implemented as name##_runtime) for the name and pointer tables below.
+#ifdef XR_USE_GRAPHICS_API_VULKAN
+#define SIMXR_VULKAN_FUNCTIONS(X) \
+    X(xrGetVulkanGraphicsRequirements2KHR) \
+    X(xrCreateVulkanInstanceKHR) \
+    X(xrGetVulkanGraphicsDevice2KHR) \
+    X(xrCreateVulkanDeviceKHR)
+#else
+#define SIMXR_VULKAN_FUNCTIONS(X)
+#endif
+
+#define SIMXR_RUNTIME_FUNCTIONS(X) \
+    X(xrGetInstanceProcAddr) \
+    X(xrEnumerateApiLayerProperties) \
+    X(xrEnumerateInstanceExtensionProperties) \
+    X(xrCreateInstance) \
+    X(xrDestroyInstance) \
+    X(xrGetInstanceProperties) \
+    X(xrGetSystem) \
+    X(xrGetSystemProperties) \
+    X(xrEnumerateViewConfigurations) \
+    X(xrEnumerateViewConfigurationViews) \
+    X(xrEnumerateEnvironmentBlendModes) \
+    X(xrCreateSession) \
+    X(xrDestroySession) \
+    X(xrEnumerateSwapchainFormats) \
+    X(xrCreateSwapchain) \
+    X(xrDestroySwapchain) \
+    X(xrEnumerateSwapchainImages) \
+    X(xrAcquireSwapchainImage) \
+    X(xrWaitSwapchainImage) \
+    X(xrReleaseSwapchainImage) \
+    X(xrBeginSession) \
+    X(xrEndSession) \
+    X(xrWaitFrame) \
+    X(xrBeginFrame) \
+    X(xrEndFrame) \
+    X(xrPollEvent) \
+    X(xrLocateViews) \
+    X(xrGetD3D11GraphicsRequirementsKHR) \
+    X(xrGetD3D12GraphicsRequirementsKHR) \
+    X(xrGetOpenGLGraphicsRequirementsKHR) \
+    SIMXR_VULKAN_FUNCTIONS(X) \
+    X(xrRequestExitSession) \
+    /* Space functions */ \
+    X(xrCreateReferenceSpace) \
+    X(xrDestroySpace) \
+    X(xrLocateSpace) \
+    X(xrEnumerateReferenceSpaces) \
+    X(xrCreateActionSpace) \
+    /* Action functions */ \
+    X(xrCreateActionSet) \
+    X(xrDestroyActionSet) \
+    X(xrCreateAction) \
+    X(xrDestroyAction) \
+    X(xrSuggestInteractionProfileBindings) \
+    X(xrAttachSessionActionSets) \
+    X(xrGetActionStateBoolean) \
+    X(xrGetActionStateFloat) \
+    X(xrGetActionStatePose) \
+    X(xrGetActionStateVector2f) \
+    X(xrSyncActions) \
+    /* Path functions */ \
+    X(xrStringToPath) \
+    X(xrPathToString) \
+    /* Interaction functions */ \
+    X(xrGetCurrentInteractionProfile) \
+    X(xrEnumerateBoundSourcesForAction) \
+    X(xrGetInputSourceLocalizedName) \
+    /* Utility functions */ \
+    X(xrResultToString) \
+    X(xrStructureTypeToString) \
+    X(xrGetReferenceSpaceBoundsRect) \
+    X(xrGetViewConfigurationProperties) \
+    /* Haptic functions */ \
+    X(xrApplyHapticFeedback) \
+    X(xrStopHapticFeedback) \
+    /* Time conversion functions */ \
+    X(xrConvertWin32PerformanceCounterToTimeKHR) \
+    X(xrConvertTimeToWin32PerformanceCounterKHR)
+
+#define SIMXR_FN_NAME(name) #name,
+#define SIMXR_FN_PTR(name) (PFN_xrVoidFunction)name##_runtime,
+static constexpr const char* kFnNames[] = { SIMXR_RUNTIME_FUNCTIONS(SIMXR_FN_NAME) };
+static const PFN_xrVoidFunction kFnPtrs[] = { SIMXR_RUNTIME_FUNCTIONS(SIMXR_FN_PTR) };
+#undef SIMXR_FN_NAME
+#undef SIMXR_FN_PTR
+static constexpr uint32_t kFnCount = (uint32_t)(sizeof(kFnNames) / sizeof(kFnNames[0]));
+static_assert(sizeof(kFnPtrs) / sizeof(kFnPtrs[0]) == kFnCount, "name and pointer tables diverged");
+
+// Open-addressed FNV-1a table over kFnNames, built at compile time. A lookup hashes the name
+// once and usually compares a single string, instead of strcmp against every entry.
+static constexpr uint32_t kFnSlots = 256;  // power of two, under 1/3 full
+static constexpr uint8_t kFnEmpty = 0xFF;
+static_assert(kFnCount * 3 <= kFnSlots && kFnCount < kFnEmpty, "grow kFnSlots");
+
+static constexpr uint32_t HashProcName(const char* name) {
+    uint32_t h = 2166136261u;
+    for (; *name; ++name) h = (h ^ (uint8_t)*name) * 16777619u;
+    return h;
+}
+
+struct FnHashTable { uint8_t slots[kFnSlots]; uint32_t maxProbe; };
+
+static constexpr FnHashTable BuildFnHashTable() {
+    FnHashTable table{};
+    for (uint32_t i = 0; i < kFnSlots; ++i) table.slots[i] = kFnEmpty;
+    table.maxProbe = 0;
+    for (uint32_t i = 0; i < kFnCount; ++i) {
+        uint32_t slot = HashProcName(kFnNames[i]) & (kFnSlots - 1);
+        uint32_t probe = 1;
+        while (table.slots[slot] != kFnEmpty) {
+            slot = (slot + 1) & (kFnSlots - 1);
+            ++probe;
+        }
+        table.slots[slot] = (uint8_t)i;
+        if (probe > table.maxProbe) table.maxProbe = probe;
+    }
+    return table;
+}
+static constexpr FnHashTable kFnHash = BuildFnHashTable();
+static_assert(kFnHash.maxProbe <= 8, "proc name hashes cluster; change kFnSlots");
 
 static XrResult XRAPI_PTR xrGetInstanceProcAddr_runtime(XrInstance instance, const char* name, PFN_xrVoidFunction* fn) {
     if (!name || !fn) {
         Logf("[SimXR] xrGetInstanceProcAddr: ERROR - name=%p, fn=%p", name, fn);
         return XR_ERROR_VALIDATION_FAILURE;
     }
-    
-    // Reduce logging verbosity for xrGetInstanceProcAddr
-    static bool reduceLogging = false;
-    static int callCount = 0;
-    callCount++;
-    
-    for (auto& e : kFnTable) {
-        if (strcmp(name, e.name) == 0) { 
-            *fn = e.fn;
-            if (callCount < 100 || strstr(name, "D3D11") || strstr(name, "Create") || strstr(name, "Destroy")) {
-                Logf("[SimXR] xrGetInstanceProcAddr: %s -> FOUND", name);
-            }
-            return XR_SUCCESS; 
+    g_procLookups.fetch_add(1, std::memory_order_relaxed);
+
+    for (uint32_t slot = HashProcName(name) & (kFnSlots - 1);; slot = (slot + 1) & (kFnSlots - 1)) {
+        const uint8_t index = kFnHash.slots[slot];
+        if (index == kFnEmpty) break;
+        if (strcmp(name, kFnNames[index]) == 0) {
+            *fn = kFnPtrs[index];
+            LogAtf(logging::CatGeneral, logging::Level::Trace, "[SimXR] xrGetInstanceProcAddr: %s -> FOUND", name);
+            return XR_SUCCESS;
         }
     }
-    
-    if (callCount < 100 || strstr(name, "D3D11")) {
-        Logf("[SimXR] xrGetInstanceProcAddr: %s -> NOT FOUND", name);
-    }
+
+    *fn = nullptr;
+    LogAtf(logging::CatGeneral, logging::Level::Debug, "[SimXR] xrGetInstanceProcAddr: %s -> NOT FOUND", name);
     return XR_ERROR_FUNCTION_UNSUPPORTED;
 }
@@ -0,0 +1,229 @@
+// Background screenshot encoder for OpenXR Simulator
+// - The frame thread hands over pixels that are already on the CPU (mapped readbacks);
+//   encoding and disk I/O run on a worker thread
+// - BMP (24-bit, as before) or PNG through WIC; PNGs of the preview are ~10x smaller
+// - Files are written under a temporary name and renamed into place, so a reader polling
+//   for screenshot.* never sees a partial image
+//
+// Environment:
+//   OPENXR_SIM_SCREENSHOT_FORMAT  bmp (default) | png; a request's "format" field overrides it
+#pragma once
+
+#include <windows.h>
+#include <objbase.h>
+#include <wincodec.h>
+#include <wrl/client.h>
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <utility>
+#include <vector>
+#include <cstdio>
+#include <cstdint>
+#include <cstring>
+#include "async_log.h"
+
+#pragma comment(lib, "ole32.lib")
+#pragma comment(lib, "windowscodecs.lib")
+
+namespace screenshot {
+
+enum class Format { Bmp, Png };
+
+inline std::atomic<Format> g_defaultFormat{Format::Bmp};
+
+inline const char* Extension(Format format) { return format == Format::Png ? "png" : "bmp"; }
+
+// 32-bit pixels, top-down, rowPitch bytes per row (readback pitch is kept, not repacked)
+struct Job {
+    std::vector<uint8_t> pixels;
+    uint32_t width = 0;
+    uint32_t height = 0;
+    uint32_t rowPitch = 0;
+    bool bgra = false;         // channel order; otherwise RGBA
+    Format format = Format::Bmp;
+    std::string path;          // final path including extension
+};
+
+class Writer {
+public:
+    static constexpr size_t kMaxQueued = 4;  // beyond this new captures are dropped, not queued
+
+    static Writer& Get() {
+        static Writer instance;
+        return instance;
+    }
+
+    // Frame thread: never blocks on encoding or I/O
+    bool Submit(Job&& job) {
+        if (job.pixels.empty() || job.width == 0 || job.height == 0) return false;
+        if (job.rowPitch == 0) job.rowPitch = job.width * 4;
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            if (m_queue.size() >= kMaxQueued) {
+                Note("[SimXR] Screenshot queue full; dropping capture");
+                return false;
+            }
+            if (!m_thread.joinable()) {
+                m_stop = false;
+                m_thread = std::thread([this] { WorkerLoop(); });
+            }
+            m_queue.push_back(std::move(job));
+        }
+        m_cv.notify_one();
+        return true;
+    }
+
+    // Finish queued writes and join. Called from xrDestroyInstance, before the DLL may unload.
+    void Shutdown() {
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            if (!m_thread.joinable()) return;
+            m_stop = true;
+        }
+        m_cv.notify_one();
+        m_thread.join();
+    }
+
+private:
+    Writer() = default;
+    // Joining from static destruction (loader lock) could deadlock; Shutdown() is the exit path
+    ~Writer() { if (m_thread.joinable()) m_thread.detach(); }
+
+    static void Note(const char* msg) { logging::Write(logging::CatMCP, logging::Level::Info, msg); }
+
+    void WorkerLoop() {
+        const bool comReady = SUCCEEDED(CoInitializeEx(nullptr, COINIT_MULTITHREADED));
+        for (;;) {
+            Job job;
+            {
+                std::unique_lock<std::mutex> lock(m_mutex);
+                m_cv.wait(lock, [this] { return m_stop || !m_queue.empty(); });
+                if (m_queue.empty()) break;  // stop requested and drained
+                job = std::move(m_queue.front());
+                m_queue.pop_front();
+            }
+            Encode(job);
+        }
+        m_wic.Reset();
+        if (comReady) CoUninitialize();
+    }
+
+    void Encode(Job& job) {
+        LARGE_INTEGER t0, t1, freq;
+        QueryPerformanceCounter(&t0);
+        const std::string tmpPath = job.path + ".tmp";
+        bool ok = (job.format == Format::Png) ? WritePng(job, tmpPath) : WriteBmp(job, tmpPath);
+        if (ok && !MoveFileExA(tmpPath.c_str(), job.path.c_str(), MOVEFILE_REPLACE_EXISTING)) ok = false;
+        // A failed encode or rename leaves a partial .tmp behind
+        if (!ok) DeleteFileA(tmpPath.c_str());
+        QueryPerformanceCounter(&t1);
+        QueryPerformanceFrequency(&freq);
+        char msg[MAX_PATH + 96];
+        snprintf(msg, sizeof(msg), "[SimXR] Screenshot %s: %s (%ux%u, %.1f ms on writer thread)",
+                 ok ? "saved" : "FAILED", job.path.c_str(), job.width, job.height,
+                 (double)(t1.QuadPart - t0.QuadPart) * 1000.0 / (double)freq.QuadPart);
+        Note(msg);
+    }
+
+    // 24-bit bottom-up BGR, one buffered write per row
+    static bool WriteBmp(const Job& job, const std::string& path) {
+        FILE* file = nullptr;
+        if (fopen_s(&file, path.c_str(), "wb") != 0 || !file) return false;
+
+        const uint32_t w = job.width, h = job.height;
+        const uint32_t rowStride = (w * 3 + 3) & ~3u;
+        const uint32_t imageSize = rowStride * h;
+        const uint32_t fileSize = 54 + imageSize;
+        uint8_t header[54] = { 'B', 'M' };
+        const uint32_t dataOffset = 54, dibSize = 40;
+        const uint16_t planes = 1, bpp = 24;
+        memcpy(header + 2, &fileSize, 4);
+        memcpy(header + 10, &dataOffset, 4);
+        memcpy(header + 14, &dibSize, 4);
+        memcpy(header + 18, &w, 4);
+        memcpy(header + 22, &h, 4);
+        memcpy(header + 26, &planes, 2);
+        memcpy(header + 28, &bpp, 2);
+        memcpy(header + 34, &imageSize, 4);
+        fwrite(header, 1, sizeof(header), file);
+
+        const int r = job.bgra ? 2 : 0, b = job.bgra ? 0 : 2;
+        std::vector<uint8_t> row(rowStride, 0);
+        for (uint32_t y = h; y-- > 0;) {
+            const uint8_t* src = job.pixels.data() + (size_t)y * job.rowPitch;
+            for (uint32_t x = 0; x < w; ++x) {
+                row[x * 3 + 0] = src[x * 4 + b];
+                row[x * 3 + 1] = src[x * 4 + 1];
+                row[x * 3 + 2] = src[x * 4 + r];
+            }
+            fwrite(row.data(), 1, rowStride, file);
+        }
+        const bool ok = (ferror(file) == 0);
+        fclose(file);
+        return ok;
+    }
+
+    // WIC PNG; the source is declared without alpha (the preview's alpha is not meaningful)
+    bool WritePng(Job& job, const std::string& path) {
+        using Microsoft::WRL::ComPtr;
+        if (!m_wic && FAILED(CoCreateInstance(CLSID_WICImagingFactory, nullptr, CLSCTX_INPROC_SERVER,
+                                              IID_PPV_ARGS(m_wic.GetAddressOf())))) {
+            Note("[SimXR] Screenshot: WIC unavailable, PNG not written");
+            return false;
+        }
+
+        // WIC has no 32bpp RGBX format, so RGBA sources are swizzled to BGRX in place first
+        if (!job.bgra) {
+            for (uint32_t y = 0; y < job.height; ++y) {
+                uint8_t* row = job.pixels.data() + (size_t)y * job.rowPitch;
+                for (uint32_t x = 0; x < job.width; ++x) std::swap(row[x * 4 + 0], row[x * 4 + 2]);
+            }
+            job.bgra = true;
+        }
+
+        wchar_t widePath[MAX_PATH];
+        if (MultiByteToWideChar(CP_ACP, 0, path.c_str(), -1, widePath, MAX_PATH) == 0) return false;
+
+        ComPtr<IWICBitmap> bitmap;
+        ComPtr<IWICStream> stream;
+        ComPtr<IWICBitmapEncoder> encoder;
+        ComPtr<IWICBitmapFrameEncode> frame;
+        HRESULT hr = m_wic->CreateBitmapFromMemory(job.width, job.height, GUID_WICPixelFormat32bppBGR,
+                                                   job.rowPitch, job.rowPitch * job.height,
+                                                   job.pixels.data(), bitmap.GetAddressOf());
+        if (SUCCEEDED(hr)) hr = m_wic->CreateStream(stream.GetAddressOf());
+        if (SUCCEEDED(hr)) hr = stream->InitializeFromFilename(widePath, GENERIC_WRITE);
+        if (SUCCEEDED(hr)) hr = m_wic->CreateEncoder(GUID_ContainerFormatPng, nullptr, encoder.GetAddressOf());
+        if (SUCCEEDED(hr)) hr = encoder->Initialize(stream.Get(), WICBitmapEncoderNoCache);
+        if (SUCCEEDED(hr)) hr = encoder->CreateNewFrame(frame.GetAddressOf(), nullptr);
+        if (SUCCEEDED(hr)) hr = frame->Initialize(nullptr);
+        if (SUCCEEDED(hr)) hr = frame->SetSize(job.width, job.height);
+        WICPixelFormatGUID encodedFormat = GUID_WICPixelFormat24bppBGR;
+        if (SUCCEEDED(hr)) hr = frame->SetPixelFormat(&encodedFormat);
+        if (SUCCEEDED(hr)) hr = frame->WriteSource(bitmap.Get(), nullptr);  // converts to encodedFormat
+        if (SUCCEEDED(hr)) hr = frame->Commit();
+        if (SUCCEEDED(hr)) hr = encoder->Commit();
+        if (FAILED(hr)) {
+            char msg[96];
+            snprintf(msg, sizeof(msg), "[SimXR] Screenshot: PNG encode failed 0x%08X", (unsigned)hr);
+            Note(msg);
+            return false;
+        }
+        return true;
+    }
+
+    std::mutex m_mutex;
+    std::condition_variable m_cv;
+    std::deque<Job> m_queue;
+    bool m_stop{false};
+    std::thread m_thread;
+    Microsoft::WRL::ComPtr<IWICImagingFactory> m_wic;  // worker thread only
+};
+
+inline bool Submit(Job&& job) { return Writer::Get().Submit(std::move(job)); }
+
+} // namespace screenshot
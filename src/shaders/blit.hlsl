@@ -0,0 +1,71 @@
+// Preview blit shaders, compiled at build time by fxc (see CMakeLists.txt) into
+// ${build}/shaders/*.h and included through blit_shaders.h
+//
+// D3D11 draws a fullscreen quad (4 vertices, triangle strip, no vertex buffer) with VSMain or
+// VSMainFlipY. D3D12 uses VSMainRect, which maps the quad to a sub-rectangle of the source
+// through root constants, with the root signature below. PSMainArray is for array swapchain
+// images, whose single-slice views are still Texture2DArray views.
+
+Texture2D txDiffuse : register(t0);
+Texture2DArray txArray : register(t0);
+SamplerState samLinear : register(s0);
+
+// D3D12: CBV-free root signature - 4 root constants, one SRV table, one static linear sampler
+#define BlitRS \
+    "RootFlags(0), " \
+    "RootConstants(num32BitConstants=4, b0), " \
+    "DescriptorTable(SRV(t0), visibility=SHADER_VISIBILITY_PIXEL), " \
+    "StaticSampler(s0, filter=FILTER_MIN_MAG_MIP_LINEAR, " \
+    "addressU=TEXTURE_ADDRESS_CLAMP, addressV=TEXTURE_ADDRESS_CLAMP, addressW=TEXTURE_ADDRESS_CLAMP, " \
+    "visibility=SHADER_VISIBILITY_PIXEL)"
+
+cbuffer BlitRect : register(b0) {
+    float2 uvOffset;  // source rect origin, normalized
+    float2 uvScale;   // source rect size, normalized (negative v flips)
+};
+
+struct VS_OUTPUT {
+    float4 Pos : SV_POSITION;
+    float2 Tex : TEXCOORD;
+};
+
+// Vertex Shader (generates fullscreen quad with correct UV mapping)
+VS_OUTPUT VSMain(uint vertexId : SV_VertexID) {
+    VS_OUTPUT output;
+    // Generate (0,0), (2,0), (0,2), (2,2) pattern
+    float2 xy = float2((vertexId << 1) & 2, vertexId & 2);
+
+    // Clip-space position: xy goes 0-2, we need -1 to 1
+    // x: 0->-1, 2->1  means x_clip = xy.x - 1
+    // y: 0->1, 2->-1  means y_clip = 1 - xy.y
+    output.Pos = float4(xy.x - 1.0, 1.0 - xy.y, 0.0, 1.0);
+
+    // Normalized UVs (0-1 range, not 0-2)
+    output.Tex = xy * 0.5;
+
+    return output;
+}
+
+// Same quad with V flipped: GL images are stored bottom-up
+VS_OUTPUT VSMainFlipY(uint vertexId : SV_VertexID) {
+    VS_OUTPUT output = VSMain(vertexId);
+    output.Tex.y = 1.0 - output.Tex.y;
+    return output;
+}
+
+// Same quad sampling only the source sub-rect (D3D12 path, uses the root constants)
+VS_OUTPUT VSMainRect(uint vertexId : SV_VertexID) {
+    VS_OUTPUT output = VSMain(vertexId);
+    output.Tex = uvOffset + output.Tex * uvScale;
+    return output;
+}
+
+// Pixel Shader - GPU handles sRGB conversion automatically with proper formats
+float4 PSMain(VS_OUTPUT input) : SV_TARGET {
+    return txDiffuse.Sample(samLinear, input.Tex);
+}
+
+// Array swapchains (D3D12): the view's FirstArraySlice selects the eye, so sample slice 0
+float4 PSMainArray(VS_OUTPUT input) : SV_TARGET {
+    return txArray.Sample(samLinear, float3(input.Tex, 0.0));
+}
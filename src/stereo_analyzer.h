@@ -0,0 +1,355 @@
+// Stereo-consistency and frame-diff analysis of the composed preview for OpenXR Simulator
+// - Every Nth presented frame the preview is reduced on the CPU to a luma grid per eye: one
+//   sampled row per grid row, each cell the mean of the pixels it spans horizontally, so
+//   horizontal detail survives for the disparity match at a fraction of the pixel reads
+// - Disparity: the horizontal shift that best matches the centre of the left eye in the right
+//   eye (mean squared difference, parabola-refined below one cell), in preview pixels. Content
+//   nearer than infinity sits further right in the left eye, so a correct pair gives a shift
+//   <= 0 and a confident positive one means the eyes are swapped
+// - Black frame: an eye whose brightest cell is still near black
+// - Frozen frame: every tile hash equal to the last analysis that saw a change, while the head
+//   pose (from the pose history at the frame's display time) has moved since then
+// - D3D12 analyses the readback it already maps to paint the window; D3D11 and GL copy the
+//   backbuffer into a staging ring and map it a frame or more later, never waiting on the GPU
+// - Results are published through the telemetry block (mcp_integration.h), so tools read them
+//   without a screenshot round trip
+//
+// Environment:
+//   OPENXR_SIM_STEREO_ANALYZE  analyse every Nth presented frame (default 6, 0 disables)
+#pragma once
+
+#include <windows.h>
+#include <d3d11.h>
+#include <wrl/client.h>
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+#include <mutex>
+
+#include "pose_history.h"
+
+namespace stereo {
+
+using Microsoft::WRL::ComPtr;
+
+enum class Layout {
+    SideBySide,  // left eye in the left half
+    OverUnder,   // left eye in the top half
+    Single,      // one eye fills the preview (no stereo pair)
+    None         // nothing to analyse (anaglyph)
+};
+
+enum Flags : uint32_t {
+    FlagStereo      = 1u << 0,  // both eyes were analysed; disparity fields are meaningful
+    FlagLowTexture  = 1u << 1,  // too little detail in the match window to trust the disparity
+    FlagEyesSwapped = 1u << 2,
+    FlagLeftBlack   = 1u << 3,
+    FlagRightBlack  = 1u << 4,  // (single-eye layouts report only the left flag)
+    FlagFrozen      = 1u << 5
+};
+
+struct Result {
+    uint64_t analyses = 0;      // completed analyses; changes whenever the fields below do
+    uint32_t flags = 0;
+    uint32_t eyeWidth = 0;      // width of one analysed eye image, in preview pixels
+    float disparityPx = 0;      // right eye relative to the left; negative for a correct pair
+    float matchRms = 0;         // RMS luma difference (0..255) at the best shift
+    float textureStd = 0;       // luma standard deviation of the match window
+    float meanLuma[2] = {};     // per eye, 0..255
+    uint32_t changedTiles = 0;  // tiles whose hash differs from the previous analysis
+    uint32_t tileCount = 0;
+    uint32_t unchangedRun = 0;  // consecutive analyses with no changed tile
+};
+
+inline std::atomic<uint32_t> g_every{6};
+
+inline bool Due(uint64_t tick) {
+    const uint32_t every = g_every.load(std::memory_order_relaxed);
+    return every != 0 && tick % every == 0;
+}
+
+class Analyzer {
+public:
+    static constexpr uint32_t kGridW = 256;  // cells per eye row, at most
+    static constexpr uint32_t kGridH = 64;   // sampled rows per eye
+    static constexpr uint32_t kTilesX = 8, kTilesY = 4;
+    static constexpr uint32_t kTiles = 2 * kTilesX * kTilesY;
+
+    static Analyzer& Get() {
+        static Analyzer instance;
+        return instance;
+    }
+
+    // pixels: top-down 8-bit RGBA or BGRA rows of the whole composed preview
+    void Analyze(const uint8_t* pixels, uint32_t pitch, uint32_t width, uint32_t height, bool bgra,
+                 Layout layout, int64_t displayTime) {
+        if (!pixels || layout == Layout::None || width < 16 || height < 16) return;
+        std::lock_guard<std::mutex> lock(m_mutex);
+        const uint32_t eyeW = layout == Layout::SideBySide ? width / 2 : width;
+        const uint32_t eyeH = layout == Layout::OverUnder ? height / 2 : height;
+        const uint32_t eyeCount = layout == Layout::Single ? 1 : 2;
+        for (uint32_t e = 0; e < eyeCount; ++e) {
+            const uint32_t x0 = (layout == Layout::SideBySide && e == 1) ? eyeW : 0;
+            const uint32_t y0 = (layout == Layout::OverUnder && e == 1) ? eyeH : 0;
+            BuildGrid(m_grid[e], pixels + (size_t)y0 * pitch + (size_t)x0 * 4, pitch, eyeW, eyeH, bgra);
+        }
+
+        Result r;
+        r.analyses = m_result.analyses + 1;
+        r.eyeWidth = eyeW;
+        for (uint32_t e = 0; e < eyeCount; ++e) {
+            uint32_t sum = 0, peak = 0;
+            for (uint32_t y = 0; y < kGridH; ++y) {
+                for (uint32_t x = 0; x < m_cols; ++x) {
+                    sum += m_grid[e][y][x];
+                    peak = std::max<uint32_t>(peak, m_grid[e][y][x]);
+                }
+            }
+            r.meanLuma[e] = (float)sum / (float)(kGridH * m_cols);
+            if (peak < kBlackPeak) r.flags |= e == 0 ? FlagLeftBlack : FlagRightBlack;
+        }
+        if (eyeCount == 2) {
+            r.flags |= FlagStereo;
+            MatchEyes(r);
+        }
+        DiffTiles(r, eyeCount, layout, displayTime);
+        m_result = r;
+    }
+
+    Result Latest() {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        return m_result;
+    }
+
+private:
+    static constexpr uint32_t kBlackPeak = 8;       // brightest cell below this: black
+    static constexpr float kMinTextureStd = 3.0f;   // luma std dev needed to trust a match
+    static constexpr float kMovedDeg = 0.25f;
+    static constexpr float kMovedMm = 1.0f;
+
+    void BuildGrid(uint8_t (&grid)[kGridH][kGridW], const uint8_t* origin, uint32_t pitch,
+                   uint32_t eyeW, uint32_t eyeH, bool bgra) {
+        m_cols = std::min(eyeW, kGridW);
+        const uint32_t r = bgra ? 2 : 0, b = bgra ? 0 : 2;
+        for (uint32_t gy = 0; gy < kGridH; ++gy) {
+            const uint8_t* row = origin + (size_t)(((2 * gy + 1) * eyeH) / (2 * kGridH)) * pitch;
+            for (uint32_t gx = 0; gx < m_cols; ++gx) {
+                const uint32_t xa = gx * eyeW / m_cols, xb = (gx + 1) * eyeW / m_cols;
+                uint32_t sum = 0;
+                for (uint32_t x = xa; x < xb; ++x) {
+                    const uint8_t* p = row + (size_t)x * 4;
+                    sum += (p[r] * 77u + p[1] * 150u + p[b] * 29u) >> 8;
+                }
+                grid[gy][gx] = (uint8_t)(sum / (xb - xa));
+            }
+        }
+    }
+
+    // Mean squared difference between the left window and the right one shifted by dx cells
+    float WindowError(int dx, uint32_t x0, uint32_t x1, uint32_t y0, uint32_t y1) const {
+        uint64_t sum = 0;
+        for (uint32_t y = y0; y < y1; ++y) {
+            const uint8_t* l = m_grid[0][y];
+            const uint8_t* r = m_grid[1][y];
+            for (uint32_t x = x0; x < x1; ++x) {
+                const int d = (int)l[x] - (int)r[(int)x + dx];
+                sum += (uint64_t)(d * d);
+            }
+        }
+        return (float)sum / (float)((x1 - x0) * (y1 - y0));
+    }
+
+    void MatchEyes(Result& r) const {
+        // Centre window, half the eye each way, away from edges
+        const uint32_t x0 = m_cols / 4, x1 = x0 + m_cols / 2;
+        const uint32_t y0 = kGridH / 4, y1 = y0 + kGridH / 2;
+        const int maxShift = (int)(m_cols / 6);
+
+        uint64_t sum = 0, sumSq = 0;
+        for (uint32_t y = y0; y < y1; ++y) {
+            for (uint32_t x = x0; x < x1; ++x) {
+                const uint32_t v = m_grid[0][y][x];
+                sum += v;
+                sumSq += v * v;
+            }
+        }
+        const float n = (float)((x1 - x0) * (y1 - y0));
+        const float mean = (float)sum / n;
+        r.textureStd = sqrtf(std::max(0.0f, (float)sumSq / n - mean * mean));
+
+        float errors[2 * kGridW / 6 + 1];
+        int best = 0;
+        for (int dx = -maxShift; dx <= maxShift; ++dx) {
+            errors[dx + maxShift] = WindowError(dx, x0, x1, y0, y1);
+            if (errors[dx + maxShift] < errors[best + maxShift]) best = dx;
+        }
+        float offset = 0.0f;
+        if (best > -maxShift && best < maxShift) {
+            const float em = errors[best + maxShift - 1], e0 = errors[best + maxShift], ep = errors[best + maxShift + 1];
+            const float curve = em - 2.0f * e0 + ep;
+            if (curve > 1e-3f) offset = std::clamp(0.5f * (em - ep) / curve, -0.5f, 0.5f);
+        }
+        const float cellPx = (float)r.eyeWidth / (float)m_cols;
+        r.disparityPx = ((float)best + offset) * cellPx;
+        r.matchRms = sqrtf(errors[best + maxShift]);
+
+        if (r.textureStd < kMinTextureStd) {
+            r.flags |= FlagLowTexture;
+            return;
+        }
+        // Swapped only when the wrong-signed shift is clearly better than no shift at all,
+        // with the same floor the screenshot check used for "any parallax" (2 px per 1280)
+        const float minPx = std::max(2.0f, (float)r.eyeWidth / 640.0f);
+        if (r.disparityPx >= minPx && errors[best + maxShift] < 0.8f * errors[maxShift]) {
+            r.flags |= FlagEyesSwapped;
+        }
+    }
+
+    static uint64_t TileHash(const uint8_t (&grid)[kGridH][kGridW], uint32_t cols, uint32_t tx, uint32_t ty) {
+        uint64_t hash = 1469598103934665603ull;  // FNV-1a
+        const uint32_t xa = tx * cols / kTilesX, xb = (tx + 1) * cols / kTilesX;
+        for (uint32_t y = ty * kGridH / kTilesY; y < (ty + 1) * kGridH / kTilesY; ++y) {
+            for (uint32_t x = xa; x < xb; ++x) {
+                hash = (hash ^ grid[y][x]) * 1099511628211ull;
+            }
+        }
+        return hash;
+    }
+
+    void DiffTiles(Result& r, uint32_t eyeCount, Layout layout, int64_t displayTime) {
+        uint64_t hashes[kTiles];
+        r.tileCount = eyeCount * kTilesX * kTilesY;
+        for (uint32_t e = 0; e < eyeCount; ++e) {
+            for (uint32_t ty = 0; ty < kTilesY; ++ty) {
+                for (uint32_t tx = 0; tx < kTilesX; ++tx) {
+                    hashes[(e * kTilesY + ty) * kTilesX + tx] = TileHash(m_grid[e], m_cols, tx, ty);
+                }
+            }
+        }
+        posehistory::Sample pose;
+        const bool havePose = posehistory::History::Get().At(displayTime, pose);
+
+        const bool comparable = m_haveTiles && m_tileLayout == layout && m_tileCols == m_cols;
+        r.changedTiles = r.tileCount;
+        if (comparable) {
+            r.changedTiles = 0;
+            for (uint32_t i = 0; i < r.tileCount; ++i) r.changedTiles += hashes[i] != m_tiles[i];
+        }
+        if (comparable && r.changedTiles == 0) {
+            r.unchangedRun = m_result.unchangedRun + 1;
+            if (havePose && m_haveChangePose && Moved(m_changePose, pose.head)) r.flags |= FlagFrozen;
+        } else {
+            m_changePose = pose.head;
+            m_haveChangePose = havePose;
+        }
+        memcpy(m_tiles, hashes, sizeof(hashes));
+        m_haveTiles = true;
+        m_tileLayout = layout;
+        m_tileCols = m_cols;
+    }
+
+    static bool Moved(const posehistory::Pose& a, const posehistory::Pose& b) {
+        float dot = 0.0f, d2 = 0.0f;
+        for (int i = 0; i < 4; ++i) dot += a.orientation[i] * b.orientation[i];
+        for (int i = 0; i < 3; ++i) d2 += (a.position[i] - b.position[i]) * (a.position[i] - b.position[i]);
+        const float deg = 2.0f * acosf(std::min(fabsf(dot), 1.0f)) * 57.2957795f;
+        return deg > kMovedDeg || sqrtf(d2) * 1000.0f > kMovedMm;
+    }
+
+    std::mutex m_mutex;  // the frame thread or the compositor thread analyses; telemetry reads
+    uint8_t m_grid[2][kGridH][kGridW] = {};
+    uint32_t m_cols = 0;
+    uint64_t m_tiles[kTiles] = {};
+    bool m_haveTiles = false;
+    Layout m_tileLayout = Layout::None;
+    uint32_t m_tileCols = 0;
+    posehistory::Pose m_changePose;
+    bool m_haveChangePose = false;
+    Result m_result;
+};
+
+// D3D11 / GL: the backbuffer of every Nth frame is copied into a staging ring just before
+// Present and analysed once the copy has retired. One ring per device/thread.
+class Readback11 {
+public:
+    static constexpr uint32_t kSlots = 2;
+    static constexpr uint32_t kMaxFramesWaited = 8;  // then the copy is dropped, never waited for
+
+    void Queue(ID3D11Device* device, ID3D11DeviceContext* ctx, ID3D11Texture2D* backbuffer,
+               Layout layout, int64_t displayTime) {
+        if (!Due(++m_tick) || !device || !ctx || !backbuffer || layout == Layout::None) return;
+        D3D11_TEXTURE2D_DESC desc;
+        backbuffer->GetDesc(&desc);
+        const bool bgra = desc.Format == DXGI_FORMAT_B8G8R8A8_UNORM || desc.Format == DXGI_FORMAT_B8G8R8A8_UNORM_SRGB;
+        const bool rgba = desc.Format == DXGI_FORMAT_R8G8B8A8_UNORM || desc.Format == DXGI_FORMAT_R8G8B8A8_UNORM_SRGB;
+        if ((!bgra && !rgba) || desc.SampleDesc.Count > 1) return;
+        Slot* slot = nullptr;
+        for (auto& candidate : m_slots) {
+            if (!candidate.pending) { slot = &candidate; break; }
+        }
+        if (!slot) return;  // both copies still in flight: skip this one
+        if (!slot->staging || slot->desc.Width != desc.Width || slot->desc.Height != desc.Height ||
+            slot->desc.Format != desc.Format || slot->device.Get() != device) {
+            D3D11_TEXTURE2D_DESC stagingDesc = desc;
+            stagingDesc.MipLevels = 1;
+            stagingDesc.ArraySize = 1;
+            stagingDesc.Usage = D3D11_USAGE_STAGING;
+            stagingDesc.BindFlags = 0;
+            stagingDesc.CPUAccessFlags = D3D11_CPU_ACCESS_READ;
+            stagingDesc.MiscFlags = 0;
+            slot->staging.Reset();
+            if (FAILED(device->CreateTexture2D(&stagingDesc, nullptr, slot->staging.GetAddressOf()))) return;
+            slot->device = device;
+            slot->desc = desc;
+        }
+        ctx->CopyResource(slot->staging.Get(), backbuffer);
+        slot->pending = true;
+        slot->bgra = bgra;
+        slot->layout = layout;
+        slot->displayTime = displayTime;
+        slot->framesWaited = 0;
+    }
+
+    void Poll(ID3D11DeviceContext* ctx) {
+        if (!ctx) return;
+        for (auto& slot : m_slots) {
+            if (!slot.pending) continue;
+            D3D11_MAPPED_SUBRESOURCE mapped;
+            HRESULT hr = ctx->Map(slot.staging.Get(), 0, D3D11_MAP_READ, D3D11_MAP_FLAG_DO_NOT_WAIT, &mapped);
+            if (hr == DXGI_ERROR_WAS_STILL_DRAWING) {
+                if (++slot.framesWaited >= kMaxFramesWaited) slot.pending = false;
+                continue;
+            }
+            slot.pending = false;
+            if (FAILED(hr)) continue;
+            Analyzer::Get().Analyze((const uint8_t*)mapped.pData, mapped.RowPitch, slot.desc.Width, slot.desc.Height,
+                                    slot.bgra, slot.layout, slot.displayTime);
+            ctx->Unmap(slot.staging.Get(), 0);
+        }
+    }
+
+    // Drop the staging textures (their device is going away)
+    void Reset() {
+        for (auto& slot : m_slots) slot = Slot{};
+    }
+
+private:
+    struct Slot {
+        ComPtr<ID3D11Device> device;
+        ComPtr<ID3D11Texture2D> staging;
+        D3D11_TEXTURE2D_DESC desc{};
+        bool pending = false;
+        bool bgra = false;
+        Layout layout = Layout::None;
+        int64_t displayTime = 0;
+        uint32_t framesWaited = 0;
+    };
+    Slot m_slots[kSlots];
+    uint64_t m_tick = 0;
+};
+
+inline Readback11 g_readback11;  // frame thread; the compositor thread keeps its own
+
+} // namespace stereo
@@ -0,0 +1,428 @@
+// Frame-budget stress mode for OpenXR Simulator
+// - Lets an app's dynamic-resolution and frame-timing code be tested against a compositor
+//   that misses frames: xrWaitFrame can block through extra vsyncs (predictedDisplayTime moves
+//   with it), jitter predictedDisplayTime, and return shouldRender = XR_FALSE on a schedule
+// - xrEndFrame can spin the app's thread for a fixed CPU cost and queue copy work on the app's
+//   own D3D11 context / D3D12 queue. The copy count is calibrated from GPU timestamps read back
+//   a few frames later (never waited on) so the extra GPU time tracks the requested budget.
+//   OpenGL sessions get no GPU load.
+// - Schedules are frame-counted from the moment a configuration is applied and random choices
+//   come from a seeded generator, so a given configuration reproduces the same frame pattern
+// - Configured through the MCP set_stress tool; counters are reported under "stress" in
+//   runtime_status.json
+#pragma once
+
+#include <windows.h>
+#include <d3d11.h>
+#include <d3d12.h>
+#include <wrl/client.h>
+#include <algorithm>
+#include <cstdarg>
+#include <cstdio>
+#include <cstdint>
+#include "async_log.h"
+
+namespace stress {
+
+using Microsoft::WRL::ComPtr;
+
+struct Config {
+    bool enabled = false;
+    uint32_t missEvery = 0;        // every Nth frame misses (0 = never)
+    uint32_t missVsyncs = 1;       // vsyncs each miss blocks through (1..8)
+    float missChance = 0.0f;       // additional per-frame miss probability (0..1)
+    float jitterMs = 0.0f;         // predictedDisplayTime offset, uniform in +-jitterMs
+    uint32_t skipRenderEvery = 0;  // every Nth frame reports shouldRender = XR_FALSE (0 = never)
+    float cpuLoadMs = 0.0f;        // busy time added to each xrEndFrame
+    float gpuLoadMs = 0.0f;        // GPU time added to the app's queue each frame
+    uint32_t seed = 1;
+    uint32_t frames = 0;           // switch off after this many frames (0 = until disabled)
+};
+
+struct Counters {
+    uint64_t frames = 0;
+    uint64_t missedFrames = 0;
+    uint64_t missedVsyncs = 0;
+    uint64_t renderSkipped = 0;
+};
+
+inline Config g_config;
+inline Counters g_counters;
+inline uint64_t g_rng = 1;
+inline float g_gpuMeasuredMs = 0.0f;
+inline uint32_t g_gpuCopies = 0;
+
+inline void Note(const char* fmt, ...) {
+    char msg[256];
+    int n = snprintf(msg, sizeof(msg), "[SimXR] ");
+    va_list args;
+    va_start(args, fmt);
+    vsnprintf(msg + n, sizeof(msg) - n, fmt, args);
+    va_end(args);
+    logging::Write(logging::CatFrame, logging::Level::Info, msg);
+}
+
+// xorshift64*, uniform in [0, 1)
+inline float Random() {
+    g_rng ^= g_rng >> 12;
+    g_rng ^= g_rng << 25;
+    g_rng ^= g_rng >> 27;
+    return (float)((g_rng * 0x2545F4914F6CDD1DULL) >> 40) / 16777216.0f;
+}
+
+// Frame thread (xrWaitFrame's MCP poll). Restarts the schedule and the counters.
+inline void Apply(const Config& config) {
+    g_config = config;
+    g_config.missVsyncs = std::clamp<uint32_t>(g_config.missVsyncs, 1, 8);
+    g_config.missChance = std::clamp(g_config.missChance, 0.0f, 1.0f);
+    g_config.jitterMs = std::clamp(g_config.jitterMs, 0.0f, 100.0f);
+    g_config.cpuLoadMs = std::clamp(g_config.cpuLoadMs, 0.0f, 100.0f);
+    g_config.gpuLoadMs = std::clamp(g_config.gpuLoadMs, 0.0f, 100.0f);
+    g_counters = {};
+    g_rng = 0x9E3779B97F4A7C15ULL ^ (uint64_t)(g_config.seed ? g_config.seed : 1);
+    Note("Stress %s: miss every %u (+%.2f chance) x%u vsyncs, jitter +-%.2f ms, skip render every %u, "
+         "cpu %.2f ms, gpu %.2f ms, seed %u, frames %u",
+         g_config.enabled ? "on" : "off", g_config.missEvery, g_config.missChance, g_config.missVsyncs,
+         g_config.jitterMs, g_config.skipRenderEvery, g_config.cpuLoadMs, g_config.gpuLoadMs, g_config.seed,
+         g_config.frames);
+}
+
+inline bool Enabled() { return g_config.enabled; }
+
+struct FramePlan {
+    uint32_t extraVsyncs = 0;  // additional frame boundaries xrWaitFrame waits through
+    int64_t jitterNs = 0;      // added to predictedDisplayTime
+    bool shouldRender = true;
+};
+
+// Once per xrWaitFrame, after the regular pacing wait
+inline FramePlan NextFrame(int64_t periodNs) {
+    FramePlan plan;
+    if (!g_config.enabled) return plan;
+    if (g_config.frames != 0 && g_counters.frames >= g_config.frames) {
+        g_config.enabled = false;
+        Note("Stress: finished after %llu frames (%llu missed, %llu render skipped)",
+             (unsigned long long)g_counters.frames, (unsigned long long)g_counters.missedFrames,
+             (unsigned long long)g_counters.renderSkipped);
+        return plan;
+    }
+    const uint64_t frame = ++g_counters.frames;
+    // Draw every random number on every frame so the pattern doesn't depend on which knobs are on
+    const float missRoll = Random();
+    const float jitterRoll = Random();
+    if ((g_config.missEvery != 0 && frame % g_config.missEvery == 0) || missRoll < g_config.missChance) {
+        plan.extraVsyncs = g_config.missVsyncs;
+        ++g_counters.missedFrames;
+        g_counters.missedVsyncs += plan.extraVsyncs;
+    }
+    if (g_config.jitterMs > 0.0f) {
+        // Under half a period either way, so display times stay increasing
+        const double amplitude = std::min((double)g_config.jitterMs * 1e6, (double)periodNs * 0.49);
+        plan.jitterNs = (int64_t)(amplitude * (2.0 * (double)jitterRoll - 1.0));
+    }
+    if (g_config.skipRenderEvery != 0 && frame % g_config.skipRenderEvery == 0) {
+        plan.shouldRender = false;
+        ++g_counters.renderSkipped;
+    }
+    return plan;
+}
+
+// xrEndFrame, on the app's thread
+inline void SpinCpu() {
+    if (!g_config.enabled || g_config.cpuLoadMs <= 0.0f) return;
+    LARGE_INTEGER freq, start, now;
+    QueryPerformanceFrequency(&freq);
+    QueryPerformanceCounter(&start);
+    const LONGLONG ticks = (LONGLONG)((double)g_config.cpuLoadMs * 1e-3 * (double)freq.QuadPart);
+    do {
+        YieldProcessor();
+        QueryPerformanceCounter(&now);
+    } while (now.QuadPart - start.QuadPart < ticks);
+}
+
+// Copy count for the next frame from the last measured one, limited to halving/doubling per step
+inline uint32_t Calibrate(uint32_t copies, float measuredMs, float targetMs) {
+    static constexpr uint32_t kMaxCopies = 4096;
+    g_gpuMeasuredMs = measuredMs;
+    if (measuredMs <= 0.0f) return std::min(copies * 2, kMaxCopies);
+    const float ratio = std::clamp(targetMs / measuredMs, 0.5f, 2.0f);
+    return std::clamp<uint32_t>((uint32_t)((float)copies * ratio + 0.5f), 1, kMaxCopies);
+}
+
+constexpr UINT kLoadTextureSize = 2048;  // RGBA8, 16 MB per copy
+constexpr uint32_t kLoadFrames = 4;      // load submissions in flight before a frame is skipped
+
+// Copies between two private textures on the app's immediate context. CopyResource binds
+// nothing, so the app's pipeline state is untouched.
+class GpuLoad11 {
+public:
+    void Submit(ID3D11Device* device, ID3D11DeviceContext* ctx, float targetMs) {
+        if (!device || !ctx || m_failed) return;
+        if (device != m_device.Get()) {
+            Reset();
+            if (!Create(device)) return;
+        }
+        Resolve(ctx, targetMs);
+        Frame& frame = m_frames[m_next];
+        if (frame.pending) return;  // GPU more than kLoadFrames behind
+        ctx->Begin(frame.disjoint.Get());
+        ctx->End(frame.begin.Get());
+        for (uint32_t i = 0; i < m_copies; ++i) ctx->CopyResource(m_dst.Get(), m_src.Get());
+        ctx->End(frame.end.Get());
+        ctx->End(frame.disjoint.Get());
+        frame.pending = true;
+        frame.copies = m_copies;
+        m_next = (m_next + 1) % kLoadFrames;
+        g_gpuCopies = m_copies;
+    }
+
+    void Reset() {
+        for (Frame& frame : m_frames) frame = {};
+        m_src.Reset();
+        m_dst.Reset();
+        m_device.Reset();
+        m_next = 0;
+        m_oldest = 0;
+        m_copies = 1;
+        m_failed = false;
+    }
+
+private:
+    struct Frame {
+        ComPtr<ID3D11Query> disjoint, begin, end;
+        uint32_t copies = 0;
+        bool pending = false;
+    };
+
+    bool Create(ID3D11Device* device) {
+        D3D11_TEXTURE2D_DESC desc = {};
+        desc.Width = desc.Height = kLoadTextureSize;
+        desc.MipLevels = desc.ArraySize = 1;
+        desc.Format = DXGI_FORMAT_R8G8B8A8_UNORM;
+        desc.SampleDesc.Count = 1;
+        desc.Usage = D3D11_USAGE_DEFAULT;
+        HRESULT hr = device->CreateTexture2D(&desc, nullptr, m_src.GetAddressOf());
+        if (SUCCEEDED(hr)) hr = device->CreateTexture2D(&desc, nullptr, m_dst.GetAddressOf());
+        for (uint32_t i = 0; SUCCEEDED(hr) && i < kLoadFrames; ++i) {
+            D3D11_QUERY_DESC qd = { D3D11_QUERY_TIMESTAMP_DISJOINT, 0 };
+            hr = device->CreateQuery(&qd, m_frames[i].disjoint.GetAddressOf());
+            qd.Query = D3D11_QUERY_TIMESTAMP;
+            if (SUCCEEDED(hr)) hr = device->CreateQuery(&qd, m_frames[i].begin.GetAddressOf());
+            if (SUCCEEDED(hr)) hr = device->CreateQuery(&qd, m_frames[i].end.GetAddressOf());
+        }
+        if (FAILED(hr)) {
+            Note("Stress: D3D11 GPU load unavailable (0x%08X)", (unsigned)hr);
+            m_failed = true;
+            return false;
+        }
+        m_device = device;
+        return true;
+    }
+
+    void Resolve(ID3D11DeviceContext* ctx, float targetMs) {
+        while (m_frames[m_oldest].pending) {
+            Frame& frame = m_frames[m_oldest];
+            D3D11_QUERY_DATA_TIMESTAMP_DISJOINT dj = {};
+            UINT64 begin = 0, end = 0;
+            if (ctx->GetData(frame.disjoint.Get(), &dj, sizeof(dj), D3D11_ASYNC_GETDATA_DONOTFLUSH) != S_OK ||
+                ctx->GetData(frame.begin.Get(), &begin, sizeof(begin), D3D11_ASYNC_GETDATA_DONOTFLUSH) != S_OK ||
+                ctx->GetData(frame.end.Get(), &end, sizeof(end), D3D11_ASYNC_GETDATA_DONOTFLUSH) != S_OK) {
+                return;
+            }
+            // Frames recorded before the last adjustment no longer say anything about it
+            if (!dj.Disjoint && dj.Frequency != 0 && end > begin && frame.copies == m_copies) {
+                m_copies = Calibrate(m_copies, (float)((double)(end - begin) * 1000.0 / (double)dj.Frequency), targetMs);
+            }
+            frame.pending = false;
+            m_oldest = (m_oldest + 1) % kLoadFrames;
+        }
+    }
+
+    ComPtr<ID3D11Device> m_device;
+    ComPtr<ID3D11Texture2D> m_src, m_dst;
+    Frame m_frames[kLoadFrames];
+    uint32_t m_next = 0, m_oldest = 0;
+    uint32_t m_copies = 1;
+    bool m_failed = false;
+};
+
+// Copies recorded into a private command list and executed on the app's queue, bracketed by
+// timestamps resolved into a readback buffer. A frame whose list is still in flight is skipped,
+// so the load never queues more than kLoadFrames lists ahead of the GPU.
+class GpuLoad12 {
+public:
+    void Submit(ID3D12Device* device, ID3D12CommandQueue* queue, float targetMs) {
+        if (!device || !queue || m_failed) return;
+        if (device != m_device.Get() || queue != m_queue.Get()) {
+            Reset();
+            if (!Create(device, queue)) return;
+        }
+        Resolve(targetMs);
+        Frame& frame = m_frames[m_next];
+        if (frame.fenceValue != 0) return;  // GPU more than kLoadFrames behind
+
+        frame.allocator->Reset();
+        m_list->Reset(frame.allocator.Get(), nullptr);
+        m_list->EndQuery(m_queries.Get(), D3D12_QUERY_TYPE_TIMESTAMP, m_next * 2);
+        for (uint32_t i = 0; i < m_copies; ++i) m_list->CopyResource(m_dst.Get(), m_src.Get());
+        m_list->EndQuery(m_queries.Get(), D3D12_QUERY_TYPE_TIMESTAMP, m_next * 2 + 1);
+        m_list->ResolveQueryData(m_queries.Get(), D3D12_QUERY_TYPE_TIMESTAMP, m_next * 2, 2, m_readback.Get(),
+                                 (UINT64)m_next * 2 * sizeof(UINT64));
+        if (FAILED(m_list->Close())) {
+            Note("Stress: D3D12 GPU load command list failed to close; GPU load disabled");
+            m_failed = true;
+            return;
+        }
+        ID3D12CommandList* lists[] = { m_list.Get() };
+        queue->ExecuteCommandLists(1, lists);
+        queue->Signal(m_fence.Get(), ++m_lastFence);
+        frame.fenceValue = m_lastFence;
+        frame.copies = m_copies;
+        m_next = (m_next + 1) % kLoadFrames;
+        g_gpuCopies = m_copies;
+    }
+
+    // Waits for the lists still in flight (session teardown)
+    void Reset() {
+        if (m_fence && m_fence->GetCompletedValue() < m_lastFence) {
+            HANDLE event = CreateEventW(nullptr, FALSE, FALSE, nullptr);
+            if (event && SUCCEEDED(m_fence->SetEventOnCompletion(m_lastFence, event))) {
+                WaitForSingleObject(event, 2000);
+            }
+            if (event) CloseHandle(event);
+        }
+        for (Frame& frame : m_frames) frame = {};
+        m_list.Reset();
+        m_fence.Reset();
+        m_queries.Reset();
+        m_readback.Reset();
+        m_src.Reset();
+        m_dst.Reset();
+        m_queue.Reset();
+        m_device.Reset();
+        m_lastFence = 0;
+        m_next = 0;
+        m_copies = 1;
+        m_failed = false;
+    }
+
+private:
+    struct Frame {
+        ComPtr<ID3D12CommandAllocator> allocator;
+        UINT64 fenceValue = 0;  // 0: free
+        uint32_t copies = 0;
+    };
+
+    bool Create(ID3D12Device* device, ID3D12CommandQueue* queue) {
+        const D3D12_COMMAND_QUEUE_DESC qd = queue->GetDesc();
+        if (qd.Type != D3D12_COMMAND_LIST_TYPE_DIRECT && qd.Type != D3D12_COMMAND_LIST_TYPE_COMPUTE) {
+            Note("Stress: the app's queue type %d has no timestamp support; GPU load disabled", (int)qd.Type);
+            m_failed = true;
+            return false;
+        }
+        HRESULT hr = queue->GetTimestampFrequency(&m_frequency);
+
+        D3D12_HEAP_PROPERTIES heap = { D3D12_HEAP_TYPE_DEFAULT };
+        D3D12_RESOURCE_DESC tex = {};
+        tex.Dimension = D3D12_RESOURCE_DIMENSION_TEXTURE2D;
+        tex.Width = tex.Height = kLoadTextureSize;
+        tex.DepthOrArraySize = tex.MipLevels = 1;
+        tex.Format = DXGI_FORMAT_R8G8B8A8_UNORM;
+        tex.SampleDesc.Count = 1;
+        // Created in their copy states and never transitioned
+        if (SUCCEEDED(hr)) hr = device->CreateCommittedResource(&heap, D3D12_HEAP_FLAG_NONE, &tex,
+                                                                D3D12_RESOURCE_STATE_COPY_SOURCE, nullptr,
+                                                                IID_PPV_ARGS(m_src.GetAddressOf()));
+        if (SUCCEEDED(hr)) hr = device->CreateCommittedResource(&heap, D3D12_HEAP_FLAG_NONE, &tex,
+                                                                D3D12_RESOURCE_STATE_COPY_DEST, nullptr,
+                                                                IID_PPV_ARGS(m_dst.GetAddressOf()));
+
+        D3D12_HEAP_PROPERTIES readbackHeap = { D3D12_HEAP_TYPE_READBACK };
+        D3D12_RESOURCE_DESC buf = {};
+        buf.Dimension = D3D12_RESOURCE_DIMENSION_BUFFER;
+        buf.Width = kLoadFrames * 2 * sizeof(UINT64);
+        buf.Height = buf.DepthOrArraySize = buf.MipLevels = 1;
+        buf.SampleDesc.Count = 1;
+        buf.Layout = D3D12_TEXTURE_LAYOUT_ROW_MAJOR;
+        if (SUCCEEDED(hr)) hr = device->CreateCommittedResource(&readbackHeap, D3D12_HEAP_FLAG_NONE, &buf,
+                                                                D3D12_RESOURCE_STATE_COPY_DEST, nullptr,
+                                                                IID_PPV_ARGS(m_readback.GetAddressOf()));
+        D3D12_QUERY_HEAP_DESC qhd = { D3D12_QUERY_HEAP_TYPE_TIMESTAMP, kLoadFrames * 2, 0 };
+        if (SUCCEEDED(hr)) hr = device->CreateQueryHeap(&qhd, IID_PPV_ARGS(m_queries.GetAddressOf()));
+        for (uint32_t i = 0; SUCCEEDED(hr) && i < kLoadFrames; ++i) {
+            hr = device->CreateCommandAllocator(qd.Type, IID_PPV_ARGS(m_frames[i].allocator.GetAddressOf()));
+        }
+        if (SUCCEEDED(hr)) hr = device->CreateCommandList(0, qd.Type, m_frames[0].allocator.Get(), nullptr,
+                                                          IID_PPV_ARGS(m_list.GetAddressOf()));
+        if (SUCCEEDED(hr)) hr = m_list->Close();
+        if (SUCCEEDED(hr)) hr = device->CreateFence(0, D3D12_FENCE_FLAG_NONE, IID_PPV_ARGS(m_fence.GetAddressOf()));
+        if (FAILED(hr)) {
+            Note("Stress: D3D12 GPU load unavailable (0x%08X)", (unsigned)hr);
+            Reset();
+            m_failed = true;
+            return false;
+        }
+        m_device = device;
+        m_queue = queue;
+        return true;
+    }
+
+    void Resolve(float targetMs) {
+        const UINT64 completed = m_fence->GetCompletedValue();
+        for (uint32_t i = 0; i < kLoadFrames; ++i) {
+            Frame& frame = m_frames[i];
+            if (frame.fenceValue == 0 || frame.fenceValue > completed) continue;
+            const D3D12_RANGE range = { i * 2 * sizeof(UINT64), (i * 2 + 2) * sizeof(UINT64) };
+            void* mapped = nullptr;
+            if (SUCCEEDED(m_readback->Map(0, &range, &mapped))) {
+                const UINT64* stamps = (const UINT64*)((const uint8_t*)mapped + range.Begin);
+                const D3D12_RANGE written = { 0, 0 };
+                const UINT64 begin = stamps[0], end = stamps[1];
+                m_readback->Unmap(0, &written);
+                // Frames recorded before the last adjustment no longer say anything about it
+                if (m_frequency != 0 && end > begin && frame.copies == m_copies) {
+                    m_copies = Calibrate(m_copies, (float)((double)(end - begin) * 1000.0 / (double)m_frequency),
+                                         targetMs);
+                }
+            }
+            frame.fenceValue = 0;
+        }
+    }
+
+    ComPtr<ID3D12Device> m_device;
+    ComPtr<ID3D12CommandQueue> m_queue;
+    ComPtr<ID3D12GraphicsCommandList> m_list;
+    ComPtr<ID3D12Fence> m_fence;
+    ComPtr<ID3D12QueryHeap> m_queries;
+    ComPtr<ID3D12Resource> m_readback;
+    ComPtr<ID3D12Resource> m_src, m_dst;
+    Frame m_frames[kLoadFrames];
+    UINT64 m_lastFence = 0;
+    UINT64 m_frequency = 0;
+    uint32_t m_next = 0;
+    uint32_t m_copies = 1;
+    bool m_failed = false;
+};
+
+inline GpuLoad11 g_gpuLoad11;
+inline GpuLoad12 g_gpuLoad12;
+
+// Session teardown: drop the load resources held on the app's device
+inline void ReleaseGpuLoad() {
+    g_gpuLoad11.Reset();
+    g_gpuLoad12.Reset();
+    g_gpuCopies = 0;
+    g_gpuMeasuredMs = 0.0f;
+}
+
+inline void WriteJson(FILE* f, const char* indent) {
+    fprintf(f, "%s\"stress\": {\"enabled\": %s, \"frames\": %llu, \"missed_frames\": %llu, \"missed_vsyncs\": %llu, "
+            "\"render_skipped\": %llu, \"jitter_ms\": %.2f, \"cpu_load_ms\": %.2f, \"gpu_load_ms\": %.2f, "
+            "\"gpu_measured_ms\": %.3f, \"gpu_copies\": %u}",
+            indent, g_config.enabled ? "true" : "false", (unsigned long long)g_counters.frames,
+            (unsigned long long)g_counters.missedFrames, (unsigned long long)g_counters.missedVsyncs,
+            (unsigned long long)g_counters.renderSkipped, g_config.jitterMs, g_config.cpuLoadMs, g_config.gpuLoadMs,
+            g_gpuMeasuredMs, g_gpuCopies);
+}
+
+} // namespace stress
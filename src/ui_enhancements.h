@@ -46,6 +46,16 @@ enum MenuCommand {
     ID_TOOLS_SCREENSHOT = 1401,
     ID_TOOLS_RESET_VIEW = 1402,
     ID_TOOLS_TOGGLE_STATS = 1403,
+    ID_TOOLS_LOW_LATENCY_PREVIEW = 1404,
+    ID_TOOLS_RECORD = 1405,
+
+    // Refresh rate (frame pacing)
+    ID_RATE_72 = 1451,
+    ID_RATE_90 = 1452,
+    ID_RATE_120 = 1453,
+    ID_RATE_144 = 1454,
+    ID_RATE_UNLOCKED = 1455,
+    ID_RATE_VBLANK = 1456,
 
     // Help
     ID_HELP_CONTROLS = 1501,
@@ -66,6 +76,13 @@ enum class DisplayLayout {
     Anaglyph
 };
 
+// Frame pacing mode for xrWaitFrame
+enum class FramePacing {
+    Fixed,     // refreshRateHz
+    Unlocked,  // no waiting
+    VBlank     // preview monitor's vertical blank
+};
+
 // UI State
 struct UIState {
     ViewMode viewMode = ViewMode::BothEyes;
@@ -81,6 +98,12 @@ struct UIState {
 
     // Render options
     bool showFullRender = false;  // If true, show full swapchain instead of imageRect crop
+    bool lowLatencyPreview = false;  // D3D12: wait for this frame's readback instead of painting the previous one
+    bool recording = false;          // video recording in progress (mirrors recording::Recorder)
+
+    // Simulated display refresh
+    FramePacing framePacing = FramePacing::Fixed;
+    int refreshRateHz = 90;
 };
 
 inline UIState g_uiState;
@@ -160,8 +183,19 @@ inline HMENU CreateAppMenu() {
     HMENU toolsMenu = CreatePopupMenu();
     AppendMenuW(toolsMenu, MF_STRING, ID_TOOLS_SCREENSHOT, L"Take &Screenshot\tF12");
     AppendMenuW(toolsMenu, MF_STRING, ID_TOOLS_RESET_VIEW, L"&Reset View\tHome");
+    AppendMenuW(toolsMenu, MF_STRING, ID_TOOLS_RECORD, L"Record &Video\tF9");
     AppendMenuW(toolsMenu, MF_SEPARATOR, 0, nullptr);
     AppendMenuW(toolsMenu, MF_STRING, ID_TOOLS_TOGGLE_STATS, L"Show &Statistics\tF3");
+    AppendMenuW(toolsMenu, MF_STRING, ID_TOOLS_LOW_LATENCY_PREVIEW, L"&Low-Latency Preview (D3D12)");
+    HMENU rateMenu = CreatePopupMenu();
+    AppendMenuW(rateMenu, MF_STRING, ID_RATE_72, L"72 Hz");
+    AppendMenuW(rateMenu, MF_STRING, ID_RATE_90, L"90 Hz");
+    AppendMenuW(rateMenu, MF_STRING, ID_RATE_120, L"120 Hz");
+    AppendMenuW(rateMenu, MF_STRING, ID_RATE_144, L"144 Hz");
+    AppendMenuW(rateMenu, MF_SEPARATOR, 0, nullptr);
+    AppendMenuW(rateMenu, MF_STRING, ID_RATE_UNLOCKED, L"&Unlocked");
+    AppendMenuW(rateMenu, MF_STRING, ID_RATE_VBLANK, L"Match &Monitor (VBlank)");
+    AppendMenuW(toolsMenu, MF_POPUP, (UINT_PTR)rateMenu, L"Refresh &Rate");
     AppendMenuW(menuBar, MF_POPUP, (UINT_PTR)toolsMenu, L"&Tools");
 
     // Help Menu
@@ -201,6 +235,21 @@ inline void UpdateMenuState(HMENU menu) {
     // Stats toggle
     CheckMenuItem(menu, ID_TOOLS_TOGGLE_STATS,
         g_uiState.showStats ? MF_CHECKED : MF_UNCHECKED);
+    CheckMenuItem(menu, ID_TOOLS_LOW_LATENCY_PREVIEW,
+        g_uiState.lowLatencyPreview ? MF_CHECKED : MF_UNCHECKED);
+    CheckMenuItem(menu, ID_TOOLS_RECORD,
+        g_uiState.recording ? MF_CHECKED : MF_UNCHECKED);
+
+    // Refresh rate checks
+    const bool fixedRate = (g_uiState.framePacing == FramePacing::Fixed);
+    CheckMenuItem(menu, ID_RATE_72, (fixedRate && g_uiState.refreshRateHz == 72) ? MF_CHECKED : MF_UNCHECKED);
+    CheckMenuItem(menu, ID_RATE_90, (fixedRate && g_uiState.refreshRateHz == 90) ? MF_CHECKED : MF_UNCHECKED);
+    CheckMenuItem(menu, ID_RATE_120, (fixedRate && g_uiState.refreshRateHz == 120) ? MF_CHECKED : MF_UNCHECKED);
+    CheckMenuItem(menu, ID_RATE_144, (fixedRate && g_uiState.refreshRateHz == 144) ? MF_CHECKED : MF_UNCHECKED);
+    CheckMenuItem(menu, ID_RATE_UNLOCKED,
+        g_uiState.framePacing == FramePacing::Unlocked ? MF_CHECKED : MF_UNCHECKED);
+    CheckMenuItem(menu, ID_RATE_VBLANK,
+        g_uiState.framePacing == FramePacing::VBlank ? MF_CHECKED : MF_UNCHECKED);
 
     // FOV checks
     CheckMenuItem(menu, ID_FOV_70, g_uiState.fovDegrees == 70 ? MF_CHECKED : MF_UNCHECKED);
@@ -240,6 +289,7 @@ inline void ShowControlsDialog(HWND parent) {
         L"  G - Toggle full render\n\n"
         L"Other:\n"
         L"  F12 - Screenshot\n"
+        L"  F9 - Start/stop video recording\n"
         L"  F3 - Toggle stats\n"
         L"  Home - Reset view";
 
@@ -305,7 +355,8 @@ inline void AdjustZoom(float delta) {
 inline bool HandleMenuCommand(HWND hwnd, WPARAM wParam,
     std::function<void()> resizeCallback = nullptr,
     std::function<void()> screenshotCallback = nullptr,
-    std::function<void()> resetViewCallback = nullptr) {
+    std::function<void()> resetViewCallback = nullptr,
+    std::function<void()> recordCallback = nullptr) {
 
     int cmd = LOWORD(wParam);
     bool needsResize = false;
@@ -411,10 +462,37 @@ inline bool HandleMenuCommand(HWND hwnd, WPARAM wParam,
             if (resetViewCallback) resetViewCallback();
             return true;
 
+        case ID_TOOLS_RECORD:
+            if (recordCallback) recordCallback();
+            break;
+
         case ID_TOOLS_TOGGLE_STATS:
             g_uiState.showStats = !g_uiState.showStats;
             return true;
 
+        case ID_TOOLS_LOW_LATENCY_PREVIEW:
+            g_uiState.lowLatencyPreview = !g_uiState.lowLatencyPreview;
+            break;
+
+        // Refresh rate
+        case ID_RATE_72:
+        case ID_RATE_90:
+        case ID_RATE_120:
+        case ID_RATE_144: {
+            static const int rates[] = { 72, 90, 120, 144 };
+            g_uiState.framePacing = FramePacing::Fixed;
+            g_uiState.refreshRateHz = rates[cmd - ID_RATE_72];
+            break;
+        }
+
+        case ID_RATE_UNLOCKED:
+            g_uiState.framePacing = FramePacing::Unlocked;
+            break;
+
+        case ID_RATE_VBLANK:
+            g_uiState.framePacing = FramePacing::VBlank;
+            break;
+
         // Help
         case ID_HELP_CONTROLS:
             ShowControlsDialog(hwnd);
@@ -443,7 +521,8 @@ inline bool HandleMenuCommand(HWND hwnd, WPARAM wParam,
 inline bool HandleKeyboardShortcut(HWND hwnd, WPARAM vk,
     std::function<void()> resizeCallback = nullptr,
     std::function<void()> screenshotCallback = nullptr,
-    std::function<void()> resetViewCallback = nullptr) {
+    std::function<void()> resetViewCallback = nullptr,
+    std::function<void()> recordCallback = nullptr) {
 
     switch (vk) {
         case 'B':
@@ -485,6 +564,9 @@ inline bool HandleKeyboardShortcut(HWND hwnd, WPARAM vk,
         case VK_F12:
             if (screenshotCallback) screenshotCallback();
             return true;
+        case VK_F9:
+            return HandleMenuCommand(hwnd, ID_TOOLS_RECORD, resizeCallback, screenshotCallback, resetViewCallback,
+                                     recordCallback);
         case VK_HOME:
             if (resetViewCallback) resetViewCallback();
             return true;
@@ -521,8 +603,9 @@ inline void ApplyDarkTheme(HWND hwnd) {
 }
 
 // Update window title with current state info
-inline void UpdateWindowTitle(HWND hwnd, int fps = 0, int frameCount = 0) {
-    wchar_t title[256];
+// stats: optional suffix (per-stage frame timings when Show Statistics is on)
+inline void UpdateWindowTitle(HWND hwnd, int fps = 0, int frameCount = 0, const wchar_t* stats = nullptr) {
+    wchar_t title[512];
 
     const wchar_t* viewModeStr = L"Both Eyes";
     if (g_uiState.viewMode == ViewMode::LeftEyeOnly) viewModeStr = L"Left Eye";
@@ -540,6 +623,10 @@ inline void UpdateWindowTitle(HWND hwnd, int fps = 0, int frameCount = 0) {
     } else {
         swprintf_s(title, L"OpenXR Simulator - %s - %s", viewModeStr, zoomStr);
     }
+    if (stats && stats[0]) {
+        wcscat_s(title, L" - ");
+        wcsncat_s(title, stats, _TRUNCATE);
+    }
 
     SetWindowTextW(hwnd, title);
 }
@@ -0,0 +1,926 @@
+// Video recording for OpenXR Simulator
+// - Records the composed preview, or each eye at full resolution into its own file, as
+//   H.264 or HEVC MP4 through the Media Foundation sink writer with hardware encoders
+// - Frames never go through the CPU. The frame thread copies the source into a shared
+//   texture: a keyed-mutex texture on D3D11 (and GL, through the D3D11 preview device) or a
+//   shared committed resource recorded into the preview command list on D3D12. A recorder
+//   thread with its own D3D11 device converts it to BGRA and hands the texture to the
+//   encoder as a DXGI surface buffer
+// - Sample times are the frames' predicted display times, relative to the first frame
+// - The frame thread never waits for the recorder: when all of a stream's slots are in
+//   flight the frame is dropped and counted
+// - A file keeps the size of its first frame; later frames (a resized preview) are scaled
+//
+// Environment:
+//   OPENXR_SIM_RECORD_SOURCE   preview (default) | eyes; what Tools > Record Video (F9) records
+//   OPENXR_SIM_RECORD_CODEC    h264 (default) | hevc
+//   OPENXR_SIM_RECORD_BITRATE  Mbit/s per stream (default 20)
+#pragma once
+
+#include <windows.h>
+#include <d3d11_1.h>
+#include <d3d12.h>
+#include <dxgi1_2.h>
+#include <mfapi.h>
+#include <mfidl.h>
+#include <mfreadwrite.h>
+#include <mferror.h>
+#include <wrl/client.h>
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <cstdarg>
+#include <cstdio>
+#include <cstdint>
+#include "async_log.h"
+#include "blit_shaders.h"
+
+#pragma comment(lib, "mfplat.lib")
+#pragma comment(lib, "mfreadwrite.lib")
+#pragma comment(lib, "mfuuid.lib")
+
+namespace recording {
+
+using Microsoft::WRL::ComPtr;
+
+enum class Source { Preview, Eyes };
+enum class Codec { H264, Hevc };
+enum Stream : uint32_t { StreamPreview = 0, StreamLeft, StreamRight, StreamCount };
+
+struct Options {
+    Source source = Source::Preview;
+    Codec codec = Codec::H264;
+    uint32_t bitrateMbps = 20;
+};
+
+inline Options g_defaults;  // from the environment at xrCreateInstance
+
+inline const char* SourceName(Source source) { return source == Source::Eyes ? "eyes" : "preview"; }
+inline const char* CodecName(Codec codec) { return codec == Codec::Hevc ? "hevc" : "h264"; }
+inline const char* StreamName(uint32_t stream) {
+    static const char* names[StreamCount] = { "preview", "left", "right" };
+    return stream < StreamCount ? names[stream] : "unknown";
+}
+
+// Typeless group of a colour format the recorder can convert, or UNKNOWN
+inline DXGI_FORMAT TypelessFormat(DXGI_FORMAT format) {
+    switch (format) {
+        case DXGI_FORMAT_R8G8B8A8_TYPELESS: case DXGI_FORMAT_R8G8B8A8_UNORM: case DXGI_FORMAT_R8G8B8A8_UNORM_SRGB:
+            return DXGI_FORMAT_R8G8B8A8_TYPELESS;
+        case DXGI_FORMAT_B8G8R8A8_TYPELESS: case DXGI_FORMAT_B8G8R8A8_UNORM: case DXGI_FORMAT_B8G8R8A8_UNORM_SRGB:
+            return DXGI_FORMAT_B8G8R8A8_TYPELESS;
+        case DXGI_FORMAT_B8G8R8X8_TYPELESS: case DXGI_FORMAT_B8G8R8X8_UNORM: case DXGI_FORMAT_B8G8R8X8_UNORM_SRGB:
+            return DXGI_FORMAT_B8G8R8X8_TYPELESS;
+        case DXGI_FORMAT_R10G10B10A2_TYPELESS: case DXGI_FORMAT_R10G10B10A2_UNORM:
+            return DXGI_FORMAT_R10G10B10A2_TYPELESS;
+        case DXGI_FORMAT_R16G16B16A16_TYPELESS: case DXGI_FORMAT_R16G16B16A16_FLOAT: case DXGI_FORMAT_R16G16B16A16_UNORM:
+            return DXGI_FORMAT_R16G16B16A16_TYPELESS;
+        case DXGI_FORMAT_R11G11B10_FLOAT:
+            return DXGI_FORMAT_R11G11B10_FLOAT;
+        default:
+            return DXGI_FORMAT_UNKNOWN;
+    }
+}
+
+// View the recorder samples a source through. sRGB images are read as UNORM, so the encoded
+// values are the bytes the app wrote, as in the preview.
+inline DXGI_FORMAT SampleFormat(DXGI_FORMAT format) {
+    switch (TypelessFormat(format)) {
+        case DXGI_FORMAT_R8G8B8A8_TYPELESS:    return DXGI_FORMAT_R8G8B8A8_UNORM;
+        case DXGI_FORMAT_B8G8R8A8_TYPELESS:    return DXGI_FORMAT_B8G8R8A8_UNORM;
+        case DXGI_FORMAT_B8G8R8X8_TYPELESS:    return DXGI_FORMAT_B8G8R8X8_UNORM;
+        case DXGI_FORMAT_R10G10B10A2_TYPELESS: return DXGI_FORMAT_R10G10B10A2_UNORM;
+        case DXGI_FORMAT_R16G16B16A16_TYPELESS:
+            return format == DXGI_FORMAT_R16G16B16A16_UNORM ? format : DXGI_FORMAT_R16G16B16A16_FLOAT;
+        case DXGI_FORMAT_R11G11B10_FLOAT:      return DXGI_FORMAT_R11G11B10_FLOAT;
+        default:                               return DXGI_FORMAT_UNKNOWN;
+    }
+}
+
+// Float images hold linear light and are sRGB-encoded on the way into the video
+inline bool IsLinearFormat(DXGI_FORMAT sampleFormat) {
+    return sampleFormat == DXGI_FORMAT_R16G16B16A16_FLOAT || sampleFormat == DXGI_FORMAT_R11G11B10_FLOAT;
+}
+
+class Recorder {
+public:
+    static constexpr uint32_t kSlots = 3;           // per stream: being written, queued, being converted
+    static constexpr DWORD kEncodeSamples = 4;      // encoder input textures per stream
+    static constexpr UINT kMaxQueued = kSlots * StreamCount;
+
+    static Recorder& Get() {
+        static Recorder instance;
+        return instance;
+    }
+
+    // Start recording into <basePath>_<stream>.mp4. A recording in progress is finished first.
+    bool Start(const Options& options, const std::string& basePath) {
+        Stop();
+        Join();
+        ResetSlots(false);
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            m_options = options;
+            if (m_options.bitrateMbps == 0) m_options.bitrateMbps = 20;
+            for (uint32_t i = 0; i < StreamCount; ++i) {
+                m_paths[i] = basePath + "_" + StreamName(i) + ".mp4";
+                m_frames[i].store(0, std::memory_order_relaxed);
+                m_dropped[i].store(0, std::memory_order_relaxed);
+                m_pending12[i] = -1;
+            }
+            m_queue.clear();
+            m_stop = false;
+            m_thread = std::thread([this] { ThreadMain(); });
+        }
+        m_active.store(true, std::memory_order_release);
+        Notef("[SimXR] Recording started: source=%s codec=%s %u Mbit/s -> %s_*.mp4", SourceName(options.source),
+              CodecName(options.codec), m_options.bitrateMbps, basePath.c_str());
+        return true;
+    }
+
+    // Stop accepting frames; the recorder thread encodes what is queued and finalizes the files
+    void Stop() {
+        m_active.store(false, std::memory_order_release);
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            if (!m_thread.joinable() || m_stop) return;
+            m_stop = true;
+        }
+        m_cv.notify_one();
+    }
+
+    // Stop, wait for the files to be finalized and drop the shared textures. Must run before
+    // the producing devices go away (xrDestroySession) and before the DLL may unload.
+    void Shutdown() {
+        Stop();
+        Join();
+        ResetSlots(true);
+    }
+
+    bool Recording() const { return m_active.load(std::memory_order_acquire); }
+
+    // Whether frames for this stream are wanted; cheap enough to call every frame
+    bool Wants(uint32_t stream) const {
+        if (!Recording()) return false;
+        const bool eyes = (m_options.source == Source::Eyes);
+        return eyes ? (stream == StreamLeft || stream == StreamRight) : (stream == StreamPreview);
+    }
+
+    // D3D11 producer (app thread, compositor thread, GL preview device): copy one subresource
+    // (optionally a box of it) into the stream's next free slot. flipY for bottom-up GL images.
+    bool Submit11(uint32_t stream, ID3D11Device* device, ID3D11DeviceContext* ctx, ID3D11Texture2D* source,
+                  UINT subresource, const D3D11_BOX* box, bool flipY, int64_t timeNs, int64_t periodNs) {
+        if (!Wants(stream) || !device || !ctx || !source) return false;
+        D3D11_TEXTURE2D_DESC desc;
+        source->GetDesc(&desc);
+        if (!Supported(stream, desc.Format, desc.SampleDesc.Count)) return false;
+        const UINT width = box ? box->right - box->left : desc.Width;
+        const UINT height = box ? box->bottom - box->top : desc.Height;
+        if (width == 0 || height == 0) return false;
+
+        const int slotIndex = Claim(stream);
+        if (slotIndex < 0) {
+            m_dropped[stream].fetch_add(1, std::memory_order_relaxed);
+            return false;
+        }
+        Slot& slot = m_slots[stream][slotIndex];
+        if (!slot.tex11 || slot.producer != device || slot.width != width || slot.height != height ||
+            slot.format != desc.Format) {
+            ReleaseProducerSide(slot);
+            D3D11_TEXTURE2D_DESC sharedDesc = {};
+            sharedDesc.Width = width;
+            sharedDesc.Height = height;
+            sharedDesc.MipLevels = 1;
+            sharedDesc.ArraySize = 1;
+            sharedDesc.Format = TypelessFormat(desc.Format);
+            sharedDesc.SampleDesc.Count = 1;
+            sharedDesc.Usage = D3D11_USAGE_DEFAULT;
+            sharedDesc.BindFlags = D3D11_BIND_SHADER_RESOURCE;
+            sharedDesc.MiscFlags = D3D11_RESOURCE_MISC_SHARED_KEYEDMUTEX;
+            ComPtr<IDXGIResource> dxgiRes;
+            ComPtr<IDXGIDevice> dxgiDev;
+            ComPtr<IDXGIAdapter> adapter;
+            DXGI_ADAPTER_DESC adapterDesc = {};
+            HRESULT hr = device->CreateTexture2D(&sharedDesc, nullptr, slot.tex11.GetAddressOf());
+            if (SUCCEEDED(hr)) hr = slot.tex11.As(&slot.mutex11);
+            if (SUCCEEDED(hr)) hr = slot.tex11.As(&dxgiRes);
+            if (SUCCEEDED(hr)) hr = dxgiRes->GetSharedHandle(&slot.shared);
+            if (SUCCEEDED(hr)) hr = device->QueryInterface(IID_PPV_ARGS(dxgiDev.GetAddressOf()));
+            if (SUCCEEDED(hr)) hr = dxgiDev->GetAdapter(adapter.GetAddressOf());
+            if (SUCCEEDED(hr)) hr = adapter->GetDesc(&adapterDesc);
+            if (FAILED(hr)) {
+                Notef("[SimXR] Recording: %s shared texture %ux%u fmt=%d failed 0x%08X", StreamName(stream),
+                      width, height, (int)desc.Format, (unsigned)hr);
+                ReleaseProducerSide(slot);
+                Release(stream, slotIndex);
+                return false;
+            }
+            slot.producer = device;
+            slot.adapter = adapterDesc.AdapterLuid;
+            slot.width = width;
+            slot.height = height;
+            slot.format = desc.Format;
+            slot.generation++;
+        }
+
+        // The recorder released key 0 before freeing the slot, so this never waits
+        if (slot.mutex11->AcquireSync(0, 0) != S_OK) {
+            Release(stream, slotIndex);
+            m_dropped[stream].fetch_add(1, std::memory_order_relaxed);
+            return false;
+        }
+        ctx->CopySubresourceRegion(slot.tex11.Get(), 0, 0, 0, 0, source, subresource, box);
+        slot.mutex11->ReleaseSync(1);
+        Post(stream, slotIndex, nullptr, 0, timeNs, periodNs, flipY);
+        return true;
+    }
+
+    // D3D12 producer: record a copy of one subresource (in COPY_SOURCE state) into the stream's
+    // next free slot on the open preview command list. Commit12 posts it once the list is
+    // submitted; the recorder thread waits for the fence before reading.
+    bool Record12(uint32_t stream, ID3D12Device* device, ID3D12GraphicsCommandList* list, ID3D12Resource* source,
+                  UINT subresource, const D3D12_BOX* box, int64_t timeNs, int64_t periodNs) {
+        if (!Wants(stream) || !device || !list || !source) return false;
+        const D3D12_RESOURCE_DESC desc = source->GetDesc();
+        if (!Supported(stream, desc.Format, desc.SampleDesc.Count)) return false;
+        const UINT width = box ? box->right - box->left : (UINT)desc.Width;
+        const UINT height = box ? box->bottom - box->top : desc.Height;
+        if (width == 0 || height == 0) return false;
+
+        // A slot recorded into a list that was never committed is reused
+        int slotIndex = m_pending12[stream];
+        if (slotIndex < 0) slotIndex = Claim(stream);
+        if (slotIndex < 0) {
+            m_dropped[stream].fetch_add(1, std::memory_order_relaxed);
+            return false;
+        }
+        Slot& slot = m_slots[stream][slotIndex];
+        if (!slot.tex12 || slot.producer != device || slot.width != width || slot.height != height ||
+            slot.format != desc.Format) {
+            ReleaseProducerSide(slot);
+            D3D12_HEAP_PROPERTIES heap = {};
+            heap.Type = D3D12_HEAP_TYPE_DEFAULT;
+            D3D12_RESOURCE_DESC sharedDesc = {};
+            sharedDesc.Dimension = D3D12_RESOURCE_DIMENSION_TEXTURE2D;
+            sharedDesc.Width = width;
+            sharedDesc.Height = height;
+            sharedDesc.DepthOrArraySize = 1;
+            sharedDesc.MipLevels = 1;
+            sharedDesc.Format = TypelessFormat(desc.Format);
+            sharedDesc.SampleDesc.Count = 1;
+            sharedDesc.Layout = D3D12_TEXTURE_LAYOUT_UNKNOWN;
+            HRESULT hr = device->CreateCommittedResource(&heap, D3D12_HEAP_FLAG_SHARED, &sharedDesc,
+                                                         D3D12_RESOURCE_STATE_COMMON, nullptr,
+                                                         IID_PPV_ARGS(slot.tex12.GetAddressOf()));
+            if (SUCCEEDED(hr)) hr = device->CreateSharedHandle(slot.tex12.Get(), nullptr, GENERIC_ALL, nullptr, &slot.shared);
+            if (FAILED(hr)) {
+                Notef("[SimXR] Recording: %s shared resource %ux%u fmt=%d failed 0x%08X", StreamName(stream),
+                      width, height, (int)desc.Format, (unsigned)hr);
+                ReleaseProducerSide(slot);
+                Release(stream, slotIndex);
+                m_pending12[stream] = -1;
+                return false;
+            }
+            slot.ntHandle = true;
+            slot.producer = device;
+            slot.adapter = device->GetAdapterLuid();
+            slot.width = width;
+            slot.height = height;
+            slot.format = desc.Format;
+            slot.generation++;
+        }
+
+        // COMMON on both sides of the copy: D3D11 reads it through its own device
+        D3D12_RESOURCE_BARRIER barrier = {};
+        barrier.Type = D3D12_RESOURCE_BARRIER_TYPE_TRANSITION;
+        barrier.Transition.pResource = slot.tex12.Get();
+        barrier.Transition.StateBefore = D3D12_RESOURCE_STATE_COMMON;
+        barrier.Transition.StateAfter = D3D12_RESOURCE_STATE_COPY_DEST;
+        barrier.Transition.Subresource = D3D12_RESOURCE_BARRIER_ALL_SUBRESOURCES;
+        list->ResourceBarrier(1, &barrier);
+        D3D12_TEXTURE_COPY_LOCATION dst = {};
+        dst.pResource = slot.tex12.Get();
+        dst.Type = D3D12_TEXTURE_COPY_TYPE_SUBRESOURCE_INDEX;
+        dst.SubresourceIndex = 0;
+        D3D12_TEXTURE_COPY_LOCATION src = {};
+        src.pResource = source;
+        src.Type = D3D12_TEXTURE_COPY_TYPE_SUBRESOURCE_INDEX;
+        src.SubresourceIndex = subresource;
+        list->CopyTextureRegion(&dst, 0, 0, 0, &src, box);
+        barrier.Transition.StateBefore = D3D12_RESOURCE_STATE_COPY_DEST;
+        barrier.Transition.StateAfter = D3D12_RESOURCE_STATE_COMMON;
+        list->ResourceBarrier(1, &barrier);
+
+        m_pending12[stream] = slotIndex;
+        m_pendingTime12[stream] = timeNs;
+        m_pendingPeriod12[stream] = periodNs;
+        return true;
+    }
+
+    // After ExecuteCommandLists + Signal of the list Record12 recorded into
+    void Commit12(ID3D12Fence* fence, UINT64 value) {
+        for (uint32_t stream = 0; stream < StreamCount; ++stream) {
+            const int slotIndex = m_pending12[stream];
+            if (slotIndex < 0) continue;
+            m_pending12[stream] = -1;
+            Post(stream, slotIndex, fence, value, m_pendingTime12[stream], m_pendingPeriod12[stream], false);
+        }
+    }
+
+    // "recording" object for the MCP status file
+    void WriteJson(FILE* f, const char* indent) {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        const bool active = Recording();
+        fprintf(f, "%s\"recording\": {\"active\": %s, \"source\": \"%s\", \"codec\": \"%s\", \"streams\": [",
+                indent, active ? "true" : "false", SourceName(m_options.source), CodecName(m_options.codec));
+        bool first = true;
+        for (uint32_t i = 0; i < StreamCount; ++i) {
+            const uint64_t frames = m_frames[i].load(std::memory_order_relaxed);
+            const uint64_t dropped = m_dropped[i].load(std::memory_order_relaxed);
+            if (frames == 0 && dropped == 0) continue;
+            fprintf(f, "%s{\"name\": \"%s\", \"path\": \"", first ? "" : ", ", StreamName(i));
+            for (const char* p = m_paths[i].c_str(); *p; ++p) {
+                if (*p == '\\' || *p == '"') fputc('\\', f);
+                fputc(*p, f);
+            }
+            fprintf(f, "\", \"frames\": %llu, \"dropped\": %llu}", (unsigned long long)frames, (unsigned long long)dropped);
+            first = false;
+        }
+        fprintf(f, "]}");
+    }
+
+private:
+    enum class SlotState { Free, Claimed, Queued };
+
+    struct Slot {
+        // Producer side; only touched while the slot is Free or Claimed
+        ComPtr<ID3D11Texture2D> tex11;      // D3D11 producers: keyed-mutex texture on their device
+        ComPtr<IDXGIKeyedMutex> mutex11;
+        ComPtr<ID3D12Resource> tex12;       // D3D12 producers: shared committed resource
+        const void* producer{nullptr};      // device the texture was created on
+        HANDLE shared{nullptr};             // legacy handle (D3D11) or NT handle (D3D12, ours to close)
+        bool ntHandle{false};
+        LUID adapter{};
+        UINT width{0}, height{0};
+        DXGI_FORMAT format{DXGI_FORMAT_UNKNOWN};  // the source's format
+        uint32_t generation{0};             // bumped whenever the shared texture is recreated
+        SlotState state{SlotState::Free};
+        // Recorder thread side
+        ComPtr<ID3D11Texture2D> opened;
+        ComPtr<IDXGIKeyedMutex> openedMutex;
+        ComPtr<ID3D11ShaderResourceView> srv;
+        uint32_t openedGeneration{0};
+    };
+
+    struct Frame {
+        uint32_t stream{0};
+        uint32_t slot{0};
+        ComPtr<ID3D12Fence> fence;          // D3D12: the copy is done once this reaches fenceValue
+        UINT64 fenceValue{0};
+        int64_t timeNs{0};
+        int64_t periodNs{0};
+        bool flipY{false};
+    };
+
+    // Recorder thread only
+    struct Encoder {
+        ComPtr<IMFSinkWriter> writer;
+        DWORD streamIndex{0};
+        ComPtr<IMFVideoSampleAllocatorEx> allocator;
+        ComPtr<ID3D11Texture2D> convert;    // BGRA typeless; the blit target, copied into the sample
+        ComPtr<ID3D11RenderTargetView> convertRtv[2];  // [0] UNORM, [1] UNORM_SRGB
+        UINT width{0}, height{0};
+        int64_t firstNs{0}, lastNs{0}, periodNs{0};
+        bool started{false};
+        bool failed{false};
+    };
+
+    Recorder() = default;
+    // Joining from static destruction (loader lock) could deadlock; Shutdown() is the exit path
+    ~Recorder() { if (m_thread.joinable()) m_thread.detach(); }
+
+    static void Notef(const char* fmt, ...) {
+        if (!logging::Enabled(logging::CatGeneral, logging::Level::Info)) return;
+        char buf[MAX_PATH + 160];
+        va_list ap;
+        va_start(ap, fmt);
+        vsnprintf(buf, sizeof(buf), fmt, ap);
+        va_end(ap);
+        logging::Write(logging::CatGeneral, logging::Level::Info, buf);
+    }
+
+    bool Supported(uint32_t stream, DXGI_FORMAT format, UINT sampleCount) {
+        if (sampleCount <= 1 && TypelessFormat(format) != DXGI_FORMAT_UNKNOWN) return true;
+        if (!m_unsupportedLogged[stream]) {
+            Notef("[SimXR] Recording: %s source fmt=%d samples=%u is not recordable", StreamName(stream),
+                  (int)format, sampleCount);
+            m_unsupportedLogged[stream] = true;
+        }
+        return false;
+    }
+
+    void Join() {
+        if (m_thread.joinable()) m_thread.join();
+    }
+
+    int Claim(uint32_t stream) {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        for (uint32_t k = 0; k < kSlots; ++k) {
+            const uint32_t i = (m_nextSlot[stream] + k) % kSlots;
+            if (m_slots[stream][i].state != SlotState::Free) continue;
+            m_slots[stream][i].state = SlotState::Claimed;
+            m_nextSlot[stream] = (i + 1) % kSlots;
+            return (int)i;
+        }
+        return -1;
+    }
+
+    void Release(uint32_t stream, int slotIndex) {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_slots[stream][slotIndex].state = SlotState::Free;
+    }
+
+    void Post(uint32_t stream, int slotIndex, ID3D12Fence* fence, UINT64 fenceValue, int64_t timeNs,
+              int64_t periodNs, bool flipY) {
+        Frame f;
+        f.stream = stream;
+        f.slot = (uint32_t)slotIndex;
+        f.fence = fence;
+        f.fenceValue = fenceValue;
+        f.timeNs = timeNs;
+        f.periodNs = periodNs;
+        f.flipY = flipY;
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            // After Stop the thread may already have finalized; the frame is not encoded
+            if (m_stop || !m_thread.joinable() || m_queue.size() >= kMaxQueued) {
+                m_slots[stream][slotIndex].state = SlotState::Free;
+                m_dropped[stream].fetch_add(1, std::memory_order_relaxed);
+                return;
+            }
+            m_slots[stream][slotIndex].state = SlotState::Queued;
+            m_queue.push_back(std::move(f));
+        }
+        m_cv.notify_one();
+    }
+
+    static void ReleaseProducerSide(Slot& slot) {
+        if (slot.ntHandle && slot.shared) CloseHandle(slot.shared);
+        slot.tex11.Reset();
+        slot.mutex11.Reset();
+        slot.tex12.Reset();
+        slot.producer = nullptr;
+        slot.shared = nullptr;
+        slot.ntHandle = false;
+        slot.width = slot.height = 0;
+        slot.format = DXGI_FORMAT_UNKNOWN;
+    }
+
+    // With the thread joined. release drops the textures too (the producing device is going away).
+    void ResetSlots(bool release) {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        for (auto& streamSlots : m_slots) {
+            for (auto& slot : streamSlots) {
+                slot.state = SlotState::Free;
+                slot.opened.Reset();
+                slot.openedMutex.Reset();
+                slot.srv.Reset();
+                slot.openedGeneration = 0;
+                if (release) ReleaseProducerSide(slot);
+            }
+        }
+        for (auto& pending : m_pending12) pending = -1;
+        m_queue.clear();
+    }
+
+    void ThreadMain() {
+        const bool comReady = SUCCEEDED(CoInitializeEx(nullptr, COINIT_MULTITHREADED));
+        const bool mfReady = SUCCEEDED(MFStartup(MF_VERSION, MFSTARTUP_LITE));
+        if (!mfReady) Notef("[SimXR] Recording: MFStartup failed; nothing is recorded");
+        m_fenceEvent = CreateEventA(nullptr, FALSE, FALSE, nullptr);
+        for (;;) {
+            Frame f;
+            {
+                std::unique_lock<std::mutex> lock(m_mutex);
+                m_cv.wait(lock, [this] { return m_stop || !m_queue.empty(); });
+                if (m_queue.empty()) break;  // stop requested and drained
+                f = std::move(m_queue.front());
+                m_queue.pop_front();
+            }
+            const bool encoded = mfReady && Encode(f);
+            if (!encoded) m_dropped[f.stream].fetch_add(1, std::memory_order_relaxed);
+            std::lock_guard<std::mutex> lock(m_mutex);
+            m_slots[f.stream][f.slot].state = SlotState::Free;
+        }
+
+        for (uint32_t i = 0; i < StreamCount; ++i) Finalize(i);
+        if (m_ctx) {
+            m_ctx->ClearState();
+            m_ctx->Flush();
+        }
+        for (auto& streamSlots : m_slots) {
+            for (auto& slot : streamSlots) {
+                slot.opened.Reset();
+                slot.openedMutex.Reset();
+                slot.srv.Reset();
+                slot.openedGeneration = 0;
+            }
+        }
+        m_query.Reset();
+        m_vs.Reset();
+        m_vsFlipY.Reset();
+        m_ps.Reset();
+        m_sampler.Reset();
+        m_rasterizer.Reset();
+        m_dxgiManager.Reset();
+        m_ctx.Reset();
+        m_device.Reset();
+        m_deviceFailed = false;
+        m_adapterMismatchLogged = false;
+        if (m_fenceEvent) CloseHandle(m_fenceEvent);
+        m_fenceEvent = nullptr;
+        if (mfReady) MFShutdown();
+        if (comReady) CoUninitialize();
+    }
+
+    // Recorder device on the producer's adapter, shared with Media Foundation
+    bool EnsureDevice(const LUID& luid) {
+        if (m_device) {
+            if (luid.LowPart == m_luid.LowPart && luid.HighPart == m_luid.HighPart) return true;
+            if (!m_adapterMismatchLogged) {
+                Notef("[SimXR] Recording: frame from another adapter dropped");
+                m_adapterMismatchLogged = true;
+            }
+            return false;
+        }
+        if (m_deviceFailed) return false;
+        m_deviceFailed = true;  // until everything below succeeded
+
+        ComPtr<IDXGIFactory1> factory;
+        ComPtr<IDXGIAdapter1> adapter;
+        HRESULT hr = CreateDXGIFactory1(IID_PPV_ARGS(factory.GetAddressOf()));
+        for (UINT i = 0; SUCCEEDED(hr); ++i) {
+            ComPtr<IDXGIAdapter1> candidate;
+            if (factory->EnumAdapters1(i, candidate.GetAddressOf()) == DXGI_ERROR_NOT_FOUND) break;
+            DXGI_ADAPTER_DESC1 desc;
+            candidate->GetDesc1(&desc);
+            if (desc.AdapterLuid.LowPart == luid.LowPart && desc.AdapterLuid.HighPart == luid.HighPart) {
+                adapter = candidate;
+                break;
+            }
+        }
+        if (!adapter) {
+            Notef("[SimXR] Recording: producer adapter not found (0x%08X)", (unsigned)hr);
+            return false;
+        }
+        const UINT flags = D3D11_CREATE_DEVICE_BGRA_SUPPORT | D3D11_CREATE_DEVICE_VIDEO_SUPPORT;
+        hr = D3D11CreateDevice(adapter.Get(), D3D_DRIVER_TYPE_UNKNOWN, nullptr, flags, nullptr, 0, D3D11_SDK_VERSION,
+                               m_device.GetAddressOf(), nullptr, m_ctx.GetAddressOf());
+        if (FAILED(hr)) {
+            Notef("[SimXR] Recording: D3D11CreateDevice failed 0x%08X", (unsigned)hr);
+            return false;
+        }
+        // The encoder MFTs use the device from their own threads
+        ComPtr<ID3D10Multithread> multithread;
+        if (SUCCEEDED(m_device.As(&multithread))) multithread->SetMultithreadProtected(TRUE);
+
+        UINT resetToken = 0;
+        hr = MFCreateDXGIDeviceManager(&resetToken, m_dxgiManager.GetAddressOf());
+        if (SUCCEEDED(hr)) hr = m_dxgiManager->ResetDevice(m_device.Get(), resetToken);
+        if (SUCCEEDED(hr)) hr = m_device->CreateVertexShader(g_blitVS, sizeof(g_blitVS), nullptr, m_vs.GetAddressOf());
+        if (SUCCEEDED(hr)) hr = m_device->CreateVertexShader(g_blitVSFlipY, sizeof(g_blitVSFlipY), nullptr, m_vsFlipY.GetAddressOf());
+        if (SUCCEEDED(hr)) hr = m_device->CreatePixelShader(g_blitPS, sizeof(g_blitPS), nullptr, m_ps.GetAddressOf());
+        D3D11_SAMPLER_DESC samplerDesc = {};
+        samplerDesc.Filter = D3D11_FILTER_MIN_MAG_MIP_LINEAR;
+        samplerDesc.AddressU = samplerDesc.AddressV = samplerDesc.AddressW = D3D11_TEXTURE_ADDRESS_CLAMP;
+        samplerDesc.MaxLOD = D3D11_FLOAT32_MAX;
+        if (SUCCEEDED(hr)) hr = m_device->CreateSamplerState(&samplerDesc, m_sampler.GetAddressOf());
+        D3D11_RASTERIZER_DESC rasterDesc = {};
+        rasterDesc.FillMode = D3D11_FILL_SOLID;
+        rasterDesc.CullMode = D3D11_CULL_NONE;
+        rasterDesc.DepthClipEnable = TRUE;
+        if (SUCCEEDED(hr)) hr = m_device->CreateRasterizerState(&rasterDesc, m_rasterizer.GetAddressOf());
+        D3D11_QUERY_DESC queryDesc = { D3D11_QUERY_EVENT, 0 };
+        if (SUCCEEDED(hr)) hr = m_device->CreateQuery(&queryDesc, m_query.GetAddressOf());
+        if (FAILED(hr)) {
+            Notef("[SimXR] Recording: device setup failed 0x%08X", (unsigned)hr);
+            m_dxgiManager.Reset();
+            m_ctx.Reset();
+            m_device.Reset();
+            return false;
+        }
+        m_luid = luid;
+        m_deviceFailed = false;
+        return true;
+    }
+
+    // Sink writer for a stream, sized by its first frame (even dimensions for 4:2:0)
+    bool EnsureEncoder(uint32_t stream, Encoder& enc, UINT width, UINT height, int64_t periodNs) {
+        if (enc.writer) return true;
+        if (enc.failed) return false;
+        enc.failed = true;  // until everything below succeeded
+        enc.width = (std::max)(width & ~1u, 2u);
+        enc.height = (std::max)(height & ~1u, 2u);
+        enc.periodNs = periodNs > 0 ? periodNs : 11111111;
+        const UINT32 fps = (UINT32)((1000000000LL + enc.periodNs / 2) / enc.periodNs);
+
+        std::string path;
+        uint32_t bitrateMbps;
+        Codec codec;
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            path = m_paths[stream];
+            bitrateMbps = m_options.bitrateMbps;
+            codec = m_options.codec;
+        }
+        wchar_t widePath[MAX_PATH];
+        if (MultiByteToWideChar(CP_ACP, 0, path.c_str(), -1, widePath, MAX_PATH) == 0) return false;
+
+        ComPtr<IMFAttributes> attrs;
+        ComPtr<IMFMediaType> outType, inType;
+        HRESULT hr = MFCreateAttributes(attrs.GetAddressOf(), 3);
+        if (SUCCEEDED(hr)) hr = attrs->SetUINT32(MF_READWRITE_ENABLE_HARDWARE_TRANSFORMS, TRUE);
+        if (SUCCEEDED(hr)) hr = attrs->SetUnknown(MF_SINK_WRITER_D3D_MANAGER, m_dxgiManager.Get());
+        if (SUCCEEDED(hr)) hr = attrs->SetGUID(MF_TRANSCODE_CONTAINERTYPE, MFTranscodeContainerType_MPEG4);
+        if (SUCCEEDED(hr)) hr = MFCreateSinkWriterFromURL(widePath, nullptr, attrs.Get(), enc.writer.GetAddressOf());
+
+        if (SUCCEEDED(hr)) hr = MFCreateMediaType(outType.GetAddressOf());
+        if (SUCCEEDED(hr)) hr = outType->SetGUID(MF_MT_MAJOR_TYPE, MFMediaType_Video);
+        if (SUCCEEDED(hr)) hr = outType->SetGUID(MF_MT_SUBTYPE, codec == Codec::Hevc ? MFVideoFormat_HEVC : MFVideoFormat_H264);
+        if (SUCCEEDED(hr)) hr = outType->SetUINT32(MF_MT_AVG_BITRATE, bitrateMbps * 1000000u);
+        if (SUCCEEDED(hr)) hr = outType->SetUINT32(MF_MT_INTERLACE_MODE, MFVideoInterlace_Progressive);
+        if (SUCCEEDED(hr)) hr = MFSetAttributeSize(outType.Get(), MF_MT_FRAME_SIZE, enc.width, enc.height);
+        if (SUCCEEDED(hr)) hr = MFSetAttributeRatio(outType.Get(), MF_MT_FRAME_RATE, fps, 1);
+        if (SUCCEEDED(hr)) hr = MFSetAttributeRatio(outType.Get(), MF_MT_PIXEL_ASPECT_RATIO, 1, 1);
+        if (SUCCEEDED(hr)) hr = enc.writer->AddStream(outType.Get(), &enc.streamIndex);
+
+        // BGRA in; the sink writer inserts the GPU colour converter in front of the encoder
+        if (SUCCEEDED(hr)) hr = MFCreateMediaType(inType.GetAddressOf());
+        if (SUCCEEDED(hr)) hr = inType->SetGUID(MF_MT_MAJOR_TYPE, MFMediaType_Video);
+        if (SUCCEEDED(hr)) hr = inType->SetGUID(MF_MT_SUBTYPE, MFVideoFormat_ARGB32);
+        if (SUCCEEDED(hr)) hr = inType->SetUINT32(MF_MT_INTERLACE_MODE, MFVideoInterlace_Progressive);
+        if (SUCCEEDED(hr)) hr = MFSetAttributeSize(inType.Get(), MF_MT_FRAME_SIZE, enc.width, enc.height);
+        if (SUCCEEDED(hr)) hr = MFSetAttributeRatio(inType.Get(), MF_MT_FRAME_RATE, fps, 1);
+        if (SUCCEEDED(hr)) hr = MFSetAttributeRatio(inType.Get(), MF_MT_PIXEL_ASPECT_RATIO, 1, 1);
+        if (SUCCEEDED(hr)) hr = enc.writer->SetInputMediaType(enc.streamIndex, inType.Get(), nullptr);
+        if (SUCCEEDED(hr)) hr = enc.writer->BeginWriting();
+
+        // Encoder input textures come from a pool; a sample returns to it when the encoder is done
+        ComPtr<IMFAttributes> allocAttrs;
+        if (SUCCEEDED(hr)) hr = MFCreateVideoSampleAllocatorEx(IID_PPV_ARGS(enc.allocator.GetAddressOf()));
+        if (SUCCEEDED(hr)) hr = enc.allocator->SetDirectXManager(m_dxgiManager.Get());
+        if (SUCCEEDED(hr)) hr = MFCreateAttributes(allocAttrs.GetAddressOf(), 2);
+        if (SUCCEEDED(hr)) hr = allocAttrs->SetUINT32(MF_SA_D3D11_BINDFLAGS, D3D11_BIND_RENDER_TARGET | D3D11_BIND_SHADER_RESOURCE);
+        if (SUCCEEDED(hr)) hr = allocAttrs->SetUINT32(MF_SA_D3D11_USAGE, D3D11_USAGE_DEFAULT);
+        if (SUCCEEDED(hr)) hr = enc.allocator->InitializeSampleAllocatorEx(kEncodeSamples / 2, kEncodeSamples,
+                                                                            allocAttrs.Get(), inType.Get());
+
+        D3D11_TEXTURE2D_DESC convertDesc = {};
+        convertDesc.Width = enc.width;
+        convertDesc.Height = enc.height;
+        convertDesc.MipLevels = 1;
+        convertDesc.ArraySize = 1;
+        convertDesc.Format = DXGI_FORMAT_B8G8R8A8_TYPELESS;
+        convertDesc.SampleDesc.Count = 1;
+        convertDesc.Usage = D3D11_USAGE_DEFAULT;
+        convertDesc.BindFlags = D3D11_BIND_RENDER_TARGET;
+        if (SUCCEEDED(hr)) hr = m_device->CreateTexture2D(&convertDesc, nullptr, enc.convert.GetAddressOf());
+        D3D11_RENDER_TARGET_VIEW_DESC rtvDesc = {};
+        rtvDesc.ViewDimension = D3D11_RTV_DIMENSION_TEXTURE2D;
+        rtvDesc.Format = DXGI_FORMAT_B8G8R8A8_UNORM;
+        if (SUCCEEDED(hr)) hr = m_device->CreateRenderTargetView(enc.convert.Get(), &rtvDesc, enc.convertRtv[0].GetAddressOf());
+        rtvDesc.Format = DXGI_FORMAT_B8G8R8A8_UNORM_SRGB;
+        if (SUCCEEDED(hr)) hr = m_device->CreateRenderTargetView(enc.convert.Get(), &rtvDesc, enc.convertRtv[1].GetAddressOf());
+
+        if (FAILED(hr)) {
+            Notef("[SimXR] Recording: %s %s encoder %ux%u@%u failed 0x%08X (no hardware encoder for this codec?)",
+                  StreamName(stream), CodecName(codec), enc.width, enc.height, fps, (unsigned)hr);
+            enc = Encoder{};
+            enc.failed = true;
+            return false;
+        }
+        Notef("[SimXR] Recording: %s stream %ux%u@%u %s -> %s", StreamName(stream), enc.width, enc.height, fps,
+              CodecName(codec), path.c_str());
+        enc.failed = false;
+        return true;
+    }
+
+    // Recorder-side view of a slot's shared texture, reopened after the producer recreated it
+    bool OpenSlot(Slot& slot) {
+        if (slot.opened && slot.openedGeneration == slot.generation) return true;
+        slot.opened.Reset();
+        slot.openedMutex.Reset();
+        slot.srv.Reset();
+        HRESULT hr;
+        if (slot.ntHandle) {
+            ComPtr<ID3D11Device1> device1;
+            hr = m_device.As(&device1);
+            if (SUCCEEDED(hr)) hr = device1->OpenSharedResource1(slot.shared, IID_PPV_ARGS(slot.opened.GetAddressOf()));
+        } else {
+            hr = m_device->OpenSharedResource(slot.shared, IID_PPV_ARGS(slot.opened.GetAddressOf()));
+            if (SUCCEEDED(hr)) hr = slot.opened.As(&slot.openedMutex);
+        }
+        D3D11_SHADER_RESOURCE_VIEW_DESC srvDesc = {};
+        srvDesc.Format = SampleFormat(slot.format);
+        srvDesc.ViewDimension = D3D11_SRV_DIMENSION_TEXTURE2D;
+        srvDesc.Texture2D.MipLevels = 1;
+        if (SUCCEEDED(hr)) hr = m_device->CreateShaderResourceView(slot.opened.Get(), &srvDesc, slot.srv.GetAddressOf());
+        if (FAILED(hr)) {
+            Notef("[SimXR] Recording: opening shared texture failed 0x%08X", (unsigned)hr);
+            slot.opened.Reset();
+            slot.openedMutex.Reset();
+            slot.srv.Reset();
+            return false;
+        }
+        slot.openedGeneration = slot.generation;
+        return true;
+    }
+
+    // Scale / convert a slot into the stream's BGRA target; sRGB-encode linear sources
+    bool Convert(const Frame& f, Slot& slot, Encoder& enc) {
+        if (!EnsureEncoder(f.stream, enc, slot.width, slot.height, f.periodNs)) {
+            if (AllEncodersFailed() && m_active.exchange(false)) Notef("[SimXR] Recording stopped: no encoder");
+            return false;
+        }
+        // Repeated or out-of-order display times would break the file's timeline
+        if (enc.started && f.timeNs <= enc.lastNs) return false;
+
+        const bool linear = IsLinearFormat(SampleFormat(slot.format));
+        ID3D11RenderTargetView* rtv = enc.convertRtv[linear ? 1 : 0].Get();
+        const D3D11_VIEWPORT vp = { 0.0f, 0.0f, (float)enc.width, (float)enc.height, 0.0f, 1.0f };
+        ID3D11ShaderResourceView* srv = slot.srv.Get();
+        ID3D11SamplerState* sampler = m_sampler.Get();
+        m_ctx->OMSetRenderTargets(1, &rtv, nullptr);
+        m_ctx->RSSetViewports(1, &vp);
+        m_ctx->RSSetState(m_rasterizer.Get());
+        m_ctx->IASetInputLayout(nullptr);
+        m_ctx->IASetPrimitiveTopology(D3D11_PRIMITIVE_TOPOLOGY_TRIANGLESTRIP);
+        m_ctx->VSSetShader(f.flipY ? m_vsFlipY.Get() : m_vs.Get(), nullptr, 0);
+        m_ctx->PSSetShader(m_ps.Get(), nullptr, 0);
+        m_ctx->PSSetShaderResources(0, 1, &srv);
+        m_ctx->PSSetSamplers(0, 1, &sampler);
+        m_ctx->Draw(4, 0);
+        ID3D11ShaderResourceView* nullSrv = nullptr;
+        m_ctx->PSSetShaderResources(0, 1, &nullSrv);
+        m_ctx->OMSetRenderTargets(0, nullptr, nullptr);
+        return true;
+    }
+
+    // Every stream the recording wants has an encoder that could not be created
+    bool AllEncodersFailed() const {
+        const bool eyes = (m_options.source == Source::Eyes);
+        if (!eyes) return m_encoders[StreamPreview].failed;
+        return m_encoders[StreamLeft].failed && m_encoders[StreamRight].failed;
+    }
+
+    // Hands key 0 back to the producer on every way out of Encode once the slot is opened
+    struct KeyGuard {
+        IDXGIKeyedMutex* mutex{nullptr};
+        bool held{false};
+        bool Acquire() {
+            held = !mutex || mutex->AcquireSync(1, 100) == S_OK;
+            return held;
+        }
+        void Release() {
+            if (mutex && held) mutex->ReleaseSync(0);
+            mutex = nullptr;
+        }
+        ~KeyGuard() {
+            if (mutex && !held) Acquire();
+            Release();
+        }
+    };
+
+    // The producer released a keyed-mutex slot with key 1 and only ever acquires key 0. When the
+    // recorder can't hand the key back, the texture is dropped: the next Submit11 recreates it.
+    // The slot is Queued, so the producer isn't touching it.
+    static void AbandonSlot(Slot& slot) {
+        if (slot.tex11) slot.producer = nullptr;
+    }
+
+    bool Encode(const Frame& f) {
+        Slot& slot = m_slots[f.stream][f.slot];
+        Encoder& enc = m_encoders[f.stream];
+        if (!EnsureDevice(slot.adapter)) {
+            if (m_deviceFailed && m_active.exchange(false)) Notef("[SimXR] Recording stopped: no recorder device");
+            AbandonSlot(slot);
+            return false;
+        }
+        if (!OpenSlot(slot)) {
+            AbandonSlot(slot);
+            return false;
+        }
+        // From here on the key has to go back to the producer whatever happens
+        KeyGuard key{slot.openedMutex.Get()};
+
+        if (f.fence && f.fence->GetCompletedValue() < f.fenceValue) {
+            f.fence->SetEventOnCompletion(f.fenceValue, m_fenceEvent);
+            if (WaitForSingleObject(m_fenceEvent, 1000) != WAIT_OBJECT_0) return false;
+        }
+        if (!key.Acquire()) {
+            key.mutex = nullptr;  // still at key 1; nothing to hand back
+            AbandonSlot(slot);
+            return false;
+        }
+        const bool converted = Convert(f, slot, enc);
+        if (slot.openedMutex) {
+            key.Release();
+        } else if (converted) {
+            // D3D12 has no keyed mutex: the producer may overwrite the slot once it is freed,
+            // so the draw that reads it has to have finished (this thread only)
+            m_ctx->End(m_query.Get());
+            while (m_ctx->GetData(m_query.Get(), nullptr, 0, 0) == S_FALSE) SwitchToThread();
+        }
+        if (!converted) return false;
+
+        ComPtr<IMFSample> sample;
+        HRESULT hr = enc.allocator->AllocateSample(sample.GetAddressOf());
+        if (hr == MF_E_SAMPLEALLOCATOR_EMPTY) return false;  // encoder still holds every input texture
+        ComPtr<IMFMediaBuffer> buffer;
+        ComPtr<IMFDXGIBuffer> dxgiBuffer;
+        ComPtr<ID3D11Texture2D> target;
+        if (SUCCEEDED(hr)) hr = sample->GetBufferByIndex(0, buffer.GetAddressOf());
+        if (SUCCEEDED(hr)) hr = buffer.As(&dxgiBuffer);
+        if (SUCCEEDED(hr)) hr = dxgiBuffer->GetResource(IID_PPV_ARGS(target.GetAddressOf()));
+        if (FAILED(hr)) return false;
+        m_ctx->CopyResource(target.Get(), enc.convert.Get());
+        DWORD maxLength = 0;
+        if (SUCCEEDED(buffer->GetMaxLength(&maxLength))) buffer->SetCurrentLength(maxLength);
+
+        if (!enc.started) {
+            enc.firstNs = f.timeNs;
+            enc.started = true;
+        }
+        const int64_t periodNs = f.periodNs > 0 ? f.periodNs : enc.periodNs;
+        sample->SetSampleTime((f.timeNs - enc.firstNs) / 100);  // 100 ns units
+        sample->SetSampleDuration(periodNs / 100);
+        hr = enc.writer->WriteSample(enc.streamIndex, sample.Get());
+        if (FAILED(hr)) {
+            static int failures = 0;
+            if (++failures % 60 == 1) Notef("[SimXR] Recording: %s WriteSample failed 0x%08X", StreamName(f.stream), (unsigned)hr);
+            return false;
+        }
+        enc.lastNs = f.timeNs;
+        m_frames[f.stream].fetch_add(1, std::memory_order_relaxed);
+        return true;
+    }
+
+    void Finalize(uint32_t stream) {
+        Encoder& enc = m_encoders[stream];
+        if (enc.writer) {
+            const HRESULT hr = enc.started ? enc.writer->Finalize() : S_OK;
+            std::string path;
+            {
+                std::lock_guard<std::mutex> lock(m_mutex);
+                path = m_paths[stream];
+            }
+            Notef("[SimXR] Recording %s: %s (%llu frames, %llu dropped, %.1f s)%s", FAILED(hr) ? "FAILED" : "saved",
+                  path.c_str(), (unsigned long long)m_frames[stream].load(std::memory_order_relaxed),
+                  (unsigned long long)m_dropped[stream].load(std::memory_order_relaxed),
+                  (double)(enc.lastNs - enc.firstNs) * 1e-9, enc.started ? "" : " - no frames");
+        }
+        enc = Encoder{};
+    }
+
+    // Guarded by m_mutex: slot states, queue, stop, options, paths
+    std::mutex m_mutex;
+    std::condition_variable m_cv;
+    std::deque<Frame> m_queue;
+    bool m_stop{false};
+    std::thread m_thread;
+    Options m_options;
+    std::string m_paths[StreamCount];
+    Slot m_slots[StreamCount][kSlots];
+    uint32_t m_nextSlot[StreamCount] = {};
+    std::atomic<bool> m_active{false};
+    std::atomic<uint64_t> m_frames[StreamCount] = {};
+    std::atomic<uint64_t> m_dropped[StreamCount] = {};
+    bool m_unsupportedLogged[StreamCount] = {};
+
+    // D3D12 producer: slots recorded into the open preview list, posted by Commit12
+    int m_pending12[StreamCount] = { -1, -1, -1 };
+    int64_t m_pendingTime12[StreamCount] = {};
+    int64_t m_pendingPeriod12[StreamCount] = {};
+
+    // Recorder thread
+    ComPtr<ID3D11Device> m_device;
+    ComPtr<ID3D11DeviceContext> m_ctx;
+    ComPtr<IMFDXGIDeviceManager> m_dxgiManager;
+    ComPtr<ID3D11VertexShader> m_vs;
+    ComPtr<ID3D11VertexShader> m_vsFlipY;
+    ComPtr<ID3D11PixelShader> m_ps;
+    ComPtr<ID3D11SamplerState> m_sampler;
+    ComPtr<ID3D11RasterizerState> m_rasterizer;
+    ComPtr<ID3D11Query> m_query;
+    LUID m_luid{};
+    bool m_deviceFailed{false};
+    bool m_adapterMismatchLogged{false};
+    HANDLE m_fenceEvent{nullptr};
+    Encoder m_encoders[StreamCount];
+};
+
+} // namespace recording
@@ -0,0 +1,788 @@
+// Vulkan interop for OpenXR Simulator (XR_KHR_vulkan_enable2)
+// - Color swapchain images are D3D11 textures on a runtime-owned device, created on the
+//   Vulkan device's adapter and imported into Vulkan with VK_KHR_external_memory_win32. The
+//   preview samples them through the D3D11 blit path; nothing is read back to the CPU.
+// - Two shared D3D11 fences, imported as Vulkan semaphores (VK_KHR_external_semaphore_win32),
+//   order the two APIs on the GPU: xrReleaseSwapchainImage signals "rendered" on the app's
+//   queue and the preview's context waits for it in xrEndFrame, which then signals "composed";
+//   xrAcquireSwapchainImage makes the app's queue wait for "composed" before it renders again
+// - The semaphores are timeline semaphores when the device was created with them, otherwise
+//   binary semaphores given fence values with VkD3D12FenceSubmitInfoKHR
+// - Images change hands through a queue family ownership transfer to and from
+//   VK_QUEUE_FAMILY_EXTERNAL, recorded once per image when the swapchain is created
+// - Depth, multisampled and formats without a DXGI equivalent get plain Vulkan images: the
+//   app can render into them, the preview doesn't show them
+// - Vulkan is reached through the app's vkGetInstanceProcAddr (vulkan-1.dll as a fallback),
+//   so the runtime doesn't link the Vulkan loader
+#pragma once
+
+#ifdef XR_USE_GRAPHICS_API_VULKAN
+
+#include <windows.h>
+#include <d3d11_4.h>
+#include <dxgi1_6.h>
+#include <wrl/client.h>
+#ifndef VK_USE_PLATFORM_WIN32_KHR
+#define VK_USE_PLATFORM_WIN32_KHR
+#endif
+#ifndef VK_NO_PROTOTYPES
+#define VK_NO_PROTOTYPES
+#endif
+#include <vulkan/vulkan.h>
+#include <openxr/openxr.h>
+#include <algorithm>
+#include <cstdarg>
+#include <cstdio>
+#include <cstdint>
+#include <cstring>
+#include <vector>
+#include "async_log.h"
+
+namespace vkinterop {
+
+using Microsoft::WRL::ComPtr;
+
+inline void Note(const char* fmt, ...) {
+    char msg[512];
+    int n = snprintf(msg, sizeof(msg), "[SimXR] Vulkan: ");
+    va_list args;
+    va_start(args, fmt);
+    vsnprintf(msg + n, sizeof(msg) - n, fmt, args);
+    va_end(args);
+    logging::Write(logging::CatGeneral, logging::Level::Info, msg);
+}
+
+// ---------- Loader ----------
+
+// Set from the app's XrVulkanInstanceCreateInfoKHR / XrVulkanDeviceCreateInfoKHR
+inline PFN_vkGetInstanceProcAddr g_getInstanceProcAddr = nullptr;
+// The instance from xrCreateVulkanInstanceKHR / xrGetVulkanGraphicsDevice2KHR; the device
+// create info carries none, but vkCreateDevice has to be loaded from one
+inline VkInstance g_instance = VK_NULL_HANDLE;
+
+inline PFN_vkGetInstanceProcAddr GetInstanceProcAddr() {
+    if (g_getInstanceProcAddr) return g_getInstanceProcAddr;
+    HMODULE module = GetModuleHandleA("vulkan-1.dll");
+    if (!module) module = LoadLibraryA("vulkan-1.dll");
+    if (module) g_getInstanceProcAddr = (PFN_vkGetInstanceProcAddr)GetProcAddress(module, "vkGetInstanceProcAddr");
+    return g_getInstanceProcAddr;
+}
+
+#define SIMXR_VK_INSTANCE_FUNCTIONS(X) \
+    X(vkEnumeratePhysicalDevices) \
+    X(vkGetPhysicalDeviceProperties) \
+    X(vkGetPhysicalDeviceProperties2) \
+    X(vkGetPhysicalDeviceFeatures2) \
+    X(vkGetPhysicalDeviceMemoryProperties) \
+    X(vkEnumerateDeviceExtensionProperties) \
+    X(vkCreateDevice) \
+    X(vkGetDeviceProcAddr)
+
+#define SIMXR_VK_DEVICE_FUNCTIONS(X) \
+    X(vkGetDeviceQueue) \
+    X(vkCreateFence) \
+    X(vkDestroyFence) \
+    X(vkGetFenceStatus) \
+    X(vkResetFences) \
+    X(vkWaitForFences) \
+    X(vkCreateImage) \
+    X(vkDestroyImage) \
+    X(vkGetImageMemoryRequirements) \
+    X(vkAllocateMemory) \
+    X(vkFreeMemory) \
+    X(vkBindImageMemory) \
+    X(vkCreateSemaphore) \
+    X(vkDestroySemaphore) \
+    X(vkCreateCommandPool) \
+    X(vkDestroyCommandPool) \
+    X(vkAllocateCommandBuffers) \
+    X(vkBeginCommandBuffer) \
+    X(vkEndCommandBuffer) \
+    X(vkCmdPipelineBarrier) \
+    X(vkQueueSubmit)
+
+// Interop entry points; null when the device lacks the win32 external memory/semaphore extensions
+#define SIMXR_VK_INTEROP_FUNCTIONS(X) \
+    X(vkGetMemoryWin32HandlePropertiesKHR) \
+    X(vkImportSemaphoreWin32HandleKHR)
+
+struct Functions {
+#define SIMXR_VK_DECLARE(name) PFN_##name name = nullptr;
+    SIMXR_VK_INSTANCE_FUNCTIONS(SIMXR_VK_DECLARE)
+    SIMXR_VK_DEVICE_FUNCTIONS(SIMXR_VK_DECLARE)
+    SIMXR_VK_INTEROP_FUNCTIONS(SIMXR_VK_DECLARE)
+#undef SIMXR_VK_DECLARE
+
+    bool LoadInstance(VkInstance instance) {
+        PFN_vkGetInstanceProcAddr gipa = GetInstanceProcAddr();
+        if (!gipa || !instance) return false;
+        bool ok = true;
+#define SIMXR_VK_LOAD(name) ok &= (name = (PFN_##name)gipa(instance, #name)) != nullptr;
+        SIMXR_VK_INSTANCE_FUNCTIONS(SIMXR_VK_LOAD)
+#undef SIMXR_VK_LOAD
+        return ok;
+    }
+
+    bool LoadDevice(VkDevice device) {
+        if (!vkGetDeviceProcAddr || !device) return false;
+        bool ok = true;
+#define SIMXR_VK_LOAD(name) ok &= (name = (PFN_##name)vkGetDeviceProcAddr(device, #name)) != nullptr;
+        SIMXR_VK_DEVICE_FUNCTIONS(SIMXR_VK_LOAD)
+#undef SIMXR_VK_LOAD
+#define SIMXR_VK_LOAD_OPTIONAL(name) name = (PFN_##name)vkGetDeviceProcAddr(device, #name);
+        SIMXR_VK_INTEROP_FUNCTIONS(SIMXR_VK_LOAD_OPTIONAL)
+#undef SIMXR_VK_LOAD_OPTIONAL
+        return ok;
+    }
+};
+
+// ---------- Formats ----------
+
+// Offered by xrEnumerateSwapchainFormats, most preferred first
+inline constexpr VkFormat kSwapchainFormats[] = {
+    VK_FORMAT_R8G8B8A8_SRGB,
+    VK_FORMAT_B8G8R8A8_SRGB,
+    VK_FORMAT_R8G8B8A8_UNORM,
+    VK_FORMAT_B8G8R8A8_UNORM,
+    VK_FORMAT_R16G16B16A16_SFLOAT,
+    VK_FORMAT_R32G32B32A32_SFLOAT,
+    VK_FORMAT_A2B10G10R10_UNORM_PACK32,
+    VK_FORMAT_D32_SFLOAT,
+    VK_FORMAT_D24_UNORM_S8_UINT,
+    VK_FORMAT_D32_SFLOAT_S8_UINT,
+    VK_FORMAT_D16_UNORM,
+};
+
+// Same memory layout in both APIs; UNKNOWN when there is none
+inline DXGI_FORMAT ToDXGI(VkFormat format) {
+    switch (format) {
+        case VK_FORMAT_R8G8B8A8_SRGB:            return DXGI_FORMAT_R8G8B8A8_UNORM_SRGB;
+        case VK_FORMAT_R8G8B8A8_UNORM:           return DXGI_FORMAT_R8G8B8A8_UNORM;
+        case VK_FORMAT_B8G8R8A8_SRGB:            return DXGI_FORMAT_B8G8R8A8_UNORM_SRGB;
+        case VK_FORMAT_B8G8R8A8_UNORM:           return DXGI_FORMAT_B8G8R8A8_UNORM;
+        case VK_FORMAT_R16G16B16A16_SFLOAT:      return DXGI_FORMAT_R16G16B16A16_FLOAT;
+        case VK_FORMAT_R32G32B32A32_SFLOAT:      return DXGI_FORMAT_R32G32B32A32_FLOAT;
+        case VK_FORMAT_A2B10G10R10_UNORM_PACK32: return DXGI_FORMAT_R10G10B10A2_UNORM;
+        case VK_FORMAT_D32_SFLOAT:               return DXGI_FORMAT_D32_FLOAT;
+        case VK_FORMAT_D24_UNORM_S8_UINT:        return DXGI_FORMAT_D24_UNORM_S8_UINT;
+        case VK_FORMAT_D32_SFLOAT_S8_UINT:       return DXGI_FORMAT_D32_FLOAT_S8X24_UINT;
+        case VK_FORMAT_D16_UNORM:                return DXGI_FORMAT_D16_UNORM;
+        default:                                 return DXGI_FORMAT_UNKNOWN;
+    }
+}
+
+inline VkImageAspectFlags AspectOf(VkFormat format) {
+    switch (format) {
+        case VK_FORMAT_D16_UNORM:
+        case VK_FORMAT_X8_D24_UNORM_PACK32:
+        case VK_FORMAT_D32_SFLOAT:
+            return VK_IMAGE_ASPECT_DEPTH_BIT;
+        case VK_FORMAT_D16_UNORM_S8_UINT:
+        case VK_FORMAT_D24_UNORM_S8_UINT:
+        case VK_FORMAT_D32_SFLOAT_S8_UINT:
+            return VK_IMAGE_ASPECT_DEPTH_BIT | VK_IMAGE_ASPECT_STENCIL_BIT;
+        case VK_FORMAT_S8_UINT:
+            return VK_IMAGE_ASPECT_STENCIL_BIT;
+        default:
+            return VK_IMAGE_ASPECT_COLOR_BIT;
+    }
+}
+
+// ---------- Instance and device creation (xrCreateVulkanInstanceKHR / xrCreateVulkanDeviceKHR) ----------
+
+// The app's VkInstanceCreateInfo with apiVersion raised to 1.1, where external memory and
+// semaphore capabilities and vkGetPhysicalDeviceProperties2 are core
+struct InstanceCreateInfo {
+    VkInstanceCreateInfo info{};
+    VkApplicationInfo app{};
+
+    explicit InstanceCreateInfo(const VkInstanceCreateInfo& source) : info(source) {
+        if (source.pApplicationInfo) app = *source.pApplicationInfo;
+        app.sType = VK_STRUCTURE_TYPE_APPLICATION_INFO;
+        app.apiVersion = std::max<uint32_t>(app.apiVersion, VK_API_VERSION_1_1);
+        info.pApplicationInfo = &app;
+    }
+};
+
+// The app's VkDeviceCreateInfo plus the extensions and features the interop needs, where the
+// device has them. The app's own pNext chain is kept; ours is prepended.
+struct DeviceCreateInfo {
+    VkDeviceCreateInfo info{};
+    std::vector<const char*> extensions;
+    VkPhysicalDeviceTimelineSemaphoreFeatures timelineFeatures{VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_TIMELINE_SEMAPHORE_FEATURES};
+    bool interop = false;      // external memory + semaphore win32 extensions enabled
+    bool timeline = false;     // timelineSemaphore feature enabled
+
+    DeviceCreateInfo(const Functions& fn, VkPhysicalDevice physicalDevice, const VkDeviceCreateInfo& source)
+        : info(source) {
+        extensions.assign(source.ppEnabledExtensionNames, source.ppEnabledExtensionNames + source.enabledExtensionCount);
+        uint32_t count = 0;
+        fn.vkEnumerateDeviceExtensionProperties(physicalDevice, nullptr, &count, nullptr);
+        std::vector<VkExtensionProperties> available(count);
+        fn.vkEnumerateDeviceExtensionProperties(physicalDevice, nullptr, &count, available.data());
+        auto supported = [&](const char* name) {
+            for (const auto& e : available) {
+                if (strcmp(e.extensionName, name) == 0) return true;
+            }
+            return false;
+        };
+        auto enable = [&](const char* name) {
+            if (!supported(name)) return false;
+            for (const char* e : extensions) {
+                if (strcmp(e, name) == 0) return true;
+            }
+            extensions.push_back(name);
+            return true;
+        };
+        // External memory, external semaphore and dedicated allocation are core in 1.1
+        const bool memory = enable(VK_KHR_EXTERNAL_MEMORY_WIN32_EXTENSION_NAME);
+        const bool semaphore = enable(VK_KHR_EXTERNAL_SEMAPHORE_WIN32_EXTENSION_NAME);
+        interop = memory && semaphore;
+
+        if (interop && supported(VK_KHR_TIMELINE_SEMAPHORE_EXTENSION_NAME)) {
+            VkPhysicalDeviceTimelineSemaphoreFeatures query{VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_TIMELINE_SEMAPHORE_FEATURES};
+            VkPhysicalDeviceFeatures2 features{VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_FEATURES_2};
+            features.pNext = &query;
+            fn.vkGetPhysicalDeviceFeatures2(physicalDevice, &features);
+            if (query.timelineSemaphore) {
+                // An app chain that already carries the feature decides it; adding a second
+                // timeline or Vulkan12 features struct would be invalid
+                bool chained = false;
+                for (auto* s = (const VkBaseInStructure*)source.pNext; s; s = s->pNext) {
+                    if (s->sType == VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_VULKAN_1_2_FEATURES) {
+                        timeline = ((const VkPhysicalDeviceVulkan12Features*)s)->timelineSemaphore == VK_TRUE;
+                        chained = true;
+                    } else if (s->sType == VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_TIMELINE_SEMAPHORE_FEATURES) {
+                        timeline = ((const VkPhysicalDeviceTimelineSemaphoreFeatures*)s)->timelineSemaphore == VK_TRUE;
+                        chained = true;
+                    }
+                }
+                if (!chained) {
+                    timelineFeatures.timelineSemaphore = VK_TRUE;
+                    timelineFeatures.pNext = const_cast<void*>(source.pNext);
+                    info.pNext = &timelineFeatures;
+                    timeline = true;
+                }
+                if (timeline) enable(VK_KHR_TIMELINE_SEMAPHORE_EXTENSION_NAME);
+            }
+        }
+        info.enabledExtensionCount = (uint32_t)extensions.size();
+        info.ppEnabledExtensionNames = extensions.data();
+    }
+};
+
+// What xrCreateVulkanDeviceKHR enabled on the device it created last. A session bound to a
+// device the runtime didn't create gets no interop.
+struct CreatedDevice {
+    VkDevice device = VK_NULL_HANDLE;
+    bool interop = false;
+    bool timeline = false;
+};
+inline CreatedDevice g_createdDevice;
+
+inline bool LuidOf(const Functions& fn, VkPhysicalDevice physicalDevice, LUID& luid) {
+    VkPhysicalDeviceIDProperties id{VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_ID_PROPERTIES};
+    VkPhysicalDeviceProperties2 props{VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_PROPERTIES_2};
+    props.pNext = &id;
+    fn.vkGetPhysicalDeviceProperties2(physicalDevice, &props);
+    if (!id.deviceLUIDValid) return false;
+    static_assert(sizeof(LUID) == VK_LUID_SIZE, "LUID size");
+    memcpy(&luid, id.deviceLUID, sizeof(luid));
+    return true;
+}
+
+// The physical device on the adapter with this LUID; the first discrete GPU (or any) otherwise
+inline VkPhysicalDevice SelectPhysicalDevice(const Functions& fn, VkInstance instance, const LUID* luid) {
+    uint32_t count = 0;
+    if (fn.vkEnumeratePhysicalDevices(instance, &count, nullptr) != VK_SUCCESS || count == 0) return VK_NULL_HANDLE;
+    std::vector<VkPhysicalDevice> devices(count);
+    fn.vkEnumeratePhysicalDevices(instance, &count, devices.data());
+    VkPhysicalDevice fallback = devices[0];
+    for (VkPhysicalDevice d : devices) {
+        LUID id{};
+        if (luid && LuidOf(fn, d, id) && id.LowPart == luid->LowPart && id.HighPart == luid->HighPart) return d;
+        VkPhysicalDeviceProperties props{};
+        fn.vkGetPhysicalDeviceProperties(d, &props);
+        if (props.deviceType == VK_PHYSICAL_DEVICE_TYPE_DISCRETE_GPU && fallback == devices[0]) fallback = d;
+    }
+    return fallback;
+}
+
+// ---------- Session ----------
+
+struct Device {
+    Functions fn;
+    VkInstance instance = VK_NULL_HANDLE;
+    VkPhysicalDevice physicalDevice = VK_NULL_HANDLE;
+    VkDevice device = VK_NULL_HANDLE;
+    VkQueue queue = VK_NULL_HANDLE;
+    uint32_t queueFamily = 0;
+    LUID luid{};
+    bool luidValid = false;
+    bool interop = false;           // images are shared and the semaphores below exist
+    bool timeline = false;
+    // "rendered": signalled on the app's queue with each release, waited on by the preview.
+    // "composed": signalled by the preview at the end of xrEndFrame, waited on with each acquire.
+    ComPtr<ID3D11DeviceContext4> context11;
+    ComPtr<ID3D11Fence> rendered11, composed11;
+    VkSemaphore rendered = VK_NULL_HANDLE, composed = VK_NULL_HANDLE;
+    uint64_t renderedValue = 0, composedValue = 0;   // last values signalled
+    uint64_t renderedWaited = 0;    // last "rendered" value the preview context waited for
+    // One fence per runtime submission still in flight. Teardown waits on these: the queue may
+    // only be used in xrBegin/EndFrame and xrAcquire/ReleaseSwapchainImage, so no vkQueueWaitIdle
+    // and no vkDeviceWaitIdle, which touches every queue of the app's device.
+    std::vector<VkFence> fencesInFlight, fencesFree;
+};
+
+// Bind the app's device and queue. False only when Vulkan itself can't be reached.
+inline bool Open(Device& d, VkInstance instance, VkPhysicalDevice physicalDevice, VkDevice device,
+                 uint32_t queueFamily, uint32_t queueIndex) {
+    d = Device{};
+    if (!d.fn.LoadInstance(instance) || !d.fn.LoadDevice(device)) {
+        Note("entry points unavailable (instance=%p device=%p)", (void*)instance, (void*)device);
+        return false;
+    }
+    d.instance = instance;
+    d.physicalDevice = physicalDevice;
+    d.device = device;
+    d.queueFamily = queueFamily;
+    d.fn.vkGetDeviceQueue(device, queueFamily, queueIndex, &d.queue);
+    d.luidValid = LuidOf(d.fn, physicalDevice, d.luid);
+    return d.queue != VK_NULL_HANDLE;
+}
+
+// The DXGI adapter the Vulkan device runs on, so D3D11 textures can be shared with it
+inline ComPtr<IDXGIAdapter1> FindAdapter(const Device& d) {
+    ComPtr<IDXGIAdapter1> adapter;
+    ComPtr<IDXGIFactory4> factory;
+    if (!d.luidValid || FAILED(CreateDXGIFactory1(IID_PPV_ARGS(factory.GetAddressOf())))) return adapter;
+    factory->EnumAdapterByLuid(d.luid, IID_PPV_ARGS(adapter.GetAddressOf()));
+    return adapter;
+}
+
+inline VkSemaphore ImportFence(Device& d, ID3D11Fence* fence) {
+    HANDLE handle = nullptr;
+    HRESULT hr = fence->CreateSharedHandle(nullptr, GENERIC_ALL, nullptr, &handle);
+    if (FAILED(hr)) {
+        Note("ID3D11Fence::CreateSharedHandle failed 0x%08X", (unsigned)hr);
+        return VK_NULL_HANDLE;
+    }
+    VkSemaphoreTypeCreateInfo type{VK_STRUCTURE_TYPE_SEMAPHORE_TYPE_CREATE_INFO};
+    type.semaphoreType = VK_SEMAPHORE_TYPE_TIMELINE;
+    VkSemaphoreCreateInfo ci{VK_STRUCTURE_TYPE_SEMAPHORE_CREATE_INFO};
+    if (d.timeline) ci.pNext = &type;
+    VkSemaphore semaphore = VK_NULL_HANDLE;
+    VkResult result = d.fn.vkCreateSemaphore(d.device, &ci, nullptr, &semaphore);
+    if (result == VK_SUCCESS) {
+        VkImportSemaphoreWin32HandleInfoKHR importInfo{VK_STRUCTURE_TYPE_IMPORT_SEMAPHORE_WIN32_HANDLE_INFO_KHR};
+        importInfo.semaphore = semaphore;
+        importInfo.handleType = VK_EXTERNAL_SEMAPHORE_HANDLE_TYPE_D3D12_FENCE_BIT;  // also D3D11 fences
+        importInfo.handle = handle;
+        result = d.fn.vkImportSemaphoreWin32HandleKHR(d.device, &importInfo);
+        if (result != VK_SUCCESS) {
+            d.fn.vkDestroySemaphore(d.device, semaphore, nullptr);
+            semaphore = VK_NULL_HANDLE;
+        }
+    }
+    CloseHandle(handle);  // importing an NT handle doesn't take ownership of it
+    if (result != VK_SUCCESS) Note("fence import failed (VkResult %d)", (int)result);
+    return semaphore;
+}
+
+// Shared fences between the preview's D3D11 device and the app's Vulkan device. Without them
+// (missing extensions, an 11.3-less driver, a device the runtime didn't create) swapchains
+// get plain Vulkan images and the preview stays empty.
+inline bool OpenInterop(Device& d, ID3D11Device* device11, ID3D11DeviceContext* context11) {
+    d.interop = false;
+    const CreatedDevice& created = g_createdDevice;
+    if (created.device != d.device || !created.interop) {
+        Note("device %p was not created with the interop extensions; no preview", (void*)d.device);
+        return false;
+    }
+    d.timeline = created.timeline;
+    ComPtr<ID3D11Device5> device5;
+    if (!device11 || FAILED(device11->QueryInterface(IID_PPV_ARGS(device5.GetAddressOf()))) ||
+        FAILED(context11->QueryInterface(IID_PPV_ARGS(d.context11.GetAddressOf())))) {
+        Note("D3D11.4 fences unavailable; no preview");
+        return false;
+    }
+    HRESULT hr = device5->CreateFence(0, D3D11_FENCE_FLAG_SHARED, IID_PPV_ARGS(d.rendered11.GetAddressOf()));
+    if (SUCCEEDED(hr)) hr = device5->CreateFence(0, D3D11_FENCE_FLAG_SHARED, IID_PPV_ARGS(d.composed11.GetAddressOf()));
+    if (FAILED(hr)) {
+        Note("ID3D11Device5::CreateFence failed 0x%08X; no preview", (unsigned)hr);
+        return false;
+    }
+    d.rendered = ImportFence(d, d.rendered11.Get());
+    d.composed = ImportFence(d, d.composed11.Get());
+    d.interop = d.rendered != VK_NULL_HANDLE && d.composed != VK_NULL_HANDLE;
+    return d.interop;
+}
+
+// Recycle the fences of completed submissions, then hand out a free one (null if none can be
+// created; the submission then goes untracked)
+inline VkFence NextFence(Device& d) {
+    size_t kept = 0;
+    for (VkFence fence : d.fencesInFlight) {
+        if (d.fn.vkGetFenceStatus(d.device, fence) == VK_SUCCESS) {
+            d.fn.vkResetFences(d.device, 1, &fence);
+            d.fencesFree.push_back(fence);
+        } else {
+            d.fencesInFlight[kept++] = fence;
+        }
+    }
+    d.fencesInFlight.resize(kept);
+    if (!d.fencesFree.empty()) {
+        const VkFence fence = d.fencesFree.back();
+        d.fencesFree.pop_back();
+        return fence;
+    }
+    VkFenceCreateInfo ci{VK_STRUCTURE_TYPE_FENCE_CREATE_INFO};
+    VkFence fence = VK_NULL_HANDLE;
+    if (d.fn.vkCreateFence(d.device, &ci, nullptr, &fence) != VK_SUCCESS) return VK_NULL_HANDLE;
+    return fence;
+}
+
+// Wait for every submission the runtime made; the app's own work is its business
+inline void WaitForSubmissions(Device& d) {
+    if (!d.device || d.fencesInFlight.empty()) return;
+    const VkResult result = d.fn.vkWaitForFences(d.device, (uint32_t)d.fencesInFlight.size(),
+                                                 d.fencesInFlight.data(), VK_TRUE, 2000000000ull);
+    if (result != VK_SUCCESS) Note("waiting for runtime submissions failed (VkResult %d)", (int)result);
+    d.fn.vkResetFences(d.device, (uint32_t)d.fencesInFlight.size(), d.fencesInFlight.data());
+    d.fencesFree.insert(d.fencesFree.end(), d.fencesInFlight.begin(), d.fencesInFlight.end());
+    d.fencesInFlight.clear();
+}
+
+// The app's device is still alive; only what the runtime created on it goes. Swapchain
+// chains have to be destroyed first (DestroyChain needs d).
+inline void Close(Device& d) {
+    if (d.device) {
+        WaitForSubmissions(d);
+        if (d.rendered) d.fn.vkDestroySemaphore(d.device, d.rendered, nullptr);
+        if (d.composed) d.fn.vkDestroySemaphore(d.device, d.composed, nullptr);
+        for (VkFence fence : d.fencesFree) d.fn.vkDestroyFence(d.device, fence, nullptr);
+    }
+    d = Device{};
+}
+
+inline bool Submit(Device& d, VkCommandBuffer cmd, VkSemaphore wait, uint64_t waitValue,
+                   VkSemaphore signal, uint64_t signalValue) {
+    const VkPipelineStageFlags waitStage = VK_PIPELINE_STAGE_ALL_COMMANDS_BIT;
+    VkSubmitInfo si{VK_STRUCTURE_TYPE_SUBMIT_INFO};
+    si.waitSemaphoreCount = wait ? 1 : 0;
+    si.pWaitSemaphores = &wait;
+    si.pWaitDstStageMask = &waitStage;
+    si.commandBufferCount = 1;
+    si.pCommandBuffers = &cmd;
+    si.signalSemaphoreCount = signal ? 1 : 0;
+    si.pSignalSemaphores = &signal;
+    // Same values either way; binary semaphores imported from a D3D fence take them from here
+    VkTimelineSemaphoreSubmitInfo timeline{VK_STRUCTURE_TYPE_TIMELINE_SEMAPHORE_SUBMIT_INFO};
+    VkD3D12FenceSubmitInfoKHR fenceValues{VK_STRUCTURE_TYPE_D3D12_FENCE_SUBMIT_INFO_KHR};
+    if (d.timeline) {
+        timeline.waitSemaphoreValueCount = si.waitSemaphoreCount;
+        timeline.pWaitSemaphoreValues = &waitValue;
+        timeline.signalSemaphoreValueCount = si.signalSemaphoreCount;
+        timeline.pSignalSemaphoreValues = &signalValue;
+        si.pNext = &timeline;
+    } else if (d.interop) {
+        fenceValues.waitSemaphoreValuesCount = si.waitSemaphoreCount;
+        fenceValues.pWaitSemaphoreValues = &waitValue;
+        fenceValues.signalSemaphoreValuesCount = si.signalSemaphoreCount;
+        fenceValues.pSignalSemaphoreValues = &signalValue;
+        si.pNext = &fenceValues;
+    }
+    const VkFence fence = NextFence(d);
+    const VkResult result = d.fn.vkQueueSubmit(d.queue, 1, &si, fence);
+    if (fence) (result == VK_SUCCESS ? d.fencesInFlight : d.fencesFree).push_back(fence);
+    if (result != VK_SUCCESS) {
+        static uint32_t failures = 0;
+        if (++failures <= 5) Note("vkQueueSubmit failed (VkResult %d)", (int)result);
+        return false;
+    }
+    return true;
+}
+
+// xrEndFrame, before the preview touches any image: its context waits for the last release
+inline void BeginPreview(Device& d) {
+    if (!d.interop || d.renderedValue == d.renderedWaited) return;
+    d.context11->Wait(d.rendered11.Get(), d.renderedValue);
+    d.renderedWaited = d.renderedValue;
+}
+
+// xrEndFrame, after the preview's last read. The flush gets the signal to the GPU even when
+// nothing is presented (headless, minimized window).
+inline void EndPreview(Device& d) {
+    if (!d.interop) return;
+    d.context11->Signal(d.composed11.Get(), ++d.composedValue);
+    d.context11->Flush();
+}
+
+// ---------- Swapchains ----------
+
+struct Image {
+    VkImage image = VK_NULL_HANDLE;
+    VkDeviceMemory memory = VK_NULL_HANDLE;
+    VkCommandBuffer acquireFirst = VK_NULL_HANDLE;  // from UNDEFINED, first acquire only
+    VkCommandBuffer acquire = VK_NULL_HANDLE;       // back from the preview (shared images)
+    VkCommandBuffer release = VK_NULL_HANDLE;       // over to the preview (shared images)
+    bool acquired = false;                          // acquired at least once
+};
+
+struct Chain {
+    VkCommandPool pool = VK_NULL_HANDLE;
+    std::vector<Image> images;
+    bool shared = false;            // images[i] aliases the swapchain's D3D11 texture i
+};
+
+struct ImageDesc {
+    VkFormat format = VK_FORMAT_UNDEFINED;
+    uint32_t width = 0, height = 0, arraySize = 1, mipCount = 1, sampleCount = 1;
+    XrSwapchainUsageFlags usage = 0;
+};
+
+inline uint32_t FindMemoryType(const Device& d, uint32_t typeBits) {
+    VkPhysicalDeviceMemoryProperties props{};
+    d.fn.vkGetPhysicalDeviceMemoryProperties(d.physicalDevice, &props);
+    for (uint32_t i = 0; i < props.memoryTypeCount; ++i) {
+        if ((typeBits & (1u << i)) && (props.memoryTypes[i].propertyFlags & VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT)) return i;
+    }
+    for (uint32_t i = 0; i < props.memoryTypeCount; ++i) {
+        if (typeBits & (1u << i)) return i;
+    }
+    return UINT32_MAX;
+}
+
+inline VkImageCreateInfo ImageCreateInfo(const ImageDesc& desc) {
+    const bool depth = AspectOf(desc.format) != VK_IMAGE_ASPECT_COLOR_BIT;
+    VkImageCreateInfo ci{VK_STRUCTURE_TYPE_IMAGE_CREATE_INFO};
+    ci.imageType = VK_IMAGE_TYPE_2D;
+    ci.format = desc.format;
+    ci.extent = {desc.width, desc.height, 1};
+    ci.mipLevels = desc.mipCount;
+    ci.arrayLayers = desc.arraySize;
+    ci.samples = (VkSampleCountFlagBits)desc.sampleCount;
+    ci.tiling = VK_IMAGE_TILING_OPTIMAL;
+    // The attachment usage is always there: acquired images are handed over in attachment layout
+    ci.usage = depth ? VK_IMAGE_USAGE_DEPTH_STENCIL_ATTACHMENT_BIT : VK_IMAGE_USAGE_COLOR_ATTACHMENT_BIT;
+    if (desc.usage & XR_SWAPCHAIN_USAGE_UNORDERED_ACCESS_BIT) ci.usage |= VK_IMAGE_USAGE_STORAGE_BIT;
+    if (desc.usage & XR_SWAPCHAIN_USAGE_TRANSFER_SRC_BIT) ci.usage |= VK_IMAGE_USAGE_TRANSFER_SRC_BIT;
+    if (desc.usage & XR_SWAPCHAIN_USAGE_TRANSFER_DST_BIT) ci.usage |= VK_IMAGE_USAGE_TRANSFER_DST_BIT;
+    if (desc.usage & XR_SWAPCHAIN_USAGE_SAMPLED_BIT) ci.usage |= VK_IMAGE_USAGE_SAMPLED_BIT;
+    if (desc.usage & XR_SWAPCHAIN_USAGE_INPUT_ATTACHMENT_BIT_KHR) ci.usage |= VK_IMAGE_USAGE_INPUT_ATTACHMENT_BIT;
+    if (desc.usage & XR_SWAPCHAIN_USAGE_MUTABLE_FORMAT_BIT) ci.flags |= VK_IMAGE_CREATE_MUTABLE_FORMAT_BIT;
+    ci.sharingMode = VK_SHARING_MODE_EXCLUSIVE;
+    ci.initialLayout = VK_IMAGE_LAYOUT_UNDEFINED;
+    return ci;
+}
+
+// One reusable command buffer holding a single layout transition / ownership transfer
+inline VkCommandBuffer RecordBarrier(Device& d, VkCommandPool pool, VkImage image, const ImageDesc& desc,
+                                     VkImageLayout oldLayout, VkImageLayout newLayout,
+                                     uint32_t srcFamily, uint32_t dstFamily,
+                                     VkAccessFlags srcAccess, VkAccessFlags dstAccess,
+                                     VkPipelineStageFlags srcStage, VkPipelineStageFlags dstStage) {
+    VkCommandBufferAllocateInfo ai{VK_STRUCTURE_TYPE_COMMAND_BUFFER_ALLOCATE_INFO};
+    ai.commandPool = pool;
+    ai.level = VK_COMMAND_BUFFER_LEVEL_PRIMARY;
+    ai.commandBufferCount = 1;
+    VkCommandBuffer cmd = VK_NULL_HANDLE;
+    if (d.fn.vkAllocateCommandBuffers(d.device, &ai, &cmd) != VK_SUCCESS) return VK_NULL_HANDLE;
+    VkCommandBufferBeginInfo bi{VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO};
+    // Resubmitted every frame; an earlier submit may still be pending when the app runs ahead
+    bi.flags = VK_COMMAND_BUFFER_USAGE_SIMULTANEOUS_USE_BIT;
+    d.fn.vkBeginCommandBuffer(cmd, &bi);
+    VkImageMemoryBarrier barrier{VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER};
+    barrier.srcAccessMask = srcAccess;
+    barrier.dstAccessMask = dstAccess;
+    barrier.oldLayout = oldLayout;
+    barrier.newLayout = newLayout;
+    barrier.srcQueueFamilyIndex = srcFamily;
+    barrier.dstQueueFamilyIndex = dstFamily;
+    barrier.image = image;
+    barrier.subresourceRange = {AspectOf(desc.format), 0, VK_REMAINING_MIP_LEVELS, 0, VK_REMAINING_ARRAY_LAYERS};
+    d.fn.vkCmdPipelineBarrier(cmd, srcStage, dstStage, 0, 0, nullptr, 0, nullptr, 1, &barrier);
+    return d.fn.vkEndCommandBuffer(cmd) == VK_SUCCESS ? cmd : VK_NULL_HANDLE;
+}
+
+inline bool RecordTransitions(Device& d, Chain& chain, Image& img, const ImageDesc& desc) {
+    const bool depth = AspectOf(desc.format) != VK_IMAGE_ASPECT_COLOR_BIT;
+    const VkImageLayout layout = depth ? VK_IMAGE_LAYOUT_DEPTH_STENCIL_ATTACHMENT_OPTIMAL : VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL;
+    const VkAccessFlags access = depth
+        ? VK_ACCESS_DEPTH_STENCIL_ATTACHMENT_READ_BIT | VK_ACCESS_DEPTH_STENCIL_ATTACHMENT_WRITE_BIT
+        : VK_ACCESS_COLOR_ATTACHMENT_READ_BIT | VK_ACCESS_COLOR_ATTACHMENT_WRITE_BIT;
+    const VkPipelineStageFlags stage = VK_PIPELINE_STAGE_ALL_GRAPHICS_BIT;
+    if (!chain.shared) {
+        img.acquireFirst = RecordBarrier(d, chain.pool, img.image, desc, VK_IMAGE_LAYOUT_UNDEFINED, layout,
+                                         VK_QUEUE_FAMILY_IGNORED, VK_QUEUE_FAMILY_IGNORED,
+                                         0, access, VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT, stage);
+        return img.acquireFirst != VK_NULL_HANDLE;
+    }
+    // The D3D11 side sees the image in GENERAL; ownership moves with every acquire and release
+    img.acquireFirst = RecordBarrier(d, chain.pool, img.image, desc, VK_IMAGE_LAYOUT_UNDEFINED, layout,
+                                     VK_QUEUE_FAMILY_EXTERNAL, d.queueFamily,
+                                     0, access, VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT, stage);
+    img.acquire = RecordBarrier(d, chain.pool, img.image, desc, VK_IMAGE_LAYOUT_GENERAL, layout,
+                                VK_QUEUE_FAMILY_EXTERNAL, d.queueFamily,
+                                0, access, VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT, stage);
+    img.release = RecordBarrier(d, chain.pool, img.image, desc, layout, VK_IMAGE_LAYOUT_GENERAL,
+                                d.queueFamily, VK_QUEUE_FAMILY_EXTERNAL,
+                                access, 0, stage, VK_PIPELINE_STAGE_BOTTOM_OF_PIPE_BIT);
+    return img.acquireFirst && img.acquire && img.release;
+}
+
+inline void DestroyImage(Device& d, Image& img) {
+    if (img.image) d.fn.vkDestroyImage(d.device, img.image, nullptr);
+    if (img.memory) d.fn.vkFreeMemory(d.device, img.memory, nullptr);
+    img = Image{};
+}
+
+// Command buffers go with the pool. The app has finished with the images, but our own
+// ownership transfers may still be queued.
+inline void DestroyChain(Device& d, Chain& chain) {
+    if (!d.device) return;
+    if (!chain.images.empty() || chain.pool) WaitForSubmissions(d);
+    for (Image& img : chain.images) DestroyImage(d, img);
+    chain.images.clear();
+    if (chain.pool) d.fn.vkDestroyCommandPool(d.device, chain.pool, nullptr);
+    chain.pool = VK_NULL_HANDLE;
+    chain.shared = false;
+}
+
+// A D3D11 texture on the preview device and a Vulkan image bound to the same memory
+inline bool CreateSharedImage(Device& d, ID3D11Device* device11, const ImageDesc& desc,
+                              Image& img, ComPtr<ID3D11Texture2D>& texture) {
+    D3D11_TEXTURE2D_DESC td{};
+    td.Width = desc.width;
+    td.Height = desc.height;
+    td.MipLevels = desc.mipCount;
+    td.ArraySize = desc.arraySize;
+    td.Format = ToDXGI(desc.format);
+    td.SampleDesc.Count = 1;
+    td.Usage = D3D11_USAGE_DEFAULT;
+    td.BindFlags = D3D11_BIND_SHADER_RESOURCE | D3D11_BIND_RENDER_TARGET;
+    if (desc.usage & XR_SWAPCHAIN_USAGE_UNORDERED_ACCESS_BIT) td.BindFlags |= D3D11_BIND_UNORDERED_ACCESS;
+    td.MiscFlags = D3D11_RESOURCE_MISC_SHARED | D3D11_RESOURCE_MISC_SHARED_NTHANDLE;
+    HRESULT hr = device11->CreateTexture2D(&td, nullptr, texture.ReleaseAndGetAddressOf());
+    ComPtr<IDXGIResource1> resource;
+    HANDLE handle = nullptr;
+    if (SUCCEEDED(hr)) hr = texture.As(&resource);
+    if (SUCCEEDED(hr)) hr = resource->CreateSharedHandle(nullptr, DXGI_SHARED_RESOURCE_READ | DXGI_SHARED_RESOURCE_WRITE, nullptr, &handle);
+    if (FAILED(hr)) {
+        Note("shared texture fmt=%d %ux%u failed 0x%08X", (int)td.Format, td.Width, td.Height, (unsigned)hr);
+        texture.Reset();
+        return false;
+    }
+
+    VkExternalMemoryImageCreateInfo external{VK_STRUCTURE_TYPE_EXTERNAL_MEMORY_IMAGE_CREATE_INFO};
+    external.handleTypes = VK_EXTERNAL_MEMORY_HANDLE_TYPE_D3D11_TEXTURE_BIT;
+    VkImageCreateInfo ci = ImageCreateInfo(desc);
+    ci.pNext = &external;
+    VkResult result = d.fn.vkCreateImage(d.device, &ci, nullptr, &img.image);
+    if (result == VK_SUCCESS) {
+        VkMemoryRequirements req{};
+        d.fn.vkGetImageMemoryRequirements(d.device, img.image, &req);
+        VkMemoryWin32HandlePropertiesKHR handleProps{VK_STRUCTURE_TYPE_MEMORY_WIN32_HANDLE_PROPERTIES_KHR};
+        uint32_t typeBits = req.memoryTypeBits;
+        if (d.fn.vkGetMemoryWin32HandlePropertiesKHR(d.device, VK_EXTERNAL_MEMORY_HANDLE_TYPE_D3D11_TEXTURE_BIT,
+                                                     handle, &handleProps) == VK_SUCCESS &&
+            (handleProps.memoryTypeBits & typeBits)) {
+            typeBits &= handleProps.memoryTypeBits;
+        }
+        VkMemoryDedicatedAllocateInfo dedicated{VK_STRUCTURE_TYPE_MEMORY_DEDICATED_ALLOCATE_INFO};
+        dedicated.image = img.image;
+        VkImportMemoryWin32HandleInfoKHR importInfo{VK_STRUCTURE_TYPE_IMPORT_MEMORY_WIN32_HANDLE_INFO_KHR};
+        importInfo.pNext = &dedicated;
+        importInfo.handleType = VK_EXTERNAL_MEMORY_HANDLE_TYPE_D3D11_TEXTURE_BIT;
+        importInfo.handle = handle;
+        VkMemoryAllocateInfo ai{VK_STRUCTURE_TYPE_MEMORY_ALLOCATE_INFO};
+        ai.pNext = &importInfo;
+        ai.allocationSize = req.size;
+        ai.memoryTypeIndex = FindMemoryType(d, typeBits);
+        result = ai.memoryTypeIndex == UINT32_MAX ? VK_ERROR_FEATURE_NOT_PRESENT
+                                                  : d.fn.vkAllocateMemory(d.device, &ai, nullptr, &img.memory);
+        if (result == VK_SUCCESS) result = d.fn.vkBindImageMemory(d.device, img.image, img.memory, 0);
+    }
+    CloseHandle(handle);  // importing an NT handle doesn't take ownership of it
+    if (result != VK_SUCCESS) {
+        Note("import of shared texture fmt=%d failed (VkResult %d)", (int)td.Format, (int)result);
+        DestroyImage(d, img);
+        texture.Reset();
+        return false;
+    }
+    return true;
+}
+
+inline bool CreatePlainImage(Device& d, const ImageDesc& desc, Image& img) {
+    const VkImageCreateInfo ci = ImageCreateInfo(desc);
+    VkResult result = d.fn.vkCreateImage(d.device, &ci, nullptr, &img.image);
+    if (result == VK_SUCCESS) {
+        VkMemoryRequirements req{};
+        d.fn.vkGetImageMemoryRequirements(d.device, img.image, &req);
+        VkMemoryAllocateInfo ai{VK_STRUCTURE_TYPE_MEMORY_ALLOCATE_INFO};
+        ai.allocationSize = req.size;
+        ai.memoryTypeIndex = FindMemoryType(d, req.memoryTypeBits);
+        result = ai.memoryTypeIndex == UINT32_MAX ? VK_ERROR_FEATURE_NOT_PRESENT
+                                                  : d.fn.vkAllocateMemory(d.device, &ai, nullptr, &img.memory);
+        if (result == VK_SUCCESS) result = d.fn.vkBindImageMemory(d.device, img.image, img.memory, 0);
+    }
+    if (result != VK_SUCCESS) {
+        Note("image fmt=%d %ux%u failed (VkResult %d)", (int)desc.format, desc.width, desc.height, (int)result);
+        DestroyImage(d, img);
+        return false;
+    }
+    return true;
+}
+
+// Shared images when the format and sample count allow it, plain ones otherwise (or when
+// sharing fails). textures receives the D3D11 side of shared images and stays empty otherwise.
+inline bool CreateChain(Device& d, ID3D11Device* device11, const ImageDesc& desc, uint32_t count,
+                        Chain& chain, std::vector<ComPtr<ID3D11Texture2D>>& textures) {
+    VkCommandPoolCreateInfo pi{VK_STRUCTURE_TYPE_COMMAND_POOL_CREATE_INFO};
+    pi.queueFamilyIndex = d.queueFamily;
+    if (d.fn.vkCreateCommandPool(d.device, &pi, nullptr, &chain.pool) != VK_SUCCESS) return false;
+
+    const bool shareable = d.interop && device11 && desc.sampleCount <= 1 &&
+                           AspectOf(desc.format) == VK_IMAGE_ASPECT_COLOR_BIT && ToDXGI(desc.format) != DXGI_FORMAT_UNKNOWN;
+    for (int attempt = shareable ? 0 : 1; attempt < 2; ++attempt) {
+        chain.shared = attempt == 0;
+        bool ok = true;
+        for (uint32_t i = 0; i < count && ok; ++i) {
+            Image img;
+            ComPtr<ID3D11Texture2D> texture;
+            ok = chain.shared ? CreateSharedImage(d, device11, desc, img, texture) : CreatePlainImage(d, desc, img);
+            if (ok) ok = RecordTransitions(d, chain, img, desc);
+            if (img.image) chain.images.push_back(img);
+            if (ok && texture) textures.push_back(std::move(texture));
+        }
+        if (ok) return true;
+        // Start over with plain images; recorded command buffers are freed with the pool
+        for (Image& img : chain.images) DestroyImage(d, img);
+        chain.images.clear();
+        textures.clear();
+        if (chain.shared) Note("falling back to unshared images (no preview for this swapchain)");
+    }
+    DestroyChain(d, chain);
+    return false;
+}
+
+// xrAcquireSwapchainImage: back into the app's attachment layout, after the preview's last read
+inline void Acquire(Device& d, Chain& chain, uint32_t index) {
+    if (index >= chain.images.size()) return;
+    Image& img = chain.images[index];
+    const VkCommandBuffer cmd = img.acquired ? img.acquire : img.acquireFirst;
+    img.acquired = true;
+    if (!cmd) return;
+    const bool wait = chain.shared && d.composedValue != 0;
+    Submit(d, cmd, wait ? d.composed : VK_NULL_HANDLE, d.composedValue, VK_NULL_HANDLE, 0);
+}
+
+// xrReleaseSwapchainImage: over to the preview, after the app's rendering on its queue
+inline void Release(Device& d, Chain& chain, uint32_t index) {
+    if (index >= chain.images.size() || !chain.images[index].release) return;
+    if (Submit(d, chain.images[index].release, VK_NULL_HANDLE, 0, d.rendered, d.renderedValue + 1)) ++d.renderedValue;
+}
+
+} // namespace vkinterop
+
+#endif // XR_USE_GRAPHICS_API_VULKAN